@@ -0,0 +1,273 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Ankit Deepak <adadeepak8@gmail.com>
+ *          Shravya Ks <shravya.ks0@gmail.com>,
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+//
+// This script compares the fixed and the adaptive HELLO and TC intervals
+// of OLSR6 on a square grid of nodes linked to their horizontal and
+// vertical neighbors.
+//
+// For each mode it reports:
+//  - the control overhead: OLSR6 packets, messages and bytes sent;
+//  - the convergence time: when every node first has a route to every
+//    interface address of the network;
+//  - the failure detection time: when, after a link of the middle row
+//    stops delivering packets, both of its ends stop using it.
+//
+// ./waf --run "olsr6-adaptive-intervals --side=5 --failure=60 --duration=120"
+//
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/olsr6-helper.h"
+#include "ns3/olsr6-routing-protocol.h"
+
+#include <iostream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("Olsr6AdaptiveIntervals");
+
+/**
+ * Runs the grid scenario once and measures the control overhead and the
+ * convergence times.
+ */
+class AdaptiveIntervalsExperiment
+{
+public:
+  /**
+   * \param side number of nodes on a side of the grid
+   * \param failure time at which the link fails
+   * \param duration duration of the simulation
+   */
+  AdaptiveIntervalsExperiment (uint32_t side, Time failure, Time duration);
+
+  /**
+   * \brief Runs the scenario and prints the results.
+   * \param adaptive true for adaptive intervals, false for fixed ones
+   */
+  void Run (bool adaptive);
+
+private:
+  /// Counts the control traffic sent.
+  void Tx (const olsr6::PacketHeader &header, const olsr6::MessageList &messages);
+  /// Makes the failing link drop every packet.
+  void FailLink (void);
+  /// Checks the convergence, every 100 ms.
+  void Check (void);
+
+  uint32_t m_side;                //!< Nodes on a side of the grid.
+  Time m_failure;                 //!< Time of the link failure.
+  Time m_duration;                //!< Duration of the simulation.
+
+  NodeContainer m_nodes;          //!< The grid.
+  NetDeviceContainer m_failing;   //!< The two devices of the failing link.
+  Ipv6Address m_failingAddr[2];   //!< The addresses of the failing link.
+  uint32_t m_nAddresses;          //!< Number of interface addresses of the network.
+
+  uint32_t m_nPackets;            //!< OLSR6 packets sent.
+  uint32_t m_nMessages;           //!< OLSR6 messages sent.
+  uint64_t m_nBytes;              //!< OLSR6 bytes sent.
+  Time m_converged;               //!< Convergence time, zero until converged.
+  Time m_detected;                //!< Failure detection time, zero until detected.
+};
+
+AdaptiveIntervalsExperiment::AdaptiveIntervalsExperiment (uint32_t side, Time failure, Time duration)
+  : m_side (side),
+    m_failure (failure),
+    m_duration (duration)
+{
+}
+
+void
+AdaptiveIntervalsExperiment::Tx (const olsr6::PacketHeader &header, const olsr6::MessageList &messages)
+{
+  m_nPackets++;
+  m_nMessages += messages.size ();
+  m_nBytes += header.GetPacketLength ();
+}
+
+void
+AdaptiveIntervalsExperiment::FailLink (void)
+{
+  for (uint32_t i = 0; i < m_failing.GetN (); i++)
+    {
+      Ptr<RateErrorModel> em = CreateObject<RateErrorModel> ();
+      em->SetAttribute ("ErrorRate", DoubleValue (1.0));
+      em->SetAttribute ("ErrorUnit", StringValue ("ERROR_UNIT_PACKET"));
+      m_failing.Get (i)->SetAttribute ("ReceiveErrorModel", PointerValue (em));
+    }
+}
+
+void
+AdaptiveIntervalsExperiment::Check (void)
+{
+  if (m_converged.IsZero ())
+    {
+      bool converged = true;
+      for (uint32_t i = 0; i < m_nodes.GetN () && converged; i++)
+        {
+          Ptr<Ipv6> ipv6 = m_nodes.Get (i)->GetObject<Ipv6> ();
+          Ptr<olsr6::RoutingProtocol> olsr6 = Olsr6Helper::GetOlsr6RoutingProtocol (m_nodes.Get (i));
+          converged = olsr6->GetRoutingTableEntries ().size () == m_nAddresses - (ipv6->GetNInterfaces () - 1);
+        }
+      if (converged)
+        {
+          m_converged = Simulator::Now ();
+        }
+    }
+
+  if (Simulator::Now () > m_failure && m_detected.IsZero ())
+    {
+      bool detected = true;
+      for (uint32_t i = 0; i < 2; i++)
+        {
+          Ptr<olsr6::RoutingProtocol> olsr6 =
+            Olsr6Helper::GetOlsr6RoutingProtocol (m_failing.Get (i)->GetNode ());
+          std::vector<olsr6::RoutingTableEntry> table = olsr6->GetRoutingTableEntries ();
+          for (std::vector<olsr6::RoutingTableEntry>::const_iterator it = table.begin (); it != table.end (); it++)
+            {
+              if (it->nextAddr == m_failingAddr[1 - i])
+                {
+                  detected = false;
+                }
+            }
+        }
+      if (detected)
+        {
+          m_detected = Simulator::Now ();
+        }
+    }
+
+  Simulator::Schedule (MilliSeconds (100), &AdaptiveIntervalsExperiment::Check, this);
+}
+
+void
+AdaptiveIntervalsExperiment::Run (bool adaptive)
+{
+  m_nPackets = 0;
+  m_nMessages = 0;
+  m_nBytes = 0;
+  m_converged = Seconds (0);
+  m_detected = Seconds (0);
+  m_nAddresses = 0;
+
+  m_nodes = NodeContainer ();
+  m_nodes.Create (m_side * m_side);
+
+  Olsr6Helper olsr6;
+  olsr6.Set ("AdaptiveIntervals", BooleanValue (adaptive));
+  InternetStackHelper internet;
+  internet.SetIpv4StackInstall (false);
+  internet.SetRoutingHelper (olsr6);
+  internet.Install (m_nodes);
+
+  // One channel per link of the grid
+  SimpleNetDeviceHelper simpleNetHelper;
+  simpleNetHelper.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  simpleNetHelper.SetChannelAttribute ("Delay", StringValue ("2ms"));
+
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase ("2001:1::", Ipv6Prefix (64));
+  for (uint32_t row = 0; row < m_side; row++)
+    {
+      for (uint32_t column = 0; column < m_side; column++)
+        {
+          Ptr<Node> node = m_nodes.Get (row * m_side + column);
+          if (column + 1 < m_side)
+            {
+              NetDeviceContainer devices =
+                simpleNetHelper.Install (NodeContainer (node, m_nodes.Get (row * m_side + column + 1)));
+              Ipv6InterfaceContainer interfaces = ipv6.Assign (devices);
+              ipv6.NewNetwork ();
+              m_nAddresses += 2;
+              if (row == m_side / 2 && column == 0)
+                {
+                  m_failing = devices;
+                  m_failingAddr[0] = interfaces.GetAddress (0, 1);
+                  m_failingAddr[1] = interfaces.GetAddress (1, 1);
+                }
+            }
+          if (row + 1 < m_side)
+            {
+              ipv6.Assign (simpleNetHelper.Install (NodeContainer (node, m_nodes.Get ((row + 1) * m_side + column))));
+              ipv6.NewNetwork ();
+              m_nAddresses += 2;
+            }
+        }
+    }
+
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    {
+      Olsr6Helper::GetOlsr6RoutingProtocol (m_nodes.Get (i))->TraceConnectWithoutContext (
+        "Tx", MakeCallback (&AdaptiveIntervalsExperiment::Tx, this));
+    }
+
+  Simulator::Schedule (m_failure, &AdaptiveIntervalsExperiment::FailLink, this);
+  Simulator::Schedule (MilliSeconds (100), &AdaptiveIntervalsExperiment::Check, this);
+  Simulator::Stop (m_duration);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  std::cout << (adaptive ? "adaptive" : "fixed   ")
+            << "  packets " << m_nPackets
+            << "  messages " << m_nMessages
+            << "  bytes " << m_nBytes
+            << "  converged ";
+  if (m_converged.IsZero ())
+    {
+      std::cout << "never";
+    }
+  else
+    {
+      std::cout << m_converged.GetSeconds () << " s";
+    }
+  std::cout << "  failure detected ";
+  if (m_detected.IsZero ())
+    {
+      std::cout << "never";
+    }
+  else
+    {
+      std::cout << (m_detected - m_failure).GetSeconds () << " s after";
+    }
+  std::cout << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t side = 5;
+  double failure = 60.0;
+  double duration = 120.0;
+
+  CommandLine cmd;
+  cmd.AddValue ("side", "number of nodes on a side of the grid", side);
+  cmd.AddValue ("failure", "time at which a link of the middle row fails, in seconds", failure);
+  cmd.AddValue ("duration", "duration of each simulation in seconds", duration);
+  cmd.Parse (argc, argv);
+
+  AdaptiveIntervalsExperiment experiment (side, Seconds (failure), Seconds (duration));
+  experiment.Run (false);
+  experiment.Run (true);
+
+  return 0;
+}
@@ -0,0 +1,282 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Ankit Deepak <adadeepak8@gmail.com>
+ *          Shravya Ks <shravya.ks0@gmail.com>,
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+//
+// This script compares a static willingness with the willingness
+// controller of OLSR6, which lowers the willingness of the overloaded
+// relays so that their neighbors select other MPRs.
+//
+// Three columns of 802.11b ad hoc stations, 100 m apart:
+//
+//   S0        R0        D0
+//   S1        R1        D1
+//   S2        R2        D2
+//
+// Each source S sends UDP packets to the site-local group ff05::1, which
+// the receivers D listen to.  The sources reach the receivers only through
+// the relays R, and any relay alone covers all the receivers, so each
+// source selects a single relay as MPR and the multicast data packets are
+// relayed by the MPRs of the sources (s-mpr, RFC 6621).  R0 is configured
+// with a high willingness: with a static willingness, every source selects
+// it.  With the forwarding load signal, R0 lowers its willingness when it
+// forwards more than its share, and the sources spread over the relays.
+//
+// For each mode it reports the packets relayed by each relay, the Jain
+// fairness index of these counts (1 when they are even, 1/3 when a single
+// relay carries everything) and the delivery ratio at the receivers.
+//
+// ./waf --run "olsr6-dynamic-willingness --rate=10 --duration=60"
+//
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/olsr6-helper.h"
+#include "ns3/olsr6-routing-protocol.h"
+
+#include <iostream>
+#include <set>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("Olsr6DynamicWillingness");
+
+/**
+ * Runs the three columns scenario once and measures how the multicast
+ * packets are spread over the relays.
+ */
+class DynamicWillingnessExperiment
+{
+public:
+  /**
+   * \param rate packets per second of each source
+   * \param duration duration of the traffic
+   * \param capacity forwarded packets per second taken as the full load of a relay
+   */
+  DynamicWillingnessExperiment (uint32_t rate, Time duration, uint32_t capacity);
+
+  /**
+   * \brief Runs the scenario and prints the results.
+   * \param dynamic true for the forwarding load signal, false for a static willingness
+   */
+  void Run (bool dynamic);
+
+private:
+  /**
+   * \brief Sends the next packet of a source.
+   * \param source index of the source
+   */
+  void Send (uint32_t source);
+  /// Receives the packets of a receiver.
+  void Receive (Ptr<Socket> socket);
+  /**
+   * \brief Counts the packets relayed by a node.
+   * \param count the counter of the node
+   * \param packet the packet relayed
+   * \param header its IPv6 header
+   */
+  static void Relay (uint32_t *count, Ptr<const Packet> packet, const Ipv6Header &header);
+
+  uint32_t m_rate;                //!< Packets per second of each source.
+  Time m_duration;                //!< Duration of the traffic.
+  uint32_t m_capacity;            //!< Forwarding capacity of the relays.
+
+  std::vector<Ptr<Socket> > m_sources;            //!< Sockets of the sources.
+  Time m_stop;                                    //!< End of the traffic.
+  uint32_t m_sent;                                //!< Packets sent by all the sources.
+  std::vector<std::set<uint32_t> > m_received;    //!< Packets received by each node, by source and number.
+  std::vector<uint32_t> m_relayed;                //!< Packets relayed by each node.
+};
+
+DynamicWillingnessExperiment::DynamicWillingnessExperiment (uint32_t rate, Time duration, uint32_t capacity)
+  : m_rate (rate),
+    m_duration (duration),
+    m_capacity (capacity)
+{
+}
+
+void
+DynamicWillingnessExperiment::Send (uint32_t source)
+{
+  // The source and the number of the packet make each payload different
+  uint32_t id = (source << 24) | (m_sent & 0xffffff);
+  uint8_t payload[512] = { 0 };
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      payload[i] = (id >> (8 * i)) & 0xff;
+    }
+  m_sources[source]->SendTo (Create<Packet> (payload, sizeof (payload)), 0,
+                             Inet6SocketAddress (Ipv6Address ("ff05::1"), 9));
+  m_sent++;
+  if (Simulator::Now () < m_stop)
+    {
+      Simulator::Schedule (Seconds (1.0 / m_rate), &DynamicWillingnessExperiment::Send, this, source);
+    }
+}
+
+void
+DynamicWillingnessExperiment::Receive (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      uint8_t payload[4];
+      packet->CopyData (payload, 4);
+      m_received[socket->GetNode ()->GetId ()].insert (payload[0] | (payload[1] << 8)
+                                                       | (payload[2] << 16) | (payload[3] << 24));
+    }
+}
+
+void
+DynamicWillingnessExperiment::Relay (uint32_t *count, Ptr<const Packet> packet, const Ipv6Header &header)
+{
+  (*count)++;
+}
+
+void
+DynamicWillingnessExperiment::Run (bool dynamic)
+{
+  // Nodes 0-2 are the sources, 3-5 the relays and 6-8 the receivers
+  const uint32_t column = 3;
+  NodeContainer nodes;
+  nodes.Create (3 * column);
+
+  m_sent = 0;
+  m_received.assign (nodes.GetN (), std::set<uint32_t> ());
+  m_relayed.assign (nodes.GetN (), 0);
+
+  // Neighbor columns are in range, the sources and the receivers are not
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator ("ns3::GridPositionAllocator",
+                                 "MinX", DoubleValue (0.0),
+                                 "MinY", DoubleValue (0.0),
+                                 "DeltaX", DoubleValue (100.0),
+                                 "DeltaY", DoubleValue (30.0),
+                                 "GridWidth", UintegerValue (column),
+                                 "LayoutType", StringValue ("ColumnFirst"));
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (nodes);
+
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211b);
+  YansWifiPhyHelper wifiPhy = YansWifiPhyHelper::Default ();
+  YansWifiChannelHelper wifiChannel;
+  wifiChannel.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
+  wifiChannel.AddPropagationLoss ("ns3::RangePropagationLossModel", "MaxRange", DoubleValue (150.0));
+  wifiPhy.SetChannel (wifiChannel.Create ());
+  WifiMacHelper wifiMac;
+  Config::SetDefault ("ns3::WifiRemoteStationManager::NonUnicastMode", StringValue ("DsssRate11Mbps"));
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                "DataMode", StringValue ("DsssRate11Mbps"),
+                                "ControlMode", StringValue ("DsssRate1Mbps"));
+  wifiMac.SetType ("ns3::AdhocWifiMac");
+  NetDeviceContainer devices = wifi.Install (wifiPhy, wifiMac, nodes);
+
+  Olsr6Helper olsr6;
+  olsr6.Set ("MulticastRelay", StringValue ("s-mpr"));
+  if (dynamic)
+    {
+      olsr6.Set ("WillingnessLoadSignal", StringValue ("forwarding"));
+      olsr6.Set ("ForwardingCapacity", UintegerValue (m_capacity));
+    }
+  InternetStackHelper internet;
+  internet.SetIpv4StackInstall (false);
+  internet.SetRoutingHelper (olsr6);
+  internet.Install (nodes);
+
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase ("2001:1::", Ipv6Prefix (64));
+  ipv6.Assign (devices);
+
+  // The best placed relay, as far as its configuration tells
+  Olsr6Helper::GetOlsr6RoutingProtocol (nodes.Get (column))->SetAttribute ("Willingness", StringValue ("high"));
+
+  TypeId tid = TypeId::LookupByName ("ns3::UdpSocketFactory");
+  for (uint32_t i = 2 * column; i < nodes.GetN (); i++)
+    {
+      Ptr<Socket> socket = Socket::CreateSocket (nodes.Get (i), tid);
+      socket->Bind (Inet6SocketAddress (Ipv6Address::GetAny (), 9));
+      socket->SetRecvCallback (MakeCallback (&DynamicWillingnessExperiment::Receive, this));
+    }
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Olsr6Helper::GetOlsr6RoutingProtocol (nodes.Get (i))->TraceConnectWithoutContext (
+        "MulticastRelay", MakeBoundCallback (&DynamicWillingnessExperiment::Relay, &m_relayed[i]));
+    }
+
+  // The MPRs are selected once the first TC messages went round
+  Time start = Seconds (30);
+  m_stop = start + m_duration;
+  m_sources.clear ();
+  for (uint32_t i = 0; i < column; i++)
+    {
+      Ptr<Socket> socket = Socket::CreateSocket (nodes.Get (i), tid);
+      socket->Bind6 ();
+      m_sources.push_back (socket);
+      // The sources do not send at the same time
+      Simulator::Schedule (start + Seconds (i * 0.3 / m_rate), &DynamicWillingnessExperiment::Send, this, i);
+    }
+  Simulator::Stop (m_stop + Seconds (1));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_sources.clear ();
+
+  std::cout << (dynamic ? "forwarding load" : "static") << std::endl;
+  double sum = 0;
+  double sumSquares = 0;
+  for (uint32_t i = column; i < 2 * column; i++)
+    {
+      std::cout << "  relay R" << i - column << "  relayed " << m_relayed[i] << std::endl;
+      sum += m_relayed[i];
+      sumSquares += double (m_relayed[i]) * m_relayed[i];
+    }
+  uint32_t received = 0;
+  for (uint32_t i = 2 * column; i < nodes.GetN (); i++)
+    {
+      received += m_received[i].size ();
+    }
+  std::cout << "  fairness " << (sumSquares > 0 ? sum * sum / (column * sumSquares) : 0)
+            << "  delivery " << double (received) / (m_sent * column)
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t rate = 10;
+  double duration = 60;
+  uint32_t capacity = 25;
+
+  CommandLine cmd;
+  cmd.AddValue ("rate", "packets per second of each source", rate);
+  cmd.AddValue ("duration", "duration of the traffic, in seconds", duration);
+  cmd.AddValue ("capacity", "forwarded packets per second taken as the full load of a relay", capacity);
+  cmd.Parse (argc, argv);
+
+  DynamicWillingnessExperiment experiment (rate, Seconds (duration), capacity);
+  experiment.Run (false);
+  experiment.Run (true);
+
+  return 0;
+}
@@ -0,0 +1,263 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Ankit Deepak <adadeepak8@gmail.com>
+ *          Shravya Ks <shravya.ks0@gmail.com>,
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+//
+// This script compares the hop count and the ETX link metrics of OLSR6 on
+// a square grid of nodes linked to their horizontal and vertical
+// neighbors, each link dropping a random share of its packets.
+//
+// For each metric it walks the routing tables, from every node to the main
+// address of every other node, once the routes have settled, and reports:
+//  - the mean delivery ratio of the routes: the product of the delivery
+//    ratios of their links, as the links do not retransmit;
+//  - the mean length of the routes, in hops;
+//  - the number of pairs of nodes without a complete route;
+//  - the control overhead: OLSR6 bytes sent.
+//
+// ./waf --run "olsr6-etx-grid --side=5 --maxLoss=0.5 --duration=120"
+//
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/olsr6-helper.h"
+#include "ns3/olsr6-routing-protocol.h"
+
+#include <iostream>
+#include <map>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("Olsr6EtxGrid");
+
+/**
+ * Runs the lossy grid scenario once and measures the quality of the routes.
+ */
+class EtxGridExperiment
+{
+public:
+  /**
+   * \param side number of nodes on a side of the grid
+   * \param maxLoss highest loss rate of a link
+   * \param duration duration of the simulation
+   */
+  EtxGridExperiment (uint32_t side, double maxLoss, Time duration);
+
+  /**
+   * \brief Runs the scenario and prints the results.
+   * \param metric "hop-count" or "etx"
+   */
+  void Run (std::string metric);
+
+private:
+  /// Counts the control traffic sent.
+  void Tx (const olsr6::PacketHeader &header, const olsr6::MessageList &messages);
+  /**
+   * \brief Adds a link between two nodes of the grid, with its loss rate.
+   * \param a the first node
+   * \param b the second node
+   */
+  void AddLink (Ptr<Node> a, Ptr<Node> b);
+  /// Walks the routes between every pair of nodes.
+  void Measure (void);
+
+  uint32_t m_side;                //!< Nodes on a side of the grid.
+  double m_maxLoss;               //!< Highest loss rate of a link.
+  Time m_duration;                //!< Duration of the simulation.
+
+  NodeContainer m_nodes;          //!< The grid.
+  SimpleNetDeviceHelper m_simpleNetHelper;  //!< Creates the links.
+  Ipv6AddressHelper m_ipv6;       //!< Addresses the links.
+  Ptr<UniformRandomVariable> m_loss;  //!< Draws the loss rates.
+  std::map<Ipv6Address, uint32_t> m_owner;    //!< Node of each interface address.
+  std::map<Ipv6Address, double> m_delivery;   //!< Delivery ratio towards each interface address.
+
+  uint64_t m_nBytes;              //!< OLSR6 bytes sent.
+};
+
+EtxGridExperiment::EtxGridExperiment (uint32_t side, double maxLoss, Time duration)
+  : m_side (side),
+    m_maxLoss (maxLoss),
+    m_duration (duration)
+{
+  m_simpleNetHelper.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  m_simpleNetHelper.SetChannelAttribute ("Delay", StringValue ("2ms"));
+}
+
+void
+EtxGridExperiment::Tx (const olsr6::PacketHeader &header, const olsr6::MessageList &messages)
+{
+  m_nBytes += header.GetPacketLength ();
+}
+
+void
+EtxGridExperiment::AddLink (Ptr<Node> a, Ptr<Node> b)
+{
+  NetDeviceContainer devices = m_simpleNetHelper.Install (NodeContainer (a, b));
+  Ipv6InterfaceContainer interfaces = m_ipv6.Assign (devices);
+  m_ipv6.NewNetwork ();
+
+  // Each direction of the link drops its own share of the packets
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      double loss = m_loss->GetValue (0, m_maxLoss);
+      Ptr<RateErrorModel> em = CreateObject<RateErrorModel> ();
+      em->SetAttribute ("ErrorRate", DoubleValue (loss));
+      em->SetAttribute ("ErrorUnit", StringValue ("ERROR_UNIT_PACKET"));
+      devices.Get (i)->SetAttribute ("ReceiveErrorModel", PointerValue (em));
+
+      Ipv6Address addr = interfaces.GetAddress (i, 1);
+      m_owner[addr] = devices.Get (i)->GetNode ()->GetId ();
+      m_delivery[addr] = 1 - loss;
+    }
+}
+
+void
+EtxGridExperiment::Measure (void)
+{
+  double delivery = 0;
+  uint32_t hops = 0;
+  uint32_t routes = 0;
+  uint32_t broken = 0;
+
+  for (uint32_t src = 0; src < m_nodes.GetN (); src++)
+    {
+      for (uint32_t dst = 0; dst < m_nodes.GetN (); dst++)
+        {
+          if (src == dst)
+            {
+              continue;
+            }
+          Ipv6Address target = m_nodes.Get (dst)->GetObject<Ipv6> ()->GetAddress (1, 1).GetAddress ();
+
+          // Follows the next hops, at most one per node of the grid
+          uint32_t current = src;
+          double pathDelivery = 1;
+          uint32_t pathHops = 0;
+          while (current != dst && pathHops < m_nodes.GetN ())
+            {
+              Ptr<olsr6::RoutingProtocol> olsr6 = Olsr6Helper::GetOlsr6RoutingProtocol (m_nodes.Get (current));
+              std::vector<olsr6::RoutingTableEntry> table = olsr6->GetRoutingTableEntries ();
+              std::vector<olsr6::RoutingTableEntry>::const_iterator it = table.begin ();
+              while (it != table.end () && it->destAddr != target)
+                {
+                  it++;
+                }
+              if (it == table.end () || m_owner.find (it->nextAddr) == m_owner.end ())
+                {
+                  break;
+                }
+              pathDelivery *= m_delivery[it->nextAddr];
+              current = m_owner[it->nextAddr];
+              pathHops++;
+            }
+
+          if (current == dst)
+            {
+              delivery += pathDelivery;
+              hops += pathHops;
+              routes++;
+            }
+          else
+            {
+              broken++;
+            }
+        }
+    }
+
+  std::cout << "  delivery " << (routes ? delivery / routes : 0)
+            << "  hops " << (routes ? double (hops) / routes : 0)
+            << "  broken " << broken;
+}
+
+void
+EtxGridExperiment::Run (std::string metric)
+{
+  m_nBytes = 0;
+  m_owner.clear ();
+  m_delivery.clear ();
+
+  // The same loss rates for every metric
+  m_loss = CreateObject<UniformRandomVariable> ();
+  m_loss->SetStream (0);
+
+  m_nodes = NodeContainer ();
+  m_nodes.Create (m_side * m_side);
+
+  Olsr6Helper olsr6;
+  olsr6.Set ("LinkMetric", StringValue (metric));
+  InternetStackHelper internet;
+  internet.SetIpv4StackInstall (false);
+  internet.SetRoutingHelper (olsr6);
+  internet.Install (m_nodes);
+
+  // One channel per link of the grid
+  m_ipv6.SetBase ("2001:1::", Ipv6Prefix (64));
+  for (uint32_t row = 0; row < m_side; row++)
+    {
+      for (uint32_t column = 0; column < m_side; column++)
+        {
+          Ptr<Node> node = m_nodes.Get (row * m_side + column);
+          if (column + 1 < m_side)
+            {
+              AddLink (node, m_nodes.Get (row * m_side + column + 1));
+            }
+          if (row + 1 < m_side)
+            {
+              AddLink (node, m_nodes.Get ((row + 1) * m_side + column));
+            }
+        }
+    }
+
+  for (uint32_t i = 0; i < m_nodes.GetN (); i++)
+    {
+      Olsr6Helper::GetOlsr6RoutingProtocol (m_nodes.Get (i))->TraceConnectWithoutContext (
+        "Tx", MakeCallback (&EtxGridExperiment::Tx, this));
+    }
+
+  std::cout << metric;
+  Simulator::Schedule (m_duration, &EtxGridExperiment::Measure, this);
+  Simulator::Stop (m_duration);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  std::cout << "  bytes " << m_nBytes << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t side = 5;
+  double maxLoss = 0.5;
+  double duration = 120.0;
+
+  CommandLine cmd;
+  cmd.AddValue ("side", "number of nodes on a side of the grid", side);
+  cmd.AddValue ("maxLoss", "highest loss rate of a link, the rates are uniform from 0", maxLoss);
+  cmd.AddValue ("duration", "duration of each simulation in seconds", duration);
+  cmd.Parse (argc, argv);
+
+  EtxGridExperiment experiment (side, maxLoss, Seconds (duration));
+  experiment.Run ("hop-count");
+  experiment.Run ("etx");
+
+  return 0;
+}
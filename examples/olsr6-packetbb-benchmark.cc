@@ -0,0 +1,238 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Ankit Deepak <adadeepak8@gmail.com>
+ *          Shravya Ks <shravya.ks0@gmail.com>,
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+//
+// This script measures the throughput of the RFC 5444 codec of OLSR6
+// against the RFC 3626 codec of the OLSR6 messages.
+//
+// The same TC message, advertising a number of neighbors of one /64, is
+// written and read a number of times with:
+//
+//  - the MessageHeader, with the plain and the compressed encodings;
+//  - the PbbPacket, which copies the packet when it reads it;
+//  - the PbbPacketReader, which reads the packet in place and only puts
+//    the addresses together.
+//
+// For each, it reports the size of the message and the messages written
+// and read per second.
+//
+// ./waf --run "olsr6-packetbb-benchmark --neighbors=20 --iterations=100000"
+//
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/olsr6-header.h"
+#include "ns3/olsr6-packetbb.h"
+
+#include <iostream>
+
+using namespace ns3;
+using namespace olsr6;
+
+NS_LOG_COMPONENT_DEFINE ("Olsr6PacketBbBenchmark");
+
+/**
+ * \brief Prints the results of a codec.
+ * \param name the name of the codec
+ * \param size the size of the message
+ * \param iterations the number of messages written and read
+ * \param writeMs the time taken to write the messages
+ * \param readMs the time taken to read the messages
+ */
+static void
+Report (std::string name, uint32_t size, uint32_t iterations, int64_t writeMs, int64_t readMs)
+{
+  std::cout << name << ": " << size << " bytes";
+  if (writeMs > 0)
+    {
+      std::cout << ", written " << iterations * 1000.0 / writeMs << " messages/s";
+    }
+  if (readMs > 0)
+    {
+      std::cout << ", read " << iterations * 1000.0 / readMs << " messages/s";
+    }
+  std::cout << std::endl;
+}
+
+/**
+ * \brief Writes and reads a MessageHeader a number of times.
+ * \param name the name of the encoding
+ * \param message the message
+ * \param iterations the number of times
+ */
+static void
+MeasureMessageHeader (std::string name, const MessageHeader &message, uint32_t iterations)
+{
+  uint32_t size = message.GetSerializedSize ();
+  Buffer buffer;
+  buffer.AddAtStart (size);
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t i = 0; i < iterations; i++)
+    {
+      message.Serialize (buffer.Begin ());
+    }
+  int64_t writeMs = clock.End ();
+
+  uint32_t addresses = 0;
+  clock.Start ();
+  for (uint32_t i = 0; i < iterations; i++)
+    {
+      MessageHeader read;
+      read.Deserialize (buffer.Begin ());
+      addresses += read.GetTc ().neighborAddresses.size ();
+    }
+  int64_t readMs = clock.End ();
+  NS_ASSERT (addresses == iterations * message.GetTc ().neighborAddresses.size ());
+
+  Report (name, size, iterations, writeMs, readMs);
+}
+
+/**
+ * \brief Writes a PbbPacket a number of times, and reads it as many times
+ * with a copy, then in place.
+ * \param packet the packet
+ * \param iterations the number of times
+ */
+static void
+MeasurePbb (const PbbPacket &packet, uint32_t iterations)
+{
+  uint32_t size = packet.GetSerializedSize ();
+  uint32_t numAddresses = packet.messages[0].addressBlocks[0].addresses.size ();
+  Buffer buffer;
+  buffer.AddAtStart (size);
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  for (uint32_t i = 0; i < iterations; i++)
+    {
+      packet.Serialize (buffer.Begin ());
+    }
+  int64_t writeMs = clock.End ();
+
+  uint32_t addresses = 0;
+  clock.Start ();
+  for (uint32_t i = 0; i < iterations; i++)
+    {
+      PbbPacket read;
+      read.Deserialize (buffer.Begin ());
+      addresses += read.messages[0].addressBlocks[0].addresses.size ();
+    }
+  int64_t copyMs = clock.End ();
+  NS_ASSERT (addresses == iterations * numAddresses);
+
+  // The packet header is left out of the size of the message
+  Report ("RFC 5444, copied", size - 1, iterations, writeMs, copyMs);
+
+  addresses = 0;
+  clock.Start ();
+  for (uint32_t i = 0; i < iterations; i++)
+    {
+      PbbPacketReader reader (buffer.Begin (), size);
+      PbbMessageView message;
+      while (reader.NextMessage (message))
+        {
+          PbbAddressBlockView block;
+          while (message.NextAddressBlock (block))
+            {
+              for (uint32_t k = 0; k < block.numAddresses; k++)
+                {
+                  if (block.GetAddress (k) != Ipv6Address::GetAny ())
+                    {
+                      addresses++;
+                    }
+                }
+            }
+        }
+    }
+  int64_t inPlaceMs = clock.End ();
+  NS_ASSERT (addresses == iterations * numAddresses);
+
+  Report ("RFC 5444, in place", size - 1, iterations, 0, inPlaceMs);
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t neighbors = 20;
+  uint32_t iterations = 100000;
+
+  CommandLine cmd;
+  cmd.AddValue ("neighbors", "number of neighbors advertised by the TC message, 255 at most", neighbors);
+  cmd.AddValue ("iterations", "number of times each message is written and read", iterations);
+  cmd.Parse (argc, argv);
+  NS_ABORT_MSG_IF (neighbors == 0 || neighbors > 255, "Between 1 and 255 neighbors");
+
+  MessageHeader message;
+  message.SetVTime (Seconds (15));
+  message.SetOriginatorAddress (Ipv6Address ("2001:1::1"));
+  message.SetTimeToLive (255);
+  message.SetHopCount (0);
+  message.SetMessageSequenceNumber (42);
+  MessageHeader::Tc &tc = message.GetTc ();
+  tc.ansn = 7;
+
+  // The same content in the RFC 5444 format: the validity time and the
+  // ANSN in message TLVs, the neighbors in an address block
+  PbbPacket packet;
+  PbbMessage pbbMessage;
+  pbbMessage.type = MessageHeader::TC_MESSAGE;
+  pbbMessage.hasOriginator = true;
+  pbbMessage.originator = Ipv6Address ("2001:1::1");
+  pbbMessage.hasHopLimit = true;
+  pbbMessage.hopLimit = 255;
+  pbbMessage.hasHopCount = true;
+  pbbMessage.hopCount = 0;
+  pbbMessage.hasSequenceNumber = true;
+  pbbMessage.sequenceNumber = 42;
+  PbbTlv validity;
+  validity.type = 1;
+  validity.hasValue = true;
+  validity.value.push_back (SecondsToEmf (15));
+  pbbMessage.tlvs.push_back (validity);
+  PbbTlv ansn;
+  ansn.type = 2;
+  ansn.hasValue = true;
+  ansn.value.push_back (0);
+  ansn.value.push_back (7);
+  pbbMessage.tlvs.push_back (ansn);
+  PbbAddressBlock block;
+
+  for (uint32_t i = 0; i < neighbors; i++)
+    {
+      uint8_t bytes[16] = { 0x20, 0x01, 0x00, 0x01 };
+      bytes[14] = (i + 2) >> 8;
+      bytes[15] = (i + 2) & 0xff;
+      tc.neighborAddresses.push_back (Ipv6Address (bytes));
+      block.addresses.push_back (Ipv6Address (bytes));
+    }
+  pbbMessage.addressBlocks.push_back (block);
+  packet.messages.push_back (pbbMessage);
+
+  std::cout << "TC message with " << neighbors << " neighbors, " << iterations << " iterations" << std::endl;
+  MeasureMessageHeader ("RFC 3626", message, iterations);
+  message.SetCompression (true);
+  MeasureMessageHeader ("RFC 3626, compressed", message, iterations);
+  MeasurePbb (packet, iterations);
+
+  return 0;
+}
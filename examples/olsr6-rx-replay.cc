@@ -0,0 +1,121 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Ankit Deepak <adadeepak8@gmail.com>
+ *          Shravya Ks <shravya.ks0@gmail.com>,
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+//
+// This script measures the control plane processing cost of OLSR6 on a
+// single node, without the cost of the rest of the network.
+//
+// First, a square grid of nodes linked to their horizontal and vertical
+// neighbors runs OLSR6, and the packets received by the node at the center
+// of the grid are recorded.  Then, the recorded packets are replayed a
+// number of times into a standalone OLSR6 routing protocol, and the wall
+// clock time of each replay is reported.
+//
+// ./waf --run "olsr6-rx-replay --side=5 --duration=60 --iterations=10"
+//
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/olsr6-helper.h"
+#include "ns3/olsr6-rx-trace-helper.h"
+
+#include <iostream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("Olsr6RxReplay");
+
+int main (int argc, char *argv[])
+{
+  uint32_t side = 5;
+  double duration = 60.0;
+  uint32_t iterations = 10;
+  std::string filename = "olsr6-rx-replay.trace";
+
+  CommandLine cmd;
+  cmd.AddValue ("side", "number of nodes on a side of the grid", side);
+  cmd.AddValue ("duration", "recorded duration in seconds", duration);
+  cmd.AddValue ("iterations", "number of replays", iterations);
+  cmd.AddValue ("filename", "file the packets are recorded to", filename);
+  cmd.Parse (argc, argv);
+
+  NodeContainer nodes;
+  nodes.Create (side * side);
+
+  Olsr6Helper olsr6;
+  InternetStackHelper internet;
+  internet.SetIpv4StackInstall (false);
+  internet.SetRoutingHelper (olsr6);
+  internet.Install (nodes);
+
+  // One channel per link of the grid
+  SimpleNetDeviceHelper simpleNetHelper;
+  simpleNetHelper.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  simpleNetHelper.SetChannelAttribute ("Delay", StringValue ("2ms"));
+
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase ("2001:1::", Ipv6Prefix (64));
+  for (uint32_t row = 0; row < side; row++)
+    {
+      for (uint32_t column = 0; column < side; column++)
+        {
+          Ptr<Node> node = nodes.Get (row * side + column);
+          if (column + 1 < side)
+            {
+              ipv6.Assign (simpleNetHelper.Install (NodeContainer (node, nodes.Get (row * side + column + 1))));
+              ipv6.NewNetwork ();
+            }
+          if (row + 1 < side)
+            {
+              ipv6.Assign (simpleNetHelper.Install (NodeContainer (node, nodes.Get ((row + 1) * side + column))));
+              ipv6.NewNetwork ();
+            }
+        }
+    }
+
+  Olsr6RxTraceRecorder recorder;
+  recorder.Record (nodes.Get ((side / 2) * side + side / 2), filename);
+
+  Simulator::Stop (Seconds (duration));
+  Simulator::Run ();
+  recorder.Stop ();
+  Simulator::Destroy ();
+
+  Olsr6RxTraceReplay replay;
+  replay.Load (filename);
+  std::cout << "Recorded " << replay.GetNPackets () << " packets in " << duration << " s" << std::endl;
+
+  for (uint32_t i = 0; i < iterations; i++)
+    {
+      replay.Replay ();
+      std::cout << "Replay " << i << ": " << replay.GetNMessages () << " messages in "
+                << replay.GetElapsedMs () << " ms";
+      if (replay.GetElapsedMs () > 0)
+        {
+          std::cout << " (" << replay.GetNMessages () * 1000.0 / replay.GetElapsedMs () << " messages/s)";
+        }
+      std::cout << ", " << replay.GetRoutingTableEntries ().size () << " routes" << std::endl;
+    }
+
+  return 0;
+}
@@ -0,0 +1,237 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Ankit Deepak <adadeepak8@gmail.com>
+ *          Shravya Ks <shravya.ks0@gmail.com>,
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+//
+// This script compares the relay algorithms of the multicast data packets
+// of OLSR6 (RFC 6621): classical flooding, where every node relays each
+// packet once, and s-mpr, where a node only relays the packets received
+// from the neighbors which have selected it as MPR.
+//
+// The nodes form a square grid of 802.11b ad hoc stations, each one in
+// range of its horizontal, vertical and diagonal neighbors.  The corner
+// node sends UDP packets to the site-local group ff05::1, and every other
+// node listens to it.
+//
+// For each algorithm it reports:
+//  - the delivery ratio: packets received by the nodes, duplicates aside,
+//    over the packets they should have received;
+//  - the transmissions per packet: the source and the relays.
+//
+// ./waf --run "olsr6-smf-flooding --side=6 --packets=100"
+//
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/wifi-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/olsr6-helper.h"
+#include "ns3/olsr6-routing-protocol.h"
+
+#include <iostream>
+#include <set>
+#include <vector>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("Olsr6SmfFlooding");
+
+/**
+ * Runs the grid scenario once and measures the delivery of the multicast
+ * packets and their transmissions.
+ */
+class SmfFloodingExperiment
+{
+public:
+  /**
+   * \param side number of nodes on a side of the grid
+   * \param packets number of packets sent by the source
+   * \param interval interval between two packets
+   */
+  SmfFloodingExperiment (uint32_t side, uint32_t packets, Time interval);
+
+  /**
+   * \brief Runs the scenario and prints the results.
+   * \param algorithm "cf" or "s-mpr"
+   */
+  void Run (std::string algorithm);
+
+private:
+  /// Sends the next packet of the source.
+  void Send (void);
+  /// Receives the packets of a node.
+  void Receive (Ptr<Socket> socket);
+  /// Counts the relays.
+  void Relay (Ptr<const Packet> packet, const Ipv6Header &header);
+
+  uint32_t m_side;                //!< Nodes on a side of the grid.
+  uint32_t m_packets;             //!< Packets sent by the source.
+  Time m_interval;                //!< Interval between two packets.
+
+  Ptr<Socket> m_source;           //!< Socket of the source.
+  uint32_t m_sent;                //!< Packets sent so far.
+  std::vector<std::set<uint32_t> > m_received;  //!< Numbers of the packets received by each node.
+  uint32_t m_relays;              //!< Relays of the packets.
+};
+
+SmfFloodingExperiment::SmfFloodingExperiment (uint32_t side, uint32_t packets, Time interval)
+  : m_side (side),
+    m_packets (packets),
+    m_interval (interval)
+{
+}
+
+void
+SmfFloodingExperiment::Send (void)
+{
+  // The number of the packet makes each payload different
+  uint8_t payload[512] = { 0 };
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      payload[i] = (m_sent >> (8 * i)) & 0xff;
+    }
+  m_source->SendTo (Create<Packet> (payload, sizeof (payload)), 0,
+                    Inet6SocketAddress (Ipv6Address ("ff05::1"), 9));
+  if (++m_sent < m_packets)
+    {
+      Simulator::Schedule (m_interval, &SmfFloodingExperiment::Send, this);
+    }
+}
+
+void
+SmfFloodingExperiment::Receive (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      uint8_t payload[4];
+      packet->CopyData (payload, 4);
+      m_received[socket->GetNode ()->GetId ()].insert (payload[0] | (payload[1] << 8)
+                                                       | (payload[2] << 16) | (payload[3] << 24));
+    }
+}
+
+void
+SmfFloodingExperiment::Relay (Ptr<const Packet> packet, const Ipv6Header &header)
+{
+  m_relays++;
+}
+
+void
+SmfFloodingExperiment::Run (std::string algorithm)
+{
+  m_sent = 0;
+  m_relays = 0;
+  m_received.assign (m_side * m_side, std::set<uint32_t> ());
+
+  NodeContainer nodes;
+  nodes.Create (m_side * m_side);
+
+  // Stations 50 m apart, in range of their diagonal neighbors but not beyond
+  MobilityHelper mobility;
+  mobility.SetPositionAllocator ("ns3::GridPositionAllocator",
+                                 "MinX", DoubleValue (0.0),
+                                 "MinY", DoubleValue (0.0),
+                                 "DeltaX", DoubleValue (50.0),
+                                 "DeltaY", DoubleValue (50.0),
+                                 "GridWidth", UintegerValue (m_side),
+                                 "LayoutType", StringValue ("RowFirst"));
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (nodes);
+
+  WifiHelper wifi;
+  wifi.SetStandard (WIFI_PHY_STANDARD_80211b);
+  YansWifiPhyHelper wifiPhy = YansWifiPhyHelper::Default ();
+  YansWifiChannelHelper wifiChannel;
+  wifiChannel.SetPropagationDelay ("ns3::ConstantSpeedPropagationDelayModel");
+  wifiChannel.AddPropagationLoss ("ns3::RangePropagationLossModel", "MaxRange", DoubleValue (75.0));
+  wifiPhy.SetChannel (wifiChannel.Create ());
+  WifiMacHelper wifiMac;
+  Config::SetDefault ("ns3::WifiRemoteStationManager::NonUnicastMode", StringValue ("DsssRate1Mbps"));
+  wifi.SetRemoteStationManager ("ns3::ConstantRateWifiManager",
+                                "DataMode", StringValue ("DsssRate1Mbps"),
+                                "ControlMode", StringValue ("DsssRate1Mbps"));
+  wifiMac.SetType ("ns3::AdhocWifiMac");
+  NetDeviceContainer devices = wifi.Install (wifiPhy, wifiMac, nodes);
+
+  Olsr6Helper olsr6;
+  olsr6.Set ("MulticastRelay", StringValue (algorithm));
+  InternetStackHelper internet;
+  internet.SetIpv4StackInstall (false);
+  internet.SetRoutingHelper (olsr6);
+  internet.Install (nodes);
+
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase ("2001:1::", Ipv6Prefix (64));
+  ipv6.Assign (devices);
+
+  TypeId tid = TypeId::LookupByName ("ns3::UdpSocketFactory");
+  for (uint32_t i = 1; i < nodes.GetN (); i++)
+    {
+      Ptr<Socket> socket = Socket::CreateSocket (nodes.Get (i), tid);
+      socket->Bind (Inet6SocketAddress (Ipv6Address::GetAny (), 9));
+      socket->SetRecvCallback (MakeCallback (&SmfFloodingExperiment::Receive, this));
+    }
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Olsr6Helper::GetOlsr6RoutingProtocol (nodes.Get (i))->TraceConnectWithoutContext (
+        "MulticastRelay", MakeCallback (&SmfFloodingExperiment::Relay, this));
+    }
+  m_source = Socket::CreateSocket (nodes.Get (0), tid);
+  m_source->Bind6 ();
+
+  // The MPRs are selected once the first TC messages went round
+  Simulator::Schedule (Seconds (30), &SmfFloodingExperiment::Send, this);
+  Simulator::Stop (Seconds (31 + m_interval.GetSeconds () * m_packets));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_source = 0;
+
+  uint32_t received = 0;
+  for (uint32_t i = 1; i < m_received.size (); i++)
+    {
+      received += m_received[i].size ();
+    }
+  std::cout << algorithm
+            << "  delivery " << double (received) / (m_sent * (m_received.size () - 1))
+            << "  transmissions per packet " << double (m_sent + m_relays) / m_sent
+            << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t side = 6;
+  uint32_t packets = 100;
+  double interval = 0.1;
+
+  CommandLine cmd;
+  cmd.AddValue ("side", "number of nodes on a side of the grid", side);
+  cmd.AddValue ("packets", "number of packets sent by the source", packets);
+  cmd.AddValue ("interval", "interval between two packets, in seconds", interval);
+  cmd.Parse (argc, argv);
+
+  SmfFloodingExperiment experiment (side, packets, Seconds (interval));
+  experiment.Run ("cf");
+  experiment.Run ("s-mpr");
+
+  return 0;
+}
@@ -0,0 +1,278 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Ankit Deepak <adadeepak8@gmail.com>
+ *          Shravya Ks <shravya.ks0@gmail.com>,
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+//
+// This script compares the multicast and the unicast relay of the OLSR6
+// packets without HELLO message (see the UnicastRelay attribute) on a
+// chain of routers linked point to point, each router also serving a stub
+// LAN of hosts which do not run OLSR6:
+//
+//   h h h     h h h     h h h
+//     |         |         |
+//     r0 ------ r1 ------ r2 ...
+//
+// A flooding event is a TC message originated by a router.  Once the
+// routes have settled, it counts the packets without HELLO message
+// delivered to the routers and to the hosts, and reports them per
+// flooding event.
+//
+// ./waf --run "olsr6-unicast-relay --routers=5 --hosts=3 --duration=120"
+//
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/olsr6-helper.h"
+#include "ns3/olsr6-routing-protocol.h"
+
+#include <iostream>
+#include <limits>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("Olsr6UnicastRelay");
+
+/**
+ * Runs the chain scenario once and counts the packets delivered.
+ */
+class UnicastRelayExperiment
+{
+public:
+  /**
+   * \param routers number of routers of the chain
+   * \param hosts number of hosts on the LAN of each router
+   * \param duration duration of the simulation
+   */
+  UnicastRelayExperiment (uint32_t routers, uint32_t hosts, Time duration);
+
+  /**
+   * \brief Runs the scenario and prints the results.
+   * \param unicastRelay true if the routers relay as unicast
+   */
+  void Run (bool unicastRelay);
+
+private:
+  /// Counts the TC messages originated.
+  void Tx (const olsr6::PacketHeader &header, const olsr6::MessageList &messages);
+  /**
+   * \brief Counts the packets without HELLO message delivered to a router.
+   * \param socket the raw socket of the router
+   */
+  void RouterRx (Ptr<Socket> socket);
+  /**
+   * \brief Counts the packets without HELLO message delivered to a host.
+   * \param socket the raw socket of the host
+   */
+  void HostRx (Ptr<Socket> socket);
+  /**
+   * \brief Opens a raw socket receiving the UDP packets of a node.
+   * \param node the node
+   * \param cb the receive callback
+   */
+  void Probe (Ptr<Node> node, Callback<void, Ptr<Socket> > cb);
+  /**
+   * \brief Receives a packet on a raw socket.
+   * \param socket the raw socket
+   * \returns true if it is an OLSR6 packet without HELLO message received
+   *          once the routes have settled
+   */
+  bool IsRelayed (Ptr<Socket> socket) const;
+
+  uint32_t m_routers;             //!< Routers of the chain.
+  uint32_t m_hosts;               //!< Hosts on the LAN of each router.
+  Time m_duration;                //!< Duration of the simulation.
+  Time m_start;                   //!< Time the counts start.
+
+  uint32_t m_floodingEvents;      //!< TC messages originated.
+  uint32_t m_routerPackets;       //!< Packets delivered to the routers.
+  uint32_t m_hostPackets;         //!< Packets delivered to the hosts.
+};
+
+UnicastRelayExperiment::UnicastRelayExperiment (uint32_t routers, uint32_t hosts, Time duration)
+  : m_routers (routers),
+    m_hosts (hosts),
+    m_duration (duration),
+    m_start (Seconds (20))
+{
+}
+
+void
+UnicastRelayExperiment::Tx (const olsr6::PacketHeader &header, const olsr6::MessageList &messages)
+{
+  if (Simulator::Now () < m_start)
+    {
+      return;
+    }
+  for (olsr6::MessageList::const_iterator it = messages.begin (); it != messages.end (); it++)
+    {
+      if (it->GetMessageType () == olsr6::MessageHeader::TC_MESSAGE && it->GetHopCount () == 0)
+        {
+          m_floodingEvents++;
+        }
+    }
+}
+
+bool
+UnicastRelayExperiment::IsRelayed (Ptr<Socket> socket) const
+{
+  Ptr<Packet> packet = socket->Recv (std::numeric_limits<uint32_t>::max (), 0);
+  if (Simulator::Now () < m_start)
+    {
+      return false;
+    }
+
+  Ipv6Header ipHdr;
+  packet->RemoveHeader (ipHdr);
+  UdpHeader udpHdr;
+  packet->RemoveHeader (udpHdr);
+  // The OLSR6 port
+  if (udpHdr.GetDestinationPort () != 698)
+    {
+      return false;
+    }
+  olsr6::PacketHeader pktHdr;
+  packet->RemoveHeader (pktHdr);
+  while (packet->GetSize () > 0)
+    {
+      olsr6::MessageHeader msgHdr;
+      packet->RemoveHeader (msgHdr);
+      if (msgHdr.GetMessageType () == olsr6::MessageHeader::HELLO_MESSAGE)
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+UnicastRelayExperiment::RouterRx (Ptr<Socket> socket)
+{
+  m_routerPackets += IsRelayed (socket);
+}
+
+void
+UnicastRelayExperiment::HostRx (Ptr<Socket> socket)
+{
+  m_hostPackets += IsRelayed (socket);
+}
+
+void
+UnicastRelayExperiment::Probe (Ptr<Node> node, Callback<void, Ptr<Socket> > cb)
+{
+  Ptr<SocketFactory> factory = node->GetObject<Ipv6RawSocketFactory> ();
+  Ptr<Socket> socket = factory->CreateSocket ();
+  socket->SetAttribute ("Protocol", UintegerValue (UdpL4Protocol::PROT_NUMBER));
+  socket->SetRecvCallback (cb);
+}
+
+void
+UnicastRelayExperiment::Run (bool unicastRelay)
+{
+  m_floodingEvents = 0;
+  m_routerPackets = 0;
+  m_hostPackets = 0;
+
+  NodeContainer routers;
+  routers.Create (m_routers);
+  NodeContainer hosts;
+  hosts.Create (m_routers * m_hosts);
+
+  Olsr6Helper olsr6;
+  olsr6.Set ("UnicastRelay", BooleanValue (unicastRelay));
+  InternetStackHelper internet;
+  internet.SetIpv4StackInstall (false);
+  internet.SetRoutingHelper (olsr6);
+  internet.Install (routers);
+  InternetStackHelper hostInternet;
+  hostInternet.SetIpv4StackInstall (false);
+  hostInternet.Install (hosts);
+
+  SimpleNetDeviceHelper simpleNetHelper;
+  simpleNetHelper.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  simpleNetHelper.SetChannelAttribute ("Delay", StringValue ("2ms"));
+
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase ("2001:1::", Ipv6Prefix (64));
+  for (uint32_t i = 0; i < m_routers; i++)
+    {
+      // The stub LAN of the router, one channel for all its nodes
+      NodeContainer lan (routers.Get (i));
+      for (uint32_t j = 0; j < m_hosts; j++)
+        {
+          lan.Add (hosts.Get (i * m_hosts + j));
+        }
+      ipv6.Assign (simpleNetHelper.Install (lan));
+      ipv6.NewNetwork ();
+
+      if (i + 1 < m_routers)
+        {
+          ipv6.Assign (simpleNetHelper.Install (NodeContainer (routers.Get (i), routers.Get (i + 1))));
+          ipv6.NewNetwork ();
+        }
+    }
+
+  for (uint32_t i = 0; i < routers.GetN (); i++)
+    {
+      Olsr6Helper::GetOlsr6RoutingProtocol (routers.Get (i))->TraceConnectWithoutContext (
+        "Tx", MakeCallback (&UnicastRelayExperiment::Tx, this));
+      Probe (routers.Get (i), MakeCallback (&UnicastRelayExperiment::RouterRx, this));
+    }
+  for (uint32_t i = 0; i < hosts.GetN (); i++)
+    {
+      Probe (hosts.Get (i), MakeCallback (&UnicastRelayExperiment::HostRx, this));
+    }
+
+  Simulator::Stop (m_duration);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  std::cout << (unicastRelay ? "unicast  " : "multicast")
+            << "  flooding events " << m_floodingEvents
+            << "  packets delivered to the routers " << m_routerPackets
+            << "  to the hosts " << m_hostPackets;
+  if (m_floodingEvents > 0)
+    {
+      std::cout << "  per flooding event "
+                << double (m_routerPackets + m_hostPackets) / m_floodingEvents
+                << " (hosts " << double (m_hostPackets) / m_floodingEvents << ")";
+    }
+  std::cout << std::endl;
+}
+
+int main (int argc, char *argv[])
+{
+  uint32_t routers = 5;
+  uint32_t hosts = 3;
+  double duration = 120.0;
+
+  CommandLine cmd;
+  cmd.AddValue ("routers", "number of routers of the chain", routers);
+  cmd.AddValue ("hosts", "number of hosts on the LAN of each router", hosts);
+  cmd.AddValue ("duration", "duration of each simulation in seconds", duration);
+  cmd.Parse (argc, argv);
+
+  UnicastRelayExperiment experiment (routers, hosts, Seconds (duration));
+  experiment.Run (false);
+  experiment.Run (true);
+
+  return 0;
+}
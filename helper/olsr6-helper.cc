@@ -31,16 +31,57 @@
 #include "ns3/names.h"
 #include "ns3/ptr.h"
 #include "ns3/ipv6-list-routing.h"
+#include "ns3/string.h"
+#include "ns3/boolean.h"
+#include "ns3/config.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
 
 namespace ns3 {
 
+namespace {
+/**
+ * \param prefix prefix of the snapshot file names
+ * \param node the node
+ * \returns the name of the snapshot file of the node
+ */
+std::string
+GetSnapshotFileName (std::string prefix, Ptr<Node> node)
+{
+  std::ostringstream oss;
+  oss << prefix << "-" << node->GetId () << ".olsr6";
+  return oss.str ();
+}
+
+/**
+ * \brief Forwards a TX failure of a device to the OLSR6 routing protocol.
+ * \param olsr6 the routing protocol of the node
+ * \param device the device
+ * \param neighbor the MAC address of the neighbor
+ */
+void
+TxFailure (Ptr<olsr6::RoutingProtocol> olsr6, Ptr<NetDevice> device, Mac48Address neighbor)
+{
+  olsr6->NotifyTxFailure (device, neighbor);
+}
+} // anonymous namespace
+
 Olsr6Helper::Olsr6Helper ()
+  : m_networkMemoryBytes (0),
+    m_networkMemoryHighWaterMark (0)
 {
   m_agentFactory.SetTypeId ("ns3::olsr6::RoutingProtocol");
 }
 
 Olsr6Helper::Olsr6Helper (const Olsr6Helper &o)
-  : m_agentFactory (o.m_agentFactory)
+  : m_agentFactory (o.m_agentFactory),
+    m_memoryUsage (o.m_memoryUsage),
+    m_memoryHighWaterMark (o.m_memoryHighWaterMark),
+    m_networkMemoryBytes (o.m_networkMemoryBytes),
+    m_networkMemoryHighWaterMark (o.m_networkMemoryHighWaterMark)
 {
   m_interfaceExclusions = o.m_interfaceExclusions;
 }
@@ -91,6 +132,12 @@ Olsr6Helper::Set (std::string name, const AttributeValue &value)
   m_agentFactory.Set (name, value);
 }
 
+void
+Olsr6Helper::SetOracleMode (bool enable)
+{
+  m_agentFactory.Set ("OracleMode", BooleanValue (enable));
+}
+
 int64_t
 Olsr6Helper::AssignStreams (NodeContainer c, int64_t stream)
 {
@@ -132,4 +179,142 @@ Olsr6Helper::AssignStreams (NodeContainer c, int64_t stream)
 
 }
 
+Ptr<olsr6::RoutingProtocol>
+Olsr6Helper::GetOlsr6RoutingProtocol (Ptr<Node> node)
+{
+  Ptr<Ipv6> ipv6 = node->GetObject<Ipv6> ();
+  NS_ASSERT_MSG (ipv6, "Ipv6 not installed on node");
+  Ptr<Ipv6RoutingProtocol> proto = ipv6->GetRoutingProtocol ();
+  NS_ASSERT_MSG (proto, "Ipv6 routing not installed on node");
+  Ptr<olsr6::RoutingProtocol> olsr6 = DynamicCast<olsr6::RoutingProtocol> (proto);
+  if (olsr6)
+    {
+      return olsr6;
+    }
+  Ptr<Ipv6ListRouting> list = DynamicCast<Ipv6ListRouting> (proto);
+  if (list)
+    {
+      int16_t priority;
+      for (uint32_t i = 0; i < list->GetNRoutingProtocols (); i++)
+        {
+          olsr6 = DynamicCast<olsr6::RoutingProtocol> (list->GetRoutingProtocol (i, priority));
+          if (olsr6)
+            {
+              return olsr6;
+            }
+        }
+    }
+  return 0;
+}
+
+void
+Olsr6Helper::SaveSnapshots (NodeContainer c, std::string prefix)
+{
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Ptr<olsr6::RoutingProtocol> olsr6 = GetOlsr6RoutingProtocol (*i);
+      if (!olsr6)
+        {
+          continue;
+        }
+      std::string filename = GetSnapshotFileName (prefix, *i);
+      std::ofstream file (filename.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+      if (!file.is_open ())
+        {
+          NS_FATAL_ERROR ("Could not create OLSR6 state snapshot " << filename);
+        }
+      olsr6->SaveSnapshot (file);
+    }
+}
+
+void
+Olsr6Helper::LoadSnapshots (NodeContainer c, std::string prefix)
+{
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Ptr<olsr6::RoutingProtocol> olsr6 = GetOlsr6RoutingProtocol (*i);
+      if (olsr6)
+        {
+          olsr6->SetAttribute ("SnapshotFile", StringValue (GetSnapshotFileName (prefix, *i)));
+        }
+    }
+}
+
+void
+Olsr6Helper::TrackMemoryUsage (NodeContainer c)
+{
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Ptr<olsr6::RoutingProtocol> olsr6 = GetOlsr6RoutingProtocol (*i);
+      if (!olsr6)
+        {
+          continue;
+        }
+      std::ostringstream oss;
+      oss << (*i)->GetId ();
+      m_memoryUsage[(*i)->GetId ()] = olsr6::MemoryUsage ();
+      m_memoryHighWaterMark[(*i)->GetId ()] = 0;
+      olsr6->TraceConnect ("MemoryUsage", oss.str (), MakeCallback (&Olsr6Helper::MemoryUsageSampled, this));
+    }
+}
+
+void
+Olsr6Helper::EnableLinkFailureFeedback (NodeContainer c, std::string traceSource)
+{
+  for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Ptr<olsr6::RoutingProtocol> olsr6 = GetOlsr6RoutingProtocol (*i);
+      if (!olsr6)
+        {
+          continue;
+        }
+      for (uint32_t j = 0; j < (*i)->GetNDevices (); j++)
+        {
+          std::ostringstream oss;
+          oss << "/NodeList/" << (*i)->GetId () << "/DeviceList/" << j << "/" << traceSource;
+          Config::ConnectWithoutContext (oss.str (), MakeBoundCallback (&TxFailure, olsr6, (*i)->GetDevice (j)));
+        }
+    }
+}
+
+void
+Olsr6Helper::MemoryUsageSampled (std::string context, const olsr6::MemoryUsage &usage)
+{
+  uint32_t nodeId = std::atoi (context.c_str ());
+  uint64_t bytes = usage.GetTotalBytes ();
+
+  m_networkMemoryBytes += bytes;
+  m_networkMemoryBytes -= m_memoryUsage[nodeId].GetTotalBytes ();
+  m_memoryUsage[nodeId] = usage;
+
+  m_memoryHighWaterMark[nodeId] = std::max (m_memoryHighWaterMark[nodeId], bytes);
+  m_networkMemoryHighWaterMark = std::max (m_networkMemoryHighWaterMark, m_networkMemoryBytes);
+}
+
+olsr6::MemoryUsage
+Olsr6Helper::GetNetworkMemoryUsage (void) const
+{
+  olsr6::MemoryUsage total;
+  for (std::map<uint32_t, olsr6::MemoryUsage>::const_iterator it = m_memoryUsage.begin ();
+       it != m_memoryUsage.end (); it++)
+    {
+      total += it->second;
+    }
+  return total;
+}
+
+uint64_t
+Olsr6Helper::GetNetworkMemoryHighWaterMark (void) const
+{
+  return m_networkMemoryHighWaterMark;
+}
+
+uint64_t
+Olsr6Helper::GetMemoryHighWaterMark (Ptr<Node> node) const
+{
+  std::map<uint32_t, uint64_t>::const_iterator it = m_memoryHighWaterMark.find (node->GetId ());
+  NS_ASSERT_MSG (it != m_memoryHighWaterMark.end (), "Memory usage of node " << node->GetId () << " not tracked");
+  return it->second;
+}
+
 } // namespace ns3
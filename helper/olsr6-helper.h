@@ -32,11 +32,17 @@
 #include "ns3/node.h"
 #include "ns3/node-container.h"
 #include "ns3/ipv6-routing-helper.h"
+#include "ns3/olsr6-state.h"
 #include <map>
 #include <set>
+#include <string>
 
 namespace ns3 {
 
+namespace olsr6 {
+class RoutingProtocol;
+}
+
 /**
  * \ingroup olsr6
  *
@@ -92,6 +98,17 @@ public:
    */
   void Set (std::string name, const AttributeValue &value);
 
+  /**
+   * \param enable true to install the routes from a process-wide topology
+   * model instead of exchanging OLSR6 control messages
+   *
+   * This method only affects the routing protocols created afterwards.  In
+   * oracle mode the nodes send no HELLO, TC, MID or HNA messages; the routes
+   * are computed by ns3::olsr6::OracleTopology, which links can be brought
+   * down and up with OracleTopology::SetLinkState.
+   */
+  void SetOracleMode (bool enable);
+
   /**
    * Assign a fixed random variable stream number to the random variables
    * used by this model.  Return the number of streams (possibly zero) that
@@ -105,7 +122,92 @@ public:
    */
   int64_t AssignStreams (NodeContainer c, int64_t stream);
 
+  /**
+   * \brief Finds the OLSR6 routing protocol of a node, either installed
+   * directly or as part of an Ipv6ListRouting.
+   * \param node the node
+   * \returns the OLSR6 routing protocol, or 0 if none is installed
+   */
+  static Ptr<olsr6::RoutingProtocol> GetOlsr6RoutingProtocol (Ptr<Node> node);
+
+  /**
+   * \brief Saves a binary snapshot of the OLSR6 state of every node in the container.
+   *
+   * The snapshot of each node is written to "<prefix>-<node id>.olsr6".  This
+   * method is meant to be scheduled once the network has converged, e.g.
+   * Simulator::Schedule (Seconds (60), &Olsr6Helper::SaveSnapshots, &olsr6, nodes, "warm").
+   *
+   * \param c NodeContainer of the nodes whose state is saved
+   * \param prefix prefix of the snapshot file names
+   */
+  void SaveSnapshots (NodeContainer c, std::string prefix);
+
+  /**
+   * \brief Makes every node in the container restore its OLSR6 state from the
+   * snapshot written by SaveSnapshots with the same prefix.
+   *
+   * The Install() method of the InternetStackHelper should have previously
+   * been called, and this method must be called before the simulation starts.
+   * Each snapshot is loaded when the protocol is initialized and all its
+   * expiry times are rebased to that instant.
+   *
+   * \param c NodeContainer of the nodes whose state is restored
+   * \param prefix prefix of the snapshot file names
+   */
+  void LoadSnapshots (NodeContainer c, std::string prefix);
+
+  /**
+   * \brief Aggregates the memory usage samples of every node in the container.
+   *
+   * The samples are taken by the routing protocols themselves, so the
+   * MemoryUsageInterval attribute must be set (see Set) before Install, and
+   * this helper must outlive the simulation.
+   *
+   * \param c NodeContainer of the nodes whose memory usage is tracked
+   */
+  void TrackMemoryUsage (NodeContainer c);
+
+  /**
+   * \returns the sum of the last memory usage sample of every tracked node
+   */
+  olsr6::MemoryUsage GetNetworkMemoryUsage (void) const;
+
+  /**
+   * \returns the largest total number of bytes sampled so far for the whole network
+   */
+  uint64_t GetNetworkMemoryHighWaterMark (void) const;
+
+  /**
+   * \param node a tracked node
+   * \returns the largest total number of bytes sampled so far for the node
+   */
+  uint64_t GetMemoryHighWaterMark (Ptr<Node> node) const;
+
+  /**
+   * \brief Connects the TX failure trace of every device of the nodes in the
+   * container to the OLSR6 routing protocol of the node.
+   *
+   * When a device reports that a unicast frame could not be delivered, the
+   * neighbor is lost at once (see olsr6::RoutingProtocol::NotifyTxFailure)
+   * instead of after the expiry of its link tuple.  The trace source, given
+   * relative to the device, must have the signature void (Mac48Address);
+   * devices without it are left untouched.  The Install() method of the
+   * InternetStackHelper should have previously been called.
+   *
+   * \param c NodeContainer of the nodes whose devices report TX failures
+   * \param traceSource path of the trace source, relative to the device
+   */
+  void EnableLinkFailureFeedback (NodeContainer c,
+                                  std::string traceSource = "$ns3::WifiNetDevice/RemoteStationManager/MacTxFinalDataFailed");
+
 private:
+  /**
+   * \brief Records a memory usage sample.
+   * \param context the id of the sampled node
+   * \param usage the sample
+   */
+  void MemoryUsageSampled (std::string context, const olsr6::MemoryUsage &usage);
+
   /**
    * \brief Assignment operator declared private and not implemented to disallow
    * assignment and prevent the compiler from happily inserting its own.
@@ -114,6 +216,11 @@ private:
   ObjectFactory m_agentFactory; //!< Object factory
 
   std::map< Ptr<Node>, std::set<uint32_t> > m_interfaceExclusions; //!< container of interfaces excluded from OLSR6 operations
+
+  std::map<uint32_t, olsr6::MemoryUsage> m_memoryUsage;   //!< last memory usage sample of every tracked node
+  std::map<uint32_t, uint64_t> m_memoryHighWaterMark;     //!< largest sampled total bytes of every tracked node
+  uint64_t m_networkMemoryBytes;                          //!< total bytes of the last samples of all tracked nodes
+  uint64_t m_networkMemoryHighWaterMark;                  //!< largest value of m_networkMemoryBytes
 };
 
 } // namespace ns3
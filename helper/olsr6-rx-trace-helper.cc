@@ -0,0 +1,285 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Ankit Deepak <adadeepak8@gmail.com>
+ *          Shravya Ks <shravya.ks0@gmail.com>,
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+#include "olsr6-rx-trace-helper.h"
+#include "olsr6-helper.h"
+#include "ns3/olsr6-snapshot.h"
+#include "ns3/simulator.h"
+#include "ns3/system-wall-clock-ms.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/simple-net-device.h"
+#include "ns3/simple-channel.h"
+#include "ns3/mac48-address.h"
+#include "ns3/log.h"
+
+/// Magic number at the beginning of a recorded Rx trace ("OLRX").
+#define OLSR6_RX_TRACE_MAGIC     0x4f4c5258
+/// Version of the recorded Rx trace format.
+#define OLSR6_RX_TRACE_VERSION   1
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Olsr6RxTraceHelper");
+
+/********** Olsr6RxTraceRecorder **********/
+
+Olsr6RxTraceRecorder::Olsr6RxTraceRecorder ()
+  : m_nPackets (0)
+{
+}
+
+Olsr6RxTraceRecorder::~Olsr6RxTraceRecorder ()
+{
+  Stop ();
+}
+
+void
+Olsr6RxTraceRecorder::Record (Ptr<Node> node, std::string filename)
+{
+  NS_LOG_FUNCTION (this << node->GetId () << filename);
+  NS_ASSERT_MSG (m_protocol == 0, "Already recording");
+
+  m_protocol = Olsr6Helper::GetOlsr6RoutingProtocol (node);
+  NS_ASSERT_MSG (m_protocol, "OLSR6 not installed on node");
+
+  m_file.open (filename.c_str (), std::ios::out | std::ios::binary | std::ios::trunc);
+  if (!m_file.is_open ())
+    {
+      NS_FATAL_ERROR ("Could not create OLSR6 Rx trace " << filename);
+    }
+
+  // Interface 0 is the loopback, address 0 of the others is link-local.
+  // An interface down or which lost its global address has none to record.
+  Ptr<Ipv6> ipv6 = node->GetObject<Ipv6> ();
+  std::vector<Ipv6InterfaceAddress> addresses;
+  for (uint32_t i = 1; i < ipv6->GetNInterfaces (); i++)
+    {
+      if (ipv6->GetNAddresses (i) >= 2)
+        {
+          addresses.push_back (ipv6->GetAddress (i, 1));
+        }
+    }
+  olsr6::SnapshotWriter writer (m_file, Seconds (0));
+  writer.WriteU32 (OLSR6_RX_TRACE_MAGIC);
+  writer.WriteU8 (OLSR6_RX_TRACE_VERSION);
+  writer.WriteU32 (addresses.size ());
+  for (std::vector<Ipv6InterfaceAddress>::const_iterator it = addresses.begin ();
+       it != addresses.end (); it++)
+    {
+      writer.WriteAddress (it->GetAddress ());
+      writer.WritePrefix (it->GetPrefix ());
+    }
+
+  m_nPackets = 0;
+  m_protocol->TraceConnectWithoutContext ("RxPacket", MakeCallback (&Olsr6RxTraceRecorder::RecordPacket, this));
+}
+
+void
+Olsr6RxTraceRecorder::Stop (void)
+{
+  if (m_protocol)
+    {
+      m_protocol->TraceDisconnectWithoutContext ("RxPacket", MakeCallback (&Olsr6RxTraceRecorder::RecordPacket, this));
+      m_protocol = 0;
+      m_file.close ();
+    }
+}
+
+uint32_t
+Olsr6RxTraceRecorder::GetNPackets (void) const
+{
+  return m_nPackets;
+}
+
+void
+Olsr6RxTraceRecorder::RecordPacket (Ptr<const Packet> packet, const Ipv6Address &sender, const Ipv6Address &receiver)
+{
+  std::vector<uint8_t> bytes (packet->GetSize ());
+  packet->CopyData (&bytes[0], bytes.size ());
+
+  olsr6::SnapshotWriter writer (m_file, Seconds (0));
+  writer.WriteTime (Simulator::Now ());
+  writer.WriteAddress (sender);
+  writer.WriteAddress (receiver);
+  writer.WriteU16 (bytes.size ());
+  writer.WriteBytes (&bytes[0], bytes.size ());
+  if (!writer.IsGood ())
+    {
+      NS_FATAL_ERROR ("Could not write OLSR6 Rx trace");
+    }
+  m_nPackets++;
+}
+
+/********** Olsr6RxTraceReplay **********/
+
+Olsr6RxTraceReplay::Olsr6RxTraceReplay ()
+  : m_nMessages (0),
+    m_elapsedMs (0)
+{
+}
+
+void
+Olsr6RxTraceReplay::Load (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+
+  std::ifstream file (filename.c_str (), std::ios::in | std::ios::binary);
+  if (!file.is_open ())
+    {
+      NS_FATAL_ERROR ("Could not open OLSR6 Rx trace " << filename);
+    }
+
+  olsr6::SnapshotReader reader (file, Seconds (0));
+  if (reader.ReadU32 () != OLSR6_RX_TRACE_MAGIC || reader.ReadU8 () != OLSR6_RX_TRACE_VERSION)
+    {
+      NS_FATAL_ERROR (filename << " is not an OLSR6 Rx trace of a supported version");
+    }
+
+  m_interfaces.clear ();
+  uint32_t nInterfaces = reader.ReadU32 ();
+  for (uint32_t i = 0; i < nInterfaces && reader.IsGood (); i++)
+    {
+      Ipv6Address address = reader.ReadAddress ();
+      Ipv6Prefix prefix = reader.ReadPrefix ();
+      m_interfaces.push_back (Ipv6InterfaceAddress (address, prefix));
+    }
+
+  m_records.clear ();
+  while (reader.IsGood () && file.peek () != std::ifstream::traits_type::eof ())
+    {
+      Record record;
+      record.time = reader.ReadTime ();
+      record.sender = reader.ReadAddress ();
+      record.receiver = reader.ReadAddress ();
+      record.bytes.resize (reader.ReadU16 ());
+      reader.ReadBytes (&record.bytes[0], record.bytes.size ());
+      m_records.push_back (record);
+    }
+  if (!reader.IsGood () || m_interfaces.empty ())
+    {
+      NS_FATAL_ERROR ("OLSR6 Rx trace " << filename << " is truncated");
+    }
+}
+
+void
+Olsr6RxTraceReplay::Replay (void)
+{
+  NS_LOG_FUNCTION (this << m_records.size ());
+  NS_ASSERT_MSG (Simulator::IsFinished (), "The OLSR6 Rx trace replay needs a simulator without events");
+
+  // A node whose interfaces carry the recorded addresses, each on a
+  // channel of its own.
+  Ptr<Node> node = CreateObject<Node> ();
+  InternetStackHelper internet;
+  internet.SetIpv4StackInstall (false);
+  internet.Install (node);
+  Ptr<Ipv6> ipv6 = node->GetObject<Ipv6> ();
+  for (std::vector<Ipv6InterfaceAddress>::const_iterator it = m_interfaces.begin ();
+       it != m_interfaces.end (); it++)
+    {
+      Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice> ();
+      device->SetAddress (Mac48Address::Allocate ());
+      device->SetChannel (CreateObject<SimpleChannel> ());
+      node->AddDevice (device);
+      uint32_t interface = ipv6->AddInterface (device);
+      // Set up first, so that the link-local address comes first as in
+      // the recorded node.
+      ipv6->SetUp (interface);
+      ipv6->AddAddress (interface, *it);
+    }
+
+  // The protocol knows the Ipv6 of the node, but is neither its routing
+  // protocol nor started.
+  m_protocol = CreateObject<olsr6::RoutingProtocol> ();
+  Ptr<Ipv6RoutingProtocol> routing = m_protocol;
+  routing->SetIpv6 (ipv6);
+  m_protocol->SetMainInterface (1);
+  m_protocol->TraceConnectWithoutContext ("Rx", MakeCallback (&Olsr6RxTraceReplay::CountMessages, this));
+
+  m_nMessages = 0;
+  m_table.clear ();
+  if (!m_records.empty ())
+    {
+      Simulator::Schedule (m_records.front ().time, &Olsr6RxTraceReplay::ReplayPacket, this, 0);
+    }
+
+  SystemWallClockMs clock;
+  clock.Start ();
+  Simulator::Run ();
+  m_elapsedMs = clock.End ();
+
+  m_table = m_protocol->GetRoutingTableEntries ();
+  m_protocol->Dispose ();
+  m_protocol = 0;
+  Simulator::Destroy ();
+}
+
+void
+Olsr6RxTraceReplay::ReplayPacket (uint32_t index)
+{
+  const Record &record = m_records[index];
+  m_protocol->ReceivePacket (Create<Packet> (&record.bytes[0], record.bytes.size ()),
+                             record.sender, record.receiver);
+
+  // Stop right after the last packet, before the tuples start expiring.
+  if (index + 1 == m_records.size ())
+    {
+      Simulator::Stop ();
+    }
+  else
+    {
+      Simulator::Schedule (m_records[index + 1].time - Simulator::Now (),
+                           &Olsr6RxTraceReplay::ReplayPacket, this, index + 1);
+    }
+}
+
+void
+Olsr6RxTraceReplay::CountMessages (const olsr6::PacketHeader &header, const olsr6::MessageList &messages)
+{
+  m_nMessages += messages.size ();
+}
+
+uint32_t
+Olsr6RxTraceReplay::GetNPackets (void) const
+{
+  return m_records.size ();
+}
+
+uint32_t
+Olsr6RxTraceReplay::GetNMessages (void) const
+{
+  return m_nMessages;
+}
+
+int64_t
+Olsr6RxTraceReplay::GetElapsedMs (void) const
+{
+  return m_elapsedMs;
+}
+
+std::vector<olsr6::RoutingTableEntry>
+Olsr6RxTraceReplay::GetRoutingTableEntries (void) const
+{
+  return m_table;
+}
+
+} // namespace ns3
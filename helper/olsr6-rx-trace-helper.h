@@ -0,0 +1,174 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Ankit Deepak <adadeepak8@gmail.com>
+ *          Shravya Ks <shravya.ks0@gmail.com>,
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+#ifndef OLSR6_RX_TRACE_HELPER_H
+#define OLSR6_RX_TRACE_HELPER_H
+
+#include "ns3/olsr6-routing-protocol.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/nstime.h"
+#include "ns3/ipv6-address.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup olsr6
+ *
+ * \brief Records the OLSR6 packets received by a node into a file that
+ * Olsr6RxTraceReplay can replay.
+ *
+ * The file starts with the global address and prefix of every interface of
+ * the node which has one, followed by one record per received packet: reception time,
+ * sending and receiving interface addresses and the raw OLSR6 packet.
+ */
+class Olsr6RxTraceRecorder
+{
+public:
+  Olsr6RxTraceRecorder ();
+  ~Olsr6RxTraceRecorder ();
+
+  /**
+   * \brief Starts recording the packets received by a node.
+   *
+   * The addresses of the node must already be assigned.  The recording
+   * lasts until Stop () is called or the recorder is destroyed.
+   *
+   * \param node the node, running OLSR6
+   * \param filename the file the packets are recorded to
+   */
+  void Record (Ptr<Node> node, std::string filename);
+
+  /**
+   * \brief Stops recording and closes the file.
+   */
+  void Stop (void);
+
+  /**
+   * \returns the number of packets recorded so far
+   */
+  uint32_t GetNPackets (void) const;
+
+private:
+  /**
+   * \brief Appends a received packet to the file.
+   * \param packet the packet
+   * \param sender the address of the sending interface
+   * \param receiver the address of the receiving interface
+   */
+  void RecordPacket (Ptr<const Packet> packet, const Ipv6Address &sender, const Ipv6Address &receiver);
+
+  Ptr<olsr6::RoutingProtocol> m_protocol; //!< Protocol being recorded.
+  std::ofstream m_file;                   //!< Output file.
+  uint32_t m_nPackets;                    //!< Number of packets recorded.
+};
+
+/**
+ * \ingroup olsr6
+ *
+ * \brief Replays a file written by Olsr6RxTraceRecorder into a standalone
+ * OLSR6 routing protocol, as fast as possible.
+ *
+ * The routing protocol runs on a node of its own, whose interfaces carry
+ * the recorded addresses but lead nowhere, and is never started: it opens
+ * no socket and sends no message.  Each recorded packet is handed to
+ * olsr6::RoutingProtocol::ReceivePacket at its recorded time, so that the
+ * tuple expiry timers behave as in the recorded simulation.
+ */
+class Olsr6RxTraceReplay
+{
+public:
+  Olsr6RxTraceReplay ();
+
+  /**
+   * \brief Loads a recorded file in memory.
+   * \param filename the file written by Olsr6RxTraceRecorder
+   */
+  void Load (std::string filename);
+
+  /**
+   * \brief Replays the loaded packets.
+   *
+   * The replay needs the simulator for itself: it must be called with no
+   * event scheduled, typically after Simulator::Destroy (), and it runs
+   * and then destroys the simulator.
+   */
+  void Replay (void);
+
+  /**
+   * \returns the number of loaded packets
+   */
+  uint32_t GetNPackets (void) const;
+
+  /**
+   * \returns the number of OLSR6 messages processed by the last replay
+   */
+  uint32_t GetNMessages (void) const;
+
+  /**
+   * \returns the wall clock time of the last replay, in milliseconds
+   */
+  int64_t GetElapsedMs (void) const;
+
+  /**
+   * \returns the routing table of the replayed node at the end of the last replay
+   */
+  std::vector<olsr6::RoutingTableEntry> GetRoutingTableEntries (void) const;
+
+private:
+  /// A recorded packet.
+  struct Record
+  {
+    Time time;                  //!< Reception time.
+    Ipv6Address sender;         //!< Address of the sending interface.
+    Ipv6Address receiver;       //!< Address of the receiving interface.
+    std::vector<uint8_t> bytes; //!< The OLSR6 packet.
+  };
+
+  /**
+   * \brief Hands a recorded packet to the routing protocol and schedules the next one.
+   * \param index the index of the record
+   */
+  void ReplayPacket (uint32_t index);
+
+  /**
+   * \brief Counts the messages of a processed packet.
+   * \param header the packet header
+   * \param messages the messages of the packet
+   */
+  void CountMessages (const olsr6::PacketHeader &header, const olsr6::MessageList &messages);
+
+  std::vector<Ipv6InterfaceAddress> m_interfaces;     //!< Interfaces of the recorded node.
+  std::vector<Record> m_records;                      //!< Recorded packets.
+  Ptr<olsr6::RoutingProtocol> m_protocol;             //!< Protocol being replayed into.
+  uint32_t m_nMessages;                               //!< Messages processed by the last replay.
+  int64_t m_elapsedMs;                                //!< Wall clock time of the last replay.
+  std::vector<olsr6::RoutingTableEntry> m_table;      //!< Routing table at the end of the last replay.
+};
+
+} // namespace ns3
+
+#endif /* OLSR6_RX_TRACE_HELPER_H */
@@ -0,0 +1,306 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Ankit Deepak <adadeepak8@gmail.com>
+ *          Shravya Ks <shravya.ks0@gmail.com>,
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+///
+/// \file	olsr6-authentication.cc
+/// \brief	Implementation of the SHA-256 HMAC and the replay window of the OLSR6 packets.
+///
+
+#include "olsr6-authentication.h"
+
+#include <algorithm>
+#include <cstring>
+
+/// Byte XORed with the key of the inner hash.
+#define OLSR6_HMAC_IPAD 0x36
+/// Byte XORed with the key of the outer hash.
+#define OLSR6_HMAC_OPAD 0x5c
+
+namespace ns3 {
+namespace olsr6 {
+
+/// Round constants of SHA-256.
+static const uint32_t g_sha256K[64] = {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+  0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+  0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+  0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+  0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+/**
+ * \param x A word.
+ * \param n The number of bits.
+ * \returns The word rotated right by n bits.
+ */
+static inline uint32_t
+RotateRight (uint32_t x, uint32_t n)
+{
+  return (x >> n) | (x << (32 - n));
+}
+
+// ---------------- SHA-256 -------------------------------
+
+Sha256::Sha256 ()
+{
+  Reset ();
+}
+
+void
+Sha256::Reset (void)
+{
+  m_state[0] = 0x6a09e667;
+  m_state[1] = 0xbb67ae85;
+  m_state[2] = 0x3c6ef372;
+  m_state[3] = 0xa54ff53a;
+  m_state[4] = 0x510e527f;
+  m_state[5] = 0x9b05688c;
+  m_state[6] = 0x1f83d9ab;
+  m_state[7] = 0x5be0cd19;
+  m_length = 0;
+  m_blockSize = 0;
+}
+
+void
+Sha256::Update (const uint8_t *data, uint32_t size)
+{
+  m_length += size;
+  while (size > 0)
+    {
+      uint32_t n = std::min (size, (uint32_t) BLOCK_SIZE - m_blockSize);
+      std::memcpy (m_block + m_blockSize, data, n);
+      m_blockSize += n;
+      data += n;
+      size -= n;
+      if (m_blockSize == BLOCK_SIZE)
+        {
+          Transform ();
+          m_blockSize = 0;
+        }
+    }
+}
+
+void
+Sha256::Final (uint8_t *digest)
+{
+  uint64_t bits = m_length * 8;
+
+  // A one bit, zeros up to the last 8 bytes of a block, then the length
+  m_block[m_blockSize++] = 0x80;
+  if (m_blockSize > BLOCK_SIZE - 8)
+    {
+      std::memset (m_block + m_blockSize, 0, BLOCK_SIZE - m_blockSize);
+      Transform ();
+      m_blockSize = 0;
+    }
+  std::memset (m_block + m_blockSize, 0, BLOCK_SIZE - 8 - m_blockSize);
+  for (int i = 0; i < 8; i++)
+    {
+      m_block[BLOCK_SIZE - 1 - i] = bits >> (8 * i);
+    }
+  Transform ();
+
+  for (int i = 0; i < 8; i++)
+    {
+      digest[4 * i] = m_state[i] >> 24;
+      digest[4 * i + 1] = m_state[i] >> 16;
+      digest[4 * i + 2] = m_state[i] >> 8;
+      digest[4 * i + 3] = m_state[i];
+    }
+}
+
+void
+Sha256::Transform (void)
+{
+  uint32_t w[64];
+  for (int i = 0; i < 16; i++)
+    {
+      w[i] = ((uint32_t) m_block[4 * i] << 24) | ((uint32_t) m_block[4 * i + 1] << 16)
+        | ((uint32_t) m_block[4 * i + 2] << 8) | m_block[4 * i + 3];
+    }
+  for (int i = 16; i < 64; i++)
+    {
+      uint32_t s0 = RotateRight (w[i - 15], 7) ^ RotateRight (w[i - 15], 18) ^ (w[i - 15] >> 3);
+      uint32_t s1 = RotateRight (w[i - 2], 17) ^ RotateRight (w[i - 2], 19) ^ (w[i - 2] >> 10);
+      w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+  uint32_t a = m_state[0];
+  uint32_t b = m_state[1];
+  uint32_t c = m_state[2];
+  uint32_t d = m_state[3];
+  uint32_t e = m_state[4];
+  uint32_t f = m_state[5];
+  uint32_t g = m_state[6];
+  uint32_t h = m_state[7];
+  for (int i = 0; i < 64; i++)
+    {
+      uint32_t s1 = RotateRight (e, 6) ^ RotateRight (e, 11) ^ RotateRight (e, 25);
+      uint32_t ch = (e & f) ^ (~e & g);
+      uint32_t t1 = h + s1 + ch + g_sha256K[i] + w[i];
+      uint32_t s0 = RotateRight (a, 2) ^ RotateRight (a, 13) ^ RotateRight (a, 22);
+      uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+      uint32_t t2 = s0 + maj;
+      h = g;
+      g = f;
+      f = e;
+      e = d + t1;
+      d = c;
+      c = b;
+      b = a;
+      a = t1 + t2;
+    }
+  m_state[0] += a;
+  m_state[1] += b;
+  m_state[2] += c;
+  m_state[3] += d;
+  m_state[4] += e;
+  m_state[5] += f;
+  m_state[6] += g;
+  m_state[7] += h;
+}
+
+// ---------------- HMAC-SHA-256 -------------------------------
+
+HmacSha256::HmacSha256 ()
+{
+  SetKey (0, 0);
+}
+
+HmacSha256::HmacSha256 (const std::string &key)
+{
+  SetKey ((const uint8_t *) key.data (), key.size ());
+}
+
+HmacSha256::HmacSha256 (const uint8_t *key, uint32_t size)
+{
+  SetKey (key, size);
+}
+
+void
+HmacSha256::SetKey (const uint8_t *key, uint32_t size)
+{
+  // The keys longer than a block are replaced by their hash
+  uint8_t block[Sha256::BLOCK_SIZE];
+  std::memset (block, 0, sizeof (block));
+  if (size > Sha256::BLOCK_SIZE)
+    {
+      Sha256 hash;
+      hash.Update (key, size);
+      hash.Final (block);
+    }
+  else if (size > 0)
+    {
+      std::memcpy (block, key, size);
+    }
+
+  uint8_t pad[Sha256::BLOCK_SIZE];
+  for (int i = 0; i < Sha256::BLOCK_SIZE; i++)
+    {
+      pad[i] = block[i] ^ OLSR6_HMAC_IPAD;
+    }
+  m_inner.Reset ();
+  m_inner.Update (pad, sizeof (pad));
+  for (int i = 0; i < Sha256::BLOCK_SIZE; i++)
+    {
+      pad[i] = block[i] ^ OLSR6_HMAC_OPAD;
+    }
+  m_outer.Reset ();
+  m_outer.Update (pad, sizeof (pad));
+}
+
+void
+HmacSha256::Compute (const uint8_t *data, uint32_t size, uint8_t *icv) const
+{
+  uint8_t digest[Sha256::DIGEST_SIZE];
+  Sha256 inner = m_inner;
+  inner.Update (data, size);
+  inner.Final (digest);
+  Sha256 outer = m_outer;
+  outer.Update (digest, sizeof (digest));
+  outer.Final (icv);
+}
+
+bool
+HmacSha256::Verify (const uint8_t *data, uint32_t size, const uint8_t *icv) const
+{
+  uint8_t expected[ICV_SIZE];
+  Compute (data, size, expected);
+  uint8_t difference = 0;
+  for (int i = 0; i < ICV_SIZE; i++)
+    {
+      difference |= expected[i] ^ icv[i];
+    }
+  return difference == 0;
+}
+
+// ---------------- Replay window -------------------------------
+
+ReplayWindow::ReplayWindow ()
+  : m_started (false),
+    m_highest (0),
+    m_received (0)
+{
+}
+
+bool
+ReplayWindow::Accept (uint16_t sequenceNumber, Time now, Time holdTime)
+{
+  if (!m_started || IsExpired (now))
+    {
+      m_started = true;
+      m_highest = sequenceNumber;
+      m_received = 1;
+      m_expirationTime = now + holdTime;
+      return true;
+    }
+
+  uint16_t ahead = sequenceNumber - m_highest;
+  if (ahead != 0 && ahead < 0x8000)
+    {
+      m_received = (ahead >= WINDOW_SIZE ? 0 : m_received << ahead) | 1;
+      m_highest = sequenceNumber;
+    }
+  else
+    {
+      uint16_t behind = m_highest - sequenceNumber;
+      if (behind >= WINDOW_SIZE || (m_received >> behind) & 1)
+        {
+          return false;
+        }
+      m_received |= (uint64_t) 1 << behind;
+    }
+  m_expirationTime = now + holdTime;
+  return true;
+}
+
+bool
+ReplayWindow::IsExpired (Time now) const
+{
+  return m_expirationTime < now;
+}
+
+}
+}  // namespace olsr6, ns3
@@ -0,0 +1,187 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Ankit Deepak <adadeepak8@gmail.com>
+ *          Shravya Ks <shravya.ks0@gmail.com>,
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+/// \brief	This header file declares the SHA-256 HMAC and the replay window used to authenticate the OLSR6 packets.
+
+#ifndef OLSR6_AUTHENTICATION_H
+#define OLSR6_AUTHENTICATION_H
+
+#include "ns3/nstime.h"
+
+#include <stdint.h>
+#include <string>
+
+namespace ns3 {
+namespace olsr6 {
+
+/// \ingroup olsr6
+/// \brief SHA-256 hash function (FIPS 180-4).
+///
+/// The data is hashed incrementally: Update () may be called any number of
+/// times before Final ().  The state can be copied at any point, which lets
+/// HmacSha256 hash its key once and for all.
+class Sha256
+{
+public:
+  /// Sizes of the hash function.
+  enum
+  {
+    DIGEST_SIZE = 32,  //!< Size of the digest in bytes.
+    BLOCK_SIZE = 64    //!< Size of the blocks hashed in bytes.
+  };
+
+  Sha256 ();
+
+  /**
+   * \brief Starts a new hash.
+   */
+  void Reset (void);
+
+  /**
+   * \brief Hashes data.
+   * \param data The data.
+   * \param size The size of the data.
+   */
+  void Update (const uint8_t *data, uint32_t size);
+
+  /**
+   * \brief Ends the hash.  The state must be Reset () before another hash.
+   * \param digest The buffer of DIGEST_SIZE bytes the digest is written to.
+   */
+  void Final (uint8_t *digest);
+
+private:
+  /**
+   * \brief Hashes the block buffered.
+   */
+  void Transform (void);
+
+  uint32_t m_state[8];              //!< Intermediate hash value.
+  uint64_t m_length;                //!< Number of bytes hashed so far.
+  uint8_t m_block[BLOCK_SIZE];      //!< Block being filled.
+  uint32_t m_blockSize;             //!< Number of bytes in the block.
+};
+
+/// \ingroup olsr6
+/// \brief HMAC-SHA-256 (\RFC{2104}) with precomputed key states.
+///
+/// The key is padded and hashed into the inner and outer states when the
+/// HmacSha256 is built; each ICV then starts from copies of these states
+/// and only hashes the data, plus one block for the outer hash.
+class HmacSha256
+{
+public:
+  /// Size of the ICV in bytes.
+  enum
+  {
+    ICV_SIZE = Sha256::DIGEST_SIZE
+  };
+
+  /**
+   * Builds an HMAC with an empty key.
+   */
+  HmacSha256 ();
+  /**
+   * \param key The key.
+   */
+  HmacSha256 (const std::string &key);
+  /**
+   * \param key The key.
+   * \param size The size of the key.
+   */
+  HmacSha256 (const uint8_t *key, uint32_t size);
+
+  /**
+   * \brief Computes the ICV of data.
+   * \param data The data.
+   * \param size The size of the data.
+   * \param icv The buffer of ICV_SIZE bytes the ICV is written to.
+   */
+  void Compute (const uint8_t *data, uint32_t size, uint8_t *icv) const;
+
+  /**
+   * \brief Checks the ICV of data, in a time which does not depend on
+   * where the ICV differs.
+   * \param data The data.
+   * \param size The size of the data.
+   * \param icv The ICV of ICV_SIZE bytes.
+   * \returns True if the ICV is the ICV of the data.
+   */
+  bool Verify (const uint8_t *data, uint32_t size, const uint8_t *icv) const;
+
+private:
+  /**
+   * \brief Hashes the padded key into the inner and outer states.
+   * \param key The key.
+   * \param size The size of the key.
+   */
+  void SetKey (const uint8_t *key, uint32_t size);
+
+  Sha256 m_inner;  //!< State after the key XOR ipad.
+  Sha256 m_outer;  //!< State after the key XOR opad.
+};
+
+/// \ingroup olsr6
+/// \brief Sliding window of the packet sequence numbers received from a node.
+///
+/// A sequence number is accepted once, if it is newer than the highest one
+/// received or one of the 63 before it; the 16-bit numbers wrap around as
+/// in \RFC{3626} section 19.  A window which received nothing for its hold
+/// time starts again from the next number, so that a node which restarted
+/// its numbering is heard again.
+class ReplayWindow
+{
+public:
+  /// Number of sequence numbers of the window.
+  enum
+  {
+    WINDOW_SIZE = 64
+  };
+
+  ReplayWindow ();
+
+  /**
+   * \brief Checks a sequence number and records it if it is accepted.
+   * \param sequenceNumber The sequence number.
+   * \param now The current time.
+   * \param holdTime The time the window is kept after a number is accepted.
+   * \returns True if the number was not received yet and is not too old.
+   */
+  bool Accept (uint16_t sequenceNumber, Time now, Time holdTime);
+
+  /**
+   * \param now The current time.
+   * \returns True if the window received nothing for its hold time.
+   */
+  bool IsExpired (Time now) const;
+
+private:
+  bool m_started;             //!< True once a number was accepted.
+  uint16_t m_highest;         //!< Highest number accepted.
+  uint64_t m_received;        //!< Bit n is set if m_highest - n was received.
+  Time m_expirationTime;      //!< Time the window expires.
+};
+
+}
+}  // namespace olsr6, ns3
+
+#endif /* OLSR6_AUTHENTICATION_H */
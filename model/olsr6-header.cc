@@ -25,6 +25,7 @@
  * comments have also been ported from the same
  */
 
+#include <algorithm>
 #include <cmath>
 
 #include "ns3/assert.h"
@@ -35,6 +36,27 @@
 #define IPV6_ADDRESS_SIZE 16
 #define OLSR6_MSG_HEADER_SIZE 24
 #define OLSR6_PKT_HEADER_SIZE 4
+#define OLSR6_LINK_QUALITY_SIZE 4
+/// Flag of the first Reserved field of the HELLO and TC messages
+/// announcing the link quality extension.
+#define OLSR6_LINK_QUALITY_FLAG 0x0001
+/// Size of the gateway information of the extended HNA messages.
+#define OLSR6_GATEWAY_INFO_SIZE 4
+/// Flag of the first Reserved field of the HELLO messages announcing that
+/// the node accepts the compressed messages.
+#define OLSR6_COMPRESSION_FLAG 0x0002
+/// Size of the link quality of an address in the compressed messages.
+#define OLSR6_COMPRESSED_LINK_QUALITY_SIZE 2
+/// Flag of an address block with a head.
+#define OLSR6_ADDR_HAS_HEAD 0x80
+/// Flag of an address block with a tail.
+#define OLSR6_ADDR_HAS_FULL_TAIL 0x40
+/// Flag of an address block with a tail of zeros, not written.
+#define OLSR6_ADDR_HAS_ZERO_TAIL 0x20
+/// Largest number of addresses of an address block.
+#define OLSR6_MAX_BLOCK_ADDRESSES 255
+/// Size of the Key ID and Reserved fields of the signature messages.
+#define OLSR6_SIGNATURE_HEADER_SIZE 4
 
 namespace ns3 {
 
@@ -102,6 +124,221 @@ EmfToSeconds (uint8_t olsr6Format)
 }
 
 
+// ---------------- Compressed address lists -------------------------------
+
+/// Consecutive addresses of an address list sharing a head and a tail.
+struct AddressBlock
+{
+  uint32_t first;   //!< Index of the first address of the block.
+  uint32_t end;     //!< Index after the last address of the block.
+  uint8_t head;     //!< Length of the head.
+  uint8_t tail;     //!< Length of the tail.
+  bool zeroTail;    //!< True if the tail is made of zeros.
+};
+
+///
+/// \brief Sets the head and the tail of an address block.
+///
+/// \param block the block.
+/// \param first the bytes of the first address of the block.
+/// \param prefix the length of the prefix shared by the addresses.
+/// \param suffix the length of the suffix shared by the addresses.
+///
+static void
+SetBlockBounds (AddressBlock &block, const uint8_t first[IPV6_ADDRESS_SIZE], uint8_t prefix, uint8_t suffix)
+{
+  block.head = prefix;
+  block.tail = std::min<uint8_t> (suffix, IPV6_ADDRESS_SIZE - prefix);
+  block.zeroTail = block.tail > 0;
+  for (uint8_t k = IPV6_ADDRESS_SIZE - block.tail; k < IPV6_ADDRESS_SIZE; k++)
+    {
+      block.zeroTail = block.zeroTail && first[k] == 0;
+    }
+}
+
+///
+/// \brief Computes the size of an address block.
+///
+/// \param block the block.
+/// \return the number of bytes of the block.
+///
+static uint32_t
+GetBlockSize (const AddressBlock &block)
+{
+  return 2 + (block.head > 0 ? 1 + block.head : 0)
+         + (block.tail > 0 ? 1 + (block.zeroTail ? 0 : block.tail) : 0)
+         + (block.end - block.first) * (IPV6_ADDRESS_SIZE - block.head - block.tail);
+}
+
+///
+/// \brief Finds the block starting at an address of an address list.
+///
+/// The block is extended with the next addresses as long as this costs
+/// less than starting a new block.
+///
+/// \param addresses the addresses of the list.
+/// \param first the index of the first address of the block.
+/// \return the block.
+///
+static AddressBlock
+GetAddressBlock (const std::vector<Ipv6Address> &addresses, uint32_t first)
+{
+  uint8_t firstBytes[IPV6_ADDRESS_SIZE];
+  addresses[first].GetBytes (firstBytes);
+
+  // A single address is written whole
+  AddressBlock block;
+  block.first = first;
+  block.end = first + 1;
+  SetBlockBounds (block, firstBytes, 0, 0);
+  AddressBlock single = block;
+  uint8_t prefix = IPV6_ADDRESS_SIZE;
+  uint8_t suffix = IPV6_ADDRESS_SIZE;
+
+  while (block.end < addresses.size () && block.end - block.first < OLSR6_MAX_BLOCK_ADDRESSES)
+    {
+      uint8_t bytes[IPV6_ADDRESS_SIZE];
+      addresses[block.end].GetBytes (bytes);
+      uint8_t p = 0;
+      while (p < prefix && bytes[p] == firstBytes[p])
+        {
+          p++;
+        }
+      uint8_t s = 0;
+      while (s < suffix && bytes[IPV6_ADDRESS_SIZE - 1 - s] == firstBytes[IPV6_ADDRESS_SIZE - 1 - s])
+        {
+          s++;
+        }
+
+      AddressBlock extended = block;
+      extended.end++;
+      SetBlockBounds (extended, firstBytes, p, s);
+      if (GetBlockSize (extended) > GetBlockSize (block) + GetBlockSize (single))
+        {
+          break;
+        }
+      block = extended;
+      prefix = p;
+      suffix = s;
+    }
+  return block;
+}
+
+///
+/// \brief Computes the size of a compressed address list.
+///
+/// \param addresses the addresses of the list.
+/// \return the number of bytes of the list.
+///
+static uint32_t
+GetAddressListSize (const std::vector<Ipv6Address> &addresses)
+{
+  uint32_t size = 2;
+  for (uint32_t first = 0; first < addresses.size (); )
+    {
+      AddressBlock block = GetAddressBlock (addresses, first);
+      size += GetBlockSize (block);
+      first = block.end;
+    }
+  return size;
+}
+
+///
+/// \brief Writes a compressed address list.
+///
+/// \param i the buffer iterator, moved after the list.
+/// \param addresses the addresses of the list.
+///
+static void
+WriteAddressList (Buffer::Iterator &i, const std::vector<Ipv6Address> &addresses)
+{
+  NS_ASSERT (addresses.size () <= 0xffff);
+  i.WriteHtonU16 (addresses.size ());
+  for (uint32_t first = 0; first < addresses.size (); )
+    {
+      AddressBlock block = GetAddressBlock (addresses, first);
+      uint8_t bytes[IPV6_ADDRESS_SIZE];
+      addresses[block.first].GetBytes (bytes);
+
+      i.WriteU8 (block.end - block.first);
+      i.WriteU8 ((block.head > 0 ? OLSR6_ADDR_HAS_HEAD : 0)
+                 | (block.tail > 0 ? (block.zeroTail ? OLSR6_ADDR_HAS_ZERO_TAIL : OLSR6_ADDR_HAS_FULL_TAIL) : 0));
+      if (block.head > 0)
+        {
+          i.WriteU8 (block.head);
+          i.Write (bytes, block.head);
+        }
+      if (block.tail > 0)
+        {
+          i.WriteU8 (block.tail);
+          if (!block.zeroTail)
+            {
+              i.Write (bytes + IPV6_ADDRESS_SIZE - block.tail, block.tail);
+            }
+        }
+      uint8_t midLength = IPV6_ADDRESS_SIZE - block.head - block.tail;
+      for (uint32_t n = block.first; n < block.end; n++)
+        {
+          addresses[n].GetBytes (bytes);
+          i.Write (bytes + block.head, midLength);
+        }
+      first = block.end;
+    }
+}
+
+///
+/// \brief Reads a compressed address list.
+///
+/// \param i the buffer iterator, moved after the list.
+/// \param addresses the addresses of the list.
+/// \return the number of bytes read.
+///
+static uint32_t
+ReadAddressList (Buffer::Iterator &i, std::vector<Ipv6Address> &addresses)
+{
+  uint32_t size = 2;
+  uint16_t numAddresses = i.ReadNtohU16 ();
+  addresses.clear ();
+  while (addresses.size () < numAddresses)
+    {
+      uint8_t blockAddresses = i.ReadU8 ();
+      uint8_t flags = i.ReadU8 ();
+      size += 2;
+      NS_ASSERT (blockAddresses > 0 && addresses.size () + blockAddresses <= numAddresses);
+
+      uint8_t bytes[IPV6_ADDRESS_SIZE] = { 0 };
+      uint8_t head = 0;
+      uint8_t tail = 0;
+      if (flags & OLSR6_ADDR_HAS_HEAD)
+        {
+          head = i.ReadU8 ();
+          NS_ASSERT (head <= IPV6_ADDRESS_SIZE);
+          i.Read (bytes, head);
+          size += 1 + head;
+        }
+      if (flags & (OLSR6_ADDR_HAS_FULL_TAIL | OLSR6_ADDR_HAS_ZERO_TAIL))
+        {
+          tail = i.ReadU8 ();
+          NS_ASSERT (head + tail <= IPV6_ADDRESS_SIZE);
+          size++;
+          if (flags & OLSR6_ADDR_HAS_FULL_TAIL)
+            {
+              i.Read (bytes + IPV6_ADDRESS_SIZE - tail, tail);
+              size += tail;
+            }
+        }
+      uint8_t midLength = IPV6_ADDRESS_SIZE - head - tail;
+      for (uint8_t n = 0; n < blockAddresses; n++)
+        {
+          i.Read (bytes + head, midLength);
+          addresses.push_back (Ipv6Address (bytes));
+        }
+      size += blockAddresses * midLength;
+    }
+  return size;
+}
+
+
 
 // ---------------- OLSR6 Packet -------------------------------
 
@@ -166,7 +403,9 @@ PacketHeader::Deserialize (Buffer::Iterator start)
 NS_OBJECT_ENSURE_REGISTERED (MessageHeader);
 
 MessageHeader::MessageHeader ()
-  : m_messageType (MessageHeader::MessageType (0))
+  : m_messageType (MessageHeader::MessageType (0)),
+    m_compression (false),
+    m_compressed (false)
 {
 }
 
@@ -190,25 +429,56 @@ MessageHeader::GetInstanceTypeId (void) const
   return GetTypeId ();
 }
 
+bool
+MessageHeader::IsCompressed () const
+{
+  if (m_compressed)
+    {
+      return true;
+    }
+  if (!m_compression)
+    {
+      return false;
+    }
+  switch (m_messageType)
+    {
+    case MID_MESSAGE:
+      return m_message.mid.GetCompressedSize () < m_message.mid.GetSerializedSize ();
+    case HELLO_MESSAGE:
+      return m_message.hello.GetCompressedSize () < m_message.hello.GetSerializedSize ();
+    case TC_MESSAGE:
+      return m_message.tc.GetCompressedSize () < m_message.tc.GetSerializedSize ();
+    default:
+      return false;
+    }
+}
+
 uint32_t
 MessageHeader::GetSerializedSize (void) const
 {
   uint32_t size = OLSR6_MSG_HEADER_SIZE;
+  bool compressed = IsCompressed ();
   switch (m_messageType)
     {
     case MID_MESSAGE:
-      size += m_message.mid.GetSerializedSize ();
+      size += compressed ? m_message.mid.GetCompressedSize () : m_message.mid.GetSerializedSize ();
       break;
     case HELLO_MESSAGE:
       NS_LOG_DEBUG ("Hello Message Size: " << size << " + " << m_message.hello.GetSerializedSize ());
-      size += m_message.hello.GetSerializedSize ();
+      size += compressed ? m_message.hello.GetCompressedSize () : m_message.hello.GetSerializedSize ();
       break;
     case TC_MESSAGE:
-      size += m_message.tc.GetSerializedSize ();
+      size += compressed ? m_message.tc.GetCompressedSize () : m_message.tc.GetSerializedSize ();
       break;
     case HNA_MESSAGE:
       size += m_message.hna.GetSerializedSize ();
       break;
+    case DTC_MESSAGE:
+      size += m_message.diffTc.GetSerializedSize ();
+      break;
+    case SIGNATURE_MESSAGE:
+      size += m_message.signature.GetSerializedSize ();
+      break;
     default:
       NS_ASSERT (false);
     }
@@ -225,7 +495,14 @@ void
 MessageHeader::Serialize (Buffer::Iterator start) const
 {
   Buffer::Iterator i = start;
-  i.WriteU8 (m_messageType);
+  bool compressed = IsCompressed ();
+  MessageType type = m_messageType;
+  if (compressed)
+    {
+      type = (m_messageType == HELLO_MESSAGE ? C_HELLO_MESSAGE
+              : m_messageType == TC_MESSAGE ? C_TC_MESSAGE : C_MID_MESSAGE);
+    }
+  i.WriteU8 (type);
   i.WriteU8 (m_vTime);
   i.WriteHtonU16 (GetSerializedSize ());
   WriteTo (i, m_originatorAddress);
@@ -236,17 +513,44 @@ MessageHeader::Serialize (Buffer::Iterator start) const
   switch (m_messageType)
     {
     case MID_MESSAGE:
-      m_message.mid.Serialize (i);
+      if (compressed)
+        {
+          m_message.mid.SerializeCompressed (i);
+        }
+      else
+        {
+          m_message.mid.Serialize (i);
+        }
       break;
     case HELLO_MESSAGE:
-      m_message.hello.Serialize (i);
+      if (compressed)
+        {
+          m_message.hello.SerializeCompressed (i);
+        }
+      else
+        {
+          m_message.hello.Serialize (i);
+        }
       break;
     case TC_MESSAGE:
-      m_message.tc.Serialize (i);
+      if (compressed)
+        {
+          m_message.tc.SerializeCompressed (i);
+        }
+      else
+        {
+          m_message.tc.Serialize (i);
+        }
       break;
     case HNA_MESSAGE:
       m_message.hna.Serialize (i);
       break;
+    case DTC_MESSAGE:
+      m_message.diffTc.Serialize (i);
+      break;
+    case SIGNATURE_MESSAGE:
+      m_message.signature.Serialize (i);
+      break;
     default:
       NS_ASSERT (false);
     }
@@ -259,7 +563,14 @@ MessageHeader::Deserialize (Buffer::Iterator start)
   uint32_t size;
   Buffer::Iterator i = start;
   m_messageType  = (MessageType) i.ReadU8 ();
-  NS_ASSERT (m_messageType >= HELLO_MESSAGE && m_messageType <= HNA_MESSAGE);
+  NS_ASSERT (m_messageType >= HELLO_MESSAGE && m_messageType <= SIGNATURE_MESSAGE);
+  // The compressed messages are the HELLO, TC and MID messages in another encoding
+  m_compression = m_compressed = m_messageType >= C_HELLO_MESSAGE && m_messageType <= C_MID_MESSAGE;
+  if (m_compressed)
+    {
+      m_messageType = (m_messageType == C_HELLO_MESSAGE ? HELLO_MESSAGE
+                       : m_messageType == C_TC_MESSAGE ? TC_MESSAGE : MID_MESSAGE);
+    }
   m_vTime  = i.ReadU8 ();
   m_messageSize  = i.ReadNtohU16 ();
   ReadFrom (i,m_originatorAddress);
@@ -270,17 +581,26 @@ MessageHeader::Deserialize (Buffer::Iterator start)
   switch (m_messageType)
     {
     case MID_MESSAGE:
-      size += m_message.mid.Deserialize (i, m_messageSize - OLSR6_MSG_HEADER_SIZE);
+      size += m_compressed ? m_message.mid.DeserializeCompressed (i, m_messageSize - OLSR6_MSG_HEADER_SIZE)
+        : m_message.mid.Deserialize (i, m_messageSize - OLSR6_MSG_HEADER_SIZE);
       break;
     case HELLO_MESSAGE:
-      size += m_message.hello.Deserialize (i, m_messageSize - OLSR6_MSG_HEADER_SIZE);
+      size += m_compressed ? m_message.hello.DeserializeCompressed (i, m_messageSize - OLSR6_MSG_HEADER_SIZE)
+        : m_message.hello.Deserialize (i, m_messageSize - OLSR6_MSG_HEADER_SIZE);
       break;
     case TC_MESSAGE:
-      size += m_message.tc.Deserialize (i, m_messageSize - OLSR6_MSG_HEADER_SIZE);
+      size += m_compressed ? m_message.tc.DeserializeCompressed (i, m_messageSize - OLSR6_MSG_HEADER_SIZE)
+        : m_message.tc.Deserialize (i, m_messageSize - OLSR6_MSG_HEADER_SIZE);
       break;
     case HNA_MESSAGE:
       size += m_message.hna.Deserialize (i, m_messageSize - OLSR6_MSG_HEADER_SIZE);
       break;
+    case DTC_MESSAGE:
+      size += m_message.diffTc.Deserialize (i, m_messageSize - OLSR6_MSG_HEADER_SIZE);
+      break;
+    case SIGNATURE_MESSAGE:
+      size += m_message.signature.Deserialize (i, m_messageSize - OLSR6_MSG_HEADER_SIZE);
+      break;
     default:
       NS_ASSERT (false);
     }
@@ -334,6 +654,28 @@ MessageHeader::Mid::Deserialize (Buffer::Iterator start, uint32_t messageSize)
   return GetSerializedSize ();
 }
 
+uint32_t
+MessageHeader::Mid::GetCompressedSize (void) const
+{
+  return GetAddressListSize (this->interfaceAddresses);
+}
+
+void
+MessageHeader::Mid::SerializeCompressed (Buffer::Iterator start) const
+{
+  Buffer::Iterator i = start;
+  WriteAddressList (i, this->interfaceAddresses);
+}
+
+uint32_t
+MessageHeader::Mid::DeserializeCompressed (Buffer::Iterator start, uint32_t messageSize)
+{
+  Buffer::Iterator i = start;
+  uint32_t size = ReadAddressList (i, this->interfaceAddresses);
+  NS_ASSERT (size == messageSize);
+  return size;
+}
+
 
 
 // ---------------- OLSR6 HELLO Message -------------------------------
@@ -348,6 +690,7 @@ MessageHeader::Hello::GetSerializedSize (void) const
       const LinkMessage &lm = *iter;
       size += 4;
       size += IPV6_ADDRESS_SIZE * lm.neighborInterfaceAddresses.size ();
+      size += OLSR6_LINK_QUALITY_SIZE * lm.linkQualities.size ();
     }
   return size;
 }
@@ -363,7 +706,11 @@ MessageHeader::Hello::Serialize (Buffer::Iterator start) const
 {
   Buffer::Iterator i = start;
 
-  i.WriteU16 (0); // Reserved
+  // Either every link message carries the link qualities or none does
+  bool linkQuality = !this->linkMessages.empty () && !this->linkMessages.front ().linkQualities.empty ();
+
+  i.WriteHtonU16 ((linkQuality ? OLSR6_LINK_QUALITY_FLAG : 0)
+                  | (this->compression ? OLSR6_COMPRESSION_FLAG : 0)); // Reserved
   i.WriteU8 (this->hTime);
   i.WriteU8 (this->willingness);
 
@@ -371,6 +718,7 @@ MessageHeader::Hello::Serialize (Buffer::Iterator start) const
        iter != this->linkMessages.end (); iter++)
     {
       const LinkMessage &lm = *iter;
+      NS_ASSERT (lm.linkQualities.size () == (linkQuality ? lm.neighborInterfaceAddresses.size () : 0));
 
       i.WriteU8 (lm.linkCode);
       i.WriteU8 (0); // Reserved
@@ -379,12 +727,18 @@ MessageHeader::Hello::Serialize (Buffer::Iterator start) const
       // from the beginning of the "Link Code" field and until the
       // next "Link Code" field (or - if there are no more link types
       // - the end of the message).
-      i.WriteHtonU16 (4 + lm.neighborInterfaceAddresses.size () * IPV6_ADDRESS_SIZE);
+      i.WriteHtonU16 (4 + lm.neighborInterfaceAddresses.size () * IPV6_ADDRESS_SIZE
+                      + lm.linkQualities.size () * OLSR6_LINK_QUALITY_SIZE);
 
-      for (std::vector<Ipv6Address>::const_iterator neigh_iter = lm.neighborInterfaceAddresses.begin ();
-           neigh_iter != lm.neighborInterfaceAddresses.end (); neigh_iter++)
+      for (uint32_t n = 0; n < lm.neighborInterfaceAddresses.size (); n++)
         {
-          WriteTo (i,*neigh_iter);
+          WriteTo (i,lm.neighborInterfaceAddresses[n]);
+          if (linkQuality)
+            {
+              i.WriteU8 (lm.linkQualities[n].lq);
+              i.WriteU8 (lm.linkQualities[n].nlq);
+              i.WriteU16 (0); // Reserved
+            }
         }
     }
 }
@@ -400,12 +754,15 @@ MessageHeader::Hello::Deserialize (Buffer::Iterator start, uint32_t messageSize)
 
   uint16_t helloSizeLeft = messageSize;
 
-  i.ReadNtohU16 (); // Reserved
+  uint16_t flags = i.ReadNtohU16 (); // Reserved
+  bool linkQuality = flags & OLSR6_LINK_QUALITY_FLAG;
+  this->compression = flags & OLSR6_COMPRESSION_FLAG;
   this->hTime = i.ReadU8 ();
   this->willingness = i.ReadU8 ();
 
   helloSizeLeft -= 4;
 
+  uint32_t entrySize = IPV6_ADDRESS_SIZE + (linkQuality ? OLSR6_LINK_QUALITY_SIZE : 0);
   while (helloSizeLeft)
     {
       LinkMessage lm;
@@ -413,12 +770,20 @@ MessageHeader::Hello::Deserialize (Buffer::Iterator start, uint32_t messageSize)
       lm.linkCode = i.ReadU8 ();
       i.ReadU8 (); // Reserved
       uint16_t lmSize = i.ReadNtohU16 ();
-      NS_ASSERT ((lmSize - 4) % IPV6_ADDRESS_SIZE == 0);
+      NS_ASSERT ((lmSize - 4) % entrySize == 0);
       Ipv6Address next_add;
-      for (int n = (lmSize - 4) / IPV6_ADDRESS_SIZE; n; --n)
+      for (int n = (lmSize - 4) / entrySize; n; --n)
         {
           ReadFrom (i,next_add);
           lm.neighborInterfaceAddresses.push_back (next_add);
+          if (linkQuality)
+            {
+              LinkQuality quality;
+              quality.lq = i.ReadU8 ();
+              quality.nlq = i.ReadU8 ();
+              i.ReadU16 (); // Reserved
+              lm.linkQualities.push_back (quality);
+            }
         }
       helloSizeLeft -= lmSize;
       this->linkMessages.push_back (lm);
@@ -427,6 +792,115 @@ MessageHeader::Hello::Deserialize (Buffer::Iterator start, uint32_t messageSize)
   return messageSize;
 }
 
+uint32_t
+MessageHeader::Hello::GetCompressedSize (void) const
+{
+  std::vector<Ipv6Address> addresses;
+  bool linkQuality = false;
+  for (std::vector<LinkMessage>::const_iterator iter = this->linkMessages.begin ();
+       iter != this->linkMessages.end (); iter++)
+    {
+      addresses.insert (addresses.end (), iter->neighborInterfaceAddresses.begin (),
+                        iter->neighborInterfaceAddresses.end ());
+      linkQuality = linkQuality || !iter->linkQualities.empty ();
+    }
+  return 4 + GetAddressListSize (addresses)
+         + addresses.size () * (1 + (linkQuality ? OLSR6_COMPRESSED_LINK_QUALITY_SIZE : 0));
+}
+
+void
+MessageHeader::Hello::SerializeCompressed (Buffer::Iterator start) const
+{
+  Buffer::Iterator i = start;
+
+  // Either every link message carries the link qualities or none does
+  bool linkQuality = !this->linkMessages.empty () && !this->linkMessages.front ().linkQualities.empty ();
+
+  std::vector<Ipv6Address> addresses;
+  for (std::vector<LinkMessage>::const_iterator iter = this->linkMessages.begin ();
+       iter != this->linkMessages.end (); iter++)
+    {
+      NS_ASSERT (iter->linkQualities.size () == (linkQuality ? iter->neighborInterfaceAddresses.size () : 0));
+      addresses.insert (addresses.end (), iter->neighborInterfaceAddresses.begin (),
+                        iter->neighborInterfaceAddresses.end ());
+    }
+
+  // A compressed HELLO implies the compression flag
+  i.WriteHtonU16 ((linkQuality ? OLSR6_LINK_QUALITY_FLAG : 0) | OLSR6_COMPRESSION_FLAG); // Reserved
+  i.WriteU8 (this->hTime);
+  i.WriteU8 (this->willingness);
+  WriteAddressList (i, addresses);
+
+  for (std::vector<LinkMessage>::const_iterator iter = this->linkMessages.begin ();
+       iter != this->linkMessages.end (); iter++)
+    {
+      for (uint32_t n = 0; n < iter->neighborInterfaceAddresses.size (); n++)
+        {
+          i.WriteU8 (iter->linkCode);
+        }
+    }
+  if (linkQuality)
+    {
+      for (std::vector<LinkMessage>::const_iterator iter = this->linkMessages.begin ();
+           iter != this->linkMessages.end (); iter++)
+        {
+          for (uint32_t n = 0; n < iter->linkQualities.size (); n++)
+            {
+              i.WriteU8 (iter->linkQualities[n].lq);
+              i.WriteU8 (iter->linkQualities[n].nlq);
+            }
+        }
+    }
+}
+
+uint32_t
+MessageHeader::Hello::DeserializeCompressed (Buffer::Iterator start, uint32_t messageSize)
+{
+  Buffer::Iterator i = start;
+
+  NS_ASSERT (messageSize >= 6);
+
+  this->linkMessages.clear ();
+
+  bool linkQuality = i.ReadNtohU16 () & OLSR6_LINK_QUALITY_FLAG; // Reserved
+  this->compression = true;
+  this->hTime = i.ReadU8 ();
+  this->willingness = i.ReadU8 ();
+
+  std::vector<Ipv6Address> addresses;
+  uint32_t size = 4 + ReadAddressList (i, addresses);
+  for (uint32_t n = 0; n < addresses.size (); n++)
+    {
+      uint8_t linkCode = i.ReadU8 ();
+      if (this->linkMessages.empty () || this->linkMessages.back ().linkCode != linkCode)
+        {
+          LinkMessage lm;
+          lm.linkCode = linkCode;
+          this->linkMessages.push_back (lm);
+        }
+      this->linkMessages.back ().neighborInterfaceAddresses.push_back (addresses[n]);
+    }
+  size += addresses.size ();
+  if (linkQuality)
+    {
+      for (std::vector<LinkMessage>::iterator iter = this->linkMessages.begin ();
+           iter != this->linkMessages.end (); iter++)
+        {
+          for (uint32_t n = 0; n < iter->neighborInterfaceAddresses.size (); n++)
+            {
+              LinkQuality quality;
+              quality.lq = i.ReadU8 ();
+              quality.nlq = i.ReadU8 ();
+              iter->linkQualities.push_back (quality);
+            }
+        }
+      size += addresses.size () * OLSR6_COMPRESSED_LINK_QUALITY_SIZE;
+    }
+  NS_ASSERT (size == messageSize);
+
+  return messageSize;
+}
+
 
 
 // ---------------- OLSR6 TC Message -------------------------------
@@ -434,7 +908,8 @@ MessageHeader::Hello::Deserialize (Buffer::Iterator start, uint32_t messageSize)
 uint32_t
 MessageHeader::Tc::GetSerializedSize (void) const
 {
-  return 4 + this->neighborAddresses.size () * IPV6_ADDRESS_SIZE;
+  return 4 + this->neighborAddresses.size () * IPV6_ADDRESS_SIZE
+         + this->linkQualities.size () * OLSR6_LINK_QUALITY_SIZE;
 }
 
 void
@@ -448,13 +923,21 @@ MessageHeader::Tc::Serialize (Buffer::Iterator start) const
 {
   Buffer::Iterator i = start;
 
+  bool linkQuality = !this->linkQualities.empty ();
+  NS_ASSERT (!linkQuality || this->linkQualities.size () == this->neighborAddresses.size ());
+
   i.WriteHtonU16 (this->ansn);
-  i.WriteHtonU16 (0); // Reserved
+  i.WriteHtonU16 (linkQuality ? OLSR6_LINK_QUALITY_FLAG : 0); // Reserved
 
-  for (std::vector<Ipv6Address>::const_iterator iter = this->neighborAddresses.begin ();
-       iter != this->neighborAddresses.end (); iter++)
+  for (uint32_t n = 0; n < this->neighborAddresses.size (); n++)
     {
-      WriteTo (i,*iter);
+      WriteTo (i,this->neighborAddresses[n]);
+      if (linkQuality)
+        {
+          i.WriteU8 (this->linkQualities[n].lq);
+          i.WriteU8 (this->linkQualities[n].nlq);
+          i.WriteU16 (0); // Reserved
+        }
     }
 }
 
@@ -464,31 +947,163 @@ MessageHeader::Tc::Deserialize (Buffer::Iterator start, uint32_t messageSize)
   Buffer::Iterator i = start;
 
   this->neighborAddresses.clear ();
+  this->linkQualities.clear ();
   NS_ASSERT (messageSize >= 4);
 
   this->ansn = i.ReadNtohU16 ();
-  i.ReadNtohU16 (); // Reserved
+  bool linkQuality = i.ReadNtohU16 () & OLSR6_LINK_QUALITY_FLAG; // Reserved
 
-  NS_ASSERT ((messageSize - 4) % IPV6_ADDRESS_SIZE == 0);
-  int numAddresses = (messageSize - 4) / IPV6_ADDRESS_SIZE;
-  this->neighborAddresses.clear ();
+  uint32_t entrySize = IPV6_ADDRESS_SIZE + (linkQuality ? OLSR6_LINK_QUALITY_SIZE : 0);
+  NS_ASSERT ((messageSize - 4) % entrySize == 0);
+  int numAddresses = (messageSize - 4) / entrySize;
   Ipv6Address next_add;
   for (int n = 0; n < numAddresses; ++n)
     {
       ReadFrom (i,next_add);
       this->neighborAddresses.push_back (next_add);
+      if (linkQuality)
+        {
+          LinkQuality quality;
+          quality.lq = i.ReadU8 ();
+          quality.nlq = i.ReadU8 ();
+          i.ReadU16 (); // Reserved
+          this->linkQualities.push_back (quality);
+        }
     }
 
   return messageSize;
 }
 
+uint32_t
+MessageHeader::Tc::GetCompressedSize (void) const
+{
+  return 4 + GetAddressListSize (this->neighborAddresses)
+         + this->linkQualities.size () * OLSR6_COMPRESSED_LINK_QUALITY_SIZE;
+}
+
+void
+MessageHeader::Tc::SerializeCompressed (Buffer::Iterator start) const
+{
+  Buffer::Iterator i = start;
+
+  bool linkQuality = !this->linkQualities.empty ();
+  NS_ASSERT (!linkQuality || this->linkQualities.size () == this->neighborAddresses.size ());
+
+  i.WriteHtonU16 (this->ansn);
+  i.WriteHtonU16 (linkQuality ? OLSR6_LINK_QUALITY_FLAG : 0); // Reserved
+  WriteAddressList (i, this->neighborAddresses);
+  for (uint32_t n = 0; n < this->linkQualities.size (); n++)
+    {
+      i.WriteU8 (this->linkQualities[n].lq);
+      i.WriteU8 (this->linkQualities[n].nlq);
+    }
+}
+
+uint32_t
+MessageHeader::Tc::DeserializeCompressed (Buffer::Iterator start, uint32_t messageSize)
+{
+  Buffer::Iterator i = start;
+
+  this->linkQualities.clear ();
+  NS_ASSERT (messageSize >= 6);
+
+  this->ansn = i.ReadNtohU16 ();
+  bool linkQuality = i.ReadNtohU16 () & OLSR6_LINK_QUALITY_FLAG; // Reserved
+  uint32_t size = 4 + ReadAddressList (i, this->neighborAddresses);
+  if (linkQuality)
+    {
+      for (uint32_t n = 0; n < this->neighborAddresses.size (); n++)
+        {
+          LinkQuality quality;
+          quality.lq = i.ReadU8 ();
+          quality.nlq = i.ReadU8 ();
+          this->linkQualities.push_back (quality);
+        }
+      size += this->neighborAddresses.size () * OLSR6_COMPRESSED_LINK_QUALITY_SIZE;
+    }
+  NS_ASSERT (size == messageSize);
+
+  return messageSize;
+}
+
+
+// ---------------- OLSR6 Differential TC Message -------------------------------
+
+uint32_t
+MessageHeader::DiffTc::GetSerializedSize (void) const
+{
+  return 8 + (this->addedAddresses.size () + this->removedAddresses.size ()) * IPV6_ADDRESS_SIZE;
+}
+
+void
+MessageHeader::DiffTc::Print (std::ostream &os) const
+{
+  /// \todo
+}
+
+void
+MessageHeader::DiffTc::Serialize (Buffer::Iterator start) const
+{
+  Buffer::Iterator i = start;
+
+  i.WriteHtonU16 (this->ansn);
+  i.WriteHtonU16 (this->baseAnsn);
+  i.WriteHtonU16 (this->addedAddresses.size ());
+  i.WriteHtonU16 (0); // Reserved
+
+  for (std::vector<Ipv6Address>::const_iterator iter = this->addedAddresses.begin ();
+       iter != this->addedAddresses.end (); iter++)
+    {
+      WriteTo (i,*iter);
+    }
+  for (std::vector<Ipv6Address>::const_iterator iter = this->removedAddresses.begin ();
+       iter != this->removedAddresses.end (); iter++)
+    {
+      WriteTo (i,*iter);
+    }
+}
+
+uint32_t
+MessageHeader::DiffTc::Deserialize (Buffer::Iterator start, uint32_t messageSize)
+{
+  Buffer::Iterator i = start;
+
+  NS_ASSERT (messageSize >= 8);
+
+  this->ansn = i.ReadNtohU16 ();
+  this->baseAnsn = i.ReadNtohU16 ();
+  uint16_t numAdded = i.ReadNtohU16 ();
+  i.ReadNtohU16 (); // Reserved
+
+  NS_ASSERT ((messageSize - 8) % IPV6_ADDRESS_SIZE == 0);
+  int numAddresses = (messageSize - 8) / IPV6_ADDRESS_SIZE;
+  NS_ASSERT (numAdded <= numAddresses);
+  this->addedAddresses.clear ();
+  this->removedAddresses.clear ();
+  Ipv6Address next_add;
+  for (int n = 0; n < numAddresses; ++n)
+    {
+      ReadFrom (i,next_add);
+      if (n < numAdded)
+        {
+          this->addedAddresses.push_back (next_add);
+        }
+      else
+        {
+          this->removedAddresses.push_back (next_add);
+        }
+    }
+
+  return messageSize;
+}
 
 // ---------------- OLSR6 HNA Message -------------------------------
 
 uint32_t
 MessageHeader::Hna::GetSerializedSize (void) const
 {
-  return 2 * this->associations.size () * IPV6_ADDRESS_SIZE;
+  return (this->capacity > 0 ? OLSR6_GATEWAY_INFO_SIZE : 0)
+         + 2 * this->associations.size () * IPV6_ADDRESS_SIZE;
 }
 
 void
@@ -502,6 +1117,13 @@ MessageHeader::Hna::Serialize (Buffer::Iterator start) const
 {
   Buffer::Iterator i = start;
 
+  if (this->capacity > 0)
+    {
+      i.WriteHtonU16 (this->capacity);
+      i.WriteU8 (this->load);
+      i.WriteU8 (0); // Reserved
+    }
+
   uint8_t buf[16];
   for (size_t n = 0; n < this->associations.size (); ++n)
     {
@@ -516,8 +1138,20 @@ MessageHeader::Hna::Deserialize (Buffer::Iterator start, uint32_t messageSize)
 {
   Buffer::Iterator i = start;
 
-  NS_ASSERT (messageSize % (IPV6_ADDRESS_SIZE * 2) == 0);
-  int numAddresses = messageSize / IPV6_ADDRESS_SIZE / 2;
+  // The associations are 32 bytes long, the gateway information is not
+  uint32_t associationsSize = messageSize;
+  this->capacity = 0;
+  this->load = 0;
+  if (messageSize % (IPV6_ADDRESS_SIZE * 2) == OLSR6_GATEWAY_INFO_SIZE)
+    {
+      this->capacity = i.ReadNtohU16 ();
+      this->load = i.ReadU8 ();
+      i.ReadU8 (); // Reserved
+      associationsSize -= OLSR6_GATEWAY_INFO_SIZE;
+    }
+
+  NS_ASSERT (associationsSize % (IPV6_ADDRESS_SIZE * 2) == 0);
+  int numAddresses = associationsSize / IPV6_ADDRESS_SIZE / 2;
   this->associations.clear ();
   uint8_t buf[16];
   for (int n = 0; n < numAddresses; ++n)
@@ -531,6 +1165,52 @@ MessageHeader::Hna::Deserialize (Buffer::Iterator start, uint32_t messageSize)
   return messageSize;
 }
 
+// ---------------- OLSR6 Signature Message -------------------------------
+
+MessageHeader::Signature::Signature ()
+  : keyId (0)
+{
+  std::fill (this->icv, this->icv + sizeof (this->icv), 0);
+}
+
+uint32_t
+MessageHeader::Signature::GetSerializedSize (void) const
+{
+  return OLSR6_SIGNATURE_HEADER_SIZE + sizeof (this->icv);
+}
+
+void
+MessageHeader::Signature::Print (std::ostream &os) const
+{
+  /// \todo
+}
+
+void
+MessageHeader::Signature::Serialize (Buffer::Iterator start) const
+{
+  Buffer::Iterator i = start;
+
+  i.WriteU8 (this->keyId);
+  i.WriteU8 (0); // Reserved
+  i.WriteHtonU16 (0); // Reserved
+  i.Write (this->icv, sizeof (this->icv));
+}
+
+uint32_t
+MessageHeader::Signature::Deserialize (Buffer::Iterator start, uint32_t messageSize)
+{
+  Buffer::Iterator i = start;
+
+  NS_ASSERT (messageSize == GetSerializedSize ());
+
+  this->keyId = i.ReadU8 ();
+  i.ReadU8 (); // Reserved
+  i.ReadNtohU16 (); // Reserved
+  i.Read (this->icv, sizeof (this->icv));
+
+  return messageSize;
+}
+
 }
 }  // namespace olsr6, ns3
 
@@ -170,6 +170,30 @@ public:
    |                                                               |
    +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
   \endverbatim
+ *
+ * HELLO, TC and MID messages have a compressed encoding too, sent with
+ * their own message types so that the nodes which do not know it ignore
+ * them.  Their addresses are carried by an address list: the number of
+ * addresses, then blocks of consecutive addresses sharing a head and a
+ * tail, in the spirit of the address blocks of RFC 5444, where each
+ * address only takes its mid bytes.
+ *
+  \verbatim
+    0                   1                   2                   3
+    0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+   |      Number of Addresses      |   Num-Addr    |  Addr Flags   |
+   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+   |  Head Length  |  Head ...     |  Tail Length  |  Tail ...     |
+   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+   |                        Mid ... (Num-Addr times)               |
+   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+   |   Num-Addr    |  Addr Flags   |  ... (next blocks)            |
+   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  \endverbatim
+ *
+ * The Addr Flags tell whether the block has a head (0x80), a tail
+ * (0x40), or a tail of zeros which is not written (0x20).
  */
 class MessageHeader : public Header
 {
@@ -183,6 +207,15 @@ public:
     TC_MESSAGE    = 2,
     MID_MESSAGE   = 3,
     HNA_MESSAGE   = 4,
+    DTC_MESSAGE   = 5,
+    /// Compressed HELLO, received as a HELLO_MESSAGE for which IsCompressed () is true.
+    C_HELLO_MESSAGE = 6,
+    /// Compressed TC, received as a TC_MESSAGE for which IsCompressed () is true.
+    C_TC_MESSAGE  = 7,
+    /// Compressed MID, received as a MID_MESSAGE for which IsCompressed () is true.
+    C_MID_MESSAGE = 8,
+    /// Signature of the packet, which ends it (see RoutingProtocol, AuthenticationKey).
+    SIGNATURE_MESSAGE = 9,
   };
 
   MessageHeader ();
@@ -290,6 +323,23 @@ public:
     return m_messageSequenceNumber;
   }
 
+  /**
+   * Allow the compressed encoding of a HELLO, TC or MID message.  It is
+   * used when it is smaller than the plain one.
+   * \param compression True to allow the compressed encoding.
+   */
+  void SetCompression (bool compression)
+  {
+    m_compression = compression;
+    m_compressed = false;
+  }
+  /**
+   * Tell whether the message is serialized, or was received, in the
+   * compressed encoding.
+   * \return True if the message is compressed.
+   */
+  bool IsCompressed () const;
+
 private:
   MessageType m_messageType;        //!< The message type
   uint8_t m_vTime;                  //!< The validity time.
@@ -298,6 +348,8 @@ private:
   uint8_t m_hopCount;               //!< The hop count.
   uint16_t m_messageSequenceNumber; //!< The message sequence number.
   uint16_t m_messageSize;           //!< The message size.
+  bool m_compression;               //!< True if the compressed encoding is allowed.
+  bool m_compressed;                //!< True if the message was received compressed.
 
 public:
   /**
@@ -364,6 +416,37 @@ public:
      * \returns the number of bytes read.
      */
     uint32_t Deserialize (Buffer::Iterator start, uint32_t messageSize);
+    /**
+     * \returns the size of the compressed encoding.
+     */
+    uint32_t GetCompressedSize (void) const;
+    /**
+     * Write the compressed encoding: the address list.
+     * \param start where the message should be written.
+     */
+    void SerializeCompressed (Buffer::Iterator start) const;
+    /**
+     * Read the compressed encoding.
+     * \param start where the message should be read from.
+     * \param messageSize the message size.
+     * \returns the number of bytes read.
+     */
+    uint32_t DeserializeCompressed (Buffer::Iterator start, uint32_t messageSize);
+  };
+
+  /**
+   * Quality of a link, carried by the link quality extension of the HELLO
+   * and TC messages.
+   *
+   * With the extension, announced by the bit 0 (L) of their first Reserved
+   * field, the HELLO and TC messages follow every address with 4 bytes:
+   * the LQ, the NLQ and 2 reserved bytes.  The Expected Transmission
+   * Count of the link is 1 / (LQ * NLQ).
+   */
+  struct LinkQuality
+  {
+    uint8_t lq;   //!< Ratio of the HELLO messages received on the link, in 1/255.
+    uint8_t nlq;  //!< Ratio of the HELLO messages received by the neighbor, in 1/255.
   };
 
   /**
@@ -410,6 +493,13 @@ public:
   */
   struct Hello
   {
+    Hello ()
+      : hTime (0),
+        willingness (0),
+        compression (false)
+    {
+    }
+
     /**
      * Link message item
      */
@@ -417,6 +507,7 @@ public:
     {
       uint8_t linkCode;       //!< Link code
       std::vector<Ipv6Address> neighborInterfaceAddresses;  //!< Neighbor interface address container.
+      std::vector<LinkQuality> linkQualities;  //!< Quality of the link to each address (extension only).
     };
 
     uint8_t hTime;  //!< HELLO emission interval (coded)
@@ -440,6 +531,7 @@ public:
     }
 
     uint8_t willingness; //!< The willingness of a node to carry and forward traffic for other nodes.
+    bool compression;    //!< True if the node accepts compressed messages (bit 1 of the Reserved field).
     std::vector<LinkMessage> linkMessages; //!< Link messages container.
 
     /**
@@ -470,6 +562,26 @@ public:
      * \returns the number of bytes read.
      */
     uint32_t Deserialize (Buffer::Iterator start, uint32_t messageSize);
+    /**
+     * \returns the size of the compressed encoding.
+     */
+    uint32_t GetCompressedSize (void) const;
+    /**
+     * Write the compressed encoding: the first 4 bytes of the HELLO
+     * message, the address list of all the link messages, the link code
+     * of each address and, with the link quality extension, its LQ and
+     * NLQ.
+     * \param start where the message should be written.
+     */
+    void SerializeCompressed (Buffer::Iterator start) const;
+    /**
+     * Read the compressed encoding.  Consecutive addresses of the same
+     * link code make a link message.
+     * \param start where the message should be read from.
+     * \param messageSize the message size.
+     * \returns the number of bytes read.
+     */
+    uint32_t DeserializeCompressed (Buffer::Iterator start, uint32_t messageSize);
   };
 
   /**
@@ -499,6 +611,7 @@ public:
   struct Tc
   {
     std::vector<Ipv6Address> neighborAddresses; //!< Neighbor address container.
+    std::vector<LinkQuality> linkQualities;     //!< Quality of the link to each neighbor (extension only).
     uint16_t ansn;  //!< Advertised Neighbor Sequence Number.
 
     /**
@@ -529,6 +642,93 @@ public:
      * \returns the number of bytes read.
      */
     uint32_t Deserialize (Buffer::Iterator start, uint32_t messageSize);
+    /**
+     * \returns the size of the compressed encoding.
+     */
+    uint32_t GetCompressedSize (void) const;
+    /**
+     * Write the compressed encoding: the first 4 bytes of the TC message,
+     * the address list and, with the link quality extension, the LQ and
+     * NLQ of each address.
+     * \param start where the message should be written.
+     */
+    void SerializeCompressed (Buffer::Iterator start) const;
+    /**
+     * Read the compressed encoding.
+     * \param start where the message should be read from.
+     * \param messageSize the message size.
+     * \returns the number of bytes read.
+     */
+    uint32_t DeserializeCompressed (Buffer::Iterator start, uint32_t messageSize);
+  };
+
+  /**
+   * \ingroup olsr6
+   * Differential TC Message Format
+   *
+   * Carries the changes of the Advertised Neighbor Set since the TC
+   * message with the base ANSN: the advertised set is the one of that TC
+   * plus the added addresses minus the removed ones.
+   *
+   \verbatim
+     0                   1                   2                   3
+     0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+    +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+    |              ANSN             |           Base ANSN           |
+    +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+    |       Number of Additions     |           Reserved            |
+    +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+    |                                                               |
+    |                 Added Neighbor Main Address                   |
+    |                                                               |
+    |                                                               |
+    +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+    |                              ...                              |
+    +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+    |                                                               |
+    |                Removed Neighbor Main Address                  |
+    |                                                               |
+    |                                                               |
+    +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+    |                              ...                              |
+    +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+   \endverbatim
+   */
+  struct DiffTc
+  {
+    std::vector<Ipv6Address> addedAddresses;   //!< Neighbors advertised since the base TC.
+    std::vector<Ipv6Address> removedAddresses; //!< Neighbors withdrawn since the base TC.
+    uint16_t ansn;      //!< Advertised Neighbor Sequence Number.
+    uint16_t baseAnsn;  //!< ANSN of the TC message the changes apply to.
+
+    /**
+     * This method is used to print the content of a differential TC message.
+     * \param os output stream
+     */
+    void Print (std::ostream &os) const;
+    /**
+     * Returns the expected size of the header.
+     * \returns the expected size of the header.
+     */
+    uint32_t GetSerializedSize (void) const;
+    /**
+     * This method is used by Packet::AddHeader to
+     * store a header into the byte buffer of a packet.
+     *
+     * \param start an iterator which points to where the header should
+     *        be written.
+     */
+    void Serialize (Buffer::Iterator start) const;
+    /**
+     * This method is used by Packet::RemoveHeader to
+     * re-create a header from the byte buffer of a packet.
+     *
+     * \param start an iterator which points to where the header should
+     *        read from.
+     * \param messageSize the message size.
+     * \returns the number of bytes read.
+     */
+    uint32_t Deserialize (Buffer::Iterator start, uint32_t messageSize);
   };
 
 
@@ -563,9 +763,30 @@ public:
     |                              ...                              |
     +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
    \endverbatim
+   *
+   * A gateway advertising its uplink capacity and load sends an extended
+   * HNA message, in which the associations follow a gateway information
+   * field; the size of the message, 4 plus a multiple of 32 bytes, tells
+   * them apart.
+   *
+   \verbatim
+     0                   1                   2                   3
+     0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+    +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+    |            Capacity           |      Load     |   Reserved    |
+    +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+    |                         Associations ...                      |
+    +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+   \endverbatim
    */
   struct Hna
   {
+    Hna ()
+      : capacity (0),
+        load (0)
+    {
+    }
+
     /**
      * Association item structure.
      */
@@ -576,6 +797,8 @@ public:
     };
 
     std::vector<Association> associations; //!< Association container.
+    uint16_t capacity;  //!< Uplink capacity of the gateway in Mbit/s, 0 if not advertised.
+    uint8_t load;       //!< Load of the uplink, from 0 (idle) to 255 (saturated).
 
     /**
      * This method is used to print the content of a MID message.
@@ -607,6 +830,63 @@ public:
     uint32_t Deserialize (Buffer::Iterator start, uint32_t messageSize);
   };
 
+  /**
+   * \ingroup olsr6
+   * Signature Message Format
+   *
+   * The last message of an authenticated packet, sent with a TTL of 1.  The
+   * ICV is the HMAC-SHA-256, with the key identified by Key ID, of the whole
+   * packet from its packet header, in which the ICV itself is zero.
+   *
+  \verbatim
+    0                   1                   2                   3
+    0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+   |    Key ID     |   Reserved    |           Reserved            |
+   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+   |                                                               |
+   |                      ICV (32 bytes) ...                       |
+   |                                                               |
+   +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+  \endverbatim
+  */
+  struct Signature
+  {
+    Signature ();
+
+    uint8_t keyId;    //!< Identifier of the key of the ICV.
+    uint8_t icv[32];  //!< Integrity Check Value.
+
+    /**
+     * This method is used to print the content of a signature message.
+     * \param os output stream
+     */
+    void Print (std::ostream &os) const;
+    /**
+     * Returns the expected size of the header.
+     * \returns the expected size of the header.
+     */
+    uint32_t GetSerializedSize (void) const;
+    /**
+     * This method is used by Packet::AddHeader to
+     * store a header into the byte buffer of a packet.
+     *
+     * \param start an iterator which points to where the header should
+     *        be written.
+     */
+    void Serialize (Buffer::Iterator start) const;
+    /**
+     * This method is used by Packet::RemoveHeader to
+     * re-create a header from the byte buffer of a packet.
+     *
+     * \param start an iterator which points to where the header should
+     *        read from.
+     * \param messageSize the message size.
+     * \returns the number of bytes read.
+     */
+    uint32_t Deserialize (Buffer::Iterator start, uint32_t messageSize);
+  };
+
 private:
   /**
    * Structure holding the message content.
@@ -617,6 +897,8 @@ private:
     Hello hello;  //!< HELLO message (optional).
     Tc tc;        //!< TC message (optional).
     Hna hna;      //!< HNA message (optional).
+    DiffTc diffTc;  //!< Differential TC message (optional).
+    Signature signature;  //!< Signature message (optional).
   } m_message; //!< The actual message being carried.
 
 public:
@@ -688,6 +970,40 @@ public:
     return m_message.hna;
   }
 
+  /**
+   * Set the message type to differential TC and return the message content.
+   * \returns The differential TC message.
+   */
+  DiffTc& GetDiffTc ()
+  {
+    if (m_messageType == 0)
+      {
+        m_messageType = DTC_MESSAGE;
+      }
+    else
+      {
+        NS_ASSERT (m_messageType == DTC_MESSAGE);
+      }
+    return m_message.diffTc;
+  }
+
+  /**
+   * Set the message type to signature and return the message content.
+   * \returns The signature message.
+   */
+  Signature& GetSignature ()
+  {
+    if (m_messageType == 0)
+      {
+        m_messageType = SIGNATURE_MESSAGE;
+      }
+    else
+      {
+        NS_ASSERT (m_messageType == SIGNATURE_MESSAGE);
+      }
+    return m_message.signature;
+  }
+
 
   /**
    * Get the MID message.
@@ -729,6 +1045,26 @@ public:
     return m_message.hna;
   }
 
+  /**
+   * Get the differential TC message.
+   * \returns The differential TC message.
+   */
+  const DiffTc& GetDiffTc () const
+  {
+    NS_ASSERT (m_messageType == DTC_MESSAGE);
+    return m_message.diffTc;
+  }
+
+  /**
+   * Get the signature message.
+   * \returns The signature message.
+   */
+  const Signature& GetSignature () const
+  {
+    NS_ASSERT (m_messageType == SIGNATURE_MESSAGE);
+    return m_message.signature;
+  }
+
 
 };
 
@@ -0,0 +1,536 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Ankit Deepak <adadeepak8@gmail.com>
+ *          Shravya Ks <shravya.ks0@gmail.com>,
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+///
+/// \file	olsr6-oracle.cc
+/// \brief	Implementation of the process-wide topology model of the OLSR6 oracle mode.
+///
+
+#include "olsr6-oracle.h"
+#include "olsr6-routing-protocol.h"
+#include "ns3/simulator.h"
+#include "ns3/log.h"
+#include "ns3/channel.h"
+#include "ns3/net-device.h"
+
+#include <limits>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Olsr6OracleTopology");
+
+namespace olsr6 {
+
+OracleTopology::OracleTopology ()
+{
+}
+
+OracleTopology*
+OracleTopology::Get (void)
+{
+  return Singleton<OracleTopology>::Get ();
+}
+
+void
+OracleTopology::AddNode (RoutingProtocol *protocol)
+{
+  NS_LOG_FUNCTION (this << protocol->m_mainAddress);
+
+  uint32_t index = m_vertices.size ();
+  Vertex vertex;
+  vertex.protocol = protocol;
+  vertex.addresses.push_back (protocol->m_mainAddress);
+  Ptr<Ipv6> ipv6 = protocol->m_ipv6;
+  for (uint32_t i = 0; i < ipv6->GetNInterfaces (); i++)
+    {
+      if (protocol->m_interfaceExclusions.find (i) != protocol->m_interfaceExclusions.end ())
+        {
+          continue;
+        }
+      for (uint32_t j = 0; j < ipv6->GetNAddresses (i); j++)
+        {
+          Ipv6InterfaceAddress address = ipv6->GetAddress (i, j);
+          if (address.GetScope () == Ipv6InterfaceAddress::GLOBAL
+              && address.GetAddress () != protocol->m_mainAddress)
+            {
+              vertex.addresses.push_back (address.GetAddress ());
+            }
+        }
+    }
+  m_vertices.push_back (vertex);
+
+  for (std::vector<Ipv6Address>::const_iterator it = vertex.addresses.begin ();
+       it != vertex.addresses.end (); it++)
+    {
+      m_addressIndex[*it] = index;
+    }
+
+  DiscoverLinks (index);
+  Invalidate (index);
+}
+
+void
+OracleTopology::RemoveNode (RoutingProtocol *protocol)
+{
+  NS_LOG_FUNCTION (this << protocol->m_mainAddress);
+
+  bool empty = true;
+  for (uint32_t index = 0; index < m_vertices.size (); index++)
+    {
+      Vertex &vertex = m_vertices[index];
+      if (vertex.protocol == protocol)
+        {
+          vertex.protocol = NULL;
+          for (std::set<uint32_t>::const_iterator mpr = vertex.mprSet.begin ();
+               mpr != vertex.mprSet.end (); mpr++)
+            {
+              m_vertices[*mpr].advertised.erase (index);
+            }
+          vertex.mprSet.clear ();
+          // Nodes are normally disposed of when the simulation is destroyed,
+          // in which case there is nothing left to recompute.
+          if (!Simulator::IsFinished ())
+            {
+              for (std::vector<Link>::const_iterator link = vertex.links.begin ();
+                   link != vertex.links.end (); link++)
+                {
+                  Invalidate (link->neighbor);
+                }
+            }
+        }
+      else if (vertex.protocol != NULL)
+        {
+          empty = false;
+        }
+    }
+
+  // Forget everything once the last node is gone, so that the next
+  // simulation run in this process starts from an empty topology.
+  if (empty)
+    {
+      m_recomputeEvent.Cancel ();
+      m_vertices.clear ();
+      m_addressIndex.clear ();
+      m_changed.clear ();
+    }
+}
+
+void
+OracleTopology::SetLinkState (Ipv6Address ifaceA, Ipv6Address ifaceB, bool up)
+{
+  NS_LOG_FUNCTION (this << ifaceA << ifaceB << up);
+
+  std::map<Ipv6Address, uint32_t>::const_iterator a = m_addressIndex.find (ifaceA);
+  std::map<Ipv6Address, uint32_t>::const_iterator b = m_addressIndex.find (ifaceB);
+  if (a == m_addressIndex.end () || b == m_addressIndex.end ())
+    {
+      NS_FATAL_ERROR ("Link " << ifaceA << " <-> " << ifaceB << " does not join two nodes running OLSR6 in oracle mode");
+    }
+  SetLink (a->second, ifaceA, b->second, ifaceB, up);
+  SetLink (b->second, ifaceB, a->second, ifaceA, up);
+  Invalidate (a->second);
+  Invalidate (b->second);
+}
+
+void
+OracleTopology::WillingnessChanged (RoutingProtocol *protocol)
+{
+  NS_LOG_FUNCTION (this << protocol->m_mainAddress << int (protocol->GetWillingness ()));
+
+  for (uint32_t index = 0; index < m_vertices.size (); index++)
+    {
+      if (m_vertices[index].protocol == protocol)
+        {
+          Invalidate (index);
+        }
+    }
+}
+
+uint32_t
+OracleTopology::GetNNodes (void) const
+{
+  uint32_t n = 0;
+  for (std::vector<Vertex>::const_iterator it = m_vertices.begin ();
+       it != m_vertices.end (); it++)
+    {
+      if (it->protocol != NULL)
+        {
+          n++;
+        }
+    }
+  return n;
+}
+
+void
+OracleTopology::DiscoverLinks (uint32_t index)
+{
+  RoutingProtocol *protocol = m_vertices[index].protocol;
+  Ptr<Ipv6> ipv6 = protocol->m_ipv6;
+  for (uint32_t i = 0; i < ipv6->GetNInterfaces (); i++)
+    {
+      if (protocol->m_interfaceExclusions.find (i) != protocol->m_interfaceExclusions.end ())
+        {
+          continue;
+        }
+      Ptr<NetDevice> device = ipv6->GetNetDevice (i);
+      Ptr<Channel> channel = device->GetChannel ();
+      if (channel == 0)
+        {
+          continue;
+        }
+      for (uint32_t j = 0; j < ipv6->GetNAddresses (i); j++)
+        {
+          Ipv6InterfaceAddress local = ipv6->GetAddress (i, j);
+          if (local.GetScope () != Ipv6InterfaceAddress::GLOBAL)
+            {
+              continue;
+            }
+          for (uint32_t d = 0; d < channel->GetNDevices (); d++)
+            {
+              Ptr<NetDevice> otherDevice = channel->GetDevice (d);
+              if (otherDevice == device)
+                {
+                  continue;
+                }
+              Ptr<Ipv6> otherIpv6 = otherDevice->GetNode ()->GetObject<Ipv6> ();
+              if (otherIpv6 == 0)
+                {
+                  continue;
+                }
+              int32_t otherInterface = otherIpv6->GetInterfaceForDevice (otherDevice);
+              if (otherInterface < 0)
+                {
+                  continue;
+                }
+              for (uint32_t k = 0; k < otherIpv6->GetNAddresses (otherInterface); k++)
+                {
+                  Ipv6InterfaceAddress remote = otherIpv6->GetAddress (otherInterface, k);
+                  std::map<Ipv6Address, uint32_t>::const_iterator neighbor =
+                    m_addressIndex.find (remote.GetAddress ());
+                  if (remote.GetScope () != Ipv6InterfaceAddress::GLOBAL
+                      || neighbor == m_addressIndex.end ()
+                      || neighbor->second == index)
+                    {
+                      continue;
+                    }
+                  // Only addresses of non-excluded interfaces are indexed, so
+                  // both ends of the link run OLSR6.
+                  SetLink (index, local.GetAddress (), neighbor->second, remote.GetAddress (), true);
+                  SetLink (neighbor->second, remote.GetAddress (), index, local.GetAddress (), true);
+                  Invalidate (neighbor->second);
+                }
+            }
+        }
+    }
+}
+
+void
+OracleTopology::SetLink (uint32_t from, const Ipv6Address &localIfaceAddr,
+                         uint32_t to, const Ipv6Address &neighborIfaceAddr, bool up)
+{
+  std::vector<Link> &links = m_vertices[from].links;
+  for (std::vector<Link>::iterator link = links.begin (); link != links.end (); link++)
+    {
+      if (link->localIfaceAddr == localIfaceAddr && link->neighborIfaceAddr == neighborIfaceAddr)
+        {
+          link->up = up;
+          return;
+        }
+    }
+
+  int32_t interface = m_vertices[from].protocol->m_ipv6->GetInterfaceForAddress (localIfaceAddr);
+  NS_ASSERT (interface >= 0);
+  Link link;
+  link.neighbor = to;
+  link.interface = interface;
+  link.localIfaceAddr = localIfaceAddr;
+  link.neighborIfaceAddr = neighborIfaceAddr;
+  link.up = up;
+  links.push_back (link);
+}
+
+void
+OracleTopology::Invalidate (uint32_t index)
+{
+  m_changed.insert (index);
+  if (!m_recomputeEvent.IsRunning ())
+    {
+      m_recomputeEvent = Simulator::ScheduleNow (&OracleTopology::Recompute, this);
+    }
+}
+
+void
+OracleTopology::Recompute (void)
+{
+  NS_LOG_FUNCTION (this << m_changed.size ());
+
+  // The MPR set of a node depends on its 1-hop and 2-hop neighborhood, so
+  // it changes only for the nodes whose links changed and their neighbors.
+  std::set<uint32_t> local;
+  for (std::set<uint32_t>::const_iterator it = m_changed.begin ();
+       it != m_changed.end (); it++)
+    {
+      if (m_vertices[*it].protocol == NULL)
+        {
+          continue;
+        }
+      local.insert (*it);
+      for (std::vector<Link>::const_iterator link = m_vertices[*it].links.begin ();
+           link != m_vertices[*it].links.end (); link++)
+        {
+          if (m_vertices[link->neighbor].protocol != NULL)
+            {
+              local.insert (link->neighbor);
+            }
+        }
+    }
+  m_changed.clear ();
+
+  std::vector<std::pair<uint32_t, uint32_t> > changes;
+  for (std::set<uint32_t>::const_iterator it = local.begin (); it != local.end (); it++)
+    {
+      ComputeMprSet (*it, changes);
+    }
+
+  // Those nodes also have new 1-hop or 2-hop routes; any other node only
+  // needs new routes if a changed advertised link may belong to them.
+  uint32_t recomputed = 0;
+  for (uint32_t index = 0; index < m_vertices.size (); index++)
+    {
+      if (m_vertices[index].protocol == NULL)
+        {
+          continue;
+        }
+      if (local.find (index) != local.end () || IsAffected (index, changes))
+        {
+          ComputeRoutes (index);
+          recomputed++;
+        }
+    }
+  NS_LOG_DEBUG ("Oracle recomputed " << local.size () << " MPR sets, "
+                                     << changes.size () << " advertised link changes, "
+                                     << recomputed << " routing tables");
+}
+
+void
+OracleTopology::ComputeMprSet (uint32_t index, std::vector<std::pair<uint32_t, uint32_t> > &changes)
+{
+  RoutingProtocol *protocol = m_vertices[index].protocol;
+
+  // Rebuild the neighborhood of the node in its own Olsr6State, so that
+  // its MPR set is selected by RoutingProtocol::MprComputation itself.
+  NeighborSet &neighbors = protocol->m_state.GetNeighbors ();
+  TwoHopNeighborSet &twoHopNeighbors = protocol->m_state.GetTwoHopNeighbors ();
+  neighbors.clear ();
+  twoHopNeighbors.clear ();
+
+  std::set<uint32_t> oneHop;
+  for (std::vector<Link>::const_iterator link = m_vertices[index].links.begin ();
+       link != m_vertices[index].links.end (); link++)
+    {
+      const Vertex &neighbor = m_vertices[link->neighbor];
+      if (!link->up || neighbor.protocol == NULL || !oneHop.insert (link->neighbor).second)
+        {
+          continue;
+        }
+      NeighborTuple tuple;
+      tuple.neighborMainAddr = neighbor.addresses.front ();
+      tuple.status = NeighborTuple::STATUS_SYM;
+      tuple.willingness = neighbor.protocol->GetWillingness ();
+      neighbors.push_back (tuple);
+    }
+
+  for (std::set<uint32_t>::const_iterator n = oneHop.begin (); n != oneHop.end (); n++)
+    {
+      std::set<uint32_t> twoHop;
+      for (std::vector<Link>::const_iterator link = m_vertices[*n].links.begin ();
+           link != m_vertices[*n].links.end (); link++)
+        {
+          if (!link->up || link->neighbor == index || m_vertices[link->neighbor].protocol == NULL
+              || !twoHop.insert (link->neighbor).second)
+            {
+              continue;
+            }
+          TwoHopNeighborTuple tuple;
+          tuple.neighborMainAddr = m_vertices[*n].addresses.front ();
+          tuple.twoHopNeighborAddr = m_vertices[link->neighbor].addresses.front ();
+          tuple.expirationTime = Simulator::Now ();
+          twoHopNeighbors.push_back (tuple);
+        }
+    }
+
+  protocol->MprComputation ();
+
+  std::set<uint32_t> mprSet;
+  MprSet mprAddresses = protocol->m_state.GetMprSet ();
+  for (MprSet::const_iterator it = mprAddresses.begin (); it != mprAddresses.end (); it++)
+    {
+      mprSet.insert (m_addressIndex[*it]);
+    }
+
+  // Each MPR advertises the link to this node, its MPR selector.
+  std::set<uint32_t> &oldMprSet = m_vertices[index].mprSet;
+  for (std::set<uint32_t>::const_iterator it = oldMprSet.begin (); it != oldMprSet.end (); it++)
+    {
+      if (mprSet.find (*it) == mprSet.end ())
+        {
+          m_vertices[*it].advertised.erase (index);
+          changes.push_back (std::make_pair (*it, index));
+        }
+    }
+  for (std::set<uint32_t>::const_iterator it = mprSet.begin (); it != mprSet.end (); it++)
+    {
+      if (oldMprSet.find (*it) == oldMprSet.end ())
+        {
+          m_vertices[*it].advertised.insert (index);
+          changes.push_back (std::make_pair (*it, index));
+        }
+    }
+  oldMprSet.swap (mprSet);
+}
+
+void
+OracleTopology::ComputeRoutes (uint32_t index)
+{
+  const uint32_t infinity = std::numeric_limits<uint32_t>::max ();
+  std::vector<uint32_t> distance (m_vertices.size (), infinity);
+  std::vector<const Link *> firstHop (m_vertices.size (), NULL);
+  distance[index] = 0;
+
+  RoutingProtocol *protocol = m_vertices[index].protocol;
+  protocol->Clear ();
+
+  // 1-hop neighbors: one entry per link, plus the main address below.
+  std::vector<uint32_t> oneHop;
+  for (std::vector<Link>::const_iterator link = m_vertices[index].links.begin ();
+       link != m_vertices[index].links.end (); link++)
+    {
+      if (!link->up || m_vertices[link->neighbor].protocol == NULL)
+        {
+          continue;
+        }
+      protocol->AddEntry (link->neighborIfaceAddr, link->neighborIfaceAddr, link->interface, 1);
+      if (distance[link->neighbor] == infinity)
+        {
+          distance[link->neighbor] = 1;
+          firstHop[link->neighbor] = &(*link);
+          oneHop.push_back (link->neighbor);
+        }
+    }
+
+  // 2-hop neighbors, through neighbors willing to forward.
+  std::vector<uint32_t> frontier;
+  for (std::vector<uint32_t>::const_iterator n = oneHop.begin (); n != oneHop.end (); n++)
+    {
+      if (m_vertices[*n].protocol->GetWillingness () == OLSR6_WILL_NEVER)
+        {
+          continue;
+        }
+      for (std::vector<Link>::const_iterator link = m_vertices[*n].links.begin ();
+           link != m_vertices[*n].links.end (); link++)
+        {
+          if (link->up && m_vertices[link->neighbor].protocol != NULL
+              && distance[link->neighbor] == infinity)
+            {
+              distance[link->neighbor] = 2;
+              firstHop[link->neighbor] = firstHop[*n];
+              frontier.push_back (link->neighbor);
+            }
+        }
+    }
+
+  // Farther nodes, hop by hop along the advertised links.
+  for (uint32_t h = 2; !frontier.empty (); h++)
+    {
+      std::vector<uint32_t> next;
+      for (std::vector<uint32_t>::const_iterator last = frontier.begin ();
+           last != frontier.end (); last++)
+        {
+          const std::set<uint32_t> &advertised = m_vertices[*last].advertised;
+          for (std::set<uint32_t>::const_iterator dest = advertised.begin ();
+               dest != advertised.end (); dest++)
+            {
+              if (distance[*dest] == infinity)
+                {
+                  distance[*dest] = h + 1;
+                  firstHop[*dest] = firstHop[*last];
+                  next.push_back (*dest);
+                }
+            }
+        }
+      frontier.swap (next);
+    }
+
+  // Every interface address of a destination is reached like its main address.
+  for (uint32_t dest = 0; dest < m_vertices.size (); dest++)
+    {
+      if (firstHop[dest] == NULL)
+        {
+          continue;
+        }
+      const std::vector<Ipv6Address> &addresses = m_vertices[dest].addresses;
+      for (std::vector<Ipv6Address>::const_iterator addr = addresses.begin ();
+           addr != addresses.end (); addr++)
+        {
+          RoutingTableEntry entry;
+          if (!protocol->Lookup (*addr, entry))
+            {
+              protocol->AddEntry (*addr, firstHop[dest]->neighborIfaceAddr,
+                                  firstHop[dest]->interface, distance[dest]);
+            }
+        }
+    }
+
+  protocol->m_routingTableChanged (protocol->GetSize ());
+}
+
+bool
+OracleTopology::IsAffected (uint32_t index, const std::vector<std::pair<uint32_t, uint32_t> > &changes) const
+{
+  const RoutingProtocol *protocol = m_vertices[index].protocol;
+  for (std::vector<std::pair<uint32_t, uint32_t> >::const_iterator it = changes.begin ();
+       it != changes.end (); it++)
+    {
+      if (it->second == index)
+        {
+          continue;
+        }
+      // Advertised links are only followed from nodes at 2 hops or more.
+      RoutingTableEntry last, dest;
+      if (!protocol->Lookup (m_vertices[it->first].addresses.front (), last)
+          || last.distance < 2)
+        {
+          continue;
+        }
+      // A removed link matters if it may lie on the current route to its
+      // destination, an added one if it may shorten that route.
+      if (!protocol->Lookup (m_vertices[it->second].addresses.front (), dest)
+          || dest.distance > last.distance)
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+}
+}  // namespace olsr6, ns3
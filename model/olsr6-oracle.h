@@ -0,0 +1,197 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Ankit Deepak <adadeepak8@gmail.com>
+ *          Shravya Ks <shravya.ks0@gmail.com>,
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+/// \brief	This header file declares the process-wide topology model used by the OLSR6 oracle mode.
+
+#ifndef OLSR6_ORACLE_H
+#define OLSR6_ORACLE_H
+
+#include "ns3/ipv6-address.h"
+#include "ns3/event-id.h"
+#include "ns3/singleton.h"
+
+#include <vector>
+#include <map>
+#include <set>
+
+namespace ns3 {
+namespace olsr6 {
+
+class RoutingProtocol;
+
+/// \ingroup olsr6
+/// \brief Process-wide topology model of the %OLSR6 oracle mode.
+///
+/// In oracle mode a RoutingProtocol exchanges no control traffic.  Instead,
+/// it registers with this model, which owns the only copy of the network
+/// topology, computes the routes of every node with the %OLSR6 semantics and
+/// installs them straight into each node's routing table:
+///
+///  - each node selects its MPR set from its 1-hop and 2-hop neighborhood
+///    with the same heuristic as RoutingProtocol::MprComputation;
+///  - only the links between a node and its MPR selectors are advertised,
+///    as if carried by TC messages;
+///  - the routing tables follow \RFC{3626} section 10 (1-hop neighbors,
+///    2-hop neighbors through a neighbor willing to forward, then the
+///    advertised links, hop by hop).
+///
+/// Two nodes are neighbors when they have interfaces attached to the same
+/// channel.  Links can then be brought down and up with SetLinkState (); the
+/// model only recomputes the MPR sets of the nodes around the link and the
+/// routing tables that the change can affect.
+class OracleTopology
+{
+public:
+  OracleTopology ();
+
+  /**
+   * \returns The process-wide topology model.
+   */
+  static OracleTopology* Get (void);
+
+  /**
+   * \brief Adds a node running in oracle mode to the topology.
+   *
+   * The routes are (re)computed once all the nodes started at the same
+   * time have been added.
+   *
+   * \param protocol The routing protocol of the node.
+   */
+  void AddNode (RoutingProtocol *protocol);
+
+  /**
+   * \brief Removes a node from the topology.
+   * \param protocol The routing protocol of the node.
+   */
+  void RemoveNode (RoutingProtocol *protocol);
+
+  /**
+   * \brief Brings a link between two interfaces down or up.
+   *
+   * A link that does not exist yet is created if both interfaces belong to
+   * nodes of the topology.  The routes are recomputed at the end of the
+   * current simulation time step.
+   *
+   * \param ifaceA Address of the interface at one end of the link.
+   * \param ifaceB Address of the interface at the other end of the link.
+   * \param up True if the link is up.
+   */
+  void SetLinkState (Ipv6Address ifaceA, Ipv6Address ifaceB, bool up);
+
+  /**
+   * \brief Reports that the willingness of a node changed.
+   *
+   * The MPR sets of its neighbors and the routes through it are recomputed
+   * at the end of the current simulation time step.
+   *
+   * \param protocol The routing protocol of the node.
+   */
+  void WillingnessChanged (RoutingProtocol *protocol);
+
+  /**
+   * \returns The number of nodes in the topology.
+   */
+  uint32_t GetNNodes (void) const;
+
+private:
+  /// A link from a node to one of its neighbors.
+  struct Link
+  {
+    uint32_t neighbor;              //!< Index of the neighbor node.
+    uint32_t interface;             //!< Local interface index.
+    Ipv6Address localIfaceAddr;     //!< Local interface address.
+    Ipv6Address neighborIfaceAddr;  //!< Interface address of the neighbor.
+    bool up;                        //!< True if the link is up.
+  };
+
+  /// A node of the topology.
+  struct Vertex
+  {
+    RoutingProtocol *protocol;          //!< Routing protocol of the node.
+    std::vector<Ipv6Address> addresses; //!< Main address first, then the other interface addresses.
+    std::vector<Link> links;            //!< Links to the neighbors.
+    std::set<uint32_t> mprSet;          //!< Indexes of the MPRs of the node.
+    std::set<uint32_t> advertised;      //!< Indexes of the MPR selectors, i.e. the advertised links.
+  };
+
+  /**
+   * \brief Discovers the links of a node by looking for the other nodes
+   * attached to the channels of its interfaces.
+   * \param index The index of the node.
+   */
+  void DiscoverLinks (uint32_t index);
+
+  /**
+   * \brief Creates or updates the link from a node to one of its neighbors.
+   * \param from The index of the node.
+   * \param localIfaceAddr The address of the local interface.
+   * \param to The index of the neighbor.
+   * \param neighborIfaceAddr The address of the interface of the neighbor.
+   * \param up True if the link is up.
+   */
+  void SetLink (uint32_t from, const Ipv6Address &localIfaceAddr,
+                uint32_t to, const Ipv6Address &neighborIfaceAddr, bool up);
+
+  /**
+   * \brief Marks a node whose links changed and schedules a recomputation.
+   * \param index The index of the node.
+   */
+  void Invalidate (uint32_t index);
+
+  /**
+   * \brief Recomputes the MPR sets and routing tables invalidated since the
+   * last recomputation.
+   */
+  void Recompute (void);
+
+  /**
+   * \brief Recomputes the MPR set of a node through its RoutingProtocol.
+   * \param index The index of the node.
+   * \param [out] changes Advertised links (last, dest) added or removed as a consequence.
+   */
+  void ComputeMprSet (uint32_t index, std::vector<std::pair<uint32_t, uint32_t> > &changes);
+
+  /**
+   * \brief Recomputes the routing table of a node and installs it.
+   * \param index The index of the node.
+   */
+  void ComputeRoutes (uint32_t index);
+
+  /**
+   * \brief Checks whether a change of the advertised links may change the
+   * routing table of a node, given its current routes.
+   * \param index The index of the node.
+   * \param changes The advertised links (last, dest) added or removed.
+   * \returns True if the routing table must be recomputed.
+   */
+  bool IsAffected (uint32_t index, const std::vector<std::pair<uint32_t, uint32_t> > &changes) const;
+
+  std::vector<Vertex> m_vertices;                //!< Nodes of the topology.
+  std::map<Ipv6Address, uint32_t> m_addressIndex; //!< Node index of every interface address.
+  std::set<uint32_t> m_changed;                  //!< Nodes whose links changed since the last recomputation.
+  EventId m_recomputeEvent;                      //!< Pending recomputation.
+};
+
+}
+}  // namespace olsr6, ns3
+
+#endif /* OLSR6_ORACLE_H */
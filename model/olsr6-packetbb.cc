@@ -0,0 +1,1050 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Ankit Deepak <adadeepak8@gmail.com>
+ *          Shravya Ks <shravya.ks0@gmail.com>,
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+#include <algorithm>
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+#include "ns3/address-utils.h"
+#include "olsr6-packetbb.h"
+
+#define IPV6_ADDRESS_SIZE 16
+/// Version of the generalized packet format.
+#define PBB_VERSION 0
+
+// Packet flags
+#define PBB_PKT_HAS_SEQ_NUM 0x08
+#define PBB_PKT_HAS_TLV 0x04
+
+// Message flags
+#define PBB_MSG_HAS_ORIG 0x80
+#define PBB_MSG_HAS_HOP_LIMIT 0x40
+#define PBB_MSG_HAS_HOP_COUNT 0x20
+#define PBB_MSG_HAS_SEQ_NUM 0x10
+/// Size of the fixed part of the message header.
+#define PBB_MSG_HEADER_SIZE 4
+
+// TLV flags
+#define PBB_TLV_HAS_TYPE_EXT 0x80
+#define PBB_TLV_HAS_SINGLE_INDEX 0x40
+#define PBB_TLV_HAS_MULTI_INDEX 0x20
+#define PBB_TLV_HAS_VALUE 0x10
+#define PBB_TLV_HAS_EXT_LEN 0x08
+#define PBB_TLV_IS_MULTI_VALUE 0x04
+
+// Address block flags
+#define PBB_ADDR_HAS_HEAD 0x80
+#define PBB_ADDR_HAS_FULL_TAIL 0x40
+#define PBB_ADDR_HAS_ZERO_TAIL 0x20
+#define PBB_ADDR_HAS_SINGLE_PRELEN 0x10
+#define PBB_ADDR_HAS_MULTI_PRELEN 0x08
+/// Largest number of addresses of an address block.
+#define PBB_MAX_BLOCK_ADDRESSES 255
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Olsr6PacketBb");
+
+namespace olsr6 {
+
+// ---------------- Writing -------------------------------
+
+///
+/// \brief Computes the size of a TLV block.
+///
+/// \param tlvs the TLVs of the block.
+/// \return the number of bytes of the block.
+///
+static uint32_t
+GetTlvBlockSize (const std::vector<PbbTlv> &tlvs)
+{
+  uint32_t size = 2;
+  for (std::vector<PbbTlv>::const_iterator it = tlvs.begin (); it != tlvs.end (); it++)
+    {
+      size += it->GetSerializedSize ();
+    }
+  return size;
+}
+
+///
+/// \brief Writes a TLV block.
+///
+/// \param i where the block should be written, moved after it.
+/// \param tlvs the TLVs of the block.
+///
+static void
+WriteTlvBlock (Buffer::Iterator &i, const std::vector<PbbTlv> &tlvs)
+{
+  uint32_t size = GetTlvBlockSize (tlvs) - 2;
+  NS_ASSERT (size <= 0xffff);
+  i.WriteHtonU16 (size);
+  for (std::vector<PbbTlv>::const_iterator it = tlvs.begin (); it != tlvs.end (); it++)
+    {
+      it->Serialize (i);
+    }
+}
+
+PbbTlv::PbbTlv ()
+  : type (0),
+    hasTypeExt (false),
+    typeExt (0),
+    hasIndexStart (false),
+    indexStart (0),
+    hasIndexStop (false),
+    indexStop (0),
+    multiValue (false),
+    hasValue (false)
+{
+}
+
+uint32_t
+PbbTlv::GetSerializedSize (void) const
+{
+  uint32_t size = 2;
+  size += hasTypeExt ? 1 : 0;
+  size += hasIndexStart ? 1 : 0;
+  size += hasIndexStop ? 1 : 0;
+  if (hasValue)
+    {
+      size += (value.size () > 0xff ? 2 : 1) + value.size ();
+    }
+  return size;
+}
+
+void
+PbbTlv::Serialize (Buffer::Iterator &i) const
+{
+  NS_ASSERT (!hasIndexStop || hasIndexStart);
+  NS_ASSERT (!multiValue || (hasIndexStop && hasValue));
+  NS_ASSERT (value.size () <= 0xffff);
+  NS_ASSERT (hasValue || value.empty ());
+
+  uint8_t flags = 0;
+  flags |= hasTypeExt ? PBB_TLV_HAS_TYPE_EXT : 0;
+  if (hasIndexStart)
+    {
+      flags |= hasIndexStop ? PBB_TLV_HAS_MULTI_INDEX : PBB_TLV_HAS_SINGLE_INDEX;
+    }
+  if (hasValue)
+    {
+      flags |= PBB_TLV_HAS_VALUE | (value.size () > 0xff ? PBB_TLV_HAS_EXT_LEN : 0);
+    }
+  flags |= multiValue ? PBB_TLV_IS_MULTI_VALUE : 0;
+
+  i.WriteU8 (type);
+  i.WriteU8 (flags);
+  if (hasTypeExt)
+    {
+      i.WriteU8 (typeExt);
+    }
+  if (hasIndexStart)
+    {
+      i.WriteU8 (indexStart);
+    }
+  if (hasIndexStop)
+    {
+      i.WriteU8 (indexStop);
+    }
+  if (hasValue)
+    {
+      if (value.size () > 0xff)
+        {
+          i.WriteHtonU16 (value.size ());
+        }
+      else
+        {
+          i.WriteU8 (value.size ());
+        }
+      if (!value.empty ())
+        {
+          i.Write (&value[0], value.size ());
+        }
+    }
+}
+
+/// Head and tail shared by the addresses of an address block.
+struct AddressCompression
+{
+  uint8_t head;   //!< Length of the head.
+  uint8_t tail;   //!< Length of the tail.
+  bool zeroTail;  //!< True if the tail is made of zeros.
+};
+
+///
+/// \brief Finds the head and the tail worth sharing between the addresses
+/// of an address block.
+///
+/// \param addresses the addresses of the block.
+/// \return the head and the tail.
+///
+static AddressCompression
+GetAddressCompression (const std::vector<Ipv6Address> &addresses)
+{
+  NS_ASSERT (!addresses.empty () && addresses.size () <= PBB_MAX_BLOCK_ADDRESSES);
+
+  AddressCompression compression;
+  compression.head = 0;
+  compression.tail = 0;
+  compression.zeroTail = false;
+  uint32_t n = addresses.size ();
+  if (n == 1)
+    {
+      return compression;
+    }
+
+  uint8_t first[IPV6_ADDRESS_SIZE];
+  addresses[0].GetBytes (first);
+  // Each address keeps a mid byte at least
+  uint8_t prefix = IPV6_ADDRESS_SIZE - 1;
+  uint8_t suffix = IPV6_ADDRESS_SIZE - 1;
+  for (uint32_t k = 1; k < n; k++)
+    {
+      uint8_t bytes[IPV6_ADDRESS_SIZE];
+      addresses[k].GetBytes (bytes);
+      uint8_t p = 0;
+      while (p < prefix && bytes[p] == first[p])
+        {
+          p++;
+        }
+      prefix = p;
+      uint8_t s = 0;
+      while (s < suffix && bytes[IPV6_ADDRESS_SIZE - 1 - s] == first[IPV6_ADDRESS_SIZE - 1 - s])
+        {
+          s++;
+        }
+      suffix = s;
+    }
+
+  // A head of h bytes costs 1 + h bytes and saves n * h bytes
+  if ((n - 1) * prefix > 1)
+    {
+      compression.head = prefix;
+    }
+  uint8_t tail = std::min<uint8_t> (suffix, IPV6_ADDRESS_SIZE - 1 - compression.head);
+  bool zeroTail = true;
+  for (uint8_t k = IPV6_ADDRESS_SIZE - tail; k < IPV6_ADDRESS_SIZE; k++)
+    {
+      zeroTail = zeroTail && first[k] == 0;
+    }
+  if ((zeroTail ? n * tail : (n - 1) * tail) > 1)
+    {
+      compression.tail = tail;
+      compression.zeroTail = zeroTail;
+    }
+  return compression;
+}
+
+uint32_t
+PbbAddressBlock::GetSerializedSize (void) const
+{
+  AddressCompression compression = GetAddressCompression (addresses);
+  uint32_t size = 2;
+  size += compression.head > 0 ? 1 + compression.head : 0;
+  size += compression.tail > 0 ? 1 + (compression.zeroTail ? 0 : compression.tail) : 0;
+  size += addresses.size () * (IPV6_ADDRESS_SIZE - compression.head - compression.tail);
+  size += prefixLengths.size () == addresses.size () ? prefixLengths.size () : (prefixLengths.empty () ? 0 : 1);
+  size += GetTlvBlockSize (tlvs);
+  return size;
+}
+
+void
+PbbAddressBlock::Serialize (Buffer::Iterator &i) const
+{
+  NS_ASSERT (prefixLengths.size () <= 1 || prefixLengths.size () == addresses.size ());
+  AddressCompression compression = GetAddressCompression (addresses);
+  bool multiPrefixLength = prefixLengths.size () > 1;
+
+  uint8_t flags = 0;
+  flags |= compression.head > 0 ? PBB_ADDR_HAS_HEAD : 0;
+  if (compression.tail > 0)
+    {
+      flags |= compression.zeroTail ? PBB_ADDR_HAS_ZERO_TAIL : PBB_ADDR_HAS_FULL_TAIL;
+    }
+  if (!prefixLengths.empty ())
+    {
+      flags |= multiPrefixLength ? PBB_ADDR_HAS_MULTI_PRELEN : PBB_ADDR_HAS_SINGLE_PRELEN;
+    }
+
+  uint8_t bytes[IPV6_ADDRESS_SIZE];
+  addresses[0].GetBytes (bytes);
+  i.WriteU8 (addresses.size ());
+  i.WriteU8 (flags);
+  if (compression.head > 0)
+    {
+      i.WriteU8 (compression.head);
+      i.Write (bytes, compression.head);
+    }
+  if (compression.tail > 0)
+    {
+      i.WriteU8 (compression.tail);
+      if (!compression.zeroTail)
+        {
+          i.Write (bytes + IPV6_ADDRESS_SIZE - compression.tail, compression.tail);
+        }
+    }
+  uint8_t midLength = IPV6_ADDRESS_SIZE - compression.head - compression.tail;
+  for (std::vector<Ipv6Address>::const_iterator it = addresses.begin (); it != addresses.end (); it++)
+    {
+      it->GetBytes (bytes);
+      i.Write (bytes + compression.head, midLength);
+    }
+  for (std::vector<uint8_t>::const_iterator it = prefixLengths.begin (); it != prefixLengths.end (); it++)
+    {
+      NS_ASSERT (*it <= 8 * IPV6_ADDRESS_SIZE);
+      i.WriteU8 (*it);
+    }
+  WriteTlvBlock (i, tlvs);
+}
+
+PbbMessage::PbbMessage ()
+  : type (0),
+    hasOriginator (false),
+    hasHopLimit (false),
+    hopLimit (0),
+    hasHopCount (false),
+    hopCount (0),
+    hasSequenceNumber (false),
+    sequenceNumber (0)
+{
+}
+
+uint32_t
+PbbMessage::GetSerializedSize (void) const
+{
+  uint32_t size = PBB_MSG_HEADER_SIZE;
+  size += hasOriginator ? IPV6_ADDRESS_SIZE : 0;
+  size += hasHopLimit ? 1 : 0;
+  size += hasHopCount ? 1 : 0;
+  size += hasSequenceNumber ? 2 : 0;
+  size += GetTlvBlockSize (tlvs);
+  for (std::vector<PbbAddressBlock>::const_iterator it = addressBlocks.begin ();
+       it != addressBlocks.end (); it++)
+    {
+      size += it->GetSerializedSize ();
+    }
+  return size;
+}
+
+void
+PbbMessage::Serialize (Buffer::Iterator &i) const
+{
+  uint32_t size = GetSerializedSize ();
+  NS_ASSERT (size <= 0xffff);
+
+  uint8_t flags = 0;
+  flags |= hasOriginator ? PBB_MSG_HAS_ORIG : 0;
+  flags |= hasHopLimit ? PBB_MSG_HAS_HOP_LIMIT : 0;
+  flags |= hasHopCount ? PBB_MSG_HAS_HOP_COUNT : 0;
+  flags |= hasSequenceNumber ? PBB_MSG_HAS_SEQ_NUM : 0;
+
+  i.WriteU8 (type);
+  i.WriteU8 (flags | (IPV6_ADDRESS_SIZE - 1));
+  i.WriteHtonU16 (size);
+  if (hasOriginator)
+    {
+      WriteTo (i, originator);
+    }
+  if (hasHopLimit)
+    {
+      i.WriteU8 (hopLimit);
+    }
+  if (hasHopCount)
+    {
+      i.WriteU8 (hopCount);
+    }
+  if (hasSequenceNumber)
+    {
+      i.WriteHtonU16 (sequenceNumber);
+    }
+  WriteTlvBlock (i, tlvs);
+  for (std::vector<PbbAddressBlock>::const_iterator it = addressBlocks.begin ();
+       it != addressBlocks.end (); it++)
+    {
+      it->Serialize (i);
+    }
+}
+
+
+// ---------------- Checking -------------------------------
+
+///
+/// \brief Checks a TLV block and skips it.
+///
+/// \param i the TLV block, moved after it.
+/// \param left the number of bytes left for the block, decreased by its size.
+/// \param numAddresses the number of addresses of the address block of the
+/// TLVs, 0 for packet and message TLVs, which have no index.
+/// \return false if the block is malformed.
+///
+static bool
+CheckTlvBlock (Buffer::Iterator &i, uint32_t &left, uint32_t numAddresses)
+{
+  if (left < 2)
+    {
+      return false;
+    }
+  uint16_t size = i.ReadNtohU16 ();
+  left -= 2;
+  if (size > left)
+    {
+      return false;
+    }
+  left -= size;
+
+  while (size > 0)
+    {
+      if (size < 2)
+        {
+          return false;
+        }
+      i.ReadU8 (); // Type
+      uint8_t flags = i.ReadU8 ();
+      size -= 2;
+
+      uint32_t needed = (flags & PBB_TLV_HAS_TYPE_EXT ? 1 : 0)
+        + (flags & PBB_TLV_HAS_SINGLE_INDEX ? 1 : 0)
+        + (flags & PBB_TLV_HAS_MULTI_INDEX ? 2 : 0)
+        + (flags & PBB_TLV_HAS_VALUE ? (flags & PBB_TLV_HAS_EXT_LEN ? 2 : 1) : 0);
+      if (needed > size
+          || ((flags & PBB_TLV_HAS_SINGLE_INDEX) && (flags & PBB_TLV_HAS_MULTI_INDEX))
+          || ((flags & PBB_TLV_HAS_EXT_LEN) && !(flags & PBB_TLV_HAS_VALUE))
+          || ((flags & PBB_TLV_IS_MULTI_VALUE) && !(flags & PBB_TLV_HAS_MULTI_INDEX))
+          || ((flags & (PBB_TLV_HAS_SINGLE_INDEX | PBB_TLV_HAS_MULTI_INDEX)) && numAddresses == 0))
+        {
+          return false;
+        }
+      size -= needed;
+
+      if (flags & PBB_TLV_HAS_TYPE_EXT)
+        {
+          i.ReadU8 ();
+        }
+      uint8_t indexStart = 0;
+      uint8_t indexStop = 0;
+      if (flags & (PBB_TLV_HAS_SINGLE_INDEX | PBB_TLV_HAS_MULTI_INDEX))
+        {
+          indexStart = indexStop = i.ReadU8 ();
+        }
+      if (flags & PBB_TLV_HAS_MULTI_INDEX)
+        {
+          indexStop = i.ReadU8 ();
+        }
+      if (indexStart > indexStop || (numAddresses > 0 && indexStop >= numAddresses))
+        {
+          return false;
+        }
+      uint16_t length = 0;
+      if (flags & PBB_TLV_HAS_VALUE)
+        {
+          length = flags & PBB_TLV_HAS_EXT_LEN ? i.ReadNtohU16 () : i.ReadU8 ();
+        }
+      if (length > size
+          || ((flags & PBB_TLV_IS_MULTI_VALUE) && length % (indexStop - indexStart + 1) != 0))
+        {
+          return false;
+        }
+      i.Next (length);
+      size -= length;
+    }
+  return true;
+}
+
+///
+/// \brief Checks an address block and its TLV block, and skips them.
+///
+/// \param i the address block, moved after its TLV block.
+/// \param left the number of bytes left for the block, decreased by its size.
+/// \param addressLength the length of the addresses.
+/// \return false if the block is malformed.
+///
+static bool
+CheckAddressBlock (Buffer::Iterator &i, uint32_t &left, uint8_t addressLength)
+{
+  if (left < 2)
+    {
+      return false;
+    }
+  uint8_t numAddresses = i.ReadU8 ();
+  uint8_t flags = i.ReadU8 ();
+  left -= 2;
+  if (numAddresses == 0
+      || ((flags & PBB_ADDR_HAS_FULL_TAIL) && (flags & PBB_ADDR_HAS_ZERO_TAIL))
+      || ((flags & PBB_ADDR_HAS_SINGLE_PRELEN) && (flags & PBB_ADDR_HAS_MULTI_PRELEN)))
+    {
+      return false;
+    }
+
+  uint8_t head = 0;
+  if (flags & PBB_ADDR_HAS_HEAD)
+    {
+      if (left < 1)
+        {
+          return false;
+        }
+      head = i.ReadU8 ();
+      left--;
+      if (head > addressLength || head > left)
+        {
+          return false;
+        }
+      i.Next (head);
+      left -= head;
+    }
+  uint8_t tail = 0;
+  if (flags & (PBB_ADDR_HAS_FULL_TAIL | PBB_ADDR_HAS_ZERO_TAIL))
+    {
+      if (left < 1)
+        {
+          return false;
+        }
+      tail = i.ReadU8 ();
+      left--;
+      if (head + tail > addressLength)
+        {
+          return false;
+        }
+      if (flags & PBB_ADDR_HAS_FULL_TAIL)
+        {
+          if (tail > left)
+            {
+              return false;
+            }
+          i.Next (tail);
+          left -= tail;
+        }
+    }
+
+  uint32_t mids = numAddresses * (addressLength - head - tail);
+  if (mids > left)
+    {
+      return false;
+    }
+  i.Next (mids);
+  left -= mids;
+
+  uint32_t numPrefixLengths = flags & PBB_ADDR_HAS_SINGLE_PRELEN ? 1
+    : (flags & PBB_ADDR_HAS_MULTI_PRELEN ? numAddresses : 0);
+  if (numPrefixLengths > left)
+    {
+      return false;
+    }
+  left -= numPrefixLengths;
+  for (uint32_t k = 0; k < numPrefixLengths; k++)
+    {
+      if (i.ReadU8 () > 8 * addressLength)
+        {
+          return false;
+        }
+    }
+
+  return CheckTlvBlock (i, left, numAddresses);
+}
+
+
+// ---------------- Reading in place -------------------------------
+
+bool
+PbbTlvView::HasValue (void) const
+{
+  return flags & PBB_TLV_HAS_VALUE;
+}
+
+void
+PbbTlvView::CopyTo (PbbTlv &tlv) const
+{
+  tlv.type = type;
+  tlv.hasTypeExt = flags & PBB_TLV_HAS_TYPE_EXT;
+  tlv.typeExt = typeExt;
+  tlv.hasIndexStart = flags & (PBB_TLV_HAS_SINGLE_INDEX | PBB_TLV_HAS_MULTI_INDEX);
+  tlv.indexStart = indexStart;
+  tlv.hasIndexStop = flags & PBB_TLV_HAS_MULTI_INDEX;
+  tlv.indexStop = tlv.hasIndexStop ? indexStop : 0;
+  tlv.multiValue = flags & PBB_TLV_IS_MULTI_VALUE;
+  tlv.hasValue = HasValue ();
+  tlv.value.resize (length);
+  if (length > 0)
+    {
+      Buffer::Iterator i = value;
+      i.Read (&tlv.value[0], length);
+    }
+}
+
+PbbTlvIterator::PbbTlvIterator ()
+  : m_left (0)
+{
+}
+
+PbbTlvIterator::PbbTlvIterator (Buffer::Iterator start, uint16_t size)
+  : m_next (start),
+    m_left (size)
+{
+}
+
+bool
+PbbTlvIterator::Next (PbbTlvView &tlv)
+{
+  if (m_left == 0)
+    {
+      return false;
+    }
+  Buffer::Iterator i = m_next;
+  tlv.type = i.ReadU8 ();
+  tlv.flags = i.ReadU8 ();
+  tlv.typeExt = tlv.flags & PBB_TLV_HAS_TYPE_EXT ? i.ReadU8 () : 0;
+  tlv.indexStart = tlv.flags & (PBB_TLV_HAS_SINGLE_INDEX | PBB_TLV_HAS_MULTI_INDEX) ? i.ReadU8 () : 0;
+  tlv.indexStop = tlv.flags & PBB_TLV_HAS_MULTI_INDEX ? i.ReadU8 () : tlv.indexStart;
+  tlv.length = 0;
+  if (tlv.flags & PBB_TLV_HAS_VALUE)
+    {
+      tlv.length = tlv.flags & PBB_TLV_HAS_EXT_LEN ? i.ReadNtohU16 () : i.ReadU8 ();
+    }
+  tlv.value = i;
+  i.Next (tlv.length);
+  m_left -= i.GetDistanceFrom (m_next);
+  m_next = i;
+  return true;
+}
+
+Ipv6Address
+PbbAddressBlockView::GetAddress (uint8_t index) const
+{
+  NS_ASSERT (addressLength == IPV6_ADDRESS_SIZE && index < numAddresses);
+  uint8_t bytes[IPV6_ADDRESS_SIZE] = { 0 };
+  Buffer::Iterator i = head;
+  i.Read (bytes, headLength);
+  uint8_t midLength = IPV6_ADDRESS_SIZE - headLength - tailLength;
+  i = mids;
+  i.Next (index * midLength);
+  i.Read (bytes + headLength, midLength);
+  if (flags & PBB_ADDR_HAS_FULL_TAIL)
+    {
+      i = tail;
+      i.Read (bytes + IPV6_ADDRESS_SIZE - tailLength, tailLength);
+    }
+  return Ipv6Address (bytes);
+}
+
+uint8_t
+PbbAddressBlockView::GetNPrefixLengths (void) const
+{
+  return flags & PBB_ADDR_HAS_SINGLE_PRELEN ? 1 : (flags & PBB_ADDR_HAS_MULTI_PRELEN ? numAddresses : 0);
+}
+
+uint8_t
+PbbAddressBlockView::GetPrefixLength (uint8_t index) const
+{
+  NS_ASSERT (GetNPrefixLengths () > 0 && index < numAddresses);
+  Buffer::Iterator i = prefixLengths;
+  if (flags & PBB_ADDR_HAS_MULTI_PRELEN)
+    {
+      i.Next (index);
+    }
+  return i.ReadU8 ();
+}
+
+void
+PbbAddressBlockView::CopyTo (PbbAddressBlock &block) const
+{
+  block.addresses.clear ();
+  for (uint32_t k = 0; k < numAddresses; k++)
+    {
+      block.addresses.push_back (GetAddress (k));
+    }
+  block.prefixLengths.resize (GetNPrefixLengths ());
+  if (!block.prefixLengths.empty ())
+    {
+      Buffer::Iterator i = prefixLengths;
+      i.Read (&block.prefixLengths[0], block.prefixLengths.size ());
+    }
+  block.tlvs.clear ();
+  PbbTlvIterator tlvIterator = tlvs;
+  PbbTlvView tlv;
+  while (tlvIterator.Next (tlv))
+    {
+      block.tlvs.push_back (PbbTlv ());
+      tlv.CopyTo (block.tlvs.back ());
+    }
+}
+
+PbbMessageView::PbbMessageView ()
+  : type (0),
+    flags (0),
+    addressLength (0),
+    size (0),
+    hopLimit (0),
+    hopCount (0),
+    sequenceNumber (0),
+    m_left (0)
+{
+}
+
+bool
+PbbMessageView::HasOriginator (void) const
+{
+  return flags & PBB_MSG_HAS_ORIG;
+}
+
+bool
+PbbMessageView::HasHopLimit (void) const
+{
+  return flags & PBB_MSG_HAS_HOP_LIMIT;
+}
+
+bool
+PbbMessageView::HasHopCount (void) const
+{
+  return flags & PBB_MSG_HAS_HOP_COUNT;
+}
+
+bool
+PbbMessageView::HasSequenceNumber (void) const
+{
+  return flags & PBB_MSG_HAS_SEQ_NUM;
+}
+
+Ipv6Address
+PbbMessageView::GetOriginator (void) const
+{
+  NS_ASSERT (HasOriginator () && addressLength == IPV6_ADDRESS_SIZE);
+  Ipv6Address address;
+  Buffer::Iterator i = originator;
+  ReadFrom (i, address);
+  return address;
+}
+
+bool
+PbbMessageView::NextAddressBlock (PbbAddressBlockView &block)
+{
+  if (m_left == 0)
+    {
+      return false;
+    }
+  Buffer::Iterator i = m_nextBlock;
+  block.addressLength = addressLength;
+  block.numAddresses = i.ReadU8 ();
+  block.flags = i.ReadU8 ();
+  block.headLength = 0;
+  if (block.flags & PBB_ADDR_HAS_HEAD)
+    {
+      block.headLength = i.ReadU8 ();
+    }
+  block.head = i;
+  i.Next (block.headLength);
+  block.tailLength = 0;
+  if (block.flags & (PBB_ADDR_HAS_FULL_TAIL | PBB_ADDR_HAS_ZERO_TAIL))
+    {
+      block.tailLength = i.ReadU8 ();
+    }
+  block.tail = i;
+  if (block.flags & PBB_ADDR_HAS_FULL_TAIL)
+    {
+      i.Next (block.tailLength);
+    }
+  block.mids = i;
+  i.Next (block.numAddresses * (addressLength - block.headLength - block.tailLength));
+  block.prefixLengths = i;
+  i.Next (block.GetNPrefixLengths ());
+  uint16_t tlvsSize = i.ReadNtohU16 ();
+  block.tlvs = PbbTlvIterator (i, tlvsSize);
+  i.Next (tlvsSize);
+  m_left -= i.GetDistanceFrom (m_nextBlock);
+  m_nextBlock = i;
+  return true;
+}
+
+void
+PbbMessageView::CopyTo (PbbMessage &message) const
+{
+  message.type = type;
+  message.hasOriginator = HasOriginator ();
+  message.originator = HasOriginator () ? GetOriginator () : Ipv6Address ();
+  message.hasHopLimit = HasHopLimit ();
+  message.hopLimit = hopLimit;
+  message.hasHopCount = HasHopCount ();
+  message.hopCount = hopCount;
+  message.hasSequenceNumber = HasSequenceNumber ();
+  message.sequenceNumber = sequenceNumber;
+
+  message.tlvs.clear ();
+  PbbTlvIterator tlvIterator = tlvs;
+  PbbTlvView tlv;
+  while (tlvIterator.Next (tlv))
+    {
+      message.tlvs.push_back (PbbTlv ());
+      tlv.CopyTo (message.tlvs.back ());
+    }
+
+  message.addressBlocks.clear ();
+  PbbMessageView view = *this;
+  PbbAddressBlockView block;
+  while (view.NextAddressBlock (block))
+    {
+      message.addressBlocks.push_back (PbbAddressBlock ());
+      block.CopyTo (message.addressBlocks.back ());
+    }
+}
+
+PbbPacketReader::PbbPacketReader (Buffer::Iterator start, uint32_t size)
+  : m_valid (false),
+    m_flags (0),
+    m_sequenceNumber (0),
+    m_next (start),
+    m_left (size)
+{
+  if (m_left < 1)
+    {
+      return;
+    }
+  uint8_t versionAndFlags = m_next.ReadU8 ();
+  m_left--;
+  m_flags = versionAndFlags & 0x0f;
+  if ((versionAndFlags >> 4) != PBB_VERSION)
+    {
+      return;
+    }
+  if (m_flags & PBB_PKT_HAS_SEQ_NUM)
+    {
+      if (m_left < 2)
+        {
+          return;
+        }
+      m_sequenceNumber = m_next.ReadNtohU16 ();
+      m_left -= 2;
+    }
+  if (m_flags & PBB_PKT_HAS_TLV)
+    {
+      Buffer::Iterator tlvs = m_next;
+      if (!CheckTlvBlock (m_next, m_left, 0))
+        {
+          return;
+        }
+      uint16_t tlvsSize = tlvs.ReadNtohU16 ();
+      m_tlvs = PbbTlvIterator (tlvs, tlvsSize);
+    }
+  m_valid = true;
+}
+
+bool
+PbbPacketReader::IsValid (void) const
+{
+  return m_valid;
+}
+
+bool
+PbbPacketReader::HasSequenceNumber (void) const
+{
+  return m_flags & PBB_PKT_HAS_SEQ_NUM;
+}
+
+uint16_t
+PbbPacketReader::GetSequenceNumber (void) const
+{
+  return m_sequenceNumber;
+}
+
+PbbTlvIterator
+PbbPacketReader::GetTlvs (void) const
+{
+  return m_tlvs;
+}
+
+bool
+PbbPacketReader::NextMessage (PbbMessageView &message)
+{
+  if (!m_valid || m_left == 0)
+    {
+      return false;
+    }
+  m_valid = false;
+  if (m_left < PBB_MSG_HEADER_SIZE)
+    {
+      return false;
+    }
+
+  Buffer::Iterator i = m_next;
+  message.type = i.ReadU8 ();
+  uint8_t flags = i.ReadU8 ();
+  message.flags = flags & 0xf0;
+  message.addressLength = (flags & 0x0f) + 1;
+  message.size = i.ReadNtohU16 ();
+  if (message.size < PBB_MSG_HEADER_SIZE || message.size > m_left)
+    {
+      return false;
+    }
+  uint32_t left = message.size - PBB_MSG_HEADER_SIZE;
+
+  uint32_t needed = (message.HasOriginator () ? message.addressLength : 0)
+    + (message.HasHopLimit () ? 1 : 0)
+    + (message.HasHopCount () ? 1 : 0)
+    + (message.HasSequenceNumber () ? 2 : 0);
+  if (needed > left)
+    {
+      return false;
+    }
+  left -= needed;
+  message.originator = i;
+  if (message.HasOriginator ())
+    {
+      i.Next (message.addressLength);
+    }
+  message.hopLimit = message.HasHopLimit () ? i.ReadU8 () : 0;
+  message.hopCount = message.HasHopCount () ? i.ReadU8 () : 0;
+  message.sequenceNumber = message.HasSequenceNumber () ? i.ReadNtohU16 () : 0;
+
+  Buffer::Iterator tlvs = i;
+  if (!CheckTlvBlock (i, left, 0))
+    {
+      return false;
+    }
+  uint16_t tlvsSize = tlvs.ReadNtohU16 ();
+  message.tlvs = PbbTlvIterator (tlvs, tlvsSize);
+  message.m_nextBlock = i;
+  message.m_left = left;
+  while (left > 0)
+    {
+      if (!CheckAddressBlock (i, left, message.addressLength))
+        {
+          return false;
+        }
+    }
+
+  m_next = i;
+  m_left -= message.size;
+  m_valid = true;
+  return true;
+}
+
+
+// ---------------- OLSR6 generalized packet -------------------------------
+
+NS_OBJECT_ENSURE_REGISTERED (PbbPacket);
+
+PbbPacket::PbbPacket ()
+  : hasSequenceNumber (false),
+    sequenceNumber (0)
+{
+}
+
+PbbPacket::~PbbPacket ()
+{
+}
+
+TypeId
+PbbPacket::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::olsr6::PbbPacket")
+    .SetParent<Header> ()
+    .SetGroupName ("Olsr6")
+    .AddConstructor<PbbPacket> ()
+  ;
+  return tid;
+}
+TypeId
+PbbPacket::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+PbbPacket::GetSerializedSize (void) const
+{
+  uint32_t size = 1;
+  size += hasSequenceNumber ? 2 : 0;
+  size += tlvs.empty () ? 0 : GetTlvBlockSize (tlvs);
+  for (std::vector<PbbMessage>::const_iterator it = messages.begin (); it != messages.end (); it++)
+    {
+      size += it->GetSerializedSize ();
+    }
+  return size;
+}
+
+void
+PbbPacket::Print (std::ostream &os) const
+{
+  os << "version=" << PBB_VERSION << " tlvs=" << tlvs.size () << " messages=" << messages.size ();
+}
+
+void
+PbbPacket::Serialize (Buffer::Iterator start) const
+{
+  Buffer::Iterator i = start;
+  uint8_t flags = 0;
+  flags |= hasSequenceNumber ? PBB_PKT_HAS_SEQ_NUM : 0;
+  flags |= tlvs.empty () ? 0 : PBB_PKT_HAS_TLV;
+  i.WriteU8 ((PBB_VERSION << 4) | flags);
+  if (hasSequenceNumber)
+    {
+      i.WriteHtonU16 (sequenceNumber);
+    }
+  if (!tlvs.empty ())
+    {
+      WriteTlvBlock (i, tlvs);
+    }
+  for (std::vector<PbbMessage>::const_iterator it = messages.begin (); it != messages.end (); it++)
+    {
+      it->Serialize (i);
+    }
+}
+
+uint32_t
+PbbPacket::Deserialize (Buffer::Iterator start)
+{
+  uint32_t size = start.GetRemainingSize ();
+  PbbPacketReader reader (start, size);
+
+  hasSequenceNumber = reader.HasSequenceNumber ();
+  sequenceNumber = reader.GetSequenceNumber ();
+  tlvs.clear ();
+  PbbTlvIterator tlvIterator = reader.GetTlvs ();
+  PbbTlvView tlv;
+  while (tlvIterator.Next (tlv))
+    {
+      tlvs.push_back (PbbTlv ());
+      tlv.CopyTo (tlvs.back ());
+    }
+
+  messages.clear ();
+  PbbMessageView message;
+  while (reader.NextMessage (message))
+    {
+      if (message.addressLength != IPV6_ADDRESS_SIZE)
+        {
+          NS_LOG_DEBUG ("Message of type " << int (message.type) << " with "
+                        << int (message.addressLength) << " bytes addresses dropped");
+          continue;
+        }
+      messages.push_back (PbbMessage ());
+      message.CopyTo (messages.back ());
+    }
+
+  if (!reader.IsValid ())
+    {
+      NS_LOG_DEBUG ("Malformed packet");
+      tlvs.clear ();
+      messages.clear ();
+      return 0;
+    }
+  return size;
+}
+
+}  // namespace olsr6
+}  // namespace ns3
@@ -0,0 +1,405 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Ankit Deepak <adadeepak8@gmail.com>
+ *          Shravya Ks <shravya.ks0@gmail.com>,
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+#ifndef OLSR6_PACKETBB_H
+#define OLSR6_PACKETBB_H
+
+#include <stdint.h>
+#include <vector>
+#include "ns3/header.h"
+#include "ns3/buffer.h"
+#include "ns3/ipv6-address.h"
+
+
+namespace ns3 {
+namespace olsr6 {
+
+/**
+ * \ingroup olsr6
+ *
+ * A TLV of the generalized packet format (\RFC{5444}), attached to a
+ * packet, a message or the addresses of an address block.
+ *
+  \verbatim
+    <tlv> := <tlv-type> <tlv-flags> <tlv-type-ext>?
+             (<index-start> <index-stop>?)? (<length> <value>?)?
+  \endverbatim
+ *
+ * The indexes only apply to the TLVs of an address block: without index,
+ * the TLV applies to all the addresses of the block, with a start index
+ * only, to this address, and with both, to the addresses between them,
+ * included.
+ */
+struct PbbTlv
+{
+  PbbTlv ();
+
+  uint8_t type;               //!< The TLV type.
+  bool hasTypeExt;            //!< True if the type extension is present.
+  uint8_t typeExt;            //!< The type extension.
+  bool hasIndexStart;         //!< True if the start index is present.
+  uint8_t indexStart;         //!< Index of the first address the TLV applies to.
+  bool hasIndexStop;          //!< True if the stop index is present.
+  uint8_t indexStop;          //!< Index of the last address the TLV applies to.
+  bool multiValue;            //!< True if the value is split evenly between the addresses.
+  bool hasValue;              //!< True if the value is present, even empty.
+  std::vector<uint8_t> value; //!< The value.
+
+  /**
+   * \returns the number of bytes of the TLV.
+   */
+  uint32_t GetSerializedSize (void) const;
+  /**
+   * Write the TLV.
+   * \param i where the TLV should be written, moved after it.
+   */
+  void Serialize (Buffer::Iterator &i) const;
+};
+
+/**
+ * \ingroup olsr6
+ *
+ * An address block of a message of the generalized packet format
+ * (\RFC{5444}), with the TLVs of its addresses.  The addresses share a
+ * head and a tail, which are written once, and each address only takes
+ * its mid bytes.
+ *
+  \verbatim
+    <address-block> := <num-addr> <addr-flags>
+                       (<head-length> <head>?)?
+                       (<tail-length> <tail>?)?
+                       <mid>* <prefix-length>*
+  \endverbatim
+ */
+struct PbbAddressBlock
+{
+  std::vector<Ipv6Address> addresses;   //!< The addresses, 255 at most.
+  /// The prefix length of each address, or a single one for all, or none.
+  std::vector<uint8_t> prefixLengths;
+  std::vector<PbbTlv> tlvs;             //!< The TLVs of the addresses.
+
+  /**
+   * \returns the number of bytes of the address block and its TLV block.
+   */
+  uint32_t GetSerializedSize (void) const;
+  /**
+   * Write the address block and its TLV block.
+   * \param i where the block should be written, moved after it.
+   */
+  void Serialize (Buffer::Iterator &i) const;
+};
+
+/**
+ * \ingroup olsr6
+ *
+ * A message of the generalized packet format (\RFC{5444}), with IPv6
+ * addresses.
+ *
+  \verbatim
+    <message> := <msg-header> <tlv-block> (<addr-block> <tlv-block>)*
+    <msg-header> := <msg-type> <msg-flags> <msg-addr-length> <msg-size>
+                    <msg-orig-addr>? <msg-hop-limit>? <msg-hop-count>?
+                    <msg-seq-num>?
+  \endverbatim
+ */
+struct PbbMessage
+{
+  PbbMessage ();
+
+  uint8_t type;                 //!< The message type.
+  bool hasOriginator;           //!< True if the originator address is present.
+  Ipv6Address originator;       //!< The originator address.
+  bool hasHopLimit;             //!< True if the hop limit is present.
+  uint8_t hopLimit;             //!< The hop limit.
+  bool hasHopCount;             //!< True if the hop count is present.
+  uint8_t hopCount;             //!< The hop count.
+  bool hasSequenceNumber;       //!< True if the sequence number is present.
+  uint16_t sequenceNumber;      //!< The message sequence number.
+  std::vector<PbbTlv> tlvs;     //!< The message TLVs.
+  std::vector<PbbAddressBlock> addressBlocks; //!< The address blocks.
+
+  /**
+   * \returns the number of bytes of the message.
+   */
+  uint32_t GetSerializedSize (void) const;
+  /**
+   * Write the message.
+   * \param i where the message should be written, moved after it.
+   */
+  void Serialize (Buffer::Iterator &i) const;
+};
+
+/**
+ * \ingroup olsr6
+ *
+ * A TLV read in place: its value is left in the buffer.
+ */
+struct PbbTlvView
+{
+  uint8_t type;             //!< The TLV type.
+  uint8_t flags;            //!< The TLV flags.
+  uint8_t typeExt;          //!< The type extension, 0 if absent.
+  uint8_t indexStart;       //!< The start index, 0 if absent.
+  uint8_t indexStop;        //!< The stop index, the start index if absent.
+  uint16_t length;          //!< The length of the value, 0 if absent.
+  Buffer::Iterator value;   //!< The first byte of the value.
+
+  /**
+   * \returns true if the TLV has a value, even empty.
+   */
+  bool HasValue (void) const;
+  /**
+   * Copy the TLV, its value included.
+   * \param tlv the copy.
+   */
+  void CopyTo (PbbTlv &tlv) const;
+};
+
+/**
+ * \ingroup olsr6
+ *
+ * Iterator over the TLVs of a TLV block, read in place.
+ */
+class PbbTlvIterator
+{
+public:
+  PbbTlvIterator ();
+  /**
+   * \param start the first TLV of the block.
+   * \param size the number of bytes of the TLVs of the block.
+   */
+  PbbTlvIterator (Buffer::Iterator start, uint16_t size);
+
+  /**
+   * Read the next TLV.
+   * \param tlv the TLV.
+   * \returns false if the block has no more TLV.
+   */
+  bool Next (PbbTlvView &tlv);
+
+private:
+  Buffer::Iterator m_next;  //!< The next TLV.
+  uint16_t m_left;          //!< Number of bytes left in the block.
+};
+
+/**
+ * \ingroup olsr6
+ *
+ * An address block read in place: the addresses are only put together
+ * when they are asked for.
+ */
+struct PbbAddressBlockView
+{
+  uint8_t addressLength;        //!< The length of the addresses.
+  uint8_t numAddresses;         //!< The number of addresses.
+  uint8_t flags;                //!< The address block flags.
+  uint8_t headLength;           //!< The length of the head.
+  uint8_t tailLength;           //!< The length of the tail.
+  Buffer::Iterator head;        //!< The head.
+  Buffer::Iterator tail;        //!< The tail, if it is not a tail of zeros.
+  Buffer::Iterator mids;        //!< The mid bytes of the addresses.
+  Buffer::Iterator prefixLengths; //!< The prefix lengths.
+  PbbTlvIterator tlvs;          //!< The TLVs of the addresses.
+
+  /**
+   * \param index the index of the address.
+   * \returns the address; the addresses must be IPv6 ones.
+   */
+  Ipv6Address GetAddress (uint8_t index) const;
+  /**
+   * \returns the number of prefix lengths: none, one for all the
+   * addresses, or one for each.
+   */
+  uint8_t GetNPrefixLengths (void) const;
+  /**
+   * \param index the index of the address.
+   * \returns the prefix length of the address.
+   */
+  uint8_t GetPrefixLength (uint8_t index) const;
+  /**
+   * Copy the address block, its addresses and its TLVs included.
+   * \param block the copy.
+   */
+  void CopyTo (PbbAddressBlock &block) const;
+};
+
+/**
+ * \ingroup olsr6
+ *
+ * A message read in place.  The whole message was checked before it is
+ * returned, so its TLVs and address blocks can be read without checks.
+ */
+class PbbMessageView
+{
+public:
+  PbbMessageView ();
+
+  uint8_t type;               //!< The message type.
+  uint8_t flags;              //!< The message flags.
+  uint8_t addressLength;      //!< The length of the addresses.
+  uint16_t size;              //!< The message size.
+  Buffer::Iterator originator; //!< The originator address, if present.
+  uint8_t hopLimit;           //!< The hop limit, 0 if absent.
+  uint8_t hopCount;           //!< The hop count, 0 if absent.
+  uint16_t sequenceNumber;    //!< The sequence number, 0 if absent.
+  PbbTlvIterator tlvs;        //!< The message TLVs.
+
+  /**
+   * \returns true if the originator address is present.
+   */
+  bool HasOriginator (void) const;
+  /**
+   * \returns true if the hop limit is present.
+   */
+  bool HasHopLimit (void) const;
+  /**
+   * \returns true if the hop count is present.
+   */
+  bool HasHopCount (void) const;
+  /**
+   * \returns true if the sequence number is present.
+   */
+  bool HasSequenceNumber (void) const;
+  /**
+   * \returns the originator address; the addresses must be IPv6 ones.
+   */
+  Ipv6Address GetOriginator (void) const;
+
+  /**
+   * Read the next address block.
+   * \param block the address block.
+   * \returns false if the message has no more address block.
+   */
+  bool NextAddressBlock (PbbAddressBlockView &block);
+
+  /**
+   * Copy the message, its TLVs and its address blocks included.  The
+   * addresses must be IPv6 ones.
+   * \param message the copy.
+   */
+  void CopyTo (PbbMessage &message) const;
+
+private:
+  friend class PbbPacketReader;
+
+  Buffer::Iterator m_nextBlock;  //!< The next address block.
+  uint16_t m_left;               //!< Number of bytes left for the address blocks.
+};
+
+/**
+ * \ingroup olsr6
+ *
+ * Reader of a packet of the generalized packet format (\RFC{5444}) which
+ * leaves the data in the buffer.  The messages are checked one by one,
+ * without any copy, when they are read: a malformed message ends the
+ * reading and makes the packet invalid.
+ */
+class PbbPacketReader
+{
+public:
+  /**
+   * Read the packet header and check the packet TLV block.
+   * \param start the first byte of the packet.
+   * \param size the number of bytes of the packet.
+   */
+  PbbPacketReader (Buffer::Iterator start, uint32_t size);
+
+  /**
+   * \returns false if the packet is malformed, as far as it was read.
+   */
+  bool IsValid (void) const;
+  /**
+   * \returns true if the packet sequence number is present.
+   */
+  bool HasSequenceNumber (void) const;
+  /**
+   * \returns the packet sequence number, 0 if absent.
+   */
+  uint16_t GetSequenceNumber (void) const;
+  /**
+   * \returns the packet TLVs.
+   */
+  PbbTlvIterator GetTlvs (void) const;
+
+  /**
+   * Read and check the next message.
+   * \param message the message.
+   * \returns false if the packet has no more message, or if it is malformed.
+   */
+  bool NextMessage (PbbMessageView &message);
+
+private:
+  bool m_valid;                 //!< False if the packet is malformed.
+  uint8_t m_flags;              //!< The packet flags.
+  uint16_t m_sequenceNumber;    //!< The packet sequence number.
+  PbbTlvIterator m_tlvs;        //!< The packet TLVs.
+  Buffer::Iterator m_next;      //!< The next message.
+  uint32_t m_left;              //!< Number of bytes left for the messages.
+};
+
+/**
+ * \ingroup olsr6
+ *
+ * A packet of the generalized packet format (\RFC{5444}): an optional
+ * sequence number, the packet TLVs, and the messages.  The packet takes
+ * the whole payload it is read from.
+ *
+  \verbatim
+    <packet> := <pkt-header> <message>*
+    <pkt-header> := <version> <pkt-flags> <pkt-seq-num>? <tlv-block>?
+  \endverbatim
+ *
+ * This header copies the packet; PbbPacketReader reads it in place.
+ * The messages whose addresses are not IPv6 ones are dropped, and a
+ * malformed packet is not read at all.
+ */
+class PbbPacket : public Header
+{
+public:
+  PbbPacket ();
+  virtual ~PbbPacket ();
+
+  bool hasSequenceNumber;         //!< True if the sequence number is present.
+  uint16_t sequenceNumber;        //!< The packet sequence number.
+  std::vector<PbbTlv> tlvs;       //!< The packet TLVs.
+  std::vector<PbbMessage> messages; //!< The messages.
+
+  /**
+   * \brief Get the type ID.
+   * \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual void Print (std::ostream &os) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (Buffer::Iterator start) const;
+  /**
+   * \param start where the packet should be read from.
+   * \returns the number of bytes read, 0 if the packet is malformed.
+   */
+  virtual uint32_t Deserialize (Buffer::Iterator start);
+};
+
+}  // namespace olsr6
+}  // namespace ns3
+
+#endif /* OLSR6_PACKETBB_H */
@@ -33,12 +33,26 @@
 #ifndef OLSR6_REPOSITORIES_H
 #define OLSR6_REPOSITORIES_H
 
+#include <map>
 #include <set>
 #include <vector>
 
 #include "ns3/ipv6-address.h"
 #include "ns3/nstime.h"
 
+/********** Willingness **********/
+
+/// Willingness for forwarding packets from other nodes: never.
+#define OLSR6_WILL_NEVER         0
+/// Willingness for forwarding packets from other nodes: low.
+#define OLSR6_WILL_LOW           1
+/// Willingness for forwarding packets from other nodes: medium.
+#define OLSR6_WILL_DEFAULT       3
+/// Willingness for forwarding packets from other nodes: high.
+#define OLSR6_WILL_HIGH          6
+/// Willingness for forwarding packets from other nodes: always.
+#define OLSR6_WILL_ALWAYS        7
+
 namespace ns3 {
 namespace olsr6 {
 
@@ -75,6 +89,16 @@ operator << (std::ostream &os, const IfaceAssocTuple &tuple)
 /// A Link Tuple.
 struct LinkTuple
 {
+  LinkTuple ()
+    : quality (1.0),
+      pending (false),
+      helloHistory (0),
+      helloHistoryLength (0),
+      lq (0),
+      nlq (0)
+  {
+  }
+
   /// Interface address of the local node.
   Ipv6Address localIfaceAddr;
   /// Interface address of the neighbor node.
@@ -85,6 +109,30 @@ struct LinkTuple
   Time asymTime;
   /// Time at which this tuple expires and must be removed.
   Time time;
+
+  // Link hysteresis (\RFC{3626}, section 14)
+
+  /// Link quality, between 0 and 1.
+  double quality;
+  /// True if the link is not considered as a link yet.
+  bool pending;
+  /// The link is advertised as lost until this time.
+  Time lostTime;
+  /// HELLO emission interval advertised by the neighbor, zero until its first HELLO.
+  Time helloInterval;
+  /// The next HELLO is considered missed after this time.
+  Time helloDeadline;
+
+  // ETX link metric
+
+  /// Last HELLO messages received (bit set) or missed, the latest one in bit 0.
+  uint32_t helloHistory;
+  /// Number of HELLO messages recorded in helloHistory.
+  uint32_t helloHistoryLength;
+  /// Ratio of the HELLO messages of the neighbor received on the link.
+  double lq;
+  /// Ratio of the HELLO messages received by the neighbor, as it advertises it.
+  double nlq;
 };
 
 static inline bool
@@ -143,12 +191,19 @@ operator << (std::ostream &os, const NeighborTuple &tuple)
 /// A 2-hop Tuple.
 struct TwoHopNeighborTuple
 {
+  TwoHopNeighborTuple ()
+    : cost (1.0)
+  {
+  }
+
   /// Main address of a neighbor.
   Ipv6Address neighborMainAddr;
   /// Main address of a 2-hop neighbor with a symmetric link to nb_main_addr.
   Ipv6Address twoHopNeighborAddr;
   /// Time at which this tuple expires and must be removed.
   Time expirationTime; // previously called 'time_'
+  /// ETX of the link between the neighbor and the 2-hop neighbor.
+  double cost;
 };
 
 static inline std::ostream&
@@ -215,6 +270,11 @@ operator == (const DuplicateTuple &a, const DuplicateTuple &b)
 /// A Topology Tuple
 struct TopologyTuple
 {
+  TopologyTuple ()
+    : cost (1.0)
+  {
+  }
+
   /// Main address of the destination.
   Ipv6Address destAddr;
   /// Main address of a node which is a neighbor of the destination.
@@ -223,6 +283,8 @@ struct TopologyTuple
   uint16_t sequenceNumber;
   /// Time at which this tuple expires and must be removed.
   Time expirationTime;
+  /// ETX of the link between the two nodes.
+  double cost;
 };
 
 static inline bool
@@ -272,6 +334,12 @@ operator << (std::ostream &os, const Association &tuple)
 /// An Association Tuple
 struct AssociationTuple
 {
+  AssociationTuple ()
+    : capacity (0),
+      load (0)
+  {
+  }
+
   /// Main address of the gateway.
   Ipv6Address gatewayAddr;
   /// Network Address of network reachable through gatewayAddr
@@ -280,6 +348,10 @@ struct AssociationTuple
   Ipv6Prefix netmask;
   /// Time at which this tuple expires and must be removed
   Time expirationTime;
+  /// Uplink capacity advertised by the gateway in Mbit/s, 0 if not advertised.
+  uint16_t capacity;
+  /// Load of the uplink advertised by the gateway, from 0 to 255.
+  uint8_t load;
 };
 
 static inline bool
@@ -312,6 +384,9 @@ typedef std::vector<DuplicateTuple>             DuplicateSet; //!< Duplicate Set
 typedef std::vector<IfaceAssocTuple>            IfaceAssocSet; //!< Interface Association Set type.
 typedef std::vector<AssociationTuple>           AssociationSet; //!< Association Set type.
 typedef std::vector<Association>                Associations; //!< Association Set type.
+typedef std::map<Ipv6Address, MprSet>           InterfaceMprSets; //!< MPR Set of each local interface, by interface address.
+/// Symmetric neighbors of each local interface, by interface address, with the ETX of the link to them.
+typedef std::map<Ipv6Address, std::map<Ipv6Address, double> > InterfaceNeighborCosts;
 
 
 }
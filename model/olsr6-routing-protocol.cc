@@ -38,6 +38,7 @@
 
 
 #include "olsr6-routing-protocol.h"
+#include "olsr6-oracle.h"
 #include "ns3/socket-factory.h"
 #include "ns3/udp-socket-factory.h"
 #include "ns3/simulator.h"
@@ -49,9 +50,26 @@
 #include "ns3/ipv6-route.h"
 #include "ns3/boolean.h"
 #include "ns3/uinteger.h"
+#include "ns3/double.h"
 #include "ns3/enum.h"
 #include "ns3/trace-source-accessor.h"
 #include "ns3/ipv6-header.h"
+#include "ns3/string.h"
+#include "ns3/icmpv6-l4-protocol.h"
+#include "ns3/ndisc-cache.h"
+#include "ns3/hash.h"
+#include "ns3/tag.h"
+#include "ns3/pointer.h"
+#include "ns3/queue.h"
+
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <queue>
 
 /********** Useful macros **********/
 
@@ -66,12 +84,24 @@
 
 
 
+///
+/// \brief Interval until the next HELLO message, which adapts to the
+/// stability of the neighborhood in adaptive mode.
+///
+#define OLSR6_HELLO_INTERVAL     (m_adaptiveIntervals ? m_currentHelloInterval : m_helloInterval)
+
+///
+/// \brief Interval until the next TC message, which adapts to the
+/// stability of the MPR selectors in adaptive mode.
+///
+#define OLSR6_TC_INTERVAL        (m_adaptiveIntervals ? m_currentTcInterval : m_tcInterval)
+
 ///
 /// \brief Period at which a node must cite every link and every neighbor.
 ///
 /// We only use this value in order to define OLSR6_NEIGHB_HOLD_TIME.
 ///
-#define OLSR6_REFRESH_INTERVAL   m_helloInterval
+#define OLSR6_REFRESH_INTERVAL   OLSR6_HELLO_INTERVAL
 
 
 /********** Holding times **********/
@@ -79,13 +109,15 @@
 /// Neighbor holding time.
 #define OLSR6_NEIGHB_HOLD_TIME   Time (3 * OLSR6_REFRESH_INTERVAL)
 /// Top holding time.
-#define OLSR6_TOP_HOLD_TIME      Time (3 * m_tcInterval)
+#define OLSR6_TOP_HOLD_TIME      Time (3 * OLSR6_TC_INTERVAL)
 /// Dup holding time.
 #define OLSR6_DUP_HOLD_TIME      Seconds (30)
 /// MID holding time.
 #define OLSR6_MID_HOLD_TIME      Time (3 * m_midInterval)
 /// HNA holding time.
 #define OLSR6_HNA_HOLD_TIME      Time (3 * m_hnaInterval)
+/// Holding time of the multicast data packet identifiers.
+#define OLSR6_SMF_DPD_HOLD_TIME  Seconds (5)
 
 /********** Link types **********/
 
@@ -108,24 +140,57 @@
 #define OLSR6_MPR_NEIGH          2
 
 
-/********** Willingness **********/
+/********** Load signals of the willingness controller **********/
+
+/// Static willingness: the Willingness attribute is advertised.
+#define OLSR6_LOAD_NONE          0
+/// Packets forwarded per second, over ForwardingCapacity.
+#define OLSR6_LOAD_FORWARDING    1
+/// Occupancy of the transmission queues of the OLSR6 interfaces.
+#define OLSR6_LOAD_QUEUE         2
+/// Load returned by the callback set with SetWillingnessLoadCallback.
+#define OLSR6_LOAD_CALLBACK      3
+
 
-/// Willingness for forwarding packets from other nodes: never.
-#define OLSR6_WILL_NEVER         0
-/// Willingness for forwarding packets from other nodes: low.
-#define OLSR6_WILL_LOW           1
-/// Willingness for forwarding packets from other nodes: medium.
-#define OLSR6_WILL_DEFAULT       3
-/// Willingness for forwarding packets from other nodes: high.
-#define OLSR6_WILL_HIGH          6
-/// Willingness for forwarding packets from other nodes: always.
-#define OLSR6_WILL_ALWAYS        7
+/********** Link metrics **********/
+
+/// Routes of the fewest hops.
+#define OLSR6_METRIC_HOP_COUNT   0
+/// Routes of the lowest Expected Transmission Count.
+#define OLSR6_METRIC_ETX         1
+/// Floor of the link qualities, so that the ETX of a link remains finite.
+#define OLSR6_MIN_LINK_QUALITY   (1.0 / 255)
+/// Expected Transmission Count of a link of the given LQ and NLQ.
+#define OLSR6_ETX(lq, nlq)       (1.0 / (std::max ((lq), OLSR6_MIN_LINK_QUALITY) \
+                                         * std::max ((nlq), OLSR6_MIN_LINK_QUALITY)))
+/// Link quality as carried by the link quality extension of the HELLO and TC messages.
+#define OLSR6_QUANTIZE_LQ(q)     (uint8_t (std::floor ((q) * 255 + 0.5)))
+
+
+/********** Multicast relay algorithms (RFC 6621) **********/
+
+/// Multicast data packets are not relayed.
+#define OLSR6_SMF_NONE           0
+/// Classical flooding: every multicast data packet is relayed once.
+#define OLSR6_SMF_CF             1
+/// Source-specific MPR: packets are relayed for the MPR selectors only.
+#define OLSR6_SMF_S_MPR          2
+
+
+/********** HNA gateway selection policies **********/
+
+/// The nearest gateway of each HNA network.
+#define OLSR6_GW_NEAREST         0
+/// Flows spread over the gateways by their advertised capacity left.
+#define OLSR6_GW_WEIGHTED        1
+/// Flows spread evenly over the gateways.
+#define OLSR6_GW_HASH            2
 
 
 /********** Miscellaneous constants **********/
 
 /// Maximum allowed jitter.
-#define OLSR6_MAXJITTER          (m_helloInterval.GetSeconds () / 4)
+#define OLSR6_MAXJITTER          (OLSR6_HELLO_INTERVAL.GetSeconds () / 4)
 /// Maximum allowed sequence number.
 #define OLSR6_MAX_SEQ_NUM        65535
 /// Random number between [0-OLSR6_MAXJITTER] used to jitter OLSR6 packet transmission.
@@ -143,6 +208,11 @@
 /// Maximum number of addresses advertised on a message.
 #define OLSR6_MAX_ADDRS          64
 
+/// Magic number at the beginning of a state snapshot ("OLS6").
+#define OLSR6_SNAPSHOT_MAGIC     0x4f4c5336
+/// Version of the state snapshot format.
+#define OLSR6_SNAPSHOT_VERSION   2
+
 
 namespace ns3 {
 
@@ -150,6 +220,322 @@ NS_LOG_COMPONENT_DEFINE ("Olsr6RoutingProtocol");
 
 namespace olsr6 {
 
+namespace {
+/// A path of the ETX routing table computation.
+struct EtxPath
+{
+  double cost;              //!< ETX of the path.
+  uint32_t hops;            //!< Number of hops of the path.
+  Ipv6Address dest;         //!< Main address of the destination.
+  const LinkTuple *link;    //!< Link of the first hop.
+
+  /**
+   * \param other Another path.
+   * \returns true if this path is worse than the other one, so that the
+   * top of a std::priority_queue is the best path.
+   */
+  bool operator < (const EtxPath &other) const
+  {
+    if (cost != other.cost)
+      {
+        return cost > other.cost;
+      }
+    if (hops != other.hops)
+      {
+        return hops > other.hops;
+      }
+    return other.dest < dest;
+  }
+};
+
+/// Links of the local view of the topology, from each node to its neighbors with their cost.
+typedef std::map<Ipv6Address, std::vector<std::pair<Ipv6Address, double> > > LinkGraph;
+
+/**
+ * \brief Adds a symmetric link to a graph.
+ * \param graph The graph.
+ * \param a One end of the link.
+ * \param b The other end of the link.
+ * \param cost The cost of the link.
+ */
+void
+AddGraphLink (LinkGraph &graph, const Ipv6Address &a, const Ipv6Address &b, double cost)
+{
+  graph[a].push_back (std::make_pair (b, cost));
+  graph[b].push_back (std::make_pair (a, cost));
+}
+
+/**
+ * \brief Computes the distances from a node with Dijkstra's algorithm.
+ * \param graph The graph.
+ * \param source The node the distances are computed from.
+ * \returns The distance to each node reachable from the source.
+ */
+std::map<Ipv6Address, double>
+ShortestDistances (const LinkGraph &graph, const Ipv6Address &source)
+{
+  std::map<Ipv6Address, double> distances;
+  std::priority_queue<std::pair<double, Ipv6Address>,
+                      std::vector<std::pair<double, Ipv6Address> >,
+                      std::greater<std::pair<double, Ipv6Address> > > heap;
+  heap.push (std::make_pair (0.0, source));
+  while (!heap.empty ())
+    {
+      std::pair<double, Ipv6Address> node = heap.top ();
+      heap.pop ();
+      if (!distances.insert (std::make_pair (node.second, node.first)).second)
+        {
+          continue;
+        }
+      LinkGraph::const_iterator links = graph.find (node.second);
+      if (links == graph.end ())
+        {
+          continue;
+        }
+      for (std::vector<std::pair<Ipv6Address, double> >::const_iterator it = links->second.begin ();
+           it != links->second.end (); it++)
+        {
+          if (distances.find (it->first) == distances.end ())
+            {
+              heap.push (std::make_pair (node.first + it->second, it->first));
+            }
+        }
+    }
+  return distances;
+}
+
+/**
+ * \param header The IPv6 header of a packet.
+ * \param salt An address salting the hash, so that the nodes using a
+ * different one make different choices.
+ * \returns A hash of the flow of the packet: its source and destination
+ * addresses and its flow label.
+ */
+uint32_t
+FlowHash (const Ipv6Header &header, const Ipv6Address &salt)
+{
+  uint8_t buffer[52];
+  header.GetSourceAddress ().Serialize (buffer);
+  header.GetDestinationAddress ().Serialize (buffer + 16);
+  salt.Serialize (buffer + 32);
+  uint32_t flowLabel = header.GetFlowLabel ();
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      buffer[48 + i] = (flowLabel >> (8 * i)) & 0xff;
+    }
+  return Hash32 (reinterpret_cast<const char *> (buffer), sizeof (buffer));
+}
+
+/**
+ * \brief Removes a network from a list of networks, the ones covering it
+ * being split into the networks of the rest of their addresses.
+ *
+ * \param[in,out] networks The networks.
+ * \param removed The network removed.
+ */
+void
+RemoveNetwork (Associations &networks, const Association &removed)
+{
+  uint8_t removedLength = removed.netmask.GetPrefixLength ();
+  Associations remaining;
+  for (Associations::const_iterator it = networks.begin (); it != networks.end (); it++)
+    {
+      uint8_t length = it->netmask.GetPrefixLength ();
+      if (length >= removedLength && removed.netmask.IsMatch (removed.networkAddr, it->networkAddr))
+        {
+          continue;
+        }
+      if (length >= removedLength || !it->netmask.IsMatch (it->networkAddr, removed.networkAddr))
+        {
+          remaining.push_back (*it);
+          continue;
+        }
+
+      // The rest is made of the siblings of the removed network and of its
+      // ancestors, up to the network split
+      for (uint32_t siblingLength = removedLength; siblingLength > length; siblingLength--)
+        {
+          uint8_t bytes[16];
+          removed.networkAddr.GetBytes (bytes);
+          bytes[(siblingLength - 1) / 8] ^= 0x80 >> ((siblingLength - 1) % 8);
+          Ipv6Address sibling (bytes);
+          Ipv6Prefix siblingPrefix (siblingLength);
+          remaining.push_back ((Association) { sibling.CombinePrefix (siblingPrefix), siblingPrefix });
+        }
+    }
+  networks.swap (remaining);
+}
+} // anonymous namespace
+
+/**
+ * \ingroup olsr6
+ * \brief Previous hop of a relayed multicast data packet.
+ *
+ * RouteInput is not given the link-layer source of the packets, which
+ * \RFC{6621} uses to identify the previous hop; the relays record their
+ * main address in this tag instead.  The packets without one come
+ * straight from their source.
+ */
+class SmfPreviousHopTag : public Tag
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer i) const;
+  virtual void Deserialize (TagBuffer i);
+  virtual void Print (std::ostream &os) const;
+
+  /// \returns The main address of the previous hop.
+  Ipv6Address GetPreviousHop (void) const
+  {
+    return m_previousHop;
+  }
+  /// \param previousHop The main address of the previous hop.
+  void SetPreviousHop (Ipv6Address previousHop)
+  {
+    m_previousHop = previousHop;
+  }
+
+private:
+  Ipv6Address m_previousHop;  //!< Main address of the previous hop.
+};
+
+NS_OBJECT_ENSURE_REGISTERED (SmfPreviousHopTag);
+
+TypeId
+SmfPreviousHopTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::olsr6::SmfPreviousHopTag")
+    .SetParent<Tag> ()
+    .SetGroupName ("Olsr6")
+    .AddConstructor<SmfPreviousHopTag> ()
+  ;
+  return tid;
+}
+
+TypeId
+SmfPreviousHopTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+SmfPreviousHopTag::GetSerializedSize (void) const
+{
+  return 16;
+}
+
+void
+SmfPreviousHopTag::Serialize (TagBuffer i) const
+{
+  uint8_t buf[16];
+  m_previousHop.Serialize (buf);
+  i.Write (buf, 16);
+}
+
+void
+SmfPreviousHopTag::Deserialize (TagBuffer i)
+{
+  uint8_t buf[16];
+  i.Read (buf, 16);
+  m_previousHop = Ipv6Address::Deserialize (buf);
+}
+
+void
+SmfPreviousHopTag::Print (std::ostream &os) const
+{
+  os << "previousHop=" << m_previousHop;
+}
+
+/**
+ * \ingroup olsr6
+ * \brief Gateway selected for a packet to a HNA network.
+ *
+ * Stands for the tunnel to the gateway that the selection would use in a
+ * real network: the next hops keep the gateway of the first one instead
+ * of selecting their own, which could send the packet back.
+ */
+class HnaGatewayTag : public Tag
+{
+public:
+  /**
+   * \brief Get the type ID.
+   * \return The object TypeId.
+   */
+  static TypeId GetTypeId (void);
+  virtual TypeId GetInstanceTypeId (void) const;
+  virtual uint32_t GetSerializedSize (void) const;
+  virtual void Serialize (TagBuffer i) const;
+  virtual void Deserialize (TagBuffer i);
+  virtual void Print (std::ostream &os) const;
+
+  /// \returns The main address of the gateway.
+  Ipv6Address GetGateway (void) const
+  {
+    return m_gateway;
+  }
+  /// \param gateway The main address of the gateway.
+  void SetGateway (Ipv6Address gateway)
+  {
+    m_gateway = gateway;
+  }
+
+private:
+  Ipv6Address m_gateway;  //!< Main address of the gateway.
+};
+
+NS_OBJECT_ENSURE_REGISTERED (HnaGatewayTag);
+
+TypeId
+HnaGatewayTag::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::olsr6::HnaGatewayTag")
+    .SetParent<Tag> ()
+    .SetGroupName ("Olsr6")
+    .AddConstructor<HnaGatewayTag> ()
+  ;
+  return tid;
+}
+
+TypeId
+HnaGatewayTag::GetInstanceTypeId (void) const
+{
+  return GetTypeId ();
+}
+
+uint32_t
+HnaGatewayTag::GetSerializedSize (void) const
+{
+  return 16;
+}
+
+void
+HnaGatewayTag::Serialize (TagBuffer i) const
+{
+  uint8_t buf[16];
+  m_gateway.Serialize (buf);
+  i.Write (buf, 16);
+}
+
+void
+HnaGatewayTag::Deserialize (TagBuffer i)
+{
+  uint8_t buf[16];
+  i.Read (buf, 16);
+  m_gateway = Ipv6Address::Deserialize (buf);
+}
+
+void
+HnaGatewayTag::Print (std::ostream &os) const
+{
+  os << "gateway=" << m_gateway;
+}
+
 /********** OLSR6 class **********/
 
 NS_OBJECT_ENSURE_REGISTERED (RoutingProtocol);
@@ -169,6 +555,118 @@ RoutingProtocol::GetTypeId (void)
                    TimeValue (Seconds (5)),
                    MakeTimeAccessor (&RoutingProtocol::m_tcInterval),
                    MakeTimeChecker ())
+    .AddAttribute ("AdaptiveIntervals", "Shorten the HELLO and TC intervals down to MinHelloInterval and "
+                   "MinTcInterval after a change of the Link Set or MPR Selector Set, and double them up to "
+                   "MaxHelloInterval and MaxTcInterval while the neighborhood is stable.  "
+                   "HelloInterval and TcInterval are then ignored.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&RoutingProtocol::m_adaptiveIntervals),
+                   MakeBooleanChecker ())
+    .AddAttribute ("MinHelloInterval", "Shortest HELLO messages emission interval in adaptive mode.",
+                   TimeValue (Seconds (0.5)),
+                   MakeTimeAccessor (&RoutingProtocol::m_minHelloInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("MaxHelloInterval", "Longest HELLO messages emission interval in adaptive mode.",
+                   TimeValue (Seconds (8)),
+                   MakeTimeAccessor (&RoutingProtocol::m_maxHelloInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("MinTcInterval", "Shortest TC messages emission interval in adaptive mode.",
+                   TimeValue (Seconds (1)),
+                   MakeTimeAccessor (&RoutingProtocol::m_minTcInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("MaxTcInterval", "Longest TC messages emission interval in adaptive mode.",
+                   TimeValue (Seconds (20)),
+                   MakeTimeAccessor (&RoutingProtocol::m_maxTcInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("TriggeredTc", "Send a TC as soon as the MPR Selector Set changes, "
+                   "besides the periodic ones.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&RoutingProtocol::m_triggeredTc),
+                   MakeBooleanChecker ())
+    .AddAttribute ("TriggeredTcMinSpacing", "Shortest delay between a TC and a triggered one.  "
+                   "Changes within this delay are coalesced into a single triggered TC.",
+                   TimeValue (Seconds (1)),
+                   MakeTimeAccessor (&RoutingProtocol::m_triggeredTcMinSpacing),
+                   MakeTimeChecker ())
+    .AddAttribute ("TriggeredTcHoldDown", "Window in which at most TriggeredTcMaxBurst TCs are triggered; "
+                   "further changes wait for the periodic TC.",
+                   TimeValue (Seconds (10)),
+                   MakeTimeAccessor (&RoutingProtocol::m_triggeredTcHoldDown),
+                   MakeTimeChecker ())
+    .AddAttribute ("TriggeredTcMaxBurst", "Number of triggered TCs after which triggers are held down "
+                   "until the end of the TriggeredTcHoldDown window.",
+                   UintegerValue (3),
+                   MakeUintegerAccessor (&RoutingProtocol::m_triggeredTcMaxBurst),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("LinkHysteresis", "Track the quality of the links and only establish or lose a link "
+                   "when it crosses HystThresholdHigh or HystThresholdLow (RFC 3626, section 14).",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&RoutingProtocol::m_linkHysteresis),
+                   MakeBooleanChecker ())
+    .AddAttribute ("HystScaling", "Weight of the last received or missed HELLO in the link quality.",
+                   DoubleValue (0.5),
+                   MakeDoubleAccessor (&RoutingProtocol::m_hystScaling),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("HystThresholdHigh", "Link quality above which a pending link is established.",
+                   DoubleValue (0.8),
+                   MakeDoubleAccessor (&RoutingProtocol::m_hystThresholdHigh),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("HystThresholdLow", "Link quality below which a link is lost and becomes pending.",
+                   DoubleValue (0.3),
+                   MakeDoubleAccessor (&RoutingProtocol::m_hystThresholdLow),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+    .AddAttribute ("LinkMetric", "Metric of the routes: the number of hops, or the Expected Transmission "
+                   "Count of the links, measured from the HELLO messages and advertised in the HELLO and "
+                   "TC messages.",
+                   EnumValue (OLSR6_METRIC_HOP_COUNT),
+                   MakeEnumAccessor (&RoutingProtocol::m_linkMetric),
+                   MakeEnumChecker (OLSR6_METRIC_HOP_COUNT, "hop-count",
+                                    OLSR6_METRIC_ETX, "etx"))
+    .AddAttribute ("EtxWindow", "Number of HELLO intervals over which the ratio of the HELLO messages "
+                   "received on a link is measured, with the ETX metric.",
+                   UintegerValue (16),
+                   MakeUintegerAccessor (&RoutingProtocol::m_etxWindow),
+                   MakeUintegerChecker<uint32_t> (1, 32))
+    .AddAttribute ("MaxEqualCostPaths", "Maximum number of equal-cost routes kept per destination, "
+                   "the flows being spread over them by a hash of their addresses and flow label.  "
+                   "1 keeps a single route; only the hop count metric supports more.",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&RoutingProtocol::m_maxEqualCostPaths),
+                   MakeUintegerChecker<uint32_t> (1, 16))
+    .AddAttribute ("LoopFreeAlternates", "Compute a loop-free alternate next hop (RFC 5286) for each route, "
+                   "used as soon as the link to the primary next hop is lost.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&RoutingProtocol::m_loopFreeAlternates),
+                   MakeBooleanChecker ())
+    .AddAttribute ("MulticastRelay", "Relay algorithm of the multicast data packets of a scope larger "
+                   "than link-local (RFC 6621): none, classical flooding, or relaying for the MPR "
+                   "selectors only.",
+                   EnumValue (OLSR6_SMF_NONE),
+                   MakeEnumAccessor (&RoutingProtocol::m_multicastRelay),
+                   MakeEnumChecker (OLSR6_SMF_NONE, "none",
+                                    OLSR6_SMF_CF, "cf",
+                                    OLSR6_SMF_S_MPR, "s-mpr"))
+    .AddAttribute ("TcRedundancy", "Neighbors advertised in TC messages (RFC 3626, section 15.1): "
+                   "0 for the MPR selectors, 1 for the MPR selectors and the MPRs, "
+                   "2 for all the symmetric neighbors.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&RoutingProtocol::m_tcRedundancy),
+                   MakeUintegerChecker<uint32_t> (0, 2))
+    .AddAttribute ("FisheyeTtl", "Space-separated TTL sequence cycled through by the TC messages, "
+                   "e.g. \"2 4 2 8 2 255\".  Empty means every TC floods the network.",
+                   StringValue (""),
+                   MakeStringAccessor (&RoutingProtocol::m_fisheyeTtlString),
+                   MakeStringChecker ())
+    .AddAttribute ("DifferentialTc", "Between two full TCs, send differential TCs carrying the changes "
+                   "of the MPR Selector Set only, and process the received ones.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&RoutingProtocol::m_differentialTc),
+                   MakeBooleanChecker ())
+    .AddAttribute ("FullTcRefresh", "In differential mode, one TC in FullTcRefresh advertises the whole "
+                   "MPR Selector Set.",
+                   UintegerValue (4),
+                   MakeUintegerAccessor (&RoutingProtocol::m_fullTcRefresh),
+                   MakeUintegerChecker<uint32_t> (1))
     .AddAttribute ("MidInterval", "MID messages emission interval.  Normally it is equal to TcInterval.",
                    TimeValue (Seconds (5)),
                    MakeTimeAccessor (&RoutingProtocol::m_midInterval),
@@ -177,6 +675,37 @@ RoutingProtocol::GetTypeId (void)
                    TimeValue (Seconds (5)),
                    MakeTimeAccessor (&RoutingProtocol::m_hnaInterval),
                    MakeTimeChecker ())
+    .AddAttribute ("HnaAggregation", "Advertise the local HNA networks aggregated into the fewest prefixes, "
+                   "and install the received ones so that the aggregation does not change the routes: "
+                   "the aggregates skip the networks of the node, and the networks they cover can be "
+                   "reached through their gateways too.",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&RoutingProtocol::m_hnaAggregation),
+                   MakeBooleanChecker ())
+    .AddAttribute ("HnaGatewaySelection", "Gateway of the flows to a HNA network announced by several "
+                   "gateways: the nearest one, or a hash of the flow over the gateways at most "
+                   "HnaDistanceSlack hops farther, weighted by the uplink capacity left that they "
+                   "advertise or evenly.",
+                   EnumValue (OLSR6_GW_NEAREST),
+                   MakeEnumAccessor (&RoutingProtocol::m_hnaGatewaySelection),
+                   MakeEnumChecker (OLSR6_GW_NEAREST, "nearest",
+                                    OLSR6_GW_WEIGHTED, "weighted",
+                                    OLSR6_GW_HASH, "hash"))
+    .AddAttribute ("HnaDistanceSlack", "Number of hops beyond the nearest gateway within which the gateways "
+                   "share the flows, with the weighted and hash selections.",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&RoutingProtocol::m_hnaDistanceSlack),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("GatewayCapacity", "Uplink capacity in Mbit/s advertised with the HNA networks of this "
+                   "node, for the weighted gateway selection.  0 sends plain HNA messages.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&RoutingProtocol::m_gatewayCapacity),
+                   MakeUintegerChecker<uint16_t> ())
+    .AddAttribute ("GatewayLoad", "Uplink load advertised with the capacity, from 0 (idle) to 255 "
+                   "(saturated).  It can be updated during the simulation by a monitor of the uplink.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&RoutingProtocol::m_gatewayLoad),
+                   MakeUintegerChecker<uint8_t> ())
     .AddAttribute ("Willingness", "Willingness of a node to carry and forward traffic for other nodes.",
                    EnumValue (OLSR6_WILL_DEFAULT),
                    MakeEnumAccessor (&RoutingProtocol::m_willingness),
@@ -185,15 +714,105 @@ RoutingProtocol::GetTypeId (void)
                                     OLSR6_WILL_DEFAULT, "default",
                                     OLSR6_WILL_HIGH, "high",
                                     OLSR6_WILL_ALWAYS, "always"))
+    .AddAttribute ("WillingnessLoadSignal", "Load signal from which the advertised willingness is derived: "
+                   "none keeps the Willingness attribute, forwarding uses the packets forwarded per second, "
+                   "queue the occupancy of the transmission queues of the devices which have a TxQueue, "
+                   "and callback the signal set with SetWillingnessLoadCallback.  The Willingness "
+                   "attribute is then the highest willingness advertised.",
+                   EnumValue (OLSR6_LOAD_NONE),
+                   MakeEnumAccessor (&RoutingProtocol::m_willingnessLoadSignal),
+                   MakeEnumChecker (OLSR6_LOAD_NONE, "none",
+                                    OLSR6_LOAD_FORWARDING, "forwarding",
+                                    OLSR6_LOAD_QUEUE, "queue",
+                                    OLSR6_LOAD_CALLBACK, "callback"))
+    .AddAttribute ("WillingnessUpdateInterval", "Interval between two samples of the load signal.",
+                   TimeValue (Seconds (1)),
+                   MakeTimeAccessor (&RoutingProtocol::m_willingnessUpdateInterval),
+                   MakeTimeChecker ())
+    .AddAttribute ("WillingnessHoldTime", "Time the load stays below WillingnessLoadLow before the "
+                   "willingness is raised by one level.",
+                   TimeValue (Seconds (10)),
+                   MakeTimeAccessor (&RoutingProtocol::m_willingnessHoldTime),
+                   MakeTimeChecker ())
+    .AddAttribute ("WillingnessLoadHigh", "Load above which the willingness is lowered by one level "
+                   "at each sample.",
+                   DoubleValue (0.7),
+                   MakeDoubleAccessor (&RoutingProtocol::m_willingnessLoadHigh),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("WillingnessLoadLow", "Load below which the willingness is raised again.",
+                   DoubleValue (0.3),
+                   MakeDoubleAccessor (&RoutingProtocol::m_willingnessLoadLow),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("ForwardingCapacity", "Packets forwarded per second taken as the full load, "
+                   "with the forwarding load signal.",
+                   UintegerValue (100),
+                   MakeUintegerAccessor (&RoutingProtocol::m_forwardingCapacity),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddAttribute ("CompressedMessages", "Send the HELLO, TC and MID messages with compressed addresses "
+                   "on the interfaces where every neighbor accepts them.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&RoutingProtocol::m_compressedMessages),
+                   MakeBooleanChecker ())
+    .AddAttribute ("UnicastRelay", "Send the packets without HELLO message, such as the TC, MID and HNA "
+                   "messages relayed, as unicast on the interfaces with a single symmetric neighbor, and "
+                   "not at all on the interfaces without symmetric neighbor.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&RoutingProtocol::m_unicastRelay),
+                   MakeBooleanChecker ())
+    .AddAttribute ("AuthenticationKey", "Key of the HMAC-SHA-256 signature appended to every packet sent; "
+                   "the packets received must carry a valid signature with this key or one added by "
+                   "AddAuthenticationKey, and a packet sequence number not received yet.  "
+                   "Empty means the packets are neither signed nor checked.",
+                   StringValue (""),
+                   MakeStringAccessor (&RoutingProtocol::m_authenticationKey),
+                   MakeStringChecker ())
+    .AddAttribute ("AuthenticationKeyId", "Key ID of AuthenticationKey, carried by the signatures.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&RoutingProtocol::m_authenticationKeyId),
+                   MakeUintegerChecker<uint8_t> ())
+    .AddAttribute ("SnapshotFile", "State snapshot (written by SaveSnapshot) restored when the protocol starts. "
+                   "Empty means start from an empty state.",
+                   StringValue (""),
+                   MakeStringAccessor (&RoutingProtocol::m_snapshotFile),
+                   MakeStringChecker ())
+    .AddAttribute ("OracleMode", "Exchange no control traffic and let a process-wide topology model "
+                   "install the routes of every node (see OracleTopology).",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&RoutingProtocol::m_oracleMode),
+                   MakeBooleanChecker ())
+    .AddAttribute ("MemoryUsageInterval", "Interval between two samples of the MemoryUsage trace source. "
+                   "Zero disables the sampling.",
+                   TimeValue (Seconds (0)),
+                   MakeTimeAccessor (&RoutingProtocol::m_memoryUsageInterval),
+                   MakeTimeChecker ())
     .AddTraceSource ("Rx", "Receive OLSR6 packet.",
                      MakeTraceSourceAccessor (&RoutingProtocol::m_rxPacketTrace),
                      "ns3::olsr6::RoutingProtocol::PacketTxRxTracedCallback")
+    .AddTraceSource ("RxPacket", "Receive OLSR6 packet, with the addresses of the sending and receiving interfaces.",
+                     MakeTraceSourceAccessor (&RoutingProtocol::m_rxRawPacketTrace),
+                     "ns3::olsr6::RoutingProtocol::RawPacketRxTracedCallback")
     .AddTraceSource ("Tx", "Send OLSR6 packet.",
                      MakeTraceSourceAccessor (&RoutingProtocol::m_txPacketTrace),
                      "ns3::olsr6::RoutingProtocol::PacketTxRxTracedCallback")
     .AddTraceSource ("RoutingTableChanged", "The OLSR6 routing table has changed.",
                      MakeTraceSourceAccessor (&RoutingProtocol::m_routingTableChanged),
                      "ns3::olsr6::RoutingProtocol::TableChangeTracedCallback")
+    .AddTraceSource ("MemoryUsage", "Periodic sample of the memory used by the OLSR6 repositories.",
+                     MakeTraceSourceAccessor (&RoutingProtocol::m_memoryUsageTrace),
+                     "ns3::olsr6::RoutingProtocol::MemoryUsageTracedCallback")
+    .AddTraceSource ("TcTrigger", "A TC was triggered or a trigger was suppressed.",
+                     MakeTraceSourceAccessor (&RoutingProtocol::m_tcTriggerTrace),
+                     "ns3::olsr6::RoutingProtocol::TcTriggerTracedCallback")
+    .AddTraceSource ("MulticastRelay", "A multicast data packet is relayed.",
+                     MakeTraceSourceAccessor (&RoutingProtocol::m_multicastRelayTrace),
+                     "ns3::olsr6::RoutingProtocol::MulticastRelayTracedCallback")
+    .AddTraceSource ("WillingnessChanged", "The willingness controller changed the advertised willingness.",
+                     MakeTraceSourceAccessor (&RoutingProtocol::m_willingnessTrace),
+                     "ns3::olsr6::RoutingProtocol::WillingnessTracedCallback")
+    .AddTraceSource ("AuthenticationFailure", "A packet was dropped for a missing or wrong signature, "
+                     "or as a replay.",
+                     MakeTraceSourceAccessor (&RoutingProtocol::m_authenticationFailureTrace),
+                     "ns3::olsr6::RoutingProtocol::AuthenticationFailureTracedCallback")
   ;
   return tid;
 }
@@ -201,11 +820,22 @@ RoutingProtocol::GetTypeId (void)
 
 RoutingProtocol::RoutingProtocol ()
   : m_routingTableAssociation (0),
+    m_advertisedWillingness (OLSR6_WILL_DEFAULT),
+    m_forwardedPackets (0),
+    m_willingnessTimer (Timer::CANCEL_ON_DESTROY),
     m_ipv6 (0),
     m_helloTimer (Timer::CANCEL_ON_DESTROY),
     m_tcTimer (Timer::CANCEL_ON_DESTROY),
     m_midTimer (Timer::CANCEL_ON_DESTROY),
     m_hnaTimer (Timer::CANCEL_ON_DESTROY),
+    m_triggeredTcBurst (0),
+    m_triggeredTcCount (0),
+    m_suppressedTcCount (0),
+    m_triggeredTcTimer (Timer::CANCEL_ON_DESTROY),
+    m_fisheyeIndex (0),
+    m_tcsSinceFullTc (0),
+    m_fullTcAnsn (0),
+    m_memoryUsageTimer (Timer::CANCEL_ON_DESTROY),
     m_queuedMessagesTimer (Timer::CANCEL_ON_DESTROY)
 {
   m_uniformRandomVariable = CreateObject<UniformRandomVariable> ();
@@ -227,6 +857,9 @@ RoutingProtocol::SetIpv6 (Ptr<Ipv6> ipv6)
   m_tcTimer.SetFunction (&RoutingProtocol::TcTimerExpire, this);
   m_midTimer.SetFunction (&RoutingProtocol::MidTimerExpire, this);
   m_hnaTimer.SetFunction (&RoutingProtocol::HnaTimerExpire, this);
+  m_memoryUsageTimer.SetFunction (&RoutingProtocol::MemoryUsageTimerExpire, this);
+  m_willingnessTimer.SetFunction (&RoutingProtocol::WillingnessTimerExpire, this);
+  m_triggeredTcTimer.SetFunction (&RoutingProtocol::TriggeredTcTimerExpire, this);
   m_queuedMessagesTimer.SetFunction (&RoutingProtocol::SendQueuedMessages, this);
 
   m_packetSequenceNumber = OLSR6_MAX_SEQ_NUM;
@@ -242,6 +875,11 @@ RoutingProtocol::SetIpv6 (Ptr<Ipv6> ipv6)
 
 void RoutingProtocol::DoDispose ()
 {
+  if (m_oracleMode)
+    {
+      OracleTopology::Get ()->RemoveNode (this);
+    }
+
   m_ipv6 = 0;
   m_hnaRoutingTable = 0;
   m_routingTableAssociation = 0;
@@ -252,6 +890,13 @@ void RoutingProtocol::DoDispose ()
       iter->first->Close ();
     }
   m_socketAddresses.clear ();
+  m_linkTupleTimers.clear ();
+  m_linkQualityTimers.clear ();
+  if (m_recvSocket)
+    {
+      m_recvSocket->Close ();
+      m_recvSocket = 0;
+    }
 
   Ipv6RoutingProtocol::DoDispose ();
 }
@@ -318,6 +963,69 @@ void RoutingProtocol::DoInitialize ()
 
   NS_LOG_DEBUG ("Starting OLSR6 on node " << m_mainAddress);
 
+  if (m_adaptiveIntervals)
+    {
+      NS_ASSERT_MSG (m_minHelloInterval.IsStrictlyPositive () && m_minHelloInterval <= m_maxHelloInterval,
+                     "Invalid adaptive HELLO interval range");
+      NS_ASSERT_MSG (m_minTcInterval.IsStrictlyPositive () && m_minTcInterval <= m_maxTcInterval,
+                     "Invalid adaptive TC interval range");
+      // The neighborhood is about to be discovered: start fast
+      m_currentHelloInterval = m_minHelloInterval;
+      m_currentTcInterval = m_minTcInterval;
+      m_lastLinkSetChange = Simulator::Now ();
+      m_lastMprSelectorChange = Simulator::Now ();
+    }
+  m_lastTcTime = Simulator::Now () - m_triggeredTcMinSpacing;
+  m_triggeredTcWindowStart = Simulator::Now ();
+
+  if (!m_authenticationKey.empty ())
+    {
+      m_authenticationKeys[m_authenticationKeyId] = HmacSha256 (m_authenticationKey);
+    }
+
+  m_fisheyeTtl.clear ();
+  m_fisheyeIndex = 0;
+  std::istringstream fisheyeTtl (m_fisheyeTtlString);
+  uint32_t ttl;
+  while (fisheyeTtl >> ttl)
+    {
+      if (ttl == 0 || ttl > 255)
+        {
+          NS_FATAL_ERROR ("Invalid TTL " << ttl << " in FisheyeTtl");
+        }
+      m_fisheyeTtl.push_back (ttl);
+    }
+  if (!fisheyeTtl.eof ())
+    {
+      NS_FATAL_ERROR ("Invalid FisheyeTtl \"" << m_fisheyeTtlString << "\"");
+    }
+
+  m_advertisedWillingness = m_willingness;
+  m_forwardedPackets = 0;
+  m_lowLoadSince = Simulator::Now ();
+  if (m_willingnessLoadSignal != OLSR6_LOAD_NONE)
+    {
+      if (m_willingnessLoadLow > m_willingnessLoadHigh)
+        {
+          NS_FATAL_ERROR ("WillingnessLoadLow " << m_willingnessLoadLow
+                          << " is above WillingnessLoadHigh " << m_willingnessLoadHigh);
+        }
+      if (m_willingnessLoadSignal == OLSR6_LOAD_CALLBACK && m_willingnessLoadCallback.IsNull ())
+        {
+          NS_FATAL_ERROR ("No callback set for the callback willingness load signal");
+        }
+    }
+
+  // The first TC is a full one
+  m_tcsSinceFullTc = m_fullTcRefresh;
+  m_fullTcAddresses.clear ();
+  m_diffTcBases.clear ();
+
+  if (!m_snapshotFile.empty ())
+    {
+      RestoreSnapshot (m_snapshotFile);
+    }
+
   Ipv6Address loopback ("::1");
 
   bool canRunOlsr6 = false;
@@ -334,16 +1042,38 @@ void RoutingProtocol::DoInitialize ()
         {
           // Create never expiring interface association tuple entries for our
           // own network interfaces, so that GetMainAddress () works to
-          // translate the node's own interface addresses into the main address.
+          // translate the node's own interface addresses into the main address
+          // (a restored snapshot already holds them).
           IfaceAssocTuple tuple;
           tuple.ifaceAddr = m_ipv6->GetAddress (i, 1).GetAddress ();
           tuple.mainAddr = m_mainAddress;
-          AddIfaceAssocTuple (tuple);
+          if (m_state.FindIfaceAssocTuple (tuple.ifaceAddr) == NULL)
+            {
+              AddIfaceAssocTuple (tuple);
+            }
           NS_ASSERT (GetMainAddress (m_ipv6->GetAddress (i, 1).GetAddress ()) == m_mainAddress);
         }
       canRunOlsr6 = true;
     }
 
+  if (m_oracleMode)
+    {
+      // No sockets and no timers: the topology model installs the routes.
+      for (uint32_t i = 0; i < m_ipv6->GetNInterfaces (); i++)
+        {
+          if (m_interfaceExclusions.find (i) == m_interfaceExclusions.end ())
+            {
+              m_ipv6->SetForwarding (i, true);
+            }
+        }
+      if (canRunOlsr6)
+        {
+          OracleTopology::Get ()->AddNode (this);
+          NS_LOG_DEBUG ("OLSR6 on node " << m_mainAddress << " started in oracle mode");
+        }
+      return;
+    }
+
   for (uint32_t i = 0; i < m_ipv6->GetNInterfaces (); i++)
     {
       bool activeInterface = false;
@@ -358,17 +1088,7 @@ void RoutingProtocol::DoInitialize ()
           Ipv6InterfaceAddress address = m_ipv6->GetAddress (i, j);
           if (address.GetScope () == Ipv6InterfaceAddress::GLOBAL && activeInterface == true)
             {
-              NS_LOG_LOGIC ("OLSR: adding socket to " << address.GetAddress ());
-              TypeId tid = TypeId::LookupByName ("ns3::UdpSocketFactory");
-              Ptr<Node> theNode = GetObject<Node> ();
-              Ptr<Socket> socket = Socket::CreateSocket (theNode, tid);
-              Inet6SocketAddress local = Inet6SocketAddress (address.GetAddress (), OLSR6_PORT_NUMBER);
-              int ret = socket->Bind (local);
-              NS_ASSERT_MSG (ret == 0, "Bind unsuccessful");
-              socket->BindToNetDevice (m_ipv6->GetNetDevice (i));
-              socket->ShutdownRecv ();
-              socket->SetIpv6RecvHopLimit (true);
-              m_socketAddresses[socket] = m_ipv6->GetAddress (i, j);
+              OpenSocket (i, address);
             }
         }
     }
@@ -391,11 +1111,65 @@ void RoutingProtocol::DoInitialize ()
       TcTimerExpire ();
       MidTimerExpire ();
       HnaTimerExpire ();
+      if (m_memoryUsageInterval.IsStrictlyPositive ())
+        {
+          MemoryUsageTimerExpire ();
+        }
+      // WILL_NEVER nodes never forward, whatever their load
+      if (m_willingnessLoadSignal != OLSR6_LOAD_NONE && m_willingness != OLSR6_WILL_NEVER)
+        {
+          m_willingnessTimer.Schedule (m_willingnessUpdateInterval);
+        }
 
       NS_LOG_DEBUG ("OLSR6 on node " << m_mainAddress << " started");
     }
 }
 
+void
+RoutingProtocol::OpenSocket (uint32_t interface, const Ipv6InterfaceAddress &address)
+{
+  NS_LOG_LOGIC ("OLSR: adding socket to " << address.GetAddress ());
+  TypeId tid = TypeId::LookupByName ("ns3::UdpSocketFactory");
+  Ptr<Node> theNode = GetObject<Node> ();
+  Ptr<Socket> socket = Socket::CreateSocket (theNode, tid);
+  Inet6SocketAddress local = Inet6SocketAddress (address.GetAddress (), OLSR6_PORT_NUMBER);
+  int ret = socket->Bind (local);
+  NS_ASSERT_MSG (ret == 0, "Bind unsuccessful");
+  socket->BindToNetDevice (m_ipv6->GetNetDevice (interface));
+  // The multicast packets are received by m_recvSocket, the unicast ones here
+  socket->SetRecvCallback (MakeCallback (&RoutingProtocol::RecvOlsr6, this));
+  socket->SetIpv6RecvHopLimit (true);
+  m_socketAddresses[socket] = address;
+}
+
+Ptr<Socket>
+RoutingProtocol::FindSocket (const Ipv6Address &address) const
+{
+  for (std::map< Ptr<Socket>, Ipv6InterfaceAddress >::const_iterator iter = m_socketAddresses.begin ();
+       iter != m_socketAddresses.end (); iter++)
+    {
+      if (iter->second.GetAddress () == address)
+        {
+          return iter->first;
+        }
+    }
+  return 0;
+}
+
+bool
+RoutingProtocol::CloseSocket (const Ipv6Address &address)
+{
+  Ptr<Socket> socket = FindSocket (address);
+  if (!socket)
+    {
+      return false;
+    }
+  NS_LOG_LOGIC ("OLSR: removing socket from " << address);
+  socket->Close ();
+  m_socketAddresses.erase (socket);
+  return true;
+}
+
 void RoutingProtocol::SetMainInterface (uint32_t interface)
 {
   m_mainAddress = m_ipv6->GetAddress (interface, 1).GetAddress ();
@@ -420,12 +1194,23 @@ RoutingProtocol::RecvOlsr6 (Ptr<Socket> socket)
   Ipv6Address receiverIfaceAddr;
   for (uint32_t i = 1; i < m_ipv6->GetNInterfaces (); i++)
     {
+      // An interface may have lost its global address
+      if (m_ipv6->GetNAddresses (i) < 2)
+        {
+          continue;
+        }
       Ipv6InterfaceAddress radr = m_ipv6->GetAddress (i,1);
       if (radr.IsInSameSubnet (senderIfaceAddr))
         {
           receiverIfaceAddr = radr.GetAddress ();
         }
     }
+  if (receiverIfaceAddr == Ipv6Address ())
+    {
+      NS_LOG_DEBUG ("OLSR6 node " << m_mainAddress << " has no address on the link of "
+                                  << senderIfaceAddr << ", packet ignored");
+      return;
+    }
   NS_LOG_DEBUG ("OLSR6 node " << m_mainAddress << " received a OLSR6 packet from "
                               << senderIfaceAddr << " to " << receiverIfaceAddr);
 
@@ -433,7 +1218,20 @@ RoutingProtocol::RecvOlsr6 (Ptr<Socket> socket)
   // so we check it.
   NS_ASSERT (inetSourceAddr.GetPort () == OLSR6_PORT_NUMBER);
 
-  Ptr<Packet> packet = receivedPacket;
+  ReceivePacket (receivedPacket, senderIfaceAddr, receiverIfaceAddr);
+}
+
+void
+RoutingProtocol::ReceivePacket (Ptr<Packet> packet, Ipv6Address senderIfaceAddr, Ipv6Address receiverIfaceAddr)
+{
+  m_rxRawPacketTrace (packet, senderIfaceAddr, receiverIfaceAddr);
+
+  // The signature covers the whole packet, which is read again to check it
+  Ptr<Packet> signedPacket;
+  if (!m_authenticationKey.empty ())
+    {
+      signedPacket = packet->Copy ();
+    }
 
   olsr6::PacketHeader olsr6PacketHeader;
   packet->RemoveHeader (olsr6PacketHeader);
@@ -459,6 +1257,21 @@ RoutingProtocol::RecvOlsr6 (Ptr<Socket> socket)
       messages.push_back (messageHeader);
     }
 
+  // The signature ending a packet is not a message to process or forward
+  MessageHeader signature;
+  if (!messages.empty () && messages.back ().GetMessageType () == MessageHeader::SIGNATURE_MESSAGE)
+    {
+      signature = messages.back ();
+      messages.pop_back ();
+    }
+  if (signedPacket && !AuthenticatePacket (signedPacket, olsr6PacketHeader, signature))
+    {
+      NS_LOG_DEBUG ("OLSR6 node " << m_mainAddress << " dropped a packet from "
+                                  << senderIfaceAddr << " which failed the authentication");
+      m_authenticationFailureTrace (olsr6PacketHeader, senderIfaceAddr);
+      return;
+    }
+
   m_rxPacketTrace (olsr6PacketHeader, messages);
 
   for (MessageList::const_iterator messageIter = messages.begin ();
@@ -513,6 +1326,16 @@ RoutingProtocol::RecvOlsr6 (Ptr<Socket> socket)
               ProcessHna (messageHeader, senderIfaceAddr);
               break;
 
+            case olsr6::MessageHeader::DTC_MESSAGE:
+              NS_LOG_DEBUG (Simulator::Now ().GetSeconds ()
+                            << "s OLSR6 node " << m_mainAddress
+                            <<  " received differential TC message of size " << messageHeader.GetSerializedSize ());
+              if (m_differentialTc)
+                {
+                  ProcessDiffTc (messageHeader, senderIfaceAddr);
+                }
+              break;
+
             default:
               NS_LOG_DEBUG ("OLSR6 message type " <<
                             int (messageHeader.GetMessageType ()) <<
@@ -544,7 +1367,7 @@ RoutingProtocol::RecvOlsr6 (Ptr<Socket> socket)
           if (messageHeader.GetMessageType ()  != olsr6::MessageHeader::HELLO_MESSAGE)
             {
               ForwardDefault (messageHeader, duplicated,
-                              receiverIfaceAddr, inetSourceAddr.GetIpv6 ());
+                              receiverIfaceAddr, senderIfaceAddr);
             }
         }
     }
@@ -553,363 +1376,32 @@ RoutingProtocol::RecvOlsr6 (Ptr<Socket> socket)
   RoutingTableComputation ();
 }
 
-///
-/// \brief This auxiliary function (defined in \RFC{3626}) is used for calculating the MPR Set.
-///
-/// \param tuple the neighbor tuple which has the main address of the node we are going to calculate its degree to.
-/// \return the degree of the node.
-///
-int
-RoutingProtocol::Degree (NeighborTuple const &tuple)
+void
+RoutingProtocol::MprComputation ()
 {
-  int degree = 0;
-  for (TwoHopNeighborSet::const_iterator it = m_state.GetTwoHopNeighbors ().begin ();
-       it != m_state.GetTwoHopNeighbors ().end (); it++)
+  NS_LOG_FUNCTION (this);
+
+  // The MPR set of the node is the union of the MPR sets of its interfaces
+  InterfaceNeighborCosts neighbors = GetInterfaceNeighborCosts ();
+  InterfaceMprSets interfaceMprSets;
+  if (m_linkMetric == OLSR6_METRIC_ETX)
     {
-      TwoHopNeighborTuple const &nb2hop_tuple = *it;
-      if (nb2hop_tuple.neighborMainAddr == tuple.neighborMainAddr)
-        {
-          const NeighborTuple *nb_tuple =
-            m_state.FindNeighborTuple (nb2hop_tuple.neighborMainAddr);
-          if (nb_tuple == NULL)
-            {
-              degree++;
-            }
-        }
-    }
-  return degree;
-}
-
-namespace {
-///
-/// \brief Remove all covered 2-hop neighbors from N2 set.
-/// This is a helper function used by MprComputation algorithm.
-///
-/// \param neighborMainAddr Neighbor main address.
-/// \param N2 Reference to the 2-hop neighbor set.
-///
-void
-CoverTwoHopNeighbors (Ipv6Address neighborMainAddr, TwoHopNeighborSet & N2)
-{
-  // first gather all 2-hop neighbors to be removed
-  std::set<Ipv6Address> toRemove;
-  for (TwoHopNeighborSet::iterator twoHopNeigh = N2.begin (); twoHopNeigh != N2.end (); twoHopNeigh++)
-    {
-      if (twoHopNeigh->neighborMainAddr == neighborMainAddr)
-        {
-          toRemove.insert (twoHopNeigh->twoHopNeighborAddr);
-        }
+      interfaceMprSets = m_state.ComputeInterfaceEtxMprSets (m_mainAddress, neighbors);
     }
-  // Now remove all matching records from N2
-  for (TwoHopNeighborSet::iterator twoHopNeigh = N2.begin (); twoHopNeigh != N2.end (); )
+  else
     {
-      if (toRemove.find (twoHopNeigh->twoHopNeighborAddr) != toRemove.end ())
-        {
-          twoHopNeigh = N2.erase (twoHopNeigh);
-        }
-      else
-        {
-          twoHopNeigh++;
-        }
+      interfaceMprSets = m_state.ComputeInterfaceMprSets (m_mainAddress, neighbors);
     }
-}
-} // anonymous namespace
-
-void
-RoutingProtocol::MprComputation ()
-{
-  NS_LOG_FUNCTION (this);
 
-  // MPR computation should be done for each interface. See section 8.3.1
-  // (RFC 3626) for details.
   MprSet mprSet;
-
-  // N is the subset of neighbors of the node, which are
-  // neighbor "of the interface I"
-  NeighborSet N;
-  for (NeighborSet::const_iterator neighbor = m_state.GetNeighbors ().begin ();
-       neighbor != m_state.GetNeighbors ().end (); neighbor++)
-    {
-      if (neighbor->status == NeighborTuple::STATUS_SYM) // I think that we need this check
-        {
-          N.push_back (*neighbor);
-        }
-    }
-
-  // N2 is the set of 2-hop neighbors reachable from "the interface
-  // I", excluding:
-  // (i)   the nodes only reachable by members of N with willingness WILL_NEVER
-  // (ii)  the node performing the computation
-  // (iii) all the symmetric neighbors: the nodes for which there exists a symmetric
-  //       link to this node on some interface.
-  TwoHopNeighborSet N2;
-  for (TwoHopNeighborSet::const_iterator twoHopNeigh = m_state.GetTwoHopNeighbors ().begin ();
-       twoHopNeigh != m_state.GetTwoHopNeighbors ().end (); twoHopNeigh++)
-    {
-      // excluding:
-      // (ii)  the node performing the computation
-      if (twoHopNeigh->twoHopNeighborAddr == m_mainAddress)
-        {
-          continue;
-        }
-
-      //  excluding:
-      // (i)   the nodes only reachable by members of N with willingness WILL_NEVER
-      bool ok = false;
-      for (NeighborSet::const_iterator neigh = N.begin ();
-           neigh != N.end (); neigh++)
-        {
-          if (neigh->neighborMainAddr == twoHopNeigh->neighborMainAddr)
-            {
-              if (neigh->willingness == OLSR6_WILL_NEVER)
-                {
-                  ok = false;
-                  break;
-                }
-              else
-                {
-                  ok = true;
-                  break;
-                }
-            }
-        }
-      if (!ok)
-        {
-          continue;
-        }
-
-      // excluding:
-      // (iii) all the symmetric neighbors: the nodes for which there exists a symmetric
-      //       link to this node on some interface.
-      for (NeighborSet::const_iterator neigh = N.begin ();
-           neigh != N.end (); neigh++)
-        {
-          if (neigh->neighborMainAddr == twoHopNeigh->twoHopNeighborAddr)
-            {
-              ok = false;
-              break;
-            }
-        }
-
-      if (ok)
-        {
-          N2.push_back (*twoHopNeigh);
-        }
-    }
-
-#ifdef NS3_LOG_ENABLE
-  {
-    std::ostringstream os;
-    os << "[";
-    for (TwoHopNeighborSet::const_iterator iter = N2.begin ();
-         iter != N2.end (); iter++)
-      {
-        TwoHopNeighborSet::const_iterator next = iter;
-        next++;
-        os << iter->neighborMainAddr << "->" << iter->twoHopNeighborAddr;
-        if (next != N2.end ())
-          {
-            os << ", ";
-          }
-      }
-    os << "]";
-    NS_LOG_DEBUG ("N2: " << os.str ());
-  }
-#endif  //NS3_LOG_ENABLE
-
-  // 1. Start with an MPR set made of all members of N with
-  // N_willingness equal to WILL_ALWAYS
-  for (NeighborSet::const_iterator neighbor = N.begin (); neighbor != N.end (); neighbor++)
-    {
-      if (neighbor->willingness == OLSR6_WILL_ALWAYS)
-        {
-          mprSet.insert (neighbor->neighborMainAddr);
-          // (not in RFC but I think is needed: remove the 2-hop
-          // neighbors reachable by the MPR from N2)
-          CoverTwoHopNeighbors (neighbor->neighborMainAddr, N2);
-        }
-    }
-
-  // 2. Calculate D(y), where y is a member of N, for all nodes in N.
-  // (we do this later)
-
-  // 3. Add to the MPR set those nodes in N, which are the *only*
-  // nodes to provide reachability to a node in N2.
-  std::set<Ipv6Address> coveredTwoHopNeighbors;
-  for (TwoHopNeighborSet::const_iterator twoHopNeigh = N2.begin (); twoHopNeigh != N2.end (); twoHopNeigh++)
-    {
-      bool onlyOne = true;
-      // try to find another neighbor that can reach twoHopNeigh->twoHopNeighborAddr
-      for (TwoHopNeighborSet::const_iterator otherTwoHopNeigh = N2.begin (); otherTwoHopNeigh != N2.end (); otherTwoHopNeigh++)
-        {
-          if (otherTwoHopNeigh->twoHopNeighborAddr == twoHopNeigh->twoHopNeighborAddr
-              && otherTwoHopNeigh->neighborMainAddr != twoHopNeigh->neighborMainAddr)
-            {
-              onlyOne = false;
-              break;
-            }
-        }
-      if (onlyOne)
-        {
-          NS_LOG_LOGIC ("Neighbor " << twoHopNeigh->neighborMainAddr
-                                    << " is the only that can reach 2-hop neigh. "
-                                    << twoHopNeigh->twoHopNeighborAddr
-                                    << " => select as MPR.");
-
-          mprSet.insert (twoHopNeigh->neighborMainAddr);
-
-          // take note of all the 2-hop neighbors reachable by the newly elected MPR
-          for (TwoHopNeighborSet::const_iterator otherTwoHopNeigh = N2.begin ();
-               otherTwoHopNeigh != N2.end (); otherTwoHopNeigh++)
-            {
-              if (otherTwoHopNeigh->neighborMainAddr == twoHopNeigh->neighborMainAddr)
-                {
-                  coveredTwoHopNeighbors.insert (otherTwoHopNeigh->twoHopNeighborAddr);
-                }
-            }
-        }
-    }
-  // Remove the nodes from N2 which are now covered by a node in the MPR set.
-  for (TwoHopNeighborSet::iterator twoHopNeigh = N2.begin ();
-       twoHopNeigh != N2.end (); )
-    {
-      if (coveredTwoHopNeighbors.find (twoHopNeigh->twoHopNeighborAddr) != coveredTwoHopNeighbors.end ())
-        {
-          // This works correctly only because it is known that twoHopNeigh is reachable by exactly one neighbor,
-          // so only one record in N2 exists for each of them. This record is erased here.
-          NS_LOG_LOGIC ("2-hop neigh. " << twoHopNeigh->twoHopNeighborAddr << " is already covered by an MPR.");
-          twoHopNeigh = N2.erase (twoHopNeigh);
-        }
-      else
-        {
-          twoHopNeigh++;
-        }
-    }
-
-  // 4. While there exist nodes in N2 which are not covered by at
-  // least one node in the MPR set:
-  while (N2.begin () != N2.end ())
+  for (InterfaceMprSets::const_iterator it = interfaceMprSets.begin (); it != interfaceMprSets.end (); it++)
     {
-
-#ifdef NS3_LOG_ENABLE
-      {
-        std::ostringstream os;
-        os << "[";
-        for (TwoHopNeighborSet::const_iterator iter = N2.begin ();
-             iter != N2.end (); iter++)
-          {
-            TwoHopNeighborSet::const_iterator next = iter;
-            next++;
-            os << iter->neighborMainAddr << "->" << iter->twoHopNeighborAddr;
-            if (next != N2.end ())
-              {
-                os << ", ";
-              }
-          }
-        os << "]";
-        NS_LOG_DEBUG ("Step 4 iteration: N2=" << os.str ());
-      }
-#endif  //NS3_LOG_ENABLE
-
-
-      // 4.1. For each node in N, calculate the reachability, i.e., the
-      // number of nodes in N2 which are not yet covered by at
-      // least one node in the MPR set, and which are reachable
-      // through this 1-hop neighbor
-      std::map<int, std::vector<const NeighborTuple *> > reachability;
-      std::set<int> rs;
-      for (NeighborSet::iterator it = N.begin (); it != N.end (); it++)
-        {
-          NeighborTuple const &nb_tuple = *it;
-          int r = 0;
-          for (TwoHopNeighborSet::iterator it2 = N2.begin (); it2 != N2.end (); it2++)
-            {
-              TwoHopNeighborTuple const &nb2hop_tuple = *it2;
-              if (nb_tuple.neighborMainAddr == nb2hop_tuple.neighborMainAddr)
-                {
-                  r++;
-                }
-            }
-          rs.insert (r);
-          reachability[r].push_back (&nb_tuple);
-        }
-
-      // 4.2. Select as a MPR the node with highest N_willingness among
-      // the nodes in N with non-zero reachability. In case of
-      // multiple choice select the node which provides
-      // reachability to the maximum number of nodes in N2. In
-      // case of multiple nodes providing the same amount of
-      // reachability, select the node as MPR whose D(y) is
-      // greater. Remove the nodes from N2 which are now covered
-      // by a node in the MPR set.
-      NeighborTuple const *max = NULL;
-      int max_r = 0;
-      for (std::set<int>::iterator it = rs.begin (); it != rs.end (); it++)
-        {
-          int r = *it;
-          if (r == 0)
-            {
-              continue;
-            }
-          for (std::vector<const NeighborTuple *>::iterator it2 = reachability[r].begin ();
-               it2 != reachability[r].end (); it2++)
-            {
-              const NeighborTuple *nb_tuple = *it2;
-              if (max == NULL || nb_tuple->willingness > max->willingness)
-                {
-                  max = nb_tuple;
-                  max_r = r;
-                }
-              else if (nb_tuple->willingness == max->willingness)
-                {
-                  if (r > max_r)
-                    {
-                      max = nb_tuple;
-                      max_r = r;
-                    }
-                  else if (r == max_r)
-                    {
-                      if (Degree (*nb_tuple) > Degree (*max))
-                        {
-                          max = nb_tuple;
-                          max_r = r;
-                        }
-                    }
-                }
-            }
-        }
-
-      if (max != NULL)
-        {
-          mprSet.insert (max->neighborMainAddr);
-          CoverTwoHopNeighbors (max->neighborMainAddr, N2);
-          NS_LOG_LOGIC (N2.size () << " 2-hop neighbors left to cover!");
-        }
+      mprSet.insert (it->second.begin (), it->second.end ());
     }
-
-#ifdef NS3_LOG_ENABLE
-  {
-    std::ostringstream os;
-    os << "[";
-    for (MprSet::const_iterator iter = mprSet.begin ();
-         iter != mprSet.end (); iter++)
-      {
-        MprSet::const_iterator next = iter;
-        next++;
-        os << *iter;
-        if (next != mprSet.end ())
-          {
-            os << ", ";
-          }
-      }
-    os << "]";
-    NS_LOG_DEBUG ("Computed MPR set for node " << m_mainAddress << ": " << os.str ());
-  }
-#endif  //NS3_LOG_ENABLE
-
   m_state.SetMprSet (mprSet);
 }
 
+
 Ipv6Address
 RoutingProtocol::GetMainAddress (Ipv6Address iface_addr) const
 {
@@ -935,6 +1427,64 @@ RoutingProtocol::RoutingTableComputation ()
   // 1. All the entries from the routing table are removed.
   Clear ();
 
+  // 2. and 3.
+  if (m_linkMetric == OLSR6_METRIC_ETX)
+    {
+      EtxRoutingTableComputation ();
+    }
+  else
+    {
+      HopCountRoutingTableComputation ();
+    }
+
+  // 4. For each entry in the multiple interface association base
+  // where there exists a routing entry such that:
+  // R_dest_addr == I_main_addr (of the multiple interface association entry)
+  // AND there is no routing entry such that:
+  // R_dest_addr == I_iface_addr
+  const IfaceAssocSet &ifaceAssocSet = m_state.GetIfaceAssocSet ();
+  for (IfaceAssocSet::const_iterator it = ifaceAssocSet.begin ();
+       it != ifaceAssocSet.end (); it++)
+    {
+      IfaceAssocTuple const &tuple = *it;
+      RoutingTableEntry entry1, entry2;
+      bool have_entry1 = Lookup (tuple.mainAddr, entry1);
+      bool have_entry2 = Lookup (tuple.ifaceAddr, entry2);
+      if (have_entry1 && !have_entry2)
+        {
+          // then a route entry is created in the routing table with:
+          //       R_dest_addr  =  I_iface_addr (of the multiple interface
+          //                                     association entry)
+          //       R_next_addr  =  R_next_addr  (of the recorded route entry)
+          //       R_dist       =  R_dist       (of the recorded route entry)
+          //       R_iface_addr =  R_iface_addr (of the recorded route entry).
+          AddEntry (tuple.ifaceAddr,
+                    entry1.nextAddr,
+                    entry1.interface,
+                    entry1.distance);
+        }
+    }
+
+  if (m_maxEqualCostPaths > 1 && m_linkMetric == OLSR6_METRIC_HOP_COUNT)
+    {
+      EqualCostRoutingTableComputation ();
+    }
+  if (m_loopFreeAlternates)
+    {
+      LoopFreeAlternateComputation ();
+    }
+
+  // 5. For each tuple in the association set, a route to the announced
+  //    network is created through the nearest gateway.
+  HnaRoutingTableComputation ();
+
+  NS_LOG_DEBUG ("Node " << m_mainAddress << ": RoutingTableComputation end.");
+  m_routingTableChanged (GetSize ());
+}
+
+void
+RoutingProtocol::HopCountRoutingTableComputation ()
+{
   // 2. The new routing entries are added starting with the
   // symmetric neighbors (h=1) as the destination nodes.
   const NeighborSet &neighborSet = m_state.GetNeighbors ();
@@ -1077,27 +1627,54 @@ RoutingProtocol::RoutingTableComputation ()
         }
     }
 
+  // 3. The tuples are indexed by T_last_addr once, so that every round
+  // only looks at the tuples of the nodes at distance h instead of the
+  // whole topology set.  They are still considered in topology set order,
+  // which keeps the selected next hops unchanged.
+  const TopologySet &topology = m_state.GetTopologySet ();
+  std::map<Ipv6Address, std::vector<uint32_t> > tuplesByLastAddr;
+  for (uint32_t i = 0; i < topology.size (); i++)
+    {
+      tuplesByLastAddr[topology[i].lastAddr].push_back (i);
+    }
+
   for (uint32_t h = 2;; h++)
     {
       bool added = false;
 
+      // The tuples whose T_last_addr corresponds to R_dest_addr of a route
+      // entry whose R_dist is equal to h
+      std::vector<uint32_t> candidates;
+      for (std::map<Ipv6Address, RoutingTableEntry>::const_iterator it = m_table.begin ();
+           it != m_table.end (); it++)
+        {
+          if (it->second.distance == h)
+            {
+              std::map<Ipv6Address, std::vector<uint32_t> >::const_iterator tuples =
+                tuplesByLastAddr.find (it->first);
+              if (tuples != tuplesByLastAddr.end ())
+                {
+                  candidates.insert (candidates.end (), tuples->second.begin (), tuples->second.end ());
+                }
+            }
+        }
+      std::sort (candidates.begin (), candidates.end ());
+
       // 3.1. For each topology entry in the topology table, if its
       // T_dest_addr does not correspond to R_dest_addr of any
       // route entry in the routing table AND its T_last_addr
       // corresponds to R_dest_addr of a route entry whose R_dist
       // is equal to h, then a new route entry MUST be recorded in
       // the routing table (if it does not already exist)
-      const TopologySet &topology = m_state.GetTopologySet ();
-      for (TopologySet::const_iterator it = topology.begin ();
-           it != topology.end (); it++)
+      for (std::vector<uint32_t>::const_iterator it = candidates.begin ();
+           it != candidates.end (); it++)
         {
-          const TopologyTuple &topology_tuple = *it;
+          const TopologyTuple &topology_tuple = topology[*it];
           NS_LOG_LOGIC ("Looking at topology tuple: " << topology_tuple);
 
           RoutingTableEntry destAddrEntry, lastAddrEntry;
-          bool have_destAddrEntry = Lookup (topology_tuple.destAddr, destAddrEntry);
-          bool have_lastAddrEntry = Lookup (topology_tuple.lastAddr, lastAddrEntry);
-          if (!have_destAddrEntry && have_lastAddrEntry && lastAddrEntry.distance == h)
+          if (!Lookup (topology_tuple.destAddr, destAddrEntry)
+              && Lookup (topology_tuple.lastAddr, lastAddrEntry))
             {
               NS_LOG_LOGIC ("Adding routing table entry based on the topology tuple.");
               // then a new route entry MUST be recorded in
@@ -1116,14 +1693,6 @@ RoutingProtocol::RoutingTableComputation ()
                         h + 1);
               added = true;
             }
-          else
-            {
-              NS_LOG_LOGIC ("NOT adding routing table entry based on the topology tuple: "
-                            "have_destAddrEntry=" << have_destAddrEntry
-                                                  << " have_lastAddrEntry=" << have_lastAddrEntry
-                                                  << " lastAddrEntry.distance=" << (int) lastAddrEntry.distance
-                                                  << " (h=" << h << ")");
-            }
         }
 
       if (!added)
@@ -1131,61 +1700,420 @@ RoutingProtocol::RoutingTableComputation ()
           break;
         }
     }
+}
 
-  // 4. For each entry in the multiple interface association base
-  // where there exists a routing entry such that:
-  // R_dest_addr == I_main_addr (of the multiple interface association entry)
-  // AND there is no routing entry such that:
-  // R_dest_addr == I_iface_addr
-  const IfaceAssocSet &ifaceAssocSet = m_state.GetIfaceAssocSet ();
-  for (IfaceAssocSet::const_iterator it = ifaceAssocSet.begin ();
-       it != ifaceAssocSet.end (); it++)
+void
+RoutingProtocol::EqualCostRoutingTableComputation ()
+{
+  // The nodes advertising a link to each destination: the willing
+  // neighbors of the 2-hop neighbors, and the T_last_addr of the topology
+  // tuples
+  std::map<Ipv6Address, std::vector<Ipv6Address> > predecessors;
+  const TwoHopNeighborSet &twoHopNeighbors = m_state.GetTwoHopNeighbors ();
+  for (TwoHopNeighborSet::const_iterator it = twoHopNeighbors.begin ();
+       it != twoHopNeighbors.end (); it++)
     {
-      IfaceAssocTuple const &tuple = *it;
-      RoutingTableEntry entry1, entry2;
-      bool have_entry1 = Lookup (tuple.mainAddr, entry1);
-      bool have_entry2 = Lookup (tuple.ifaceAddr, entry2);
-      if (have_entry1 && !have_entry2)
+      const NeighborTuple *neighbor = m_state.FindSymNeighborTuple (it->neighborMainAddr);
+      if (neighbor != NULL && neighbor->willingness != OLSR6_WILL_NEVER)
         {
-          // then a route entry is created in the routing table with:
-          //       R_dest_addr  =  I_iface_addr (of the multiple interface
-          //                                     association entry)
-          //       R_next_addr  =  R_next_addr  (of the recorded route entry)
-          //       R_dist       =  R_dist       (of the recorded route entry)
-          //       R_iface_addr =  R_iface_addr (of the recorded route entry).
-          AddEntry (tuple.ifaceAddr,
-                    entry1.nextAddr,
-                    entry1.interface,
-                    entry1.distance);
+          predecessors[it->twoHopNeighborAddr].push_back (it->neighborMainAddr);
         }
     }
-
-  // 5. For each tuple in the association set,
-  //    If there is no entry in the routing table with:
-  //        R_dest_addr     == A_network_addr/A_netmask
-  //   and if the announced network is not announced by the node itself,
-  //   then a new routing entry is created.
-  const AssociationSet &associationSet = m_state.GetAssociationSet ();
-
-  // Clear HNA routing table
-  for (uint32_t i = 0; i < m_hnaRoutingTable->GetNRoutes (); i++)
+  const TopologySet &topology = m_state.GetTopologySet ();
+  for (TopologySet::const_iterator it = topology.begin (); it != topology.end (); it++)
     {
-      m_hnaRoutingTable->RemoveRoute (0);
+      predecessors[it->destAddr].push_back (it->lastAddr);
     }
 
-  for (AssociationSet::const_iterator it = associationSet.begin ();
-       it != associationSet.end (); it++)
+  // Every destination starts with its own route; the others are extended
+  // by increasing distance, so that the routes of the predecessors are
+  // complete when they are used
+  std::map<Ipv6Address, std::vector<RoutingTableEntry> > paths;
+  std::vector<std::pair<uint32_t, Ipv6Address> > destinations;
+  for (std::map<Ipv6Address, RoutingTableEntry>::const_iterator it = m_table.begin ();
+       it != m_table.end (); it++)
     {
-      AssociationTuple const &tuple = *it;
-
-      // Test if HNA associations received from other gateways
-      // are also announced by this node. In such a case, no route
-      // is created for this association tuple (go to the next one).
-      bool goToNextAssociationTuple = false;
-      const Associations &localHnaAssociations = m_state.GetAssociations ();
-      NS_LOG_DEBUG ("Nb local associations: " << localHnaAssociations.size ());
-      for (Associations::const_iterator assocIterator = localHnaAssociations.begin ();
-           assocIterator != localHnaAssociations.end (); assocIterator++)
+      paths[it->first].push_back (it->second);
+      if (it->second.distance > 1 && predecessors.find (it->first) != predecessors.end ())
+        {
+          destinations.push_back (std::make_pair (it->second.distance, it->first));
+        }
+    }
+  std::sort (destinations.begin (), destinations.end ());
+
+  for (std::vector<std::pair<uint32_t, Ipv6Address> >::const_iterator dest = destinations.begin ();
+       dest != destinations.end (); dest++)
+    {
+      std::vector<RoutingTableEntry> &destPaths = paths[dest->second];
+      const std::vector<Ipv6Address> &preds = predecessors[dest->second];
+      for (std::vector<Ipv6Address>::const_iterator pred = preds.begin ();
+           pred != preds.end () && destPaths.size () < m_maxEqualCostPaths; pred++)
+        {
+          std::map<Ipv6Address, RoutingTableEntry>::const_iterator predEntry = m_table.find (*pred);
+          if (predEntry == m_table.end () || predEntry->second.distance + 1 != dest->first)
+            {
+              continue;
+            }
+          const std::vector<RoutingTableEntry> &predPaths = paths[*pred];
+          for (std::vector<RoutingTableEntry>::const_iterator path = predPaths.begin ();
+               path != predPaths.end () && destPaths.size () < m_maxEqualCostPaths; path++)
+            {
+              bool known = false;
+              for (std::vector<RoutingTableEntry>::const_iterator knownPath = destPaths.begin ();
+                   knownPath != destPaths.end () && !known; knownPath++)
+                {
+                  known = knownPath->nextAddr == path->nextAddr;
+                }
+              if (!known)
+                {
+                  RoutingTableEntry entry = *path;
+                  entry.destAddr = dest->second;
+                  entry.distance = dest->first;
+                  destPaths.push_back (entry);
+                }
+            }
+        }
+      if (destPaths.size () > 1)
+        {
+          NS_LOG_LOGIC ("Destination " << dest->second << " has " << destPaths.size ()
+                                       << " equal-cost routes");
+          m_multipathTable[dest->second] = destPaths;
+        }
+    }
+
+  // The other interfaces of a node share the routes to its main address
+  const IfaceAssocSet &ifaceAssocSet = m_state.GetIfaceAssocSet ();
+  for (IfaceAssocSet::const_iterator it = ifaceAssocSet.begin ();
+       it != ifaceAssocSet.end (); it++)
+    {
+      std::map<Ipv6Address, std::vector<RoutingTableEntry> >::const_iterator mainPaths =
+        m_multipathTable.find (it->mainAddr);
+      std::map<Ipv6Address, RoutingTableEntry>::const_iterator iface = m_table.find (it->ifaceAddr);
+      if (mainPaths == m_multipathTable.end () || iface == m_table.end ()
+          || m_multipathTable.find (it->ifaceAddr) != m_multipathTable.end ()
+          || iface->second.nextAddr != mainPaths->second.front ().nextAddr
+          || iface->second.distance != mainPaths->second.front ().distance)
+        {
+          continue;
+        }
+      std::vector<RoutingTableEntry> &ifacePaths = m_multipathTable[it->ifaceAddr];
+      ifacePaths = mainPaths->second;
+      for (std::vector<RoutingTableEntry>::iterator path = ifacePaths.begin ();
+           path != ifacePaths.end (); path++)
+        {
+          path->destAddr = it->ifaceAddr;
+        }
+    }
+}
+
+void
+RoutingProtocol::LoopFreeAlternateComputation ()
+{
+  std::map<Ipv6Address, double> neighborCosts = GetNeighborCosts ();
+  if (m_linkMetric == OLSR6_METRIC_HOP_COUNT)
+    {
+      for (std::map<Ipv6Address, double>::iterator it = neighborCosts.begin (); it != neighborCosts.end (); it++)
+        {
+          it->second = 1;
+        }
+    }
+
+  LinkGraph graph;
+  for (std::map<Ipv6Address, double>::const_iterator it = neighborCosts.begin (); it != neighborCosts.end (); it++)
+    {
+      AddGraphLink (graph, m_mainAddress, it->first, it->second);
+    }
+  const TwoHopNeighborSet &twoHopNeighbors = m_state.GetTwoHopNeighbors ();
+  for (TwoHopNeighborSet::const_iterator it = twoHopNeighbors.begin ();
+       it != twoHopNeighbors.end (); it++)
+    {
+      if (it->twoHopNeighborAddr != m_mainAddress)
+        {
+          AddGraphLink (graph, it->neighborMainAddr, it->twoHopNeighborAddr, it->cost);
+        }
+    }
+  const TopologySet &topology = m_state.GetTopologySet ();
+  for (TopologySet::const_iterator it = topology.begin (); it != topology.end (); it++)
+    {
+      AddGraphLink (graph, it->lastAddr, it->destAddr, it->cost);
+    }
+
+  // The distances from this node and from each neighbor which may forward
+  std::map<Ipv6Address, double> fromSelf = ShortestDistances (graph, m_mainAddress);
+  std::map<Ipv6Address, std::map<Ipv6Address, double> > fromNeighbor;
+  for (std::map<Ipv6Address, double>::const_iterator it = neighborCosts.begin (); it != neighborCosts.end (); it++)
+    {
+      const NeighborTuple *neighbor = m_state.FindSymNeighborTuple (it->first);
+      if (neighbor != NULL && neighbor->willingness != OLSR6_WILL_NEVER)
+        {
+          fromNeighbor[it->first] = ShortestDistances (graph, it->first);
+        }
+    }
+
+  for (std::map<Ipv6Address, RoutingTableEntry>::iterator it = m_table.begin (); it != m_table.end (); it++)
+    {
+      RoutingTableEntry sendEntry;
+      if (!FindSendEntry (it->second, sendEntry))
+        {
+          continue;
+        }
+      Ipv6Address dest = GetMainAddress (it->first);
+      Ipv6Address primary = GetMainAddress (sendEntry.nextAddr);
+      std::map<Ipv6Address, double>::const_iterator selfToDest = fromSelf.find (dest);
+      if (selfToDest == fromSelf.end ())
+        {
+          continue;
+        }
+
+      bool found = false;
+      double bestCost = 0;
+      RoutingTableEntry best;
+      for (std::map<Ipv6Address, std::map<Ipv6Address, double> >::const_iterator neighbor = fromNeighbor.begin ();
+           neighbor != fromNeighbor.end (); neighbor++)
+        {
+          if (neighbor->first == primary)
+            {
+              continue;
+            }
+          std::map<Ipv6Address, double>::const_iterator toDest = neighbor->second.find (dest);
+          std::map<Ipv6Address, double>::const_iterator toSelf = neighbor->second.find (m_mainAddress);
+          if (toDest == neighbor->second.end () || toSelf == neighbor->second.end ())
+            {
+              continue;
+            }
+          // Loop-free criterion (RFC 5286, inequality 1): the shortest path
+          // from the neighbor to the destination does not go through this node
+          if (!(toDest->second < toSelf->second + selfToDest->second))
+            {
+              continue;
+            }
+          RoutingTableEntry neighborEntry, neighborSendEntry;
+          if (!Lookup (neighbor->first, neighborEntry) || !FindSendEntry (neighborEntry, neighborSendEntry))
+            {
+              continue;
+            }
+          double cost = neighborCosts[neighbor->first] + toDest->second;
+          if (!found || cost < bestCost)
+            {
+              found = true;
+              bestCost = cost;
+              best = neighborSendEntry;
+            }
+        }
+
+      if (found)
+        {
+          NS_LOG_LOGIC ("Route to " << it->first << " via " << sendEntry.nextAddr
+                                    << " protected by " << best.nextAddr);
+          it->second.alternateNextAddr = best.nextAddr;
+          it->second.alternateInterface = best.interface;
+        }
+    }
+}
+
+void
+RoutingProtocol::RepairRoutes (const Ipv6Address &neighborIfaceAddr)
+{
+  // The routes are looked at as computed, before any of them is changed
+  std::vector<RoutingTableEntry> repaired;
+  std::vector<Ipv6Address> lost;
+  for (std::map<Ipv6Address, RoutingTableEntry>::const_iterator it = m_table.begin (); it != m_table.end (); it++)
+    {
+      RoutingTableEntry sendEntry;
+      if (FindSendEntry (it->second, sendEntry) && sendEntry.nextAddr != neighborIfaceAddr)
+        {
+          continue;
+        }
+      if (it->second.alternateNextAddr != Ipv6Address () && IsSymLink (it->second.alternateNextAddr))
+        {
+          RoutingTableEntry entry = it->second;
+          entry.nextAddr = entry.alternateNextAddr;
+          entry.interface = entry.alternateInterface;
+          entry.alternateNextAddr = Ipv6Address ();
+          repaired.push_back (entry);
+        }
+      else
+        {
+          lost.push_back (it->first);
+        }
+    }
+
+  NS_LOG_DEBUG ("Node " << m_mainAddress << ": link to " << neighborIfaceAddr << " lost, "
+                        << repaired.size () << " routes switched to their alternate, "
+                        << lost.size () << " removed");
+  for (std::vector<RoutingTableEntry>::const_iterator it = repaired.begin (); it != repaired.end (); it++)
+    {
+      m_table[it->destAddr] = *it;
+      m_multipathTable.erase (it->destAddr);
+    }
+  for (std::vector<Ipv6Address>::const_iterator it = lost.begin (); it != lost.end (); it++)
+    {
+      RemoveEntry (*it);
+    }
+
+  // The other equal-cost routes stay in use
+  std::map<Ipv6Address, std::vector<RoutingTableEntry> >::iterator it = m_multipathTable.begin ();
+  while (it != m_multipathTable.end ())
+    {
+      std::vector<RoutingTableEntry> &paths = it->second;
+      for (std::vector<RoutingTableEntry>::iterator path = paths.begin (); path != paths.end (); )
+        {
+          if (path->nextAddr == neighborIfaceAddr)
+            {
+              path = paths.erase (path);
+            }
+          else
+            {
+              path++;
+            }
+        }
+      if (paths.size () < 2)
+        {
+          m_multipathTable.erase (it++);
+        }
+      else
+        {
+          it++;
+        }
+    }
+
+  m_routingTableChanged (GetSize ());
+}
+
+void
+RoutingProtocol::EtxRoutingTableComputation ()
+{
+  // The paths start with the best link to each symmetric neighbor
+  std::priority_queue<EtxPath> heap;
+  std::map<Ipv6Address, uint8_t> willingness;
+  const NeighborSet &neighborSet = m_state.GetNeighbors ();
+  for (NeighborSet::const_iterator it = neighborSet.begin ();
+       it != neighborSet.end (); it++)
+    {
+      if (it->status != NeighborTuple::STATUS_SYM)
+        {
+          continue;
+        }
+      const LinkTuple *link = FindBestLink (it->neighborMainAddr);
+      if (link != NULL)
+        {
+          EtxPath path;
+          path.cost = OLSR6_ETX (link->lq, link->nlq);
+          path.hops = 1;
+          path.dest = it->neighborMainAddr;
+          path.link = link;
+          heap.push (path);
+          willingness[it->neighborMainAddr] = it->willingness;
+        }
+    }
+
+  // and go on along the links of the 2-hop Neighbor Set and the Topology Set
+  typedef std::map<Ipv6Address, std::vector<std::pair<Ipv6Address, double> > > EdgeMap;
+  EdgeMap edges;
+  const TwoHopNeighborSet &twoHopNeighbors = m_state.GetTwoHopNeighbors ();
+  for (TwoHopNeighborSet::const_iterator it = twoHopNeighbors.begin ();
+       it != twoHopNeighbors.end (); it++)
+    {
+      edges[it->neighborMainAddr].push_back (std::make_pair (it->twoHopNeighborAddr, it->cost));
+    }
+  const TopologySet &topology = m_state.GetTopologySet ();
+  for (TopologySet::const_iterator it = topology.begin ();
+       it != topology.end (); it++)
+    {
+      edges[it->lastAddr].push_back (std::make_pair (it->destAddr, it->cost));
+    }
+
+  std::map<Ipv6Address, EtxPath> settled;
+  while (!heap.empty ())
+    {
+      EtxPath path = heap.top ();
+      heap.pop ();
+      if (path.dest == m_mainAddress || settled.find (path.dest) != settled.end ())
+        {
+          continue;
+        }
+      settled[path.dest] = path;
+
+      // A neighbor with willingness WILL_NEVER does not forward
+      std::map<Ipv6Address, uint8_t>::const_iterator will = willingness.find (path.dest);
+      if (will != willingness.end () && will->second == OLSR6_WILL_NEVER)
+        {
+          continue;
+        }
+      EdgeMap::const_iterator out = edges.find (path.dest);
+      if (out == edges.end ())
+        {
+          continue;
+        }
+      for (std::vector<std::pair<Ipv6Address, double> >::const_iterator edge = out->second.begin ();
+           edge != out->second.end (); edge++)
+        {
+          if (settled.find (edge->first) == settled.end ())
+            {
+              EtxPath next = path;
+              next.cost += edge->second;
+              next.hops++;
+              next.dest = edge->first;
+              heap.push (next);
+            }
+        }
+    }
+
+  for (std::map<Ipv6Address, EtxPath>::const_iterator it = settled.begin ();
+       it != settled.end (); it++)
+    {
+      NS_LOG_LOGIC ("Route to " << it->first << " through " << it->second.link->neighborIfaceAddr
+                    << ", ETX " << it->second.cost << ", " << it->second.hops << " hops");
+      AddEntry (it->first,
+                it->second.link->neighborIfaceAddr,
+                it->second.link->localIfaceAddr,
+                it->second.hops);
+    }
+
+  // The other interfaces of the neighbors are reached through their own link
+  Time now = Simulator::Now ();
+  const LinkSet &linkSet = m_state.GetLinks ();
+  for (LinkSet::const_iterator it = linkSet.begin (); it != linkSet.end (); it++)
+    {
+      RoutingTableEntry entry;
+      if (it->symTime >= now && !Lookup (it->neighborIfaceAddr, entry))
+        {
+          AddEntry (it->neighborIfaceAddr, it->neighborIfaceAddr, it->localIfaceAddr, 1);
+        }
+    }
+}
+
+void
+RoutingProtocol::HnaRoutingTableComputation ()
+{
+  // 5. For each tuple in the association set,
+  //    If there is no entry in the routing table with:
+  //        R_dest_addr     == A_network_addr/A_netmask
+  //   and if the announced network is not announced by the node itself,
+  //   then a new routing entry is created.
+  const AssociationSet &associationSet = m_state.GetAssociationSet ();
+
+  // Clear HNA routing table
+  for (uint32_t i = 0; i < m_hnaRoutingTable->GetNRoutes (); i++)
+    {
+      m_hnaRoutingTable->RemoveRoute (0);
+    }
+
+  // Reachable gateways of each network
+  HnaGatewayCandidates candidates;
+  for (AssociationSet::const_iterator it = associationSet.begin ();
+       it != associationSet.end (); it++)
+    {
+      AssociationTuple const &tuple = *it;
+
+      // Test if HNA associations received from other gateways
+      // are also announced by this node. In such a case, no route
+      // is created for this association tuple (go to the next one).
+      bool goToNextAssociationTuple = false;
+      const Associations &localHnaAssociations = m_state.GetAssociations ();
+      NS_LOG_DEBUG ("Nb local associations: " << localHnaAssociations.size ());
+      for (Associations::const_iterator assocIterator = localHnaAssociations.begin ();
+           assocIterator != localHnaAssociations.end (); assocIterator++)
         {
           Association const &localHnaAssoc = *assocIterator;
           if (localHnaAssoc.networkAddr == tuple.networkAddr && localHnaAssoc.netmask == tuple.netmask)
@@ -1200,46 +2128,173 @@ RoutingProtocol::RoutingTableComputation ()
           continue;
         }
 
-      RoutingTableEntry gatewayEntry;
-
-      bool gatewayEntryExists = Lookup (tuple.gatewayAddr, gatewayEntry);
-      bool addRoute = false;
+      HnaGatewayCandidate candidate;
+      candidate.gatewayAddr = tuple.gatewayAddr;
+      if (!Lookup (tuple.gatewayAddr, candidate.entry))
+        {
+          continue;
+        }
+      candidate.weight = 1;
+      if (m_hnaGatewaySelection == OLSR6_GW_WEIGHTED && tuple.capacity > 0)
+        {
+          candidate.weight = uint32_t (tuple.capacity) * (255 - tuple.load) / 255;
+        }
 
-      uint32_t routeIndex = 0;
+      Associations networks;
+      networks.push_back ((Association) { tuple.networkAddr, tuple.netmask });
+      if (m_hnaAggregation)
+        {
+          // An aggregate may cover networks of this node, which keep their own routes
+          for (Associations::const_iterator local = localHnaAssociations.begin ();
+               local != localHnaAssociations.end (); local++)
+            {
+              RemoveNetwork (networks, *local);
+            }
+        }
+      for (Associations::const_iterator network = networks.begin (); network != networks.end (); network++)
+        {
+          Ipv6Address networkAddr = network->networkAddr;
+          candidates[std::make_pair (network->netmask.GetPrefixLength (),
+                                     networkAddr.CombinePrefix (network->netmask))].push_back (candidate);
+        }
+    }
 
-      for (routeIndex = 0; routeIndex < m_hnaRoutingTable->GetNRoutes (); routeIndex++)
+  if (m_hnaAggregation)
+    {
+      // A network may also be part of the aggregate of other gateways, which
+      // reach it as well, as they did before aggregating it.  The shortest
+      // prefixes come first.
+      for (HnaGatewayCandidates::iterator it = candidates.begin (); it != candidates.end (); it++)
         {
-          Ipv6RoutingTableEntry route = m_hnaRoutingTable->GetRoute (routeIndex);
-          if (route.GetDestNetwork () == tuple.networkAddr
-              && route.GetDestNetworkPrefix () == tuple.netmask)
+          for (HnaGatewayCandidates::const_iterator covering = candidates.begin ();
+               covering != candidates.end () && covering->first.first < it->first.first; covering++)
             {
-              break;
+              if (!Ipv6Prefix (covering->first.first).IsMatch (covering->first.second, it->first.second))
+                {
+                  continue;
+                }
+              for (std::vector<HnaGatewayCandidate>::const_iterator candidate = covering->second.begin ();
+                   candidate != covering->second.end (); candidate++)
+                {
+                  bool known = false;
+                  for (uint32_t i = 0; i < it->second.size () && !known; i++)
+                    {
+                      known = it->second[i].gatewayAddr == candidate->gatewayAddr;
+                    }
+                  if (!known)
+                    {
+                      it->second.push_back (*candidate);
+                    }
+                }
             }
         }
+    }
 
-      if (routeIndex == m_hnaRoutingTable->GetNRoutes ())
+  // Each network is routed to its nearest gateway
+  for (HnaGatewayCandidates::const_iterator it = candidates.begin (); it != candidates.end (); it++)
+    {
+      std::vector<HnaGatewayCandidate>::const_iterator nearest = it->second.begin ();
+      for (std::vector<HnaGatewayCandidate>::const_iterator candidate = it->second.begin ();
+           candidate != it->second.end (); candidate++)
         {
-          addRoute = true;
+          if (candidate->entry.distance < nearest->entry.distance)
+            {
+              nearest = candidate;
+            }
         }
-      else if (gatewayEntryExists && m_hnaRoutingTable->GetMetric (routeIndex) > gatewayEntry.distance)
+      m_hnaRoutingTable->AddNetworkRouteTo (it->first.second,
+                                            Ipv6Prefix (it->first.first),
+                                            nearest->entry.nextAddr,
+                                            nearest->entry.interface,
+                                            nearest->entry.distance);
+    }
+
+  HnaGatewayComputation (candidates);
+}
+
+void
+RoutingProtocol::HnaGatewayComputation (const HnaGatewayCandidates &candidates)
+{
+  m_hnaGateways.clear ();
+  if (m_hnaGatewaySelection == OLSR6_GW_NEAREST)
+    {
+      return;
+    }
+
+  for (HnaGatewayCandidates::const_iterator it = candidates.begin (); it != candidates.end (); it++)
+    {
+      uint32_t nearest = it->second.front ().entry.distance;
+      for (std::vector<HnaGatewayCandidate>::const_iterator candidate = it->second.begin ();
+           candidate != it->second.end (); candidate++)
         {
-          m_hnaRoutingTable->RemoveRoute (routeIndex);
-          addRoute = true;
+          nearest = std::min (nearest, candidate->entry.distance);
         }
 
-      if (addRoute && gatewayEntryExists)
+      HnaGateways &gateways = m_hnaGateways[it->first.first][it->first.second];
+      uint32_t totalWeight = 0;
+      for (std::vector<HnaGatewayCandidate>::const_iterator candidate = it->second.begin ();
+           candidate != it->second.end (); candidate++)
+        {
+          if (candidate->entry.distance <= nearest + m_hnaDistanceSlack)
+            {
+              totalWeight += candidate->weight;
+              gateways.gateways.push_back (candidate->gatewayAddr);
+              gateways.cumulativeWeights.push_back (totalWeight);
+            }
+        }
+      if (totalWeight == 0)
         {
-          m_hnaRoutingTable->AddNetworkRouteTo (tuple.networkAddr,
-                                                tuple.netmask,
-                                                gatewayEntry.nextAddr,
-                                                gatewayEntry.interface,
-                                                gatewayEntry.distance);
+          // Every gateway is saturated: they share the flows evenly
+          for (uint32_t i = 0; i < gateways.cumulativeWeights.size (); i++)
+            {
+              gateways.cumulativeWeights[i] = i + 1;
+            }
+        }
+      NS_LOG_DEBUG ("Network " << it->first.second << "/" << uint32_t (it->first.first)
+                               << " shared by " << gateways.gateways.size () << " gateways");
+    }
+}
 
+bool
+RoutingProtocol::LookupHnaGateway (Ptr<const Packet> p, const Ipv6Header &header,
+                                   Ipv6Address &gateway, RoutingTableEntry &entry) const
+{
+  HnaGatewayTag tag;
+  if (p != 0 && p->PeekPacketTag (tag))
+    {
+      if (IsMyOwnAddress (tag.GetGateway ()))
+        {
+          // The gateway routes the packet out of the network
+          return false;
+        }
+      if (Lookup (tag.GetGateway (), entry))
+        {
+          gateway = tag.GetGateway ();
+          return true;
         }
     }
 
-  NS_LOG_DEBUG ("Node " << m_mainAddress << ": RoutingTableComputation end.");
-  m_routingTableChanged (GetSize ());
+  Ipv6Address dest = header.GetDestinationAddress ();
+  for (std::map<uint8_t, std::map<Ipv6Address, HnaGateways>, std::greater<uint8_t> >::const_iterator it =
+         m_hnaGateways.begin (); it != m_hnaGateways.end (); it++)
+    {
+      std::map<Ipv6Address, HnaGateways>::const_iterator network =
+        it->second.find (dest.CombinePrefix (Ipv6Prefix (it->first)));
+      if (network == it->second.end ())
+        {
+          continue;
+        }
+
+      // Every node selects the same gateway for a flow
+      const std::vector<uint32_t> &weights = network->second.cumulativeWeights;
+      uint32_t point = FlowHash (header, Ipv6Address::GetAny ()) % weights.back ();
+      uint32_t index = std::upper_bound (weights.begin (), weights.end (), point) - weights.begin ();
+      gateway = network->second.gateways[index];
+      NS_LOG_LOGIC ("Flow " << header.GetSourceAddress () << " -> " << dest
+                            << " uses gateway " << gateway);
+      return Lookup (gateway, entry);
+    }
+  return false;
 }
 
 
@@ -1252,6 +2307,15 @@ RoutingProtocol::ProcessHello (const olsr6::MessageHeader &msg,
 
   const olsr6::MessageHeader::Hello &hello = msg.GetHello ();
 
+  if (hello.compression)
+    {
+      m_compressionNeighbors[senderIface] = Simulator::Now () + msg.GetVTime ();
+    }
+  else
+    {
+      m_compressionNeighbors.erase (senderIface);
+    }
+
   LinkSensing (msg, hello, receiverIface, senderIface);
 
 #ifdef NS3_LOG_ENABLE
@@ -1324,67 +2388,195 @@ RoutingProtocol::ProcessTc (const olsr6::MessageHeader &msg,
       return;
     }
 
+  // 3. and 4.
+  std::vector<double> costs;
+  for (std::vector<olsr6::MessageHeader::LinkQuality>::const_iterator it = tc.linkQualities.begin ();
+       it != tc.linkQualities.end (); it++)
+    {
+      costs.push_back (OLSR6_ETX (it->lq / 255.0, it->nlq / 255.0));
+    }
+  UpdateTopologySet (msg.GetOriginatorAddress (), tc.ansn, tc.neighborAddresses, msg.GetVTime (), costs);
+
+  if (m_differentialTc)
+    {
+      // The differential TCs of the originator now apply to this one
+      DiffTcBase &base = m_diffTcBases[msg.GetOriginatorAddress ()];
+      base.ansn = tc.ansn;
+      base.addresses = std::set<Ipv6Address> (tc.neighborAddresses.begin (), tc.neighborAddresses.end ());
+      base.added.clear ();
+      base.removed.clear ();
+    }
+
+#ifdef NS3_LOG_ENABLE
+  {
+    const TopologySet &topology = m_state.GetTopologySet ();
+    NS_LOG_DEBUG (Simulator::Now ().GetSeconds ()
+                  << "s ** BEGIN dump TopologySet for OLSR6 Node " << m_mainAddress);
+    for (TopologySet::const_iterator tuple = topology.begin ();
+         tuple != topology.end (); tuple++)
+      {
+        NS_LOG_DEBUG (*tuple);
+      }
+    NS_LOG_DEBUG ("** END dump TopologySet Set for OLSR6 Node " << m_mainAddress);
+  }
+#endif // NS3_LOG_ENABLE
+}
+
+void
+RoutingProtocol::ProcessDiffTc (const olsr6::MessageHeader &msg,
+                                const Ipv6Address &senderIface)
+{
+  const olsr6::MessageHeader::DiffTc &diffTc = msg.GetDiffTc ();
+  Time now = Simulator::Now ();
+
+  // As for a TC message, the sender must be a symmetric neighbor and the
+  // message must not be older than the Topology Set
+  const LinkTuple *link_tuple = m_state.FindSymLinkTuple (senderIface, now);
+  if (link_tuple == NULL)
+    {
+      return;
+    }
+  const TopologyTuple *topologyTuple =
+    m_state.FindNewerTopologyTuple (msg.GetOriginatorAddress (), diffTc.ansn);
+  if (topologyTuple != NULL)
+    {
+      return;
+    }
+
+  std::map<Ipv6Address, DiffTcBase>::iterator base = m_diffTcBases.find (msg.GetOriginatorAddress ());
+  if (base == m_diffTcBases.end () || base->second.ansn != diffTc.baseAnsn)
+    {
+      // The changes cannot be applied; the advertised links are kept until
+      // they expire or the next full TC
+      NS_LOG_LOGIC ("Differential TC from " << msg.GetOriginatorAddress ()
+                    << " based on the unknown ANSN " << diffTc.baseAnsn << ", waiting for a full TC");
+      return;
+    }
+
+  // The differential TCs are all relative to the base TC: only the
+  // differences with the last one applied change the Topology Set
+  DiffTcBase &applied = base->second;
+  std::set<Ipv6Address> added (diffTc.addedAddresses.begin (), diffTc.addedAddresses.end ());
+  std::set<Ipv6Address> removed (diffTc.removedAddresses.begin (), diffTc.removedAddresses.end ());
+  std::set<Ipv6Address> withdrawn;
+  std::set<Ipv6Address> missing;
+  for (std::set<Ipv6Address>::const_iterator it = applied.added.begin (); it != applied.added.end (); it++)
+    {
+      if (added.find (*it) == added.end ())
+        {
+          withdrawn.insert (*it);
+        }
+    }
+  for (std::set<Ipv6Address>::const_iterator it = added.begin (); it != added.end (); it++)
+    {
+      if (applied.added.find (*it) == applied.added.end ())
+        {
+          missing.insert (*it);
+        }
+    }
+  for (std::set<Ipv6Address>::const_iterator it = removed.begin (); it != removed.end (); it++)
+    {
+      if (applied.removed.find (*it) == applied.removed.end ())
+        {
+          withdrawn.insert (*it);
+        }
+    }
+  for (std::set<Ipv6Address>::const_iterator it = applied.removed.begin (); it != applied.removed.end (); it++)
+    {
+      if (removed.find (*it) == removed.end ())
+        {
+          missing.insert (*it);
+        }
+    }
+
+  // The links advertised before and still advertised are refreshed, the
+  // withdrawn ones erased; the new ones are found missing
+  Time expirationTime = now + msg.GetVTime ();
+  m_state.RefreshTopologyTuples (msg.GetOriginatorAddress (), diffTc.ansn, expirationTime, withdrawn, missing);
+  for (std::set<Ipv6Address>::const_iterator it = missing.begin (); it != missing.end (); it++)
+    {
+      TopologyTuple topologyTuple;
+      topologyTuple.destAddr = *it;
+      topologyTuple.lastAddr = msg.GetOriginatorAddress ();
+      topologyTuple.sequenceNumber = diffTc.ansn;
+      topologyTuple.expirationTime = expirationTime;
+      AddTopologyTuple (topologyTuple);
+      m_events.Track (Simulator::Schedule (DELAY (topologyTuple.expirationTime),
+                                           &RoutingProtocol::TopologyTupleTimerExpire,
+                                           this,
+                                           topologyTuple.destAddr,
+                                           topologyTuple.lastAddr));
+    }
+
+  applied.added.swap (added);
+  applied.removed.swap (removed);
+}
+
+void
+RoutingProtocol::UpdateTopologySet (const Ipv6Address &originator, uint16_t ansn,
+                                    const std::vector<Ipv6Address> &addresses, Time vTime,
+                                    const std::vector<double> &costs)
+{
+  Time now = Simulator::Now ();
+
   // 3. All tuples in the topology set where:
   //    T_last_addr == originator address AND
   //    T_seq       <  ANSN
   // MUST be removed from the topology set.
-  m_state.EraseOlderTopologyTuples (msg.GetOriginatorAddress (), tc.ansn);
+  m_state.EraseOlderTopologyTuples (originator, ansn);
 
   // 4. For each of the advertised neighbor main address received in
   // the TC message:
-  for (std::vector<Ipv6Address>::const_iterator i = tc.neighborAddresses.begin ();
-       i != tc.neighborAddresses.end (); i++)
+  // (the tuples of the originator are looked up in a single pass, and the
+  // new ones inserted afterwards so that the pointers remain valid)
+  std::map<Ipv6Address, TopologyTuple*> known = m_state.FindTopologyTuples (originator);
+  std::vector<uint32_t> unknown;
+  for (uint32_t i = 0; i < addresses.size (); i++)
     {
-      const Ipv6Address &addr = *i;
+      double cost = costs.empty () ? 1.0 : costs[i];
+
       // 4.1. If there exist some tuple in the topology set where:
       //      T_dest_addr == advertised neighbor main address, AND
       //      T_last_addr == originator address,
       // then the holding time of that tuple MUST be set to:
       //      T_time      =  current time + validity time.
-      TopologyTuple *topologyTuple =
-        m_state.FindTopologyTuple (addr, msg.GetOriginatorAddress ());
-
-      if (topologyTuple != NULL)
+      std::map<Ipv6Address, TopologyTuple*>::iterator topologyTuple = known.find (addresses[i]);
+      if (topologyTuple == known.end ())
         {
-          topologyTuple->expirationTime = now + msg.GetVTime ();
+          // Null until recorded, in case the address is advertised twice
+          known[addresses[i]] = NULL;
+          unknown.push_back (i);
         }
-      else
+      else if (topologyTuple->second != NULL)
         {
-          // 4.2. Otherwise, a new tuple MUST be recorded in the topology
-          // set where:
-          //      T_dest_addr = advertised neighbor main address,
-          //      T_last_addr = originator address,
-          //      T_seq       = ANSN,
-          //      T_time      = current time + validity time.
-          TopologyTuple topologyTuple;
-          topologyTuple.destAddr = addr;
-          topologyTuple.lastAddr = msg.GetOriginatorAddress ();
-          topologyTuple.sequenceNumber = tc.ansn;
-          topologyTuple.expirationTime = now + msg.GetVTime ();
-          AddTopologyTuple (topologyTuple);
-
-          // Schedules topology tuple deletion
-          m_events.Track (Simulator::Schedule (DELAY (topologyTuple.expirationTime),
-                                               &RoutingProtocol::TopologyTupleTimerExpire,
-                                               this,
-                                               topologyTuple.destAddr,
-                                               topologyTuple.lastAddr));
+          topologyTuple->second->expirationTime = now + vTime;
+          topologyTuple->second->cost = cost;
         }
     }
-
-#ifdef NS3_LOG_ENABLE
-  {
-    const TopologySet &topology = m_state.GetTopologySet ();
-    NS_LOG_DEBUG (Simulator::Now ().GetSeconds ()
-                  << "s ** BEGIN dump TopologySet for OLSR6 Node " << m_mainAddress);
-    for (TopologySet::const_iterator tuple = topology.begin ();
-         tuple != topology.end (); tuple++)
-      {
-        NS_LOG_DEBUG (*tuple);
-      }
-    NS_LOG_DEBUG ("** END dump TopologySet Set for OLSR6 Node " << m_mainAddress);
-  }
-#endif // NS3_LOG_ENABLE
+  for (std::vector<uint32_t>::const_iterator i = unknown.begin ();
+       i != unknown.end (); i++)
+    {
+      // 4.2. Otherwise, a new tuple MUST be recorded in the topology
+      // set where:
+      //      T_dest_addr = advertised neighbor main address,
+      //      T_last_addr = originator address,
+      //      T_seq       = ANSN,
+      //      T_time      = current time + validity time.
+      TopologyTuple topologyTuple;
+      topologyTuple.destAddr = addresses[*i];
+      topologyTuple.lastAddr = originator;
+      topologyTuple.sequenceNumber = ansn;
+      topologyTuple.expirationTime = now + vTime;
+      topologyTuple.cost = costs.empty () ? 1.0 : costs[*i];
+      AddTopologyTuple (topologyTuple);
+
+      // Schedules topology tuple deletion
+      m_events.Track (Simulator::Schedule (DELAY (topologyTuple.expirationTime),
+                                           &RoutingProtocol::TopologyTupleTimerExpire,
+                                           this,
+                                           topologyTuple.destAddr,
+                                           topologyTuple.lastAddr));
+    }
 }
 
 void
@@ -1490,6 +2682,8 @@ RoutingProtocol::ProcessHna (const olsr6::MessageHeader &msg,
       if (tuple != NULL)
         {
           tuple->expirationTime = now + msg.GetVTime ();
+          tuple->capacity = hna.capacity;
+          tuple->load = hna.load;
         }
 
       // 2.2 otherwise, a new tuple MUST be recorded with:
@@ -1499,12 +2693,13 @@ RoutingProtocol::ProcessHna (const olsr6::MessageHeader &msg,
       //          A_time         =  current time + validity time
       else
         {
-          AssociationTuple assocTuple = {
-            msg.GetOriginatorAddress (),
-            it->address,
-            it->mask,
-            now + msg.GetVTime ()
-          };
+          AssociationTuple assocTuple;
+          assocTuple.gatewayAddr = msg.GetOriginatorAddress ();
+          assocTuple.networkAddr = it->address;
+          assocTuple.netmask = it->mask;
+          assocTuple.expirationTime = now + msg.GetVTime ();
+          assocTuple.capacity = hna.capacity;
+          assocTuple.load = hna.load;
           AddAssociationTuple (assocTuple);
 
           //Schedule Association Tuple deletion
@@ -1514,6 +2709,19 @@ RoutingProtocol::ProcessHna (const olsr6::MessageHeader &msg,
         }
 
     }
+
+  // 3. The message carries all the networks of the gateway, which may
+  //    aggregate them differently than in its previous messages
+  if (m_hnaAggregation)
+    {
+      Associations networks;
+      for (std::vector<olsr6::MessageHeader::Hna::Association>::const_iterator it = hna.associations.begin ();
+           it != hna.associations.end (); it++)
+        {
+          networks.push_back ((Association) { it->address, it->mask });
+        }
+      m_state.EraseSupersededAssociationTuples (msg.GetOriginatorAddress (), networks);
+    }
 }
 
 void
@@ -1585,9 +2793,10 @@ RoutingProtocol::ForwardDefault (olsr6::MessageHeader olsr6Message,
 }
 
 void
-RoutingProtocol::QueueMessage (const olsr6::MessageHeader &message, Time delay)
+RoutingProtocol::QueueMessage (const olsr6::MessageHeader &message, Time delay, Ipv6Address iface)
 {
   m_queuedMessages.push_back (message);
+  m_queuedMessageIfaces.push_back (iface);
   if (not m_queuedMessagesTimer.IsRunning ())
     {
       m_queuedMessagesTimer.SetDelay (delay);
@@ -1597,62 +2806,262 @@ RoutingProtocol::QueueMessage (const olsr6::MessageHeader &message, Time delay)
 
 void
 RoutingProtocol::SendPacket (Ptr<Packet> packet,
-                             const MessageList &containedMessages)
+                             const MessageList &containedMessages,
+                             Ptr<Socket> socket,
+                             Ipv6Address destination)
 {
   NS_LOG_DEBUG ("OLSR6 node " << m_mainAddress << " sending a OLSR6 packet");
 
+  // The signature ends the packet; its ICV is written once the packet is complete
+  bool authentication = !m_authenticationKey.empty ();
+  if (authentication)
+    {
+      olsr6::MessageHeader signature;
+      signature.SetVTime (OLSR6_NEIGHB_HOLD_TIME);
+      signature.SetOriginatorAddress (m_mainAddress);
+      signature.SetTimeToLive (1);
+      signature.SetHopCount (0);
+      signature.SetMessageSequenceNumber (GetMessageSequenceNumber ());
+      signature.GetSignature ().keyId = m_authenticationKeyId;
+      Ptr<Packet> p = Create<Packet> ();
+      p->AddHeader (signature);
+      packet->AddAtEnd (p);
+    }
+
   // Add a header
   olsr6::PacketHeader header;
   header.SetPacketLength (header.GetSerializedSize () + packet->GetSize ());
   header.SetPacketSequenceNumber (GetPacketSequenceNumber ());
   packet->AddHeader (header);
+  if (authentication)
+    {
+      SignPacket (packet);
+    }
 
   // Trace it
   m_txPacketTrace (header, containedMessages);
 
   // Send it
-  for (std::map<Ptr<Socket>, Ipv6InterfaceAddress>::const_iterator i =
-         m_socketAddresses.begin (); i != m_socketAddresses.end (); i++)
+  socket->SendTo (packet, 0, Inet6SocketAddress (destination, OLSR6_PORT_NUMBER));
+}
+
+void
+RoutingProtocol::SendQueuedMessages ()
+{
+  NS_LOG_DEBUG ("Olsr6 node " << m_mainAddress << ": SendQueuedMessages");
+
+  Time now = Simulator::Now ();
+  for (std::map<Ipv6Address, Time>::iterator it = m_compressionNeighbors.begin ();
+       it != m_compressionNeighbors.end (); )
     {
-      Ipv6Address bcast = Ipv6Address (OLSR6_MCAST_GLOBAL);
-      i->first->SendTo (packet, 0, Inet6SocketAddress (OLSR6_MCAST_GLOBAL, OLSR6_PORT_NUMBER));
+      if (it->second < now)
+        {
+          m_compressionNeighbors.erase (it++);
+        }
+      else
+        {
+          it++;
+        }
     }
+
+  // Each interface gets the messages sent on all interfaces and its own ones,
+  // in the order they were queued
+  for (std::map<Ptr<Socket>, Ipv6InterfaceAddress>::const_iterator socket =
+         m_socketAddresses.begin (); socket != m_socketAddresses.end (); socket++)
+    {
+      Ipv6Address ifaceAddr = socket->second.GetAddress ();
+      Ptr<Packet> packet = Create<Packet> ();
+      int numMessages = 0;
+      // The messages are encoded again for each interface, whatever the
+      // encoding they were received with
+      bool compression = m_compressedMessages && CanCompress (ifaceAddr);
+
+      MessageList msglist;
+
+      for (uint32_t i = 0; i < m_queuedMessages.size (); i++)
+        {
+          if (m_queuedMessageIfaces[i] != Ipv6Address::GetAny () && m_queuedMessageIfaces[i] != ifaceAddr)
+            {
+              continue;
+            }
+          olsr6::MessageHeader message = m_queuedMessages[i];
+          message.SetCompression (compression);
+          Ptr<Packet> p = Create<Packet> ();
+          p->AddHeader (message);
+          packet->AddAtEnd (p);
+          msglist.push_back (message);
+          if (++numMessages == OLSR6_MAX_MSGS)
+            {
+              Ipv6Address destination;
+              if (GetPacketDestination (ifaceAddr, msglist, destination))
+                {
+                  SendPacket (packet, msglist, socket->first, destination);
+                }
+              msglist.clear ();
+              // Reset variables for next packet
+              numMessages = 0;
+              packet = Create<Packet> ();
+            }
+        }
+
+      Ipv6Address destination;
+      if (packet->GetSize () && GetPacketDestination (ifaceAddr, msglist, destination))
+        {
+          SendPacket (packet, msglist, socket->first, destination);
+        }
+    }
+
+  m_queuedMessages.clear ();
+  m_queuedMessageIfaces.clear ();
 }
 
 void
-RoutingProtocol::SendQueuedMessages ()
+RoutingProtocol::SignPacket (Ptr<Packet> packet)
 {
-  Ptr<Packet> packet = Create<Packet> ();
-  int numMessages = 0;
+  std::map<uint8_t, HmacSha256>::const_iterator key = m_authenticationKeys.find (m_authenticationKeyId);
+  NS_ASSERT (key != m_authenticationKeys.end ());
+
+  // The ICV ends the packet, and is computed while it is still zero
+  uint32_t size = packet->GetSize ();
+  std::vector<uint8_t> bytes (size);
+  packet->CopyData (&bytes[0], size);
+  uint8_t icv[HmacSha256::ICV_SIZE];
+  key->second.Compute (&bytes[0], size, icv);
+  packet->RemoveAtEnd (HmacSha256::ICV_SIZE);
+  packet->AddAtEnd (Create<Packet> (icv, HmacSha256::ICV_SIZE));
+}
 
-  NS_LOG_DEBUG ("Olsr6 node " << m_mainAddress << ": SendQueuedMessages");
+bool
+RoutingProtocol::AuthenticatePacket (Ptr<const Packet> packet, const PacketHeader &header,
+                                     const MessageHeader &signature)
+{
+  if (signature.GetMessageType () != MessageHeader::SIGNATURE_MESSAGE)
+    {
+      NS_LOG_LOGIC ("The packet is not signed");
+      return false;
+    }
+  std::map<uint8_t, HmacSha256>::const_iterator key =
+    m_authenticationKeys.find (signature.GetSignature ().keyId);
+  if (key == m_authenticationKeys.end ())
+    {
+      NS_LOG_LOGIC ("Unknown key " << int (signature.GetSignature ().keyId));
+      return false;
+    }
+
+  // The packet is checked as a whole, once, before any of its messages is
+  // processed; the ICV was computed with zeros in its place
+  uint32_t size = header.GetPacketLength ();
+  if (packet->GetSize () < size)
+    {
+      return false;
+    }
+  std::vector<uint8_t> bytes (size);
+  packet->CopyData (&bytes[0], size);
+  std::fill (bytes.end () - HmacSha256::ICV_SIZE, bytes.end (), 0);
+  if (!key->second.Verify (&bytes[0], size, signature.GetSignature ().icv))
+    {
+      NS_LOG_LOGIC ("Wrong ICV");
+      return false;
+    }
+
+  // The originator of the signature is authenticated with the packet, so
+  // that a replay cannot pass for another node
+  Time now = Simulator::Now ();
+  Ipv6Address signer = signature.GetOriginatorAddress ();
+  std::map<Ipv6Address, ReplayWindow>::iterator window = m_replayWindows.find (signer);
+  if (window == m_replayWindows.end ())
+    {
+      for (std::map<Ipv6Address, ReplayWindow>::iterator it = m_replayWindows.begin ();
+           it != m_replayWindows.end (); )
+        {
+          if (it->second.IsExpired (now))
+            {
+              m_replayWindows.erase (it++);
+            }
+          else
+            {
+              it++;
+            }
+        }
+      window = m_replayWindows.insert (std::make_pair (signer, ReplayWindow ())).first;
+    }
+  if (!window->second.Accept (header.GetPacketSequenceNumber (), now, OLSR6_NEIGHB_HOLD_TIME))
+    {
+      NS_LOG_LOGIC ("Packet " << header.GetPacketSequenceNumber () << " of " << signer << " replayed");
+      return false;
+    }
+  return true;
+}
+
+void
+RoutingProtocol::AddAuthenticationKey (uint8_t keyId, std::string key)
+{
+  m_authenticationKeys[keyId] = HmacSha256 (key);
+}
 
-  MessageList msglist;
+bool
+RoutingProtocol::GetPacketDestination (const Ipv6Address &ifaceAddr, const MessageList &messages,
+                                       Ipv6Address &destination) const
+{
+  destination = Ipv6Address (OLSR6_MCAST_GLOBAL);
+  if (!m_unicastRelay)
+    {
+      return true;
+    }
 
-  for (std::vector<olsr6::MessageHeader>::const_iterator message = m_queuedMessages.begin ();
-       message != m_queuedMessages.end ();
-       message++)
+  // The HELLO messages are for every node of the link, symmetric neighbor or not
+  for (MessageList::const_iterator it = messages.begin (); it != messages.end (); it++)
     {
-      Ptr<Packet> p = Create<Packet> ();
-      p->AddHeader (*message);
-      packet->AddAtEnd (p);
-      msglist.push_back (*message);
-      if (++numMessages == OLSR6_MAX_MSGS)
+      if (it->GetMessageType () == olsr6::MessageHeader::HELLO_MESSAGE)
         {
-          SendPacket (packet, msglist);
-          msglist.clear ();
-          // Reset variables for next packet
-          numMessages = 0;
-          packet = Create<Packet> ();
+          return true;
         }
     }
 
-  if (packet->GetSize ())
+  Time now = Simulator::Now ();
+  uint32_t neighbors = 0;
+  const LinkSet &linkSet = m_state.GetLinks ();
+  for (LinkSet::const_iterator link = linkSet.begin (); link != linkSet.end (); link++)
+    {
+      if (link->localIfaceAddr == ifaceAddr && link->symTime >= now)
+        {
+          neighbors++;
+          destination = link->neighborIfaceAddr;
+        }
+    }
+  if (neighbors == 0)
+    {
+      NS_LOG_LOGIC ("OLSR6 node " << m_mainAddress << " has no symmetric neighbor on "
+                                  << ifaceAddr << ", packet not sent");
+      return false;
+    }
+  if (neighbors > 1)
     {
-      SendPacket (packet, msglist);
+      destination = Ipv6Address (OLSR6_MCAST_GLOBAL);
     }
+  return true;
+}
 
-  m_queuedMessages.clear ();
+bool
+RoutingProtocol::CanCompress (const Ipv6Address &ifaceAddr) const
+{
+  Time now = Simulator::Now ();
+  bool links = false;
+  const LinkSet &linkSet = m_state.GetLinks ();
+  for (LinkSet::const_iterator link = linkSet.begin (); link != linkSet.end (); link++)
+    {
+      if (link->localIfaceAddr != ifaceAddr || link->time < now)
+        {
+          continue;
+        }
+      std::map<Ipv6Address, Time>::const_iterator neighbor = m_compressionNeighbors.find (link->neighborIfaceAddr);
+      if (neighbor == m_compressionNeighbors.end () || neighbor->second < now)
+        {
+          return false;
+        }
+      links = true;
+    }
+  return links;
 }
 
 void
@@ -1660,107 +3069,172 @@ RoutingProtocol::SendHello ()
 {
   NS_LOG_FUNCTION (this);
 
-  olsr6::MessageHeader msg;
   Time now = Simulator::Now ();
 
-  msg.SetVTime (OLSR6_NEIGHB_HOLD_TIME);
-  msg.SetOriginatorAddress (m_mainAddress);
-  msg.SetTimeToLive (1);
-  msg.SetHopCount (0);
-  msg.SetMessageSequenceNumber (GetMessageSequenceNumber ());
-  olsr6::MessageHeader::Hello &hello = msg.GetHello ();
+  for (std::map<Ptr<Socket>, Ipv6InterfaceAddress>::const_iterator socket =
+         m_socketAddresses.begin (); socket != m_socketAddresses.end (); socket++)
+    {
+      Ipv6Address ifaceAddr = socket->second.GetAddress ();
 
-  hello.SetHTime (m_helloInterval);
-  hello.willingness = m_willingness;
+      olsr6::MessageHeader msg;
 
-  std::vector<olsr6::MessageHeader::Hello::LinkMessage>
-  &linkMessages = hello.linkMessages;
+      msg.SetVTime (OLSR6_NEIGHB_HOLD_TIME);
+      msg.SetOriginatorAddress (m_mainAddress);
+      msg.SetTimeToLive (1);
+      msg.SetHopCount (0);
+      msg.SetMessageSequenceNumber (GetMessageSequenceNumber ());
+      olsr6::MessageHeader::Hello &hello = msg.GetHello ();
 
-  const LinkSet &links = m_state.GetLinks ();
-  for (LinkSet::const_iterator link_tuple = links.begin ();
-       link_tuple != links.end (); link_tuple++)
-    {
-      if (!(GetMainAddress (link_tuple->localIfaceAddr) == m_mainAddress
-            && link_tuple->time >= now))
-        {
-          continue;
-        }
+      hello.SetHTime (OLSR6_HELLO_INTERVAL);
+      hello.willingness = GetWillingness ();
+      hello.compression = m_compressedMessages;
 
-      uint8_t link_type, nb_type = 0xff;
+      std::vector<olsr6::MessageHeader::Hello::LinkMessage>
+      &linkMessages = hello.linkMessages;
 
-      // Establishes link type
-      if (link_tuple->symTime >= now)
-        {
-          link_type = OLSR6_SYM_LINK;
-        }
-      else if (link_tuple->asymTime >= now)
-        {
-          link_type = OLSR6_ASYM_LINK;
-        }
-      else
-        {
-          link_type = OLSR6_LOST_LINK;
-        }
-      // Establishes neighbor type.
-      if (m_state.FindMprAddress (GetMainAddress (link_tuple->neighborIfaceAddr)))
-        {
-          nb_type = OLSR6_MPR_NEIGH;
-          NS_LOG_DEBUG ("I consider neighbor " << GetMainAddress (link_tuple->neighborIfaceAddr)
-                                               << " to be MPR_NEIGH.");
-        }
-      else
+      // The neighbors with a link still valid on this interface
+      std::set<Ipv6Address> interfaceNeighbors;
+
+      const LinkSet &links = m_state.GetLinks ();
+      for (LinkSet::const_iterator link_tuple = links.begin ();
+           link_tuple != links.end (); link_tuple++)
         {
-          bool ok = false;
-          for (NeighborSet::const_iterator nb_tuple = m_state.GetNeighbors ().begin ();
-               nb_tuple != m_state.GetNeighbors ().end ();
-               nb_tuple++)
+          if (link_tuple->localIfaceAddr != ifaceAddr)
             {
-              if (nb_tuple->neighborMainAddr == GetMainAddress (link_tuple->neighborIfaceAddr))
-                {
-                  if (nb_tuple->status == NeighborTuple::STATUS_SYM)
-                    {
-                      NS_LOG_DEBUG ("I consider neighbor " << GetMainAddress (link_tuple->neighborIfaceAddr)
-                                                           << " to be SYM_NEIGH.");
-                      nb_type = OLSR6_SYM_NEIGH;
-                    }
-                  else if (nb_tuple->status == NeighborTuple::STATUS_NOT_SYM)
-                    {
-                      nb_type = OLSR6_NOT_NEIGH;
-                      NS_LOG_DEBUG ("I consider neighbor " << GetMainAddress (link_tuple->neighborIfaceAddr)
-                                                           << " to be NOT_NEIGH.");
-                    }
-                  else
-                    {
-                      NS_FATAL_ERROR ("There is a neighbor tuple with an unknown status!\n");
-                    }
-                  ok = true;
-                  break;
-                }
+              continue;
+            }
+          if (link_tuple->time < now)
+            {
+              continue;
+            }
+          interfaceNeighbors.insert (GetMainAddress (link_tuple->neighborIfaceAddr));
+
+          uint8_t link_type, nb_type = 0xff;
+
+          // Establishes link type
+          if (m_linkHysteresis && link_tuple->lostTime >= now)
+            {
+              link_type = OLSR6_LOST_LINK;
+            }
+          else if (m_linkHysteresis && link_tuple->pending)
+            {
+              // Not considered as a link yet
+              continue;
             }
-          if (!ok)
+          else if (link_tuple->symTime >= now)
+            {
+              link_type = OLSR6_SYM_LINK;
+            }
+          else if (link_tuple->asymTime >= now)
+            {
+              link_type = OLSR6_ASYM_LINK;
+            }
+          else
+            {
+              link_type = OLSR6_LOST_LINK;
+            }
+          // Establishes neighbor type.
+          if (!GetNeighborType (GetMainAddress (link_tuple->neighborIfaceAddr), nb_type))
             {
-              NS_LOG_WARN ("I don't know the neighbor " << GetMainAddress (link_tuple->neighborIfaceAddr) << "!!!");
               continue;
             }
+
+          olsr6::MessageHeader::Hello::LinkMessage linkMessage;
+          linkMessage.linkCode = (link_type & 0x03) | ((nb_type << 2) & 0x0f);
+          linkMessage.neighborInterfaceAddresses.push_back
+            (link_tuple->neighborIfaceAddr);
+
+          std::vector<Ipv6Address> interfaces =
+            m_state.FindNeighborInterfaces (link_tuple->neighborIfaceAddr);
+
+          linkMessage.neighborInterfaceAddresses.insert
+            (linkMessage.neighborInterfaceAddresses.end (),
+            interfaces.begin (), interfaces.end ());
+
+          if (m_linkMetric == OLSR6_METRIC_ETX)
+            {
+              olsr6::MessageHeader::LinkQuality quality;
+              quality.lq = OLSR6_QUANTIZE_LQ (link_tuple->lq);
+              quality.nlq = OLSR6_QUANTIZE_LQ (link_tuple->nlq);
+              linkMessage.linkQualities.assign (linkMessage.neighborInterfaceAddresses.size (), quality);
+            }
+
+          linkMessages.push_back (linkMessage);
         }
 
-      olsr6::MessageHeader::Hello::LinkMessage linkMessage;
-      linkMessage.linkCode = (link_type & 0x03) | ((nb_type << 2) & 0x0f);
-      linkMessage.neighborInterfaceAddresses.push_back
-        (link_tuple->neighborIfaceAddr);
+      // The neighbors reached through other interfaces only are advertised
+      // by their main address, so that the 2-hop neighbors still learn them
+      for (NeighborSet::const_iterator nb_tuple = m_state.GetNeighbors ().begin ();
+           nb_tuple != m_state.GetNeighbors ().end (); nb_tuple++)
+        {
+          uint8_t nb_type;
+          if (interfaceNeighbors.find (nb_tuple->neighborMainAddr) != interfaceNeighbors.end ()
+              || !GetNeighborType (nb_tuple->neighborMainAddr, nb_type))
+            {
+              continue;
+            }
+
+          olsr6::MessageHeader::Hello::LinkMessage linkMessage;
+          linkMessage.linkCode = (OLSR6_UNSPEC_LINK & 0x03) | ((nb_type << 2) & 0x0f);
+          linkMessage.neighborInterfaceAddresses.push_back (nb_tuple->neighborMainAddr);
 
-      std::vector<Ipv6Address> interfaces =
-        m_state.FindNeighborInterfaces (link_tuple->neighborIfaceAddr);
+          if (m_linkMetric == OLSR6_METRIC_ETX)
+            {
+              olsr6::MessageHeader::LinkQuality quality;
+              const LinkTuple *link_tuple = FindBestLink (nb_tuple->neighborMainAddr);
+              quality.lq = OLSR6_QUANTIZE_LQ (link_tuple == NULL ? 0 : link_tuple->lq);
+              quality.nlq = OLSR6_QUANTIZE_LQ (link_tuple == NULL ? 0 : link_tuple->nlq);
+              linkMessage.linkQualities.push_back (quality);
+            }
 
-      linkMessage.neighborInterfaceAddresses.insert
-        (linkMessage.neighborInterfaceAddresses.end (),
-        interfaces.begin (), interfaces.end ());
+          linkMessages.push_back (linkMessage);
+        }
 
-      linkMessages.push_back (linkMessage);
+      NS_LOG_DEBUG ("OLSR6 HELLO message size on " << ifaceAddr << ": " << int (msg.GetSerializedSize ())
+                                                   << " (with " << int (linkMessages.size ()) << " link messages)");
+      QueueMessage (msg, JITTER, ifaceAddr);
     }
-  NS_LOG_DEBUG ("OLSR6 HELLO message size: " << int (msg.GetSerializedSize ())
-                                             << " (with " << int (linkMessages.size ()) << " link messages)");
-  QueueMessage (msg, JITTER);
+}
+
+bool
+RoutingProtocol::GetNeighborType (const Ipv6Address &neighborMainAddr, uint8_t &nb_type)
+{
+  if (m_state.FindMprAddress (neighborMainAddr))
+    {
+      nb_type = OLSR6_MPR_NEIGH;
+      NS_LOG_DEBUG ("I consider neighbor " << neighborMainAddr
+                                           << " to be MPR_NEIGH.");
+      return true;
+    }
+
+  for (NeighborSet::const_iterator nb_tuple = m_state.GetNeighbors ().begin ();
+       nb_tuple != m_state.GetNeighbors ().end ();
+       nb_tuple++)
+    {
+      if (nb_tuple->neighborMainAddr == neighborMainAddr)
+        {
+          if (nb_tuple->status == NeighborTuple::STATUS_SYM)
+            {
+              NS_LOG_DEBUG ("I consider neighbor " << neighborMainAddr
+                                                   << " to be SYM_NEIGH.");
+              nb_type = OLSR6_SYM_NEIGH;
+            }
+          else if (nb_tuple->status == NeighborTuple::STATUS_NOT_SYM)
+            {
+              nb_type = OLSR6_NOT_NEIGH;
+              NS_LOG_DEBUG ("I consider neighbor " << neighborMainAddr
+                                                   << " to be NOT_NEIGH.");
+            }
+          else
+            {
+              NS_FATAL_ERROR ("There is a neighbor tuple with an unknown status!\n");
+            }
+          return true;
+        }
+    }
+
+  NS_LOG_WARN ("I don't know the neighbor " << neighborMainAddr << "!!!");
+  return false;
 }
 
 void
@@ -1769,22 +3243,141 @@ RoutingProtocol::SendTc ()
   NS_LOG_FUNCTION (this);
 
   olsr6::MessageHeader msg;
+  m_lastTcTime = Simulator::Now ();
 
-  msg.SetVTime (OLSR6_TOP_HOLD_TIME);
+  SetTcScope (msg);
   msg.SetOriginatorAddress (m_mainAddress);
-  msg.SetTimeToLive (255);
   msg.SetHopCount (0);
   msg.SetMessageSequenceNumber (GetMessageSequenceNumber ());
 
+  std::vector<Ipv6Address> advertised = GetAdvertisedNeighbors ();
+  if (m_tcRedundancy > 0)
+    {
+      // The ANSN is only incremented when the MPR selectors or the
+      // neighbors come and go, while the advertised set also follows the
+      // MPR Set and the neighbor status
+      std::set<Ipv6Address> current (advertised.begin (), advertised.end ());
+      if (current != m_advertisedNeighbors)
+        {
+          IncrementAnsn ();
+          m_advertisedNeighbors = current;
+        }
+    }
+
+  // The differential TCs carry no link quality
+  if (m_differentialTc && m_linkMetric != OLSR6_METRIC_ETX && m_tcsSinceFullTc + 1 < m_fullTcRefresh)
+    {
+      std::vector<Ipv6Address> added;
+      std::vector<Ipv6Address> removed;
+      std::set<Ipv6Address> current (advertised.begin (), advertised.end ());
+      std::set_difference (current.begin (), current.end (),
+                           m_fullTcAddresses.begin (), m_fullTcAddresses.end (),
+                           std::back_inserter (added));
+      std::set_difference (m_fullTcAddresses.begin (), m_fullTcAddresses.end (),
+                           current.begin (), current.end (),
+                           std::back_inserter (removed));
+      // A differential TC is only worth it while it is the smaller one
+      if (added.size () + removed.size () < advertised.size ())
+        {
+          olsr6::MessageHeader::DiffTc &diffTc = msg.GetDiffTc ();
+          diffTc.ansn = m_ansn;
+          diffTc.baseAnsn = m_fullTcAnsn;
+          diffTc.addedAddresses = added;
+          diffTc.removedAddresses = removed;
+          m_tcsSinceFullTc++;
+          QueueMessage (msg, JITTER);
+          return;
+        }
+    }
+
   olsr6::MessageHeader::Tc &tc = msg.GetTc ();
   tc.ansn = m_ansn;
+  tc.neighborAddresses = advertised;
+  if (m_linkMetric == OLSR6_METRIC_ETX)
+    {
+      for (std::vector<Ipv6Address>::const_iterator it = advertised.begin (); it != advertised.end (); it++)
+        {
+          const LinkTuple *link = FindBestLink (*it);
+          olsr6::MessageHeader::LinkQuality quality;
+          quality.lq = link != NULL ? OLSR6_QUANTIZE_LQ (link->lq) : 0;
+          quality.nlq = link != NULL ? OLSR6_QUANTIZE_LQ (link->nlq) : 0;
+          tc.linkQualities.push_back (quality);
+        }
+    }
+
+  if (m_differentialTc)
+    {
+      m_tcsSinceFullTc = 0;
+      m_fullTcAnsn = m_ansn;
+      m_fullTcAddresses = std::set<Ipv6Address> (advertised.begin (), advertised.end ());
+      if (!m_fisheyeTtl.empty ())
+        {
+          // The differential TCs apply to this one: it must reach every
+          // node they reach, and its links are held until the next one
+          msg.SetTimeToLive (255);
+          msg.SetVTime (std::max (msg.GetVTime (), Seconds (m_fullTcRefresh * OLSR6_TOP_HOLD_TIME.GetSeconds ())));
+        }
+    }
+  QueueMessage (msg, JITTER);
+}
 
+std::vector<Ipv6Address>
+RoutingProtocol::GetAdvertisedNeighbors () const
+{
+  std::vector<Ipv6Address> advertised;
   for (MprSelectorSet::const_iterator mprsel_tuple = m_state.GetMprSelectors ().begin ();
        mprsel_tuple != m_state.GetMprSelectors ().end (); mprsel_tuple++)
     {
-      tc.neighborAddresses.push_back (mprsel_tuple->mainAddr);
+      advertised.push_back (mprsel_tuple->mainAddr);
     }
-  QueueMessage (msg, JITTER);
+  if (m_tcRedundancy == 0)
+    {
+      return advertised;
+    }
+
+  std::set<Ipv6Address> neighbors (advertised.begin (), advertised.end ());
+  if (m_tcRedundancy == 1)
+    {
+      neighbors.insert (m_state.GetMprSet ().begin (), m_state.GetMprSet ().end ());
+    }
+  else
+    {
+      for (NeighborSet::const_iterator nb_tuple = m_state.GetNeighbors ().begin ();
+           nb_tuple != m_state.GetNeighbors ().end (); nb_tuple++)
+        {
+          if (nb_tuple->status == NeighborTuple::STATUS_SYM)
+            {
+              neighbors.insert (nb_tuple->neighborMainAddr);
+            }
+        }
+    }
+  return std::vector<Ipv6Address> (neighbors.begin (), neighbors.end ());
+}
+
+void
+RoutingProtocol::SetTcScope (olsr6::MessageHeader &msg)
+{
+  if (m_fisheyeTtl.empty ())
+    {
+      msg.SetVTime (OLSR6_TOP_HOLD_TIME);
+      msg.SetTimeToLive (255);
+      return;
+    }
+
+  uint8_t ttl = m_fisheyeTtl[m_fisheyeIndex];
+  m_fisheyeIndex = (m_fisheyeIndex + 1) % m_fisheyeTtl.size ();
+
+  // A node reached by this TC is reached again, at the latest, by the
+  // next TC whose TTL is at least this one
+  uint32_t nIntervals = 1;
+  while (m_fisheyeTtl[(m_fisheyeIndex + nIntervals - 1) % m_fisheyeTtl.size ()] < ttl)
+    {
+      nIntervals++;
+    }
+  NS_LOG_LOGIC ("TC with TTL " << (uint32_t) ttl << " held " << nIntervals << " TC intervals");
+
+  msg.SetVTime (Seconds (nIntervals * OLSR6_TOP_HOLD_TIME.GetSeconds ()));
+  msg.SetTimeToLive (ttl);
 }
 
 void
@@ -1815,7 +3408,8 @@ RoutingProtocol::SendMid ()
       for (uint32_t j = 0; j < m_ipv6->GetNAddresses (i); j++)
         {
           Ipv6Address addr = m_ipv6->GetAddress (i, j).GetAddress ();
-          if (addr != m_mainAddress && addr != loopback && m_interfaceExclusions.find (i) == m_interfaceExclusions.end () && m_ipv6->GetAddress (i, j).GetScope () == Ipv6InterfaceAddress::GLOBAL)
+          if (addr != m_mainAddress && addr != loopback && m_interfaceExclusions.find (i) == m_interfaceExclusions.end () && m_ipv6->GetAddress (i, j).GetScope () == Ipv6InterfaceAddress::GLOBAL
+              && m_ipv6->IsUp (i))
             {
               mid.interfaceAddresses.push_back (addr);
             }
@@ -1847,11 +3441,14 @@ RoutingProtocol::SendHna ()
   msg.SetHopCount (0);
   msg.SetMessageSequenceNumber (GetMessageSequenceNumber ());
   olsr6::MessageHeader::Hna &hna = msg.GetHna ();
+  hna.capacity = m_gatewayCapacity;
+  hna.load = m_gatewayLoad;
 
   std::vector<olsr6::MessageHeader::Hna::Association> &associations = hna.associations;
 
   // Add all local HNA associations to the HNA message
-  const Associations &localHnaAssociations = m_state.GetAssociations ();
+  Associations localHnaAssociations = m_hnaAggregation ? m_state.GetAggregatedAssociations ()
+    : m_state.GetAssociations ();
   for (Associations::const_iterator it = localHnaAssociations.begin ();
        it != localHnaAssociations.end (); it++)
     {
@@ -1973,6 +3570,12 @@ RoutingProtocol::LinkSensing (const olsr6::MessageHeader &msg,
       newLinkTuple.localIfaceAddr = receiverIface;
       newLinkTuple.symTime = now - Seconds (1);
       newLinkTuple.time = now + msg.GetVTime ();
+      if (m_linkHysteresis)
+        {
+          // A new link is not considered until its quality is high enough
+          newLinkTuple.quality = 0;
+          newLinkTuple.pending = true;
+        }
       link_tuple = &m_state.InsertLinkTuple (newLinkTuple);
       created = true;
       NS_LOG_LOGIC ("Existing link tuple did not exist => creating new one");
@@ -1983,6 +3586,26 @@ RoutingProtocol::LinkSensing (const olsr6::MessageHeader &msg,
       updated = true;
     }
 
+  if (m_linkHysteresis || m_linkMetric == OLSR6_METRIC_ETX)
+    {
+      bool first = link_tuple->helloInterval.IsZero ();
+      link_tuple->helloInterval = hello.GetHTime ();
+      // The HELLO emissions are jittered, hence the margin
+      link_tuple->helloDeadline = now + Seconds (1.5 * link_tuple->helloInterval.GetSeconds ());
+      if (m_linkHysteresis)
+        {
+          UpdateLinkQuality (*link_tuple, true);
+        }
+      if (m_linkMetric == OLSR6_METRIC_ETX)
+        {
+          UpdateEtx (*link_tuple, true);
+        }
+      if (first)
+        {
+          ScheduleLinkQualityTimer (*link_tuple);
+        }
+    }
+
   link_tuple->asymTime = now + msg.GetVTime ();
   for (std::vector<olsr6::MessageHeader::Hello::LinkMessage>::const_iterator linkMessage =
          hello.linkMessages.begin ();
@@ -2052,12 +3675,22 @@ RoutingProtocol::LinkSensing (const olsr6::MessageHeader &msg,
           NS_LOG_DEBUG ("   -> Neighbor: " << *neighIfaceAddr);
           if (*neighIfaceAddr == receiverIface)
             {
+              if (m_linkMetric == OLSR6_METRIC_ETX && !linkMessage->linkQualities.empty ())
+                {
+                  // The neighbor measures how many of our HELLOs it receives
+                  uint32_t index = neighIfaceAddr - linkMessage->neighborInterfaceAddresses.begin ();
+                  link_tuple->nlq = linkMessage->linkQualities[index].lq / 255.0;
+                }
               if (lt == OLSR6_LOST_LINK)
                 {
                   NS_LOG_LOGIC ("link is LOST => expiring it");
                   link_tuple->symTime = now - Seconds (1);
                   updated = true;
                 }
+              else if (m_linkHysteresis && link_tuple->pending)
+                {
+                  NS_LOG_LOGIC ("link is pending => ignoring it until its quality is high enough");
+                }
               else if (lt == OLSR6_SYM_LINK || lt == OLSR6_ASYM_LINK)
                 {
                   NS_LOG_DEBUG (*link_tuple << ": link is SYM or ASYM => should become SYM now"
@@ -2091,9 +3724,8 @@ RoutingProtocol::LinkSensing (const olsr6::MessageHeader &msg,
   if (created)
     {
       LinkTupleAdded (*link_tuple, hello.willingness);
-      m_events.Track (Simulator::Schedule (DELAY (std::min (link_tuple->time, link_tuple->symTime)),
-                                           &RoutingProtocol::LinkTupleTimerExpire, this,
-                                           link_tuple->neighborIfaceAddr));
+      ScheduleLinkTupleTimer (link_tuple->neighborIfaceAddr,
+                              std::min (link_tuple->time, link_tuple->symTime));
     }
   NS_LOG_DEBUG ("@" << now.GetSeconds () << ": Olsr6 node " << m_mainAddress
                     << ": LinkSensing END");
@@ -2158,6 +3790,13 @@ RoutingProtocol::PopulateTwoHopNeighborSet (const olsr6::MessageHeader &msg,
                nb2hop_addr_iter++)
             {
               Ipv6Address nb2hop_addr = GetMainAddress (*nb2hop_addr_iter);
+              double cost = 1.0;
+              if (!linkMessage->linkQualities.empty ())
+                {
+                  const olsr6::MessageHeader::LinkQuality &quality =
+                    linkMessage->linkQualities[nb2hop_addr_iter - linkMessage->neighborInterfaceAddresses.begin ()];
+                  cost = OLSR6_ETX (quality.lq / 255.0, quality.nlq / 255.0);
+                }
               NS_LOG_DEBUG ("Looking at 2-hop neighbor address from HELLO message: "
                             << *nb2hop_addr_iter
                             << " (main address is " << nb2hop_addr << ")");
@@ -2183,6 +3822,7 @@ RoutingProtocol::PopulateTwoHopNeighborSet (const olsr6::MessageHeader &msg,
                       new_nb2hop_tuple.neighborMainAddr = msg.GetOriginatorAddress ();
                       new_nb2hop_tuple.twoHopNeighborAddr = nb2hop_addr;
                       new_nb2hop_tuple.expirationTime = now + msg.GetVTime ();
+                      new_nb2hop_tuple.cost = cost;
                       AddTwoHopNeighborTuple (new_nb2hop_tuple);
                       // Schedules nb2hop tuple deletion
                       m_events.Track (Simulator::Schedule (DELAY (new_nb2hop_tuple.expirationTime),
@@ -2193,6 +3833,7 @@ RoutingProtocol::PopulateTwoHopNeighborSet (const olsr6::MessageHeader &msg,
                   else
                     {
                       nb2hop_tuple->expirationTime = now + msg.GetVTime ();
+                      nb2hop_tuple->cost = cost;
                     }
                 }
               else if (neighborType == OLSR6_NOT_NEIGH)
@@ -2273,42 +3914,72 @@ RoutingProtocol::PopulateMprSelectorSet (const olsr6::MessageHeader &msg,
 }
 
 
-#if 0
-///
-/// \brief Drops a given packet because it couldn't be delivered to the corresponding
-/// destination by the MAC layer. This may cause a neighbor loss, and appropriate
-/// actions are then taken.
-///
-/// \param p the packet which couldn't be delivered by the MAC layer.
-///
 void
-OLSR6::mac_failed (Ptr<Packet> p)
+RoutingProtocol::NotifyLinkFailure (Ipv6Address neighborIfaceAddr)
 {
-  double now              = Simulator::Now ();
-  struct hdr_ip* ih       = HDR_IP (p);
-  struct hdr_cmn* ch      = HDR_CMN (p);
+  Time now = Simulator::Now ();
 
-  debug ("%f: Node %d MAC Layer detects a breakage on link to %d\n",
-         now,
-         OLSR6::node_id (ra_addr ()),
-         OLSR6::node_id (ch->next_hop ()));
+  LinkTuple *link_tuple = m_state.FindLinkTuple (neighborIfaceAddr);
+  if (link_tuple == NULL || link_tuple->symTime < now)
+    {
+      return;
+    }
+  NS_LOG_DEBUG (now.GetSeconds () << "s: OLSR6 Node " << m_mainAddress
+                                  << " link layer detects a breakage on link to " << neighborIfaceAddr);
+
+  // The link is held as lost for NEIGHB_HOLD_TIME, then removed unless a
+  // HELLO establishes it again
+  link_tuple->symTime = now - Seconds (1);
+  link_tuple->lostTime = now + OLSR6_NEIGHB_HOLD_TIME;
+  link_tuple->time = now + OLSR6_NEIGHB_HOLD_TIME;
+  if (m_linkHysteresis)
+    {
+      // The link has to prove its quality again
+      link_tuple->quality = 0;
+      link_tuple->pending = true;
+    }
+  // The pending timer was set for the former symmetric time and would
+  // report the neighbor loss a second time
+  ScheduleLinkTupleTimer (neighborIfaceAddr, link_tuple->time);
+  NeighborLoss (*link_tuple);
+}
 
-  if ((u_int32_t)ih->daddr () == IP_BROADCAST)
+void
+RoutingProtocol::NotifyTxFailure (Ptr<NetDevice> device, Mac48Address neighbor)
+{
+  int32_t interface = m_ipv6->GetInterfaceForDevice (device);
+  Ptr<Icmpv6L4Protocol> icmpv6 = m_ipv6->GetObject<Icmpv6L4Protocol> ();
+  if (interface < 0 || !icmpv6)
+    {
+      return;
+    }
+  Ptr<NdiscCache> cache = icmpv6->FindCache (device);
+  if (!cache)
     {
-      drop (p, DROP_RTR_MAC_CALLBACK);
       return;
     }
 
-  OLSR6_link_tuple* link_tuple = state_.find_link_tuple (ch->next_hop ());
-  if (link_tuple != NULL)
+  // A unicast frame was sent, so the neighbor cache knows the MAC address
+  // of the neighbor interface
+  std::vector<Ipv6Address> failed;
+  const LinkSet &links = m_state.GetLinks ();
+  for (LinkSet::const_iterator it = links.begin (); it != links.end (); it++)
     {
-      link_tuple->lost_time () = now + OLSR6_NEIGHB_HOLD_TIME;
-      link_tuple->time ()      = now + OLSR6_NEIGHB_HOLD_TIME;
-      nb_loss (link_tuple);
+      if (m_ipv6->GetInterfaceForAddress (it->localIfaceAddr) != interface)
+        {
+          continue;
+        }
+      NdiscCache::Entry *entry = cache->Lookup (it->neighborIfaceAddr);
+      if (entry != NULL && entry->GetMacAddress () == neighbor)
+        {
+          failed.push_back (it->neighborIfaceAddr);
+        }
+    }
+  for (std::vector<Ipv6Address>::const_iterator it = failed.begin (); it != failed.end (); it++)
+    {
+      NotifyLinkFailure (*it);
     }
-  drop (p, DROP_RTR_MAC_CALLBACK);
 }
-#endif
 
 
 
@@ -2321,10 +3992,23 @@ RoutingProtocol::NeighborLoss (const LinkTuple &tuple)
                 << " LinkTuple " << tuple.neighborIfaceAddr << " -> neighbor loss.");
   LinkTupleUpdated (tuple, OLSR6_WILL_DEFAULT);
   m_state.EraseTwoHopNeighborTuples (GetMainAddress (tuple.neighborIfaceAddr));
+  uint32_t nMprSelectors = m_state.GetMprSelectors ().size ();
   m_state.EraseMprSelectorTuples (GetMainAddress (tuple.neighborIfaceAddr));
+  if (m_state.GetMprSelectors ().size () != nMprSelectors)
+    {
+      MprSelectorSetChanged ();
+    }
 
   MprComputation ();
-  RoutingTableComputation ();
+  if (m_loopFreeAlternates)
+    {
+      // The next received message computes the whole routing table again
+      RepairRoutes (tuple.neighborIfaceAddr);
+    }
+  else
+    {
+      RoutingTableComputation ();
+    }
 }
 
 void
@@ -2357,6 +4041,7 @@ RoutingProtocol::LinkTupleAdded (const LinkTuple &tuple, uint8_t willingness)
     }
 
   AddNeighborTuple (nb_tuple);
+  LinkSetChanged ();
 }
 
 void
@@ -2366,8 +4051,11 @@ RoutingProtocol::RemoveLinkTuple (const LinkTuple &tuple)
                 << "s: OLSR6 Node " << m_mainAddress
                 << " LinkTuple " << tuple << " REMOVED.");
 
+  CancelLinkTupleTimer (tuple.neighborIfaceAddr);
+  CancelLinkQualityTimer (tuple.neighborIfaceAddr);
   m_state.EraseNeighborTuple (GetMainAddress (tuple.neighborIfaceAddr));
   m_state.EraseLinkTuple (tuple);
+  LinkSetChanged ();
 }
 
 void
@@ -2419,6 +4107,10 @@ RoutingProtocol::LinkTupleUpdated (const LinkTuple &tuple, uint8_t willingness)
           NS_LOG_DEBUG (*nb_tuple << "->status = STATUS_NOT_SYM; changed:"
                                   << int (statusBefore != nb_tuple->status));
         }
+      if (statusBefore != nb_tuple->status)
+        {
+          LinkSetChanged ();
+        }
     }
   else
     {
@@ -2463,6 +4155,7 @@ RoutingProtocol::AddMprSelectorTuple (const MprSelectorTuple  &tuple)
 {
   m_state.InsertMprSelectorTuple (tuple);
   IncrementAnsn ();
+  MprSelectorSetChanged ();
 }
 
 void
@@ -2470,6 +4163,7 @@ RoutingProtocol::RemoveMprSelectorTuple (const MprSelectorTuple &tuple)
 {
   m_state.EraseMprSelectorTuple (tuple);
   IncrementAnsn ();
+  MprSelectorSetChanged ();
 }
 
 void
@@ -2521,24 +4215,127 @@ uint16_t RoutingProtocol::GetMessageSequenceNumber ()
 }
 
 void
-RoutingProtocol::HelloTimerExpire ()
+RoutingProtocol::HelloTimerExpire ()
+{
+  if (m_adaptiveIntervals)
+    {
+      // Decided before sending, so that the HELLO advertises it
+      m_currentHelloInterval = NextAdaptiveInterval (m_currentHelloInterval, m_lastLinkSetChange,
+                                                     m_minHelloInterval, m_maxHelloInterval);
+    }
+  SendHello ();
+  m_helloTimer.Schedule (OLSR6_HELLO_INTERVAL);
+}
+
+void
+RoutingProtocol::TcTimerExpire ()
+{
+  if (m_adaptiveIntervals)
+    {
+      m_currentTcInterval = NextAdaptiveInterval (m_currentTcInterval, m_lastMprSelectorChange,
+                                                  m_minTcInterval, m_maxTcInterval);
+    }
+  if (m_state.GetMprSelectors ().size () > 0
+      || (m_tcRedundancy > 0 && !GetAdvertisedNeighbors ().empty ()))
+    {
+      // The periodic TC carries the pending changes
+      m_triggeredTcTimer.Cancel ();
+      SendTc ();
+    }
+  else
+    {
+      NS_LOG_DEBUG ("Not sending any TC, no one selected me as MPR.");
+    }
+  m_tcTimer.Schedule (OLSR6_TC_INTERVAL);
+}
+
+Time
+RoutingProtocol::NextAdaptiveInterval (Time interval, Time lastChange, Time floor, Time ceiling) const
+{
+  if (Simulator::Now () - lastChange < interval)
+    {
+      return floor;
+    }
+  return std::min (Time (2 * interval), ceiling);
+}
+
+void
+RoutingProtocol::ShortenInterval (Timer &timer, Time &interval, Time floor)
+{
+  interval = floor;
+  if (timer.IsRunning () && timer.GetDelayLeft () > floor)
+    {
+      timer.Cancel ();
+      timer.Schedule (floor);
+    }
+}
+
+void
+RoutingProtocol::LinkSetChanged ()
+{
+  if (m_adaptiveIntervals)
+    {
+      NS_LOG_LOGIC ("Link Set changed, HELLO interval back to " << m_minHelloInterval.GetSeconds () << "s");
+      m_lastLinkSetChange = Simulator::Now ();
+      ShortenInterval (m_helloTimer, m_currentHelloInterval, m_minHelloInterval);
+    }
+}
+
+void
+RoutingProtocol::MprSelectorSetChanged ()
 {
-  SendHello ();
-  m_helloTimer.Schedule (m_helloInterval);
+  if (m_adaptiveIntervals)
+    {
+      NS_LOG_LOGIC ("MPR Selector Set changed, TC interval back to " << m_minTcInterval.GetSeconds () << "s");
+      m_lastMprSelectorChange = Simulator::Now ();
+      ShortenInterval (m_tcTimer, m_currentTcInterval, m_minTcInterval);
+    }
+  if (m_triggeredTc)
+    {
+      TriggerTc ();
+    }
 }
 
 void
-RoutingProtocol::TcTimerExpire ()
+RoutingProtocol::TriggerTc ()
 {
-  if (m_state.GetMprSelectors ().size () > 0)
+  Time now = Simulator::Now ();
+  if (now >= m_triggeredTcWindowStart + m_triggeredTcHoldDown)
     {
-      SendTc ();
+      m_triggeredTcWindowStart = now;
+      m_triggeredTcBurst = 0;
+    }
+
+  if (m_triggeredTcTimer.IsRunning ())
+    {
+      NS_LOG_LOGIC ("MPR Selector Set changed, coalesced into the pending triggered TC");
+      m_suppressedTcCount++;
+    }
+  else if (m_triggeredTcBurst >= m_triggeredTcMaxBurst)
+    {
+      NS_LOG_LOGIC ("MPR Selector Set changed, triggered TC held down until "
+                    << (m_triggeredTcWindowStart + m_triggeredTcHoldDown).GetSeconds () << "s");
+      m_suppressedTcCount++;
     }
   else
     {
-      NS_LOG_DEBUG ("Not sending any TC, no one selected me as MPR.");
+      Time delay = std::max (m_lastTcTime + m_triggeredTcMinSpacing - now, Seconds (0));
+      NS_LOG_LOGIC ("MPR Selector Set changed, TC triggered in " << delay.GetSeconds () << "s");
+      m_triggeredTcBurst++;
+      m_triggeredTcTimer.Schedule (delay);
+      return;
     }
-  m_tcTimer.Schedule (m_tcInterval);
+  m_tcTriggerTrace (m_triggeredTcCount, m_suppressedTcCount);
+}
+
+void
+RoutingProtocol::TriggeredTcTimerExpire ()
+{
+  // Also sent when the set became empty, so that the other nodes forget
+  // the advertised links at once (RFC 3626, section 9.3)
+  m_triggeredTcCount++;
+  SendTc ();
+  m_tcTriggerTrace (m_triggeredTcCount, m_suppressedTcCount);
 }
 
 void
@@ -2562,6 +4359,129 @@ RoutingProtocol::HnaTimerExpire ()
   m_hnaTimer.Schedule (m_hnaInterval);
 }
 
+void
+RoutingProtocol::MemoryUsageTimerExpire ()
+{
+  m_memoryUsageTrace (GetMemoryUsage ());
+  m_memoryUsageTimer.Schedule (m_memoryUsageInterval);
+}
+
+double
+RoutingProtocol::GetLoad ()
+{
+  switch (m_willingnessLoadSignal)
+    {
+    case OLSR6_LOAD_FORWARDING:
+      {
+        double rate = m_forwardedPackets / m_willingnessUpdateInterval.GetSeconds ();
+        m_forwardedPackets = 0;
+        return rate / m_forwardingCapacity;
+      }
+    case OLSR6_LOAD_QUEUE:
+      {
+        // The most occupied queue, among the devices which expose theirs
+        double load = 0;
+        for (uint32_t i = 0; i < m_ipv6->GetNInterfaces (); i++)
+          {
+            if (m_interfaceExclusions.find (i) != m_interfaceExclusions.end ()
+                || !m_ipv6->IsUp (i))
+              {
+                continue;
+              }
+            PointerValue queueValue;
+            if (!m_ipv6->GetNetDevice (i)->GetAttributeFailSafe ("TxQueue", queueValue))
+              {
+                continue;
+              }
+            Ptr<Queue> queue = queueValue.Get<Queue> ();
+            UintegerValue maxPackets;
+            if (queue != 0 && queue->GetAttributeFailSafe ("MaxPackets", maxPackets)
+                && maxPackets.Get () > 0)
+              {
+                load = std::max (load, double (queue->GetNPackets ()) / maxPackets.Get ());
+              }
+          }
+        return load;
+      }
+    case OLSR6_LOAD_CALLBACK:
+      return m_willingnessLoadCallback ();
+    default:
+      return 0;
+    }
+}
+
+void
+RoutingProtocol::WillingnessTimerExpire ()
+{
+  // The levels the controller steps through, WILL_NEVER aside
+  static const uint8_t levels[] = { OLSR6_WILL_LOW, OLSR6_WILL_DEFAULT, OLSR6_WILL_HIGH, OLSR6_WILL_ALWAYS };
+  static const uint32_t nLevels = sizeof (levels) / sizeof (levels[0]);
+
+  Time now = Simulator::Now ();
+  double load = GetLoad ();
+  uint8_t willingness = m_advertisedWillingness;
+  if (load > m_willingnessLoadHigh)
+    {
+      // The highest level strictly below the current willingness, which
+      // need not be a level itself
+      for (uint32_t i = nLevels; i > 0; i--)
+        {
+          if (levels[i - 1] < m_advertisedWillingness)
+            {
+              willingness = levels[i - 1];
+              break;
+            }
+        }
+    }
+  if (load >= m_willingnessLoadLow)
+    {
+      m_lowLoadSince = now;
+    }
+  else if (now - m_lowLoadSince >= m_willingnessHoldTime)
+    {
+      for (uint32_t i = 0; i < nLevels; i++)
+        {
+          if (levels[i] > m_advertisedWillingness)
+            {
+              willingness = std::min (levels[i], m_willingness);
+              break;
+            }
+        }
+      // The next raise waits for another hold time
+      m_lowLoadSince = now;
+    }
+
+  NS_LOG_LOGIC ("Load " << load << ", willingness " << int (m_advertisedWillingness)
+                        << " -> " << int (willingness));
+  if (willingness != m_advertisedWillingness)
+    {
+      m_willingnessTrace (m_advertisedWillingness, willingness);
+      m_advertisedWillingness = willingness;
+      if (m_oracleMode)
+        {
+          // The oracle selects the MPRs from the willingness of the nodes
+          OracleTopology::Get ()->WillingnessChanged (this);
+        }
+    }
+  m_willingnessTimer.Schedule (m_willingnessUpdateInterval);
+}
+
+void
+RoutingProtocol::SetWillingnessLoadCallback (Callback<double> cb)
+{
+  m_willingnessLoadCallback = cb;
+}
+
+uint8_t
+RoutingProtocol::GetWillingness (void) const
+{
+  if (m_willingnessLoadSignal == OLSR6_LOAD_NONE || m_willingness == OLSR6_WILL_NEVER)
+    {
+      return m_willingness;
+    }
+  return std::min (m_advertisedWillingness, m_willingness);
+}
+
 void
 RoutingProtocol::DupTupleTimerExpire (Ipv6Address address, uint16_t sequenceNumber)
 {
@@ -2609,18 +4529,202 @@ RoutingProtocol::LinkTupleTimerExpire (Ipv6Address neighborIfaceAddr)
           NeighborLoss (*tuple);
         }
 
-      m_events.Track (Simulator::Schedule (DELAY (tuple->time),
-                                           &RoutingProtocol::LinkTupleTimerExpire, this,
-                                           neighborIfaceAddr));
+      ScheduleLinkTupleTimer (neighborIfaceAddr, tuple->time);
     }
   else
     {
-      m_events.Track (Simulator::Schedule (DELAY (std::min (tuple->time, tuple->symTime)),
-                                           &RoutingProtocol::LinkTupleTimerExpire, this,
-                                           neighborIfaceAddr));
+      ScheduleLinkTupleTimer (neighborIfaceAddr, std::min (tuple->time, tuple->symTime));
+    }
+}
+
+void
+RoutingProtocol::ScheduleLinkTupleTimer (const Ipv6Address &neighborIfaceAddr, Time expirationTime)
+{
+  EventId &timer = m_linkTupleTimers[neighborIfaceAddr];
+  timer.Cancel ();
+  timer = Simulator::Schedule (DELAY (expirationTime),
+                               &RoutingProtocol::LinkTupleTimerExpire, this,
+                               neighborIfaceAddr);
+  m_events.Track (timer);
+}
+
+void
+RoutingProtocol::CancelLinkTupleTimer (const Ipv6Address &neighborIfaceAddr)
+{
+  std::map<Ipv6Address, EventId>::iterator it = m_linkTupleTimers.find (neighborIfaceAddr);
+  if (it != m_linkTupleTimers.end ())
+    {
+      it->second.Cancel ();
+      m_linkTupleTimers.erase (it);
+    }
+}
+
+void
+RoutingProtocol::UpdateLinkQuality (LinkTuple &tuple, bool received)
+{
+  Time now = Simulator::Now ();
+
+  tuple.quality = (1 - m_hystScaling) * tuple.quality + (received ? m_hystScaling : 0);
+
+  if (tuple.pending && tuple.quality > m_hystThresholdHigh)
+    {
+      NS_LOG_LOGIC (tuple << " quality " << tuple.quality << " => established");
+      tuple.pending = false;
+      tuple.lostTime = now - Seconds (1);
+    }
+  else if (!tuple.pending && tuple.quality < m_hystThresholdLow)
+    {
+      NS_LOG_LOGIC (tuple << " quality " << tuple.quality << " => lost");
+      tuple.pending = true;
+      tuple.lostTime = std::min (tuple.time, now + OLSR6_NEIGHB_HOLD_TIME);
+      if (tuple.symTime >= now)
+        {
+          tuple.symTime = now - Seconds (1);
+          NeighborLoss (tuple);
+        }
+    }
+}
+
+void
+RoutingProtocol::LinkQualityTimerExpire (Ipv6Address neighborIfaceAddr)
+{
+  Time now = Simulator::Now ();
+
+  LinkTuple *tuple = m_state.FindLinkTuple (neighborIfaceAddr);
+  if (tuple == NULL)
+    {
+      return;
+    }
+  if (tuple->helloDeadline <= now)
+    {
+      // One more HELLO interval before the next one is considered missed
+      tuple->helloDeadline = now + tuple->helloInterval;
+      if (m_linkHysteresis)
+        {
+          UpdateLinkQuality (*tuple, false);
+        }
+      if (m_linkMetric == OLSR6_METRIC_ETX)
+        {
+          UpdateEtx (*tuple, false);
+        }
+    }
+  ScheduleLinkQualityTimer (*tuple);
+}
+
+void
+RoutingProtocol::ScheduleLinkQualityTimer (const LinkTuple &tuple)
+{
+  // A link tuple removed and added again must not keep the timer of the
+  // former one, or each missed HELLO would be counted twice
+  EventId &timer = m_linkQualityTimers[tuple.neighborIfaceAddr];
+  timer.Cancel ();
+  timer = Simulator::Schedule (DELAY (tuple.helloDeadline),
+                               &RoutingProtocol::LinkQualityTimerExpire, this,
+                               tuple.neighborIfaceAddr);
+  m_events.Track (timer);
+}
+
+void
+RoutingProtocol::CancelLinkQualityTimer (const Ipv6Address &neighborIfaceAddr)
+{
+  std::map<Ipv6Address, EventId>::iterator it = m_linkQualityTimers.find (neighborIfaceAddr);
+  if (it != m_linkQualityTimers.end ())
+    {
+      it->second.Cancel ();
+      m_linkQualityTimers.erase (it);
     }
 }
 
+void
+RoutingProtocol::UpdateEtx (LinkTuple &tuple, bool received)
+{
+  uint32_t mask = (m_etxWindow < 32) ? (1u << m_etxWindow) - 1 : 0xffffffff;
+  tuple.helloHistory = ((tuple.helloHistory << 1) | (received ? 1 : 0)) & mask;
+  tuple.helloHistoryLength = std::min (tuple.helloHistoryLength + 1, m_etxWindow);
+
+  uint32_t nReceived = 0;
+  for (uint32_t bits = tuple.helloHistory; bits != 0; bits &= bits - 1)
+    {
+      nReceived++;
+    }
+  tuple.lq = double (nReceived) / tuple.helloHistoryLength;
+  NS_LOG_LOGIC (tuple << " LQ " << tuple.lq << " NLQ " << tuple.nlq);
+}
+
+const LinkTuple *
+RoutingProtocol::FindBestLink (const Ipv6Address &neighborMainAddr) const
+{
+  Time now = Simulator::Now ();
+  const LinkTuple *best = NULL;
+  const LinkSet &links = m_state.GetLinks ();
+  for (LinkSet::const_iterator it = links.begin (); it != links.end (); it++)
+    {
+      if (it->symTime >= now && GetMainAddress (it->neighborIfaceAddr) == neighborMainAddr
+          && (best == NULL || OLSR6_ETX (it->lq, it->nlq) < OLSR6_ETX (best->lq, best->nlq)))
+        {
+          best = &*it;
+        }
+    }
+  return best;
+}
+
+std::map<Ipv6Address, double>
+RoutingProtocol::GetNeighborCosts () const
+{
+  Time now = Simulator::Now ();
+  std::map<Ipv6Address, double> costs;
+  const LinkSet &links = m_state.GetLinks ();
+  for (LinkSet::const_iterator it = links.begin (); it != links.end (); it++)
+    {
+      if (it->symTime < now)
+        {
+          continue;
+        }
+      double cost = OLSR6_ETX (it->lq, it->nlq);
+      std::map<Ipv6Address, double>::iterator current =
+        costs.insert (std::make_pair (GetMainAddress (it->neighborIfaceAddr), cost)).first;
+      current->second = std::min (current->second, cost);
+    }
+  return costs;
+}
+
+InterfaceNeighborCosts
+RoutingProtocol::GetInterfaceNeighborCosts () const
+{
+  Time now = Simulator::Now ();
+  InterfaceNeighborCosts costs;
+  const LinkSet &links = m_state.GetLinks ();
+  for (LinkSet::const_iterator it = links.begin (); it != links.end (); it++)
+    {
+      double cost = (it->symTime < now ? std::numeric_limits<double>::infinity ()
+                     : OLSR6_ETX (it->lq, it->nlq));
+      std::map<Ipv6Address, double>::iterator current =
+        costs[it->localIfaceAddr].insert (std::make_pair (GetMainAddress (it->neighborIfaceAddr), cost)).first;
+      current->second = std::min (current->second, cost);
+    }
+
+  // The neighbors without any link tuple, such as those the oracle builds,
+  // are on a single interface of unknown address, without symmetric link
+  std::set<Ipv6Address> linked;
+  for (InterfaceNeighborCosts::const_iterator iface = costs.begin (); iface != costs.end (); iface++)
+    {
+      for (std::map<Ipv6Address, double>::const_iterator it = iface->second.begin ();
+           it != iface->second.end (); it++)
+        {
+          linked.insert (it->first);
+        }
+    }
+  const NeighborSet &neighbors = m_state.GetNeighbors ();
+  for (NeighborSet::const_iterator it = neighbors.begin (); it != neighbors.end (); it++)
+    {
+      if (linked.find (it->neighborMainAddr) == linked.end ())
+        {
+          costs[Ipv6Address::GetAny ()][it->neighborMainAddr] = std::numeric_limits<double>::infinity ();
+        }
+    }
+  return costs;
+}
+
 void
 RoutingProtocol::Nb2hopTupleTimerExpire (Ipv6Address neighborMainAddr, Ipv6Address twoHopNeighborAddr)
 {
@@ -2673,6 +4777,20 @@ RoutingProtocol::TopologyTupleTimerExpire (Ipv6Address destAddr, Ipv6Address las
   if (tuple->expirationTime < Simulator::Now ())
     {
       RemoveTopologyTuple (*tuple);
+      // Forget the base of the differential TCs of a vanished originator
+      if (m_diffTcBases.find (lastAddr) != m_diffTcBases.end ())
+        {
+          bool vanished = true;
+          const TopologySet &topology = m_state.GetTopologySet ();
+          for (TopologySet::const_iterator it = topology.begin (); it != topology.end () && vanished; it++)
+            {
+              vanished = it->lastAddr != lastAddr;
+            }
+          if (vanished)
+            {
+              m_diffTcBases.erase (lastAddr);
+            }
+        }
     }
   else
     {
@@ -2727,43 +4845,202 @@ RoutingProtocol::Clear ()
 {
   NS_LOG_FUNCTION_NOARGS ();
   m_table.clear ();
+  m_multipathTable.clear ();
 }
 
 void
 RoutingProtocol::RemoveEntry (Ipv6Address const &dest)
 {
   m_table.erase (dest);
+  m_multipathTable.erase (dest);
+}
+
+bool
+RoutingProtocol::Lookup (Ipv6Address const &dest,
+                         RoutingTableEntry &outEntry) const
+{
+  // Get the iterator at "dest" position
+  std::map<Ipv6Address, RoutingTableEntry>::const_iterator it =
+    m_table.find (dest);
+  // If there is no route to "dest", return NULL
+  if (it == m_table.end ())
+    {
+      return false;
+    }
+  outEntry = it->second;
+  return true;
 }
 
-bool
-RoutingProtocol::Lookup (Ipv6Address const &dest,
-                         RoutingTableEntry &outEntry) const
-{
-  // Get the iterator at "dest" position
-  std::map<Ipv6Address, RoutingTableEntry>::const_iterator it =
-    m_table.find (dest);
-  // If there is no route to "dest", return NULL
-  if (it == m_table.end ())
+bool
+RoutingProtocol::FindSendEntry (RoutingTableEntry const &entry,
+                                RoutingTableEntry &outEntry) const
+{
+  outEntry = entry;
+  while (outEntry.destAddr != outEntry.nextAddr)
+    {
+      if (not Lookup (outEntry.nextAddr, outEntry))
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+void
+RoutingProtocol::SelectEqualCostEntry (const Ipv6Header &header, RoutingTableEntry &entry) const
+{
+  std::map<Ipv6Address, std::vector<RoutingTableEntry> >::const_iterator it =
+    m_multipathTable.find (header.GetDestinationAddress ());
+  if (it == m_multipathTable.end ())
+    {
+      return;
+    }
+
+  // The main address salts the hash, so that the nodes along a path do not
+  // all make the same choice
+  uint32_t hash = FlowHash (header, m_mainAddress);
+
+  entry = it->second[hash % it->second.size ()];
+  NS_LOG_LOGIC ("Flow " << header.GetSourceAddress () << " -> " << header.GetDestinationAddress ()
+                        << " (label " << header.GetFlowLabel () << ") uses next hop " << entry.nextAddr
+                        << " among " << it->second.size ());
+}
+
+bool
+RoutingProtocol::IsSmfDestination (const Ipv6Address &dst) const
+{
+  if (m_multicastRelay == OLSR6_SMF_NONE || !dst.IsMulticast ())
+    {
+      return false;
+    }
+  // The scope is the low nibble of the second byte
+  uint8_t buf[16];
+  dst.Serialize (buf);
+  return (buf[1] & 0x0f) > 2;
+}
+
+bool
+RoutingProtocol::IsSmfDuplicate (Ptr<const Packet> p, const Ipv6Header &header)
+{
+  Time now = Simulator::Now ();
+  while (!m_smfPacketIdTimes.empty () && m_smfPacketIdTimes.front ().first < now)
+    {
+      m_smfPacketIds.erase (m_smfPacketIdTimes.front ().second);
+      m_smfPacketIdTimes.pop_front ();
+    }
+
+  // The fields which do not change along the path
+  std::vector<uint8_t> buffer (40 + p->GetSize ());
+  header.GetSourceAddress ().Serialize (&buffer[0]);
+  header.GetDestinationAddress ().Serialize (&buffer[16]);
+  uint32_t flowLabel = header.GetFlowLabel ();
+  for (uint32_t i = 0; i < 4; i++)
+    {
+      buffer[32 + i] = (flowLabel >> (8 * i)) & 0xff;
+    }
+  buffer[36] = header.GetNextHeader ();
+  p->CopyData (&buffer[40], p->GetSize ());
+  uint32_t id = Hash32 (reinterpret_cast<const char *> (&buffer[0]), buffer.size ());
+
+  if (!m_smfPacketIds.insert (id).second)
+    {
+      return true;
+    }
+  m_smfPacketIdTimes.push_back (std::make_pair (now + OLSR6_SMF_DPD_HOLD_TIME, id));
+  return false;
+}
+
+bool
+RoutingProtocol::SmfRouteInput (Ptr<const Packet> p, const Ipv6Header &header, Ptr<const NetDevice> idev,
+                                MulticastForwardCallback mcb, LocalDeliverCallback lcb)
+{
+  if (IsSmfDuplicate (p, header))
+    {
+      NS_LOG_LOGIC ("Duplicate multicast packet from " << header.GetSourceAddress () << " dropped");
+      return true;
+    }
+
+  // Inside an Ipv6ListRouting, the list delivers the multicast packets
+  // locally; alone, this protocol does
+  uint32_t iif = m_ipv6->GetInterfaceForDevice (idev);
+  if (m_ipv6->GetRoutingProtocol () == this && !lcb.IsNull ())
+    {
+      lcb (p, header, iif);
+    }
+
+  Ipv6Address previousHop = header.GetSourceAddress ();
+  SmfPreviousHopTag tag;
+  if (p->PeekPacketTag (tag))
+    {
+      previousHop = tag.GetPreviousHop ();
+    }
+  if (m_multicastRelay == OLSR6_SMF_S_MPR
+      && m_state.FindMprSelectorTuple (GetMainAddress (previousHop)) == NULL)
+    {
+      NS_LOG_LOGIC ("Multicast packet from " << header.GetSourceAddress () << " not relayed: "
+                                             << previousHop << " is not an MPR selector");
+      return true;
+    }
+  if (header.GetHopLimit () <= 1)
+    {
+      return true;
+    }
+
+  // Relayed on every OLSR6 interface, including the incoming one
+  Ptr<Ipv6MulticastRoute> mrtentry = Create<Ipv6MulticastRoute> ();
+  mrtentry->SetGroup (header.GetDestinationAddress ());
+  mrtentry->SetOrigin (header.GetSourceAddress ());
+  mrtentry->SetParent (iif);
+  for (uint32_t i = 0; i < m_ipv6->GetNInterfaces (); i++)
     {
-      return false;
+      if (m_interfaceExclusions.find (i) == m_interfaceExclusions.end ()
+          && m_ipv6->GetNAddresses (i) > 1
+          && m_ipv6->GetAddress (i, 0).GetAddress () != Ipv6Address::GetLoopback ())
+        {
+          mrtentry->SetOutputTtl (i, header.GetHopLimit () - 1);
+        }
     }
-  outEntry = it->second;
+
+  Ptr<Packet> packet = p->Copy ();
+  packet->RemovePacketTag (tag);
+  tag.SetPreviousHop (m_mainAddress);
+  packet->AddPacketTag (tag);
+
+  NS_LOG_LOGIC ("Multicast packet from " << header.GetSourceAddress () << " relayed");
+  m_multicastRelayTrace (packet, header);
+  m_forwardedPackets++;
+  mcb (idev, mrtentry, packet, header);
   return true;
 }
 
 bool
-RoutingProtocol::FindSendEntry (RoutingTableEntry const &entry,
-                                RoutingTableEntry &outEntry) const
+RoutingProtocol::IsSymLink (const Ipv6Address &neighborIfaceAddr) const
 {
-  outEntry = entry;
-  while (outEntry.destAddr != outEntry.nextAddr)
+  Time now = Simulator::Now ();
+  const LinkSet &links = m_state.GetLinks ();
+  for (LinkSet::const_iterator it = links.begin (); it != links.end (); it++)
     {
-      if (not Lookup (outEntry.nextAddr, outEntry))
+      if (it->neighborIfaceAddr == neighborIfaceAddr)
         {
-          return false;
+          return it->symTime >= now;
         }
     }
-  return true;
+  return false;
+}
+
+void
+RoutingProtocol::SelectAlternate (const RoutingTableEntry &entry, RoutingTableEntry &sendEntry) const
+{
+  if (entry.alternateNextAddr == Ipv6Address ()
+      || IsSymLink (sendEntry.nextAddr)
+      || !IsSymLink (entry.alternateNextAddr))
+    {
+      return;
+    }
+  NS_LOG_LOGIC ("Link to " << sendEntry.nextAddr << " lost, route to " << entry.destAddr
+                           << " switches to " << entry.alternateNextAddr);
+  sendEntry.nextAddr = entry.alternateNextAddr;
+  sendEntry.interface = entry.alternateInterface;
 }
 
 Ptr<Ipv6Route>
@@ -2774,13 +5051,40 @@ RoutingProtocol::RouteOutput (Ptr<Packet> p, const Ipv6Header &header, Ptr<NetDe
   RoutingTableEntry entry1, entry2;
   bool found = false;
 
-  if (Lookup (header.GetDestinationAddress (), entry1) != 0)
+  if (IsSmfDestination (header.GetDestinationAddress ()))
+    {
+      // The source sends on the requested interface, or on the one of its
+      // main address; the relays take it from there
+      int32_t interfaceIdx = oif ? m_ipv6->GetInterfaceForDevice (oif)
+        : m_ipv6->GetInterfaceForAddress (m_mainAddress);
+      if (interfaceIdx < 0 || m_ipv6->GetNAddresses (interfaceIdx) < 2)
+        {
+          sockerr = Socket::ERROR_NOROUTETOHOST;
+          return rtentry;
+        }
+      rtentry = Create<Ipv6Route> ();
+      rtentry->SetDestination (header.GetDestinationAddress ());
+      rtentry->SetSource (m_ipv6->GetAddress (interfaceIdx, 1).GetAddress ());
+      rtentry->SetGateway (Ipv6Address::GetAny ());
+      rtentry->SetOutputDevice (m_ipv6->GetNetDevice (interfaceIdx));
+      sockerr = Socket::ERROR_NOTERROR;
+      return rtentry;
+    }
+
+  Ipv6Address gateway;
+  if (Lookup (header.GetDestinationAddress (), entry1) != 0
+      || LookupHnaGateway (p, header, gateway, entry1))
     {
       bool foundSendEntry = FindSendEntry (entry1, entry2);
       if (!foundSendEntry)
         {
           NS_FATAL_ERROR ("FindSendEntry failure");
         }
+      if (!oif)
+        {
+          SelectEqualCostEntry (header, entry2);
+          SelectAlternate (entry1, entry2);
+        }
       uint32_t interfaceIdx = entry2.interface;
       if (oif && m_ipv6->GetInterfaceForDevice (oif) != static_cast<int> (interfaceIdx))
         {
@@ -2816,6 +5120,13 @@ RoutingProtocol::RouteOutput (Ptr<Packet> p, const Ipv6Header &header, Ptr<NetDe
       rtentry->SetGateway (entry2.nextAddr);
       rtentry->SetOutputDevice (m_ipv6->GetNetDevice (interfaceIdx));
       sockerr = Socket::ERROR_NOTERROR;
+      if (p != 0 && gateway != Ipv6Address ())
+        {
+          HnaGatewayTag tag;
+          p->RemovePacketTag (tag);
+          tag.SetGateway (gateway);
+          p->AddPacketTag (tag);
+        }
       NS_LOG_DEBUG ("Olsr6 node " << m_mainAddress
                                   << ": RouteOutput for dest=" << header.GetDestinationAddress ()
                                   << " --> nextHop=" << entry2.nextAddr
@@ -2860,6 +5171,11 @@ bool RoutingProtocol::RouteInput  (Ptr<const Packet> p,
       return true;
     }
 
+  if (IsSmfDestination (dst))
+    {
+      return SmfRouteInput (p, header, idev, mcb, lcb);
+    }
+
   // Local delivery
   NS_ASSERT (m_ipv6->GetInterfaceForDevice (idev) >= 0);
   //uint32_t iif = m_ipv6->GetInterfaceForDevice (idev);
@@ -2867,13 +5183,17 @@ bool RoutingProtocol::RouteInput  (Ptr<const Packet> p,
   // Forwarding
   Ptr<Ipv6Route> rtentry;
   RoutingTableEntry entry1, entry2;
-  if (Lookup (header.GetDestinationAddress (), entry1))
+  Ipv6Address gateway;
+  if (Lookup (header.GetDestinationAddress (), entry1)
+      || LookupHnaGateway (p, header, gateway, entry1))
     {
       bool foundSendEntry = FindSendEntry (entry1, entry2);
       if (!foundSendEntry)
         {
           NS_FATAL_ERROR ("FindSendEntry failure");
         }
+      SelectEqualCostEntry (header, entry2);
+      SelectAlternate (entry1, entry2);
       rtentry = Create<Ipv6Route> ();
       rtentry->SetDestination (header.GetDestinationAddress ());
       uint32_t interfaceIdx = entry2.interface;
@@ -2901,6 +5221,21 @@ bool RoutingProtocol::RouteInput  (Ptr<const Packet> p,
                                   << " --> nextHop=" << entry2.nextAddr
                                   << " interface=" << entry2.interface);
 
+      HnaGatewayTag tag;
+      if (gateway != Ipv6Address ()
+          && !(p->PeekPacketTag (tag) && tag.GetGateway () == gateway))
+        {
+          // Record the gateway selected here for the next hops
+          Ptr<Packet> packet = p->Copy ();
+          packet->RemovePacketTag (tag);
+          tag.SetGateway (gateway);
+          packet->AddPacketTag (tag);
+          m_forwardedPackets++;
+          ucb (idev, rtentry, packet, header);
+          return true;
+        }
+
+      m_forwardedPackets++;
       ucb (idev, rtentry, p, header);
       return true;
     }
@@ -2935,18 +5270,217 @@ bool RoutingProtocol::RouteInput  (Ptr<const Packet> p,
 void
 RoutingProtocol::NotifyInterfaceUp (uint32_t i)
 {
+  // Before DoInitialize, and in oracle mode, there is nothing to update
+  if (!m_recvSocket || m_interfaceExclusions.find (i) != m_interfaceExclusions.end ())
+    {
+      return;
+    }
+  NS_LOG_DEBUG (Simulator::Now ().GetSeconds () << "s: OLSR6 node " << m_mainAddress
+                                                << " interface " << i << " up");
+
+  m_ipv6->SetForwarding (i, true);
+  bool changed = false;
+  for (uint32_t j = 0; j < m_ipv6->GetNAddresses (i); j++)
+    {
+      Ipv6InterfaceAddress address = m_ipv6->GetAddress (i, j);
+      if (address.GetScope () == Ipv6InterfaceAddress::GLOBAL && !FindSocket (address.GetAddress ()))
+        {
+          AddLocalAddress (i, address);
+          changed = true;
+        }
+    }
+  if (changed)
+    {
+      LocalInterfacesChanged ();
+    }
 }
 void
 RoutingProtocol::NotifyInterfaceDown (uint32_t i)
 {
+  if (!m_recvSocket || m_interfaceExclusions.find (i) != m_interfaceExclusions.end ())
+    {
+      return;
+    }
+  NS_LOG_DEBUG (Simulator::Now ().GetSeconds () << "s: OLSR6 node " << m_mainAddress
+                                                << " interface " << i << " down");
+
+  // The interface may have dropped its addresses already
+  std::set<Ipv6Address> addresses;
+  for (std::map< Ptr<Socket>, Ipv6InterfaceAddress >::const_iterator iter = m_socketAddresses.begin ();
+       iter != m_socketAddresses.end (); iter++)
+    {
+      int32_t interface = m_ipv6->GetInterfaceForAddress (iter->second.GetAddress ());
+      if (interface < 0 || uint32_t (interface) == i)
+        {
+          addresses.insert (iter->second.GetAddress ());
+        }
+    }
+  for (std::set<Ipv6Address>::const_iterator it = addresses.begin (); it != addresses.end (); it++)
+    {
+      CloseSocket (*it);
+    }
+  if (!addresses.empty ())
+    {
+      LocalInterfaceLoss (addresses);
+      LocalInterfacesChanged ();
+    }
 }
 void
 RoutingProtocol::NotifyAddAddress (uint32_t interface, Ipv6InterfaceAddress address)
 {
+  if (!m_recvSocket || m_interfaceExclusions.find (interface) != m_interfaceExclusions.end ()
+      || address.GetScope () != Ipv6InterfaceAddress::GLOBAL || !m_ipv6->IsUp (interface)
+      || FindSocket (address.GetAddress ()))
+    {
+      return;
+    }
+  NS_LOG_DEBUG (Simulator::Now ().GetSeconds () << "s: OLSR6 node " << m_mainAddress
+                                                << " address " << address.GetAddress () << " added");
+
+  AddLocalAddress (interface, address);
+  LocalInterfacesChanged ();
 }
 void
 RoutingProtocol::NotifyRemoveAddress (uint32_t interface, Ipv6InterfaceAddress address)
 {
+  if (!m_recvSocket || !CloseSocket (address.GetAddress ()))
+    {
+      return;
+    }
+  NS_LOG_DEBUG (Simulator::Now ().GetSeconds () << "s: OLSR6 node " << m_mainAddress
+                                                << " address " << address.GetAddress () << " removed");
+
+  // The main address keeps identifying the node, whatever its interfaces
+  IfaceAssocTuple *tuple = m_state.FindIfaceAssocTuple (address.GetAddress ());
+  if (tuple != NULL && tuple->mainAddr == m_mainAddress && tuple->ifaceAddr != m_mainAddress)
+    {
+      RemoveIfaceAssocTuple (*tuple);
+    }
+
+  std::set<Ipv6Address> addresses;
+  addresses.insert (address.GetAddress ());
+  LocalInterfaceLoss (addresses);
+  LocalInterfacesChanged ();
+}
+
+void
+RoutingProtocol::AddLocalAddress (uint32_t interface, const Ipv6InterfaceAddress &address)
+{
+  OpenSocket (interface, address);
+
+  IfaceAssocTuple tuple;
+  tuple.ifaceAddr = address.GetAddress ();
+  tuple.mainAddr = m_mainAddress;
+  if (m_state.FindIfaceAssocTuple (tuple.ifaceAddr) == NULL)
+    {
+      AddIfaceAssocTuple (tuple);
+    }
+}
+
+void
+RoutingProtocol::LocalInterfacesChanged ()
+{
+  // The neighbors learn the new interface set without waiting for the timers
+  SendMid ();
+  SendHello ();
+}
+
+void
+RoutingProtocol::LocalInterfaceLoss (const std::set<Ipv6Address> &localIfaceAddrs)
+{
+  Time now = Simulator::Now ();
+
+  // The links of the lost addresses are removed at once instead of timing out
+  std::vector<LinkTuple> lost;
+  const LinkSet &links = m_state.GetLinks ();
+  for (LinkSet::const_iterator it = links.begin (); it != links.end (); it++)
+    {
+      if (localIfaceAddrs.find (it->localIfaceAddr) != localIfaceAddrs.end ())
+        {
+          lost.push_back (*it);
+        }
+    }
+  if (lost.empty ())
+    {
+      return;
+    }
+
+  std::set<Ipv6Address> lostNeighbors;
+  std::set<Ipv6Address> lostNextAddrs;
+  for (std::vector<LinkTuple>::const_iterator it = lost.begin (); it != lost.end (); it++)
+    {
+      NS_LOG_DEBUG (now.GetSeconds () << "s: OLSR6 Node " << m_mainAddress
+                                      << " LinkTuple " << *it << " lost with its interface.");
+      CancelLinkTupleTimer (it->neighborIfaceAddr);
+      CancelLinkQualityTimer (it->neighborIfaceAddr);
+      m_state.EraseLinkTuple (*it);
+      lostNeighbors.insert (GetMainAddress (it->neighborIfaceAddr));
+      lostNextAddrs.insert (it->neighborIfaceAddr);
+    }
+
+  // The neighbors may still be reached through other interfaces
+  uint32_t nMprSelectors = m_state.GetMprSelectors ().size ();
+  for (std::set<Ipv6Address>::const_iterator neighbor = lostNeighbors.begin ();
+       neighbor != lostNeighbors.end (); neighbor++)
+    {
+      bool hasLink = false;
+      bool hasSymLink = false;
+      for (LinkSet::const_iterator it = links.begin (); it != links.end (); it++)
+        {
+          if (GetMainAddress (it->neighborIfaceAddr) == *neighbor)
+            {
+              hasLink = true;
+              hasSymLink = hasSymLink || it->symTime >= now;
+            }
+        }
+
+      NeighborTuple *nb_tuple = m_state.FindNeighborTuple (*neighbor);
+      if (!hasLink)
+        {
+          m_state.EraseNeighborTuple (*neighbor);
+        }
+      else if (nb_tuple != NULL)
+        {
+          nb_tuple->status = (hasSymLink ? NeighborTuple::STATUS_SYM : NeighborTuple::STATUS_NOT_SYM);
+        }
+      if (!hasSymLink)
+        {
+          m_state.EraseTwoHopNeighborTuples (*neighbor);
+          m_state.EraseMprSelectorTuples (*neighbor);
+        }
+    }
+  if (m_state.GetMprSelectors ().size () != nMprSelectors)
+    {
+      MprSelectorSetChanged ();
+    }
+  LinkSetChanged ();
+  MprComputation ();
+
+  // Only the routes through the lost links have to change
+  bool affected = false;
+  for (std::map<Ipv6Address, RoutingTableEntry>::const_iterator it = m_table.begin ();
+       it != m_table.end () && !affected; it++)
+    {
+      RoutingTableEntry sendEntry;
+      affected = !FindSendEntry (it->second, sendEntry)
+        || lostNextAddrs.find (sendEntry.nextAddr) != lostNextAddrs.end ();
+    }
+  if (!affected)
+    {
+      NS_LOG_DEBUG ("Node " << m_mainAddress << ": no route used the lost links");
+    }
+  else if (m_loopFreeAlternates)
+    {
+      // The next received message computes the whole routing table again
+      for (std::set<Ipv6Address>::const_iterator it = lostNextAddrs.begin (); it != lostNextAddrs.end (); it++)
+        {
+          RepairRoutes (*it);
+        }
+    }
+  else
+    {
+      RoutingTableComputation ();
+    }
 }
 
 void RoutingProtocol::NotifyAddRoute (Ipv6Address dst, Ipv6Prefix mask, Ipv6Address nextHop, uint32_t interface, Ipv6Address prefixToUse)
@@ -3015,6 +5549,109 @@ RoutingProtocol::GetRoutingTableEntries () const
   return retval;
 }
 
+std::vector<RoutingTableEntry>
+RoutingProtocol::GetEqualCostEntries (Ipv6Address dest) const
+{
+  std::map<Ipv6Address, std::vector<RoutingTableEntry> >::const_iterator it = m_multipathTable.find (dest);
+  if (it != m_multipathTable.end ())
+    {
+      return it->second;
+    }
+  std::vector<RoutingTableEntry> retval;
+  RoutingTableEntry entry;
+  if (Lookup (dest, entry))
+    {
+      retval.push_back (entry);
+    }
+  return retval;
+}
+
+MemoryUsage
+RoutingProtocol::GetMemoryUsage () const
+{
+  MemoryUsage usage = m_state.GetMemoryUsage ();
+
+  usage.routingTable.AddTree (m_table.size (), sizeof (std::pair<const Ipv6Address, RoutingTableEntry>));
+  usage.routingTable.AddTree (m_multipathTable.size (),
+                              sizeof (std::pair<const Ipv6Address, std::vector<RoutingTableEntry> >));
+  for (std::map<Ipv6Address, std::vector<RoutingTableEntry> >::const_iterator it = m_multipathTable.begin ();
+       it != m_multipathTable.end (); it++)
+    {
+      usage.routingTable.bytes += it->second.capacity () * sizeof (RoutingTableEntry);
+    }
+  for (std::map<uint8_t, std::map<Ipv6Address, HnaGateways>, std::greater<uint8_t> >::const_iterator it =
+         m_hnaGateways.begin (); it != m_hnaGateways.end (); it++)
+    {
+      usage.routingTable.AddTree (it->second.size (), sizeof (std::pair<const Ipv6Address, HnaGateways>));
+      for (std::map<Ipv6Address, HnaGateways>::const_iterator network = it->second.begin ();
+           network != it->second.end (); network++)
+        {
+          usage.routingTable.bytes += network->second.gateways.capacity () * sizeof (Ipv6Address)
+            + network->second.cumulativeWeights.capacity () * sizeof (uint32_t);
+        }
+    }
+
+  // The bases of the differential TCs complement the Topology Set
+  ContainerUsage diffTcBases;
+  diffTcBases.AddTree (m_diffTcBases.size (), sizeof (std::pair<const Ipv6Address, DiffTcBase>));
+  for (std::map<Ipv6Address, DiffTcBase>::const_iterator it = m_diffTcBases.begin (); it != m_diffTcBases.end (); it++)
+    {
+      diffTcBases.AddTree (it->second.addresses.size () + it->second.added.size () + it->second.removed.size (),
+                           sizeof (Ipv6Address));
+    }
+  usage.topologySet.bytes += diffTcBases.bytes;
+
+  // The compression capabilities of the neighbor interfaces complement the Link Set
+  usage.linkSet.AddTree (m_compressionNeighbors.size (), sizeof (std::pair<const Ipv6Address, Time>));
+  usage.linkSet.AddTree (m_replayWindows.size (), sizeof (std::pair<const Ipv6Address, ReplayWindow>));
+
+  // The multicast data packet identifiers complement the Duplicate Set
+  ContainerUsage smfPacketIds;
+  smfPacketIds.AddTree (m_smfPacketIds.size (), sizeof (uint32_t));
+  smfPacketIds.bytes += m_smfPacketIdTimes.size () * sizeof (std::pair<Time, uint32_t>);
+  usage.duplicateSet.bytes += smfPacketIds.bytes;
+
+  // The messages own their body, which is about as large as its serialization
+  usage.queuedMessages.AddVector (m_queuedMessages);
+  usage.queuedMessages.bytes += m_queuedMessageIfaces.capacity () * sizeof (Ipv6Address);
+  for (MessageList::const_iterator it = m_queuedMessages.begin (); it != m_queuedMessages.end (); it++)
+    {
+      usage.queuedMessages.bytes += it->GetSerializedSize ();
+    }
+
+  // Every tuple with an expiry time has one expiry event pending, except
+  // the never expiring interface associations of the node itself.
+  uint32_t nEvents = usage.linkSet.count + usage.twoHopNeighborSet.count
+    + usage.topologySet.count + usage.mprSelectorSet.count
+    + usage.duplicateSet.count + usage.associationSet.count;
+  if (m_linkHysteresis || m_linkMetric == OLSR6_METRIC_ETX)
+    {
+      // Links also have a pending link quality event
+      nEvents += usage.linkSet.count;
+    }
+  const IfaceAssocSet &ifaceAssocSet = m_state.GetIfaceAssocSet ();
+  for (IfaceAssocSet::const_iterator it = ifaceAssocSet.begin (); it != ifaceAssocSet.end (); it++)
+    {
+      if (it->mainAddr != m_mainAddress)
+        {
+          nEvents++;
+        }
+    }
+  Timer const *timers[] = { &m_helloTimer, &m_tcTimer, &m_midTimer, &m_hnaTimer,
+                            &m_triggeredTcTimer, &m_memoryUsageTimer, &m_willingnessTimer,
+                            &m_queuedMessagesTimer };
+  for (uint32_t i = 0; i < sizeof (timers) / sizeof (timers[0]); i++)
+    {
+      if (timers[i]->IsRunning ())
+        {
+          nEvents++;
+        }
+    }
+  usage.events.AddTree (nEvents, sizeof (EventId));
+
+  return usage;
+}
+
 int64_t
 RoutingProtocol::AssignStreams (int64_t stream)
 {
@@ -3023,6 +5660,169 @@ RoutingProtocol::AssignStreams (int64_t stream)
   return 1;
 }
 
+void
+RoutingProtocol::SaveSnapshot (std::ostream &os) const
+{
+  NS_LOG_FUNCTION (this);
+
+  SnapshotWriter writer (os, Simulator::Now ());
+  writer.WriteU32 (OLSR6_SNAPSHOT_MAGIC);
+  writer.WriteU8 (OLSR6_SNAPSHOT_VERSION);
+  writer.WriteAddress (m_mainAddress);
+  writer.WriteU16 (m_packetSequenceNumber);
+  writer.WriteU16 (m_messageSequenceNumber);
+  writer.WriteU16 (m_ansn);
+  writer.WriteU8 (m_linkTupleTimerFirstTime);
+
+  m_state.Serialize (writer);
+
+  writer.WriteU32 (m_table.size ());
+  for (std::map<Ipv6Address, RoutingTableEntry>::const_iterator iter = m_table.begin ();
+       iter != m_table.end (); iter++)
+    {
+      writer.WriteAddress (iter->second.destAddr);
+      writer.WriteAddress (iter->second.nextAddr);
+      writer.WriteU32 (iter->second.interface);
+      writer.WriteU32 (iter->second.distance);
+    }
+
+  if (!writer.IsGood ())
+    {
+      NS_FATAL_ERROR ("Could not write the OLSR6 state snapshot of node " << m_mainAddress);
+    }
+}
+
+void
+RoutingProtocol::RestoreSnapshot (std::string filename)
+{
+  NS_LOG_FUNCTION (this << filename);
+
+  std::ifstream file (filename.c_str (), std::ios::in | std::ios::binary);
+  if (!file.is_open ())
+    {
+      NS_FATAL_ERROR ("Could not open OLSR6 state snapshot " << filename);
+    }
+
+  Time now = Simulator::Now ();
+  SnapshotReader reader (file, now);
+  if (reader.ReadU32 () != OLSR6_SNAPSHOT_MAGIC)
+    {
+      NS_FATAL_ERROR (filename << " is not an OLSR6 state snapshot");
+    }
+  // The older snapshots lack fields which the state cannot do without,
+  // such as the hysteresis of the links
+  uint8_t version = reader.ReadU8 ();
+  if (version != OLSR6_SNAPSHOT_VERSION)
+    {
+      NS_FATAL_ERROR ("OLSR6 state snapshot " << filename << " has version " << (uint32_t) version
+                                              << ", only version " << OLSR6_SNAPSHOT_VERSION
+                                              << " can be restored");
+    }
+  Ipv6Address mainAddress = reader.ReadAddress ();
+  if (mainAddress != m_mainAddress)
+    {
+      NS_FATAL_ERROR ("OLSR6 state snapshot " << filename << " belongs to node " << mainAddress
+                                              << ", not to node " << m_mainAddress);
+    }
+  m_packetSequenceNumber = reader.ReadU16 ();
+  m_messageSequenceNumber = reader.ReadU16 ();
+  m_ansn = reader.ReadU16 ();
+  m_linkTupleTimerFirstTime = (reader.ReadU8 () != 0);
+
+  bool stateOk = m_state.Deserialize (reader);
+
+  Clear ();
+  for (uint32_t n = reader.ReadU32 (); n > 0 && reader.IsGood (); n--)
+    {
+      RoutingTableEntry entry;
+      entry.destAddr = reader.ReadAddress ();
+      entry.nextAddr = reader.ReadAddress ();
+      entry.interface = reader.ReadU32 ();
+      entry.distance = reader.ReadU32 ();
+      m_table[entry.destAddr] = entry;
+    }
+
+  if (!stateOk || !reader.IsGood ())
+    {
+      NS_FATAL_ERROR ("OLSR6 state snapshot " << filename << " is truncated");
+    }
+
+  // The tuple expiry times have been rebased to now: schedule the
+  // corresponding expiry events again.
+  for (LinkSet::const_iterator it = m_state.GetLinks ().begin ();
+       it != m_state.GetLinks ().end (); it++)
+    {
+      ScheduleLinkTupleTimer (it->neighborIfaceAddr, std::min (it->time, it->symTime));
+      // The missed HELLOs are watched from the first HELLO of the neighbor
+      if ((m_linkHysteresis || m_linkMetric == OLSR6_METRIC_ETX) && !it->helloInterval.IsZero ())
+        {
+          ScheduleLinkQualityTimer (*it);
+        }
+    }
+  for (TwoHopNeighborSet::const_iterator it = m_state.GetTwoHopNeighbors ().begin ();
+       it != m_state.GetTwoHopNeighbors ().end (); it++)
+    {
+      m_events.Track (Simulator::Schedule (DELAY (it->expirationTime),
+                                           &RoutingProtocol::Nb2hopTupleTimerExpire, this,
+                                           it->neighborMainAddr, it->twoHopNeighborAddr));
+    }
+  for (MprSelectorSet::const_iterator it = m_state.GetMprSelectors ().begin ();
+       it != m_state.GetMprSelectors ().end (); it++)
+    {
+      m_events.Track (Simulator::Schedule (DELAY (it->expirationTime),
+                                           &RoutingProtocol::MprSelTupleTimerExpire, this,
+                                           it->mainAddr));
+    }
+  for (TopologySet::const_iterator it = m_state.GetTopologySet ().begin ();
+       it != m_state.GetTopologySet ().end (); it++)
+    {
+      m_events.Track (Simulator::Schedule (DELAY (it->expirationTime),
+                                           &RoutingProtocol::TopologyTupleTimerExpire, this,
+                                           it->destAddr, it->lastAddr));
+    }
+  for (IfaceAssocSet::const_iterator it = m_state.GetIfaceAssocSet ().begin ();
+       it != m_state.GetIfaceAssocSet ().end (); it++)
+    {
+      // The tuples of our own interfaces never expire
+      if (it->mainAddr != m_mainAddress)
+        {
+          m_events.Track (Simulator::Schedule (DELAY (it->time),
+                                               &RoutingProtocol::IfaceAssocTupleTimerExpire, this,
+                                               it->ifaceAddr));
+        }
+    }
+  for (AssociationSet::const_iterator it = m_state.GetAssociationSet ().begin ();
+       it != m_state.GetAssociationSet ().end (); it++)
+    {
+      m_events.Track (Simulator::Schedule (DELAY (it->expirationTime),
+                                           &RoutingProtocol::AssociationTupleTimerExpire, this,
+                                           it->gatewayAddr, it->networkAddr, it->netmask));
+    }
+  for (DuplicateSet::const_iterator it = m_state.GetDuplicates ().begin ();
+       it != m_state.GetDuplicates ().end (); it++)
+    {
+      m_events.Track (Simulator::Schedule (DELAY (it->expirationTime),
+                                           &RoutingProtocol::DupTupleTimerExpire, this,
+                                           it->address, it->sequenceNumber));
+    }
+
+  // The equal cost paths and the loop-free alternates are not saved: they
+  // follow from the restored routes and state, as in RoutingTableComputation
+  if (m_maxEqualCostPaths > 1 && m_linkMetric == OLSR6_METRIC_HOP_COUNT)
+    {
+      EqualCostRoutingTableComputation ();
+    }
+  if (m_loopFreeAlternates)
+    {
+      LoopFreeAlternateComputation ();
+    }
+  HnaRoutingTableComputation ();
+
+  NS_LOG_DEBUG ("Node " << m_mainAddress << " restored " << GetSize ()
+                        << " routes from snapshot " << filename);
+  m_routingTableChanged (GetSize ());
+}
+
 bool
 RoutingProtocol::IsMyOwnAddress (const Ipv6Address & a) const
 {
@@ -32,6 +32,7 @@
 #include "ns3/test.h"
 #include "olsr6-state.h"
 #include "olsr6-repositories.h"
+#include "olsr6-authentication.h"
 
 #include "ns3/object.h"
 #include "ns3/packet.h"
@@ -44,12 +45,19 @@
 #include "ns3/ipv6.h"
 #include "ns3/ipv6-routing-protocol.h"
 #include "ns3/ipv6-static-routing.h"
+#include "ns3/net-device.h"
+#include "ns3/mac48-address.h"
 
 #include <vector>
 #include <map>
+#include <deque>
+#include <functional>
+#include <string>
+#include <iostream>
 
 /// Testcase for MPR computation mechanism
 class Olsr6MprTestCase;
+class Olsr6LinkHysteresisTestCase;
 
 namespace ns3 {
 namespace olsr6 {
@@ -67,17 +75,22 @@ struct RoutingTableEntry
   Ipv6Address nextAddr; //!< Address of the next hop.
   uint32_t interface; //!< Interface index
   uint32_t distance; //!< Distance in hops to the destination.
+  Ipv6Address alternateNextAddr; //!< Loop-free alternate next hop (\RFC{5286}), unspecified if none.
+  uint32_t alternateInterface; //!< Interface index of the loop-free alternate next hop.
 
   RoutingTableEntry () : // default values
                          destAddr (),
                          nextAddr (),
                          interface (0),
-                         distance (0)
+                         distance (0),
+                         alternateNextAddr (),
+                         alternateInterface (0)
   {
   }
 };
 
 class RoutingProtocol;
+class OracleTopology;
 
 ///
 /// \ingroup olsr6
@@ -88,6 +101,8 @@ class RoutingProtocol : public Ipv6RoutingProtocol
 {
 public:
   friend class ::Olsr6MprTestCase;
+  friend class ::Olsr6LinkHysteresisTestCase;
+  friend class OracleTopology;
 
   /**
    * \brief Get the type ID.
@@ -117,6 +132,17 @@ public:
    */
   std::vector<RoutingTableEntry> GetRoutingTableEntries () const;
 
+  /**
+   * \brief Returns the equal-cost routes to a destination.
+   *
+   * The first one is the route of the routing table; the others are only
+   * kept when MaxEqualCostPaths is greater than 1.
+   *
+   * \param dest The destination address.
+   * \returns The routes to the destination, empty if there is none.
+   */
+  std::vector<RoutingTableEntry> GetEqualCostEntries (Ipv6Address dest) const;
+
   /**
    * Assign a fixed random variable stream number to the random variables
    * used by this model.  Return the number of streams (possibly zero) that
@@ -127,6 +153,82 @@ public:
    */
   int64_t AssignStreams (int64_t stream);
 
+  /**
+   * \brief Writes a binary snapshot of the complete protocol state.
+   *
+   * The snapshot holds the Olsr6State, the routing table, the sequence
+   * number counters and the expiry time of every tuple, stored relative to
+   * the current simulation time.  It can be restored in a later simulation
+   * through the SnapshotFile attribute.
+   *
+   * \param os The stream the snapshot is written to.
+   */
+  void SaveSnapshot (std::ostream &os) const;
+
+  /**
+   * \brief Processes an OLSR6 packet as if it had been received on a socket.
+   *
+   * This is the processing path of every received packet; it is public so
+   * that recorded traffic can be replayed into an instance that has no
+   * socket (see Olsr6RxTraceReplay).
+   *
+   * \param packet The packet, starting with its OLSR6 packet header.
+   * \param senderIfaceAddr Address of the sending interface.
+   * \param receiverIfaceAddr Address of the receiving interface.
+   */
+  void ReceivePacket (Ptr<Packet> packet, Ipv6Address senderIfaceAddr, Ipv6Address receiverIfaceAddr);
+
+  /**
+   * \brief Reports that the link layer failed to deliver a frame to a neighbor.
+   *
+   * The link to the neighbor interface is no longer considered symmetric:
+   * the neighbor is lost at once and the routes are recomputed, instead of
+   * waiting for the link tuple to expire.  A later HELLO from the neighbor
+   * establishes the link again; otherwise the link tuple expires after
+   * NEIGHB_HOLD_TIME.
+   *
+   * \param neighborIfaceAddr Address of the neighbor interface.
+   */
+  void NotifyLinkFailure (Ipv6Address neighborIfaceAddr);
+
+  /**
+   * \brief Reports that a device failed to deliver a frame to a neighbor.
+   *
+   * The neighbor interface is resolved through the neighbor cache of the
+   * device, then handled as in NotifyLinkFailure.  This is the sink of the
+   * TX failure traces connected by Olsr6Helper::EnableLinkFailureFeedback.
+   *
+   * \param device The device which failed to deliver the frame.
+   * \param neighbor MAC address of the neighbor.
+   */
+  void NotifyTxFailure (Ptr<NetDevice> device, Mac48Address neighbor);
+
+  /**
+   * \brief Accepts the packets signed with another key.
+   *
+   * With the AuthenticationKey attribute set, the node signs its packets
+   * with that key and only accepts the packets signed with it or with a key
+   * added here, such as the keys of the neighbors of another domain.  The
+   * inner and outer HMAC states of each key are computed once, here.
+   *
+   * \param keyId The Key ID the packets signed with the key carry.
+   * \param key The key.
+   */
+  void AddAuthenticationKey (uint8_t keyId, std::string key);
+
+  /**
+   * \brief Counts the elements of every repository of the node and
+   * estimates the memory they use.
+   *
+   * Besides the sets of Olsr6State, the usage covers the routing table, the
+   * queued messages and the pending events.  The events are not enumerable,
+   * so they are estimated as one per tuple with an expiry time plus the
+   * running message timers.
+   *
+   * \returns The memory usage of the node.
+   */
+  MemoryUsage GetMemoryUsage () const;
+
   /**
    * TracedCallback signature for Packet transmit and receive events.
    *
@@ -135,6 +237,30 @@ public:
    */
   typedef void (*PacketTxRxTracedCallback)(const PacketHeader & header, const MessageList & messages);
 
+  /**
+   * TracedCallback signature for the reception of a whole OLSR6 packet.
+   *
+   * \param [in] packet The packet, starting with its OLSR6 packet header.
+   * \param [in] sender Address of the sending interface.
+   * \param [in] receiver Address of the receiving interface.
+   */
+  typedef void (*RawPacketRxTracedCallback)(Ptr<const Packet> packet, const Ipv6Address & sender, const Ipv6Address & receiver);
+
+  /**
+   * TracedCallback signature for memory usage samples.
+   *
+   * \param [in] usage The memory usage of the node.
+   */
+  typedef void (*MemoryUsageTracedCallback)(const MemoryUsage & usage);
+
+  /**
+   * TracedCallback signature for triggered TC decisions.
+   *
+   * \param [in] triggered The number of triggered TC messages sent so far.
+   * \param [in] suppressed The number of triggers suppressed so far.
+   */
+  typedef void (*TcTriggerTracedCallback)(uint32_t triggered, uint32_t suppressed);
+
   /**
    * TracedCallback signature for routing table computation.
    *
@@ -142,6 +268,30 @@ public:
    */
   typedef void (*TableChangeTracedCallback)(uint32_t size);
 
+  /**
+   * TracedCallback signature for the multicast data packets relayed.
+   *
+   * \param [in] packet The packet, without its IPv6 header.
+   * \param [in] header The IPv6 header of the packet.
+   */
+  typedef void (*MulticastRelayTracedCallback)(Ptr<const Packet> packet, const Ipv6Header & header);
+
+  /**
+   * TracedCallback signature for the changes of the advertised willingness.
+   *
+   * \param [in] oldWillingness The willingness advertised until now.
+   * \param [in] newWillingness The willingness advertised from now on.
+   */
+  typedef void (*WillingnessTracedCallback)(uint8_t oldWillingness, uint8_t newWillingness);
+
+  /**
+   * TracedCallback signature for the packets dropped by the authentication.
+   *
+   * \param [in] header The packet header.
+   * \param [in] sender Address of the sending interface.
+   */
+  typedef void (*AuthenticationFailureTracedCallback)(const PacketHeader & header, const Ipv6Address & sender);
+
 private:
   std::set<uint32_t> m_interfaceExclusions; //!< Set of interfaces excluded by OSLR.
   Ptr<Ipv6StaticRouting> m_routingTableAssociation; //!< Associations from an Ipv4StaticRouting instance
@@ -199,11 +349,33 @@ public:
    * \returns the internal HNA table
    */
   Ptr<const Ipv6StaticRouting> GetRoutingTableAssociation () const;
+
+  /**
+   * \brief Sets the load signal of the willingness controller, when the
+   * WillingnessLoadSignal attribute is "callback".
+   *
+   * \param cb Returns the load of the node, from 0 (idle) to 1 (saturated).
+   */
+  void SetWillingnessLoadCallback (Callback<double> cb);
+
+  /**
+   * \brief Gets the willingness advertised in the HELLO messages.
+   *
+   * It is the Willingness attribute, unless the willingness controller
+   * lowered it because of the load of the node.
+   *
+   * \returns The advertised willingness.
+   */
+  uint8_t GetWillingness (void) const;
   virtual void PrintRoutingTable (Ptr<OutputStreamWrapper> stream) const;
 protected:
   virtual void DoInitialize (void);
 private:
   std::map<Ipv6Address, RoutingTableEntry> m_table; //!< Data structure for the routing table.
+  /// Equal-cost routes to the destinations which have more than one, the route of m_table first.
+  std::map<Ipv6Address, std::vector<RoutingTableEntry> > m_multipathTable;
+  uint32_t m_maxEqualCostPaths; //!< Maximum number of equal-cost routes kept per destination.
+  bool m_loopFreeAlternates;    //!< True if the routes are protected by loop-free alternate next hops.
 
   Ptr<Ipv6StaticRouting> m_hnaRoutingTable; //!< Routing table for HNA routes
 
@@ -219,9 +391,54 @@ private:
   Time m_hnaInterval;     //!< HNA messages' emission interval.
   uint8_t m_willingness;  //!<  Willingness for forwarding packets on behalf of other nodes.
 
+  uint8_t m_willingnessLoadSignal;      //!< Load signal of the willingness controller, none if static.
+  Time m_willingnessUpdateInterval;     //!< Interval between two samples of the load.
+  Time m_willingnessHoldTime;           //!< Time the load stays low before the willingness is raised.
+  double m_willingnessLoadHigh;         //!< Load above which the willingness is lowered.
+  double m_willingnessLoadLow;          //!< Load below which the willingness is raised.
+  uint32_t m_forwardingCapacity;        //!< Forwarded packets per second taken as full load.
+  Callback<double> m_willingnessLoadCallback; //!< Load signal set by the user.
+  uint8_t m_advertisedWillingness;      //!< Willingness set by the controller.
+  uint32_t m_forwardedPackets;          //!< Packets forwarded since the last sample.
+  Time m_lowLoadSince;                  //!< Start of the current period of low load.
+  Timer m_willingnessTimer;             //!< Timer for the load samples.
+
+  /**
+   * \brief Samples the load of the node and steps the advertised
+   * willingness, then reschedules the timer.
+   *
+   * The willingness is lowered by one level, down to WILL_LOW, as soon as
+   * the load exceeds WillingnessLoadHigh, and raised by one level, up to
+   * the Willingness attribute, once the load stayed below
+   * WillingnessLoadLow for WillingnessHoldTime.  In between, it is kept,
+   * so that the MPR sets of the neighbors do not follow every variation
+   * of the load.
+   */
+  void WillingnessTimerExpire ();
+
+  /**
+   * \brief Measures the load of the node with the configured signal.
+   * \returns The load, from 0 (idle) to 1 (saturated) or beyond.
+   */
+  double GetLoad ();
+
   Olsr6State m_state;  //!< Internal state with all needed data structs.
   Ptr<Ipv6> m_ipv6;   //!< IPv4 object the routing is linked to.
 
+  std::string m_snapshotFile; //!< Snapshot restored in DoInitialize, if not empty.
+  bool m_oracleMode;          //!< True if the routes are computed by the OracleTopology.
+
+  /**
+   * \brief Restores the protocol state from a snapshot written by SaveSnapshot.
+   *
+   * All tuple expiry times are rebased to the current simulation time and
+   * the corresponding expiry events are scheduled again.  A snapshot of
+   * another format version is rejected.
+   *
+   * \param filename The snapshot file.
+   */
+  void RestoreSnapshot (std::string filename);
+
   /**
    * \brief Clears the routing table and frees the memory assigned to each one of its entries.
    */
@@ -300,6 +517,106 @@ private:
   bool FindSendEntry (const RoutingTableEntry &entry,
                       RoutingTableEntry &outEntry) const;
 
+  /**
+   * \brief Computes the equal-cost routes to the destinations of the
+   * routing table, up to MaxEqualCostPaths per destination.
+   *
+   * A destination at distance h is reached through the next hops of each
+   * node at distance h-1 which advertises a link to it.  Only the hop count
+   * metric is supported.
+   */
+  void EqualCostRoutingTableComputation ();
+
+  /**
+   * \brief Selects, among the equal-cost routes to the destination of a
+   * packet, the one of its flow.
+   *
+   * The flow is identified by the source and destination addresses and the
+   * flow label, so that the packets of a flow are not reordered.
+   *
+   * \param header The IPv6 header of the packet.
+   * \param[in,out] entry The route found by FindSendEntry, replaced by the
+   * route of the flow.
+   */
+  void SelectEqualCostEntry (const Ipv6Header &header, RoutingTableEntry &entry) const;
+
+  /**
+   * \brief Computes a loop-free alternate next hop (\RFC{5286}) for each
+   * entry of the routing table.
+   *
+   * The distances are computed from the local view of the topology: the
+   * links to the symmetric neighbors, the 2-hop neighbor set and the
+   * topology set.  A neighbor N is a loop-free alternate towards a
+   * destination D if dist(N, D) < dist(N, S) + dist(S, D), S being this
+   * node; among them, the one with the shortest path is selected.
+   */
+  void LoopFreeAlternateComputation ();
+
+  /**
+   * \brief Switches the routes through a lost link to their loop-free
+   * alternate next hops, and removes the routes without one, instead of
+   * computing the whole routing table again.
+   *
+   * \param neighborIfaceAddr The neighbor interface address of the lost link.
+   */
+  void RepairRoutes (const Ipv6Address &neighborIfaceAddr);
+
+  /**
+   * \brief Replaces the next hop of a route by its loop-free alternate when
+   * the link to the next hop is no longer symmetric.
+   *
+   * \param entry The routing table entry of the destination.
+   * \param[in,out] sendEntry The next hop found by FindSendEntry.
+   */
+  void SelectAlternate (const RoutingTableEntry &entry, RoutingTableEntry &sendEntry) const;
+
+  /**
+   * \param neighborIfaceAddr A neighbor interface address.
+   * \returns True if the link to the neighbor interface is symmetric.
+   */
+  bool IsSymLink (const Ipv6Address &neighborIfaceAddr) const;
+
+  uint8_t m_multicastRelay;   //!< Relay algorithm of the multicast data packets (\RFC{6621}).
+  std::set<uint32_t> m_smfPacketIds;  //!< Hash of the multicast data packets seen recently.
+  std::deque<std::pair<Time, uint32_t> > m_smfPacketIdTimes;  //!< The same hashes with their expiry time, oldest first.
+
+  /**
+   * \param dst A destination address.
+   * \returns True if the packets to the destination are relayed by the
+   * simplified multicast forwarding: multicast addresses of a scope larger
+   * than link-local.
+   */
+  bool IsSmfDestination (const Ipv6Address &dst) const;
+
+  /**
+   * \brief Records a multicast data packet in the duplicate packet
+   * detection cache (\RFC{6621}, section 6.2, hash-assisted).
+   *
+   * The packet is identified by a hash of its source and destination
+   * addresses, its flow label and its payload.
+   *
+   * \param p The packet, without its IPv6 header.
+   * \param header The IPv6 header of the packet.
+   * \returns True if the packet was already recorded.
+   */
+  bool IsSmfDuplicate (Ptr<const Packet> p, const Ipv6Header &header);
+
+  /**
+   * \brief Delivers locally and relays a multicast data packet.
+   *
+   * With the s-mpr algorithm, the packet is relayed only if its previous
+   * hop has selected this node as MPR; with cf, every packet is relayed.
+   *
+   * \param p The packet, without its IPv6 header.
+   * \param header The IPv6 header of the packet.
+   * \param idev The device the packet was received on.
+   * \param mcb The multicast forwarding callback.
+   * \param lcb The local delivery callback.
+   * \returns True, the packet being handled.
+   */
+  bool SmfRouteInput (Ptr<const Packet> p, const Ipv6Header &header, Ptr<const NetDevice> idev,
+                      MulticastForwardCallback mcb, LocalDeliverCallback lcb);
+
   // From Ipv6RoutingProtocol
   virtual Ptr<Ipv6Route> RouteOutput (Ptr<Packet> p,
                                       const Ipv6Header &header,
@@ -323,12 +640,77 @@ private:
 
   void DoDispose ();
 
+  /**
+   * Opens the socket which sends the %OLSR6 packets from an address, and
+   * receives the packets sent to it by the neighbors in unicast relay mode.
+   * \param interface The interface of the address.
+   * \param address The address.
+   */
+  void OpenSocket (uint32_t interface, const Ipv6InterfaceAddress &address);
+
+  /**
+   * \param address A local address.
+   * \returns The socket which sends the %OLSR6 packets from the address, or 0.
+   */
+  Ptr<Socket> FindSocket (const Ipv6Address &address) const;
+
+  /**
+   * Closes the socket which sends the %OLSR6 packets from an address.
+   * \param address The address.
+   * \returns False if there is no socket for the address.
+   */
+  bool CloseSocket (const Ipv6Address &address);
+
+  /**
+   * Starts running %OLSR6 on a new address: opens its socket and associates
+   * it with the main address.
+   * \param interface The interface of the address.
+   * \param address The address.
+   */
+  void AddLocalAddress (uint32_t interface, const Ipv6InterfaceAddress &address);
+
+  /**
+   * Sends a MID and a HELLO message right away after the set of the
+   * interfaces running %OLSR6 changed.
+   */
+  void LocalInterfacesChanged ();
+
+  /**
+   * \brief Removes the links of local addresses which are no longer used,
+   * and updates the neighbors, the MPR set and the routes through them.
+   *
+   * Only the routes through the removed links are repaired; the routing
+   * table is left untouched if none of them used these links.
+   *
+   * \param localIfaceAddrs The local addresses.
+   */
+  void LocalInterfaceLoss (const std::set<Ipv6Address> &localIfaceAddrs);
+
   /**
    * Send an OLSR6 message.
    * \param packet The packet to be sent.
    * \param containedMessages The messages contained in the packet.
+   * \param socket The socket of the interface to send the packet on.
+   * \param destination The destination of the packet.
+   */
+  void SendPacket (Ptr<Packet> packet, const MessageList &containedMessages, Ptr<Socket> socket,
+                   Ipv6Address destination);
+
+  /**
+   * \brief Chooses the destination of a packet sent on an interface.
+   *
+   * The packets are multicast to all the nodes of the link.  In unicast
+   * relay mode, the packets without HELLO message, which only matter to the
+   * symmetric neighbors, are sent to the neighbor if the interface has a
+   * single one, and not sent if it has none.
+   *
+   * \param ifaceAddr The address of the interface.
+   * \param messages The messages of the packet.
+   * \param destination The destination chosen.
+   * \returns False if the packet must not be sent.
    */
-  void SendPacket (Ptr<Packet> packet, const MessageList &containedMessages);
+  bool GetPacketDestination (const Ipv6Address &ifaceAddr, const MessageList &messages,
+                             Ipv6Address &destination) const;
 
   /**
    * Increments packet sequence number and returns the new value.
@@ -358,6 +740,75 @@ private:
    */
   void RoutingTableComputation ();
 
+  /**
+   * \brief Creates the routes to the neighbors, the 2-hop neighbors and the
+   * nodes of the Topology Set, by increasing number of hops (steps 2 and 3
+   * of the routing table computation).
+   */
+  void HopCountRoutingTableComputation ();
+
+  /**
+   * \brief Rebuilds the HNA routing table from the Association Set and the
+   * current routing table (step 5 of the routing table computation).
+   */
+  void HnaRoutingTableComputation ();
+
+  /// A reachable gateway of a HNA network.
+  struct HnaGatewayCandidate
+  {
+    Ipv6Address gatewayAddr;      //!< Main address of the gateway.
+    RoutingTableEntry entry;      //!< Routing table entry of the gateway.
+    uint32_t weight;              //!< Share of the flows of the gateway.
+  };
+  /// Reachable gateways of the HNA networks, by prefix length and network address.
+  typedef std::map<std::pair<uint8_t, Ipv6Address>, std::vector<HnaGatewayCandidate> > HnaGatewayCandidates;
+
+  bool m_hnaAggregation;  //!< True if the HNA networks are aggregated.
+
+  /// Gateways of a HNA network among which the flows are spread.
+  struct HnaGateways
+  {
+    std::vector<Ipv6Address> gateways;          //!< Main addresses of the gateways.
+    std::vector<uint32_t> cumulativeWeights;    //!< Sum of the weights of the gateways up to each one.
+  };
+
+  /// Gateways of the HNA networks, by prefix length (longest first) and network address.
+  std::map<uint8_t, std::map<Ipv6Address, HnaGateways>, std::greater<uint8_t> > m_hnaGateways;
+  uint8_t m_hnaGatewaySelection;  //!< Selection policy of the gateway of the HNA networks.
+  uint32_t m_hnaDistanceSlack;    //!< Extra hops to the gateways selected besides the nearest ones.
+  uint16_t m_gatewayCapacity;     //!< Uplink capacity advertised in the HNA messages, in Mbit/s.
+  uint8_t m_gatewayLoad;          //!< Uplink load advertised in the HNA messages.
+
+  /**
+   * \brief Lists, for each HNA network, the gateways among which the flows
+   * are spread with their weights, unless the policy is to use the nearest
+   * gateway of the HNA routing table.
+   *
+   * The gateways are the reachable ones at most HnaDistanceSlack hops
+   * farther than the nearest one.
+   *
+   * \param candidates The reachable gateways of each network.
+   */
+  void HnaGatewayComputation (const HnaGatewayCandidates &candidates);
+
+  /**
+   * \brief Finds the gateway of a packet to a HNA network.
+   *
+   * The gateway recorded in the packet by a previous hop is kept while it
+   * is reachable; otherwise the gateway of the flow is selected among the
+   * ones of the longest matching network, by a hash of the addresses and
+   * flow label of the packet, in O(log n).
+   *
+   * \param p The packet, null if the caller only queries a route.
+   * \param header The IPv6 header of the packet.
+   * \param[out] gateway The main address of the gateway.
+   * \param[out] entry The routing table entry of the gateway.
+   * \returns True if a gateway was found, false if the packet is routed by
+   * the HNA routing table.
+   */
+  bool LookupHnaGateway (Ptr<const Packet> p, const Ipv6Header &header,
+                         Ipv6Address &gateway, RoutingTableEntry &entry) const;
+
   /**
    * \brief Gets the main address associated with a given interface address.
    * \param iface_addr the interface address.
@@ -397,6 +848,122 @@ private:
    */
   void HnaTimerExpire ();
 
+  bool m_adaptiveIntervals;       //!< True if the HELLO and TC intervals adapt to the neighborhood stability.
+  Time m_minHelloInterval;        //!< Shortest adaptive HELLO interval.
+  Time m_maxHelloInterval;        //!< Longest adaptive HELLO interval.
+  Time m_minTcInterval;           //!< Shortest adaptive TC interval.
+  Time m_maxTcInterval;           //!< Longest adaptive TC interval.
+  Time m_currentHelloInterval;    //!< Interval until the next HELLO message, advertised in HELLO messages.
+  Time m_currentTcInterval;       //!< Interval until the next TC message, advertised in TC messages.
+  Time m_lastLinkSetChange;       //!< Time of the last change of the Link Set.
+  Time m_lastMprSelectorChange;   //!< Time of the last change of the MPR Selector Set.
+
+  /**
+   * \brief Computes the next interval of an adaptive timer.
+   *
+   * The interval stays at its floor while the watched set changed during
+   * the last interval, and doubles up to its ceiling otherwise.
+   *
+   * \param interval The current interval.
+   * \param lastChange The time of the last change of the watched set.
+   * \param floor The shortest interval.
+   * \param ceiling The longest interval.
+   * \returns The next interval.
+   */
+  Time NextAdaptiveInterval (Time interval, Time lastChange, Time floor, Time ceiling) const;
+
+  /**
+   * \brief Brings an adaptive timer back to its floor, so that the next
+   * message is sent early.
+   * \param timer The timer.
+   * \param interval The current interval of the timer, set to the floor.
+   * \param floor The shortest interval.
+   */
+  void ShortenInterval (Timer &timer, Time &interval, Time floor);
+
+  /**
+   * \brief Notifies a change of the Link Set (a link appeared, disappeared
+   * or changed its symmetry), which shortens the HELLO interval in adaptive mode.
+   */
+  void LinkSetChanged ();
+
+  /**
+   * \brief Notifies a change of the MPR Selector Set, which shortens the
+   * TC interval in adaptive mode and triggers a TC if enabled.
+   */
+  void MprSelectorSetChanged ();
+
+  bool m_triggeredTc;                 //!< True if MPR Selector Set changes trigger a TC.
+  Time m_triggeredTcMinSpacing;       //!< Shortest delay between a TC and a triggered one.
+  Time m_triggeredTcHoldDown;         //!< Window in which at most m_triggeredTcMaxBurst TCs are triggered.
+  uint32_t m_triggeredTcMaxBurst;     //!< Number of triggered TCs after which triggers are held down.
+  Time m_lastTcTime;                  //!< Time at which the last TC was built.
+  Time m_triggeredTcWindowStart;      //!< Start of the current hold-down window.
+  uint32_t m_triggeredTcBurst;        //!< Triggered TCs sent in the current hold-down window.
+  uint32_t m_triggeredTcCount;        //!< Triggered TCs sent.
+  uint32_t m_suppressedTcCount;       //!< Triggers coalesced into a pending TC or held down.
+  Timer m_triggeredTcTimer;           //!< Timer for the pending triggered TC.
+
+  /**
+   * \brief Schedules a triggered TC, unless one is already pending or
+   * triggers are held down.
+   */
+  void TriggerTc ();
+
+  /**
+   * \brief Sends the pending triggered TC.
+   */
+  void TriggeredTcTimerExpire ();
+
+  uint32_t m_tcRedundancy;            //!< TC_REDUNDANCY: 0 MPR selectors, 1 and MPRs, 2 all symmetric neighbors.
+  std::set<Ipv6Address> m_advertisedNeighbors;  //!< Neighbors advertised in the last TC, if m_tcRedundancy > 0.
+
+  /**
+   * \brief Gets the neighbors to advertise in TC messages, depending on
+   * TC_REDUNDANCY (\RFC{3626}, section 15.1).
+   * \returns The main addresses of the advertised neighbors.
+   */
+  std::vector<Ipv6Address> GetAdvertisedNeighbors () const;
+
+  std::string m_fisheyeTtlString;     //!< TTL sequence of the TC messages, as configured.
+  std::vector<uint8_t> m_fisheyeTtl;  //!< TTL sequence of the TC messages, empty if disabled.
+  uint32_t m_fisheyeIndex;            //!< Position of the next TC in m_fisheyeTtl.
+
+  bool m_differentialTc;              //!< True if the TCs between two full ones only carry the changes.
+  uint32_t m_fullTcRefresh;           //!< One TC in m_fullTcRefresh is a full one.
+  uint32_t m_tcsSinceFullTc;          //!< Differential TCs sent since the last full one.
+  uint16_t m_fullTcAnsn;              //!< ANSN of the last full TC sent.
+  std::set<Ipv6Address> m_fullTcAddresses;  //!< Advertised Neighbor Set of the last full TC sent.
+
+  /// Last full TC received from an originator, which the differential ones apply to.
+  struct DiffTcBase
+  {
+    uint16_t ansn;                      //!< ANSN of the full TC.
+    std::set<Ipv6Address> addresses;    //!< Advertised Neighbor Set of the full TC.
+    std::set<Ipv6Address> added;        //!< Neighbors added by the last differential TC applied.
+    std::set<Ipv6Address> removed;      //!< Neighbors removed by the last differential TC applied.
+  };
+  std::map<Ipv6Address, DiffTcBase> m_diffTcBases;  //!< Bases of the differential TCs, by originator.
+
+  /**
+   * \brief Sets the TTL of a TC message and its validity time.
+   *
+   * In fisheye mode, the TTL is the next one of the sequence and the
+   * validity time covers the TC emissions until the next TC reaching at
+   * least as far, so that distant nodes keep the advertised links between
+   * two TCs reaching them.
+   *
+   * \param msg The TC message.
+   */
+  void SetTcScope (olsr6::MessageHeader &msg);
+
+  Time m_memoryUsageInterval; //!< Interval between two memory usage samples, zero if disabled.
+  Timer m_memoryUsageTimer;   //!< Timer for the memory usage samples.
+  /**
+   * \brief Samples the memory usage into the MemoryUsage trace and reschedules the timer.
+   */
+  void MemoryUsageTimerExpire ();
+
   /**
    * \brief Removes tuple if expired. Else timer is rescheduled to expire at tuple.expirationTime.
    *
@@ -421,6 +988,106 @@ private:
    */
   void LinkTupleTimerExpire (Ipv6Address neighborIfaceAddr);
 
+  /**
+   * \brief Schedules the expiry timer of a link, replacing the pending one if any.
+   *
+   * \param neighborIfaceAddr The tuple neighbor interface address.
+   * \param expirationTime The time the timer expires.
+   */
+  void ScheduleLinkTupleTimer (const Ipv6Address &neighborIfaceAddr, Time expirationTime);
+
+  /**
+   * \brief Cancels the expiry timer of a link, when its tuple is removed.
+   *
+   * \param neighborIfaceAddr The tuple neighbor interface address.
+   */
+  void CancelLinkTupleTimer (const Ipv6Address &neighborIfaceAddr);
+
+  /// Pending link expiry timers, one per link, by neighbor interface address.
+  std::map<Ipv6Address, EventId> m_linkTupleTimers;
+
+  bool m_linkHysteresis;      //!< True if link hysteresis (\RFC{3626}, section 14) is enabled.
+  double m_hystScaling;       //!< HYST_SCALING: weight of the last HELLO in the link quality.
+  double m_hystThresholdHigh; //!< HYST_THRESHOLD_HIGH: quality above which a pending link is established.
+  double m_hystThresholdLow;  //!< HYST_THRESHOLD_LOW: quality below which a link becomes pending.
+
+  /**
+   * \brief Updates the quality of a link on a received or a missed HELLO,
+   * and its pending state when the quality crosses a threshold.
+   *
+   * \param tuple The link tuple.
+   * \param received True if a HELLO was received, false if one was missed.
+   */
+  void UpdateLinkQuality (LinkTuple &tuple, bool received);
+
+  /**
+   * \brief Counts a missed HELLO if none was received on the link since
+   * its deadline, and reschedules the timer to the next deadline.
+   *
+   * \param neighborIfaceAddr The tuple neighbor interface address.
+   */
+  void LinkQualityTimerExpire (Ipv6Address neighborIfaceAddr);
+
+  /**
+   * \brief Schedules the missed HELLO timer of a link at its deadline,
+   * replacing the pending one if any.
+   *
+   * \param tuple The link tuple.
+   */
+  void ScheduleLinkQualityTimer (const LinkTuple &tuple);
+
+  /**
+   * \brief Cancels the missed HELLO timer of a link, when its tuple is removed.
+   *
+   * \param neighborIfaceAddr The tuple neighbor interface address.
+   */
+  void CancelLinkQualityTimer (const Ipv6Address &neighborIfaceAddr);
+
+  /// Pending missed HELLO timers, one per link, by neighbor interface address.
+  std::map<Ipv6Address, EventId> m_linkQualityTimers;
+
+  uint8_t m_linkMetric;       //!< Metric of the links, hop count or ETX.
+  uint32_t m_etxWindow;       //!< Number of HELLO intervals the LQ of a link is measured over.
+
+  /**
+   * \brief Records a received or a missed HELLO in the LQ of a link.
+   *
+   * \param tuple The link tuple.
+   * \param received True if a HELLO was received, false if one was missed.
+   */
+  void UpdateEtx (LinkTuple &tuple, bool received);
+
+  /**
+   * \brief Finds the symmetric link to a neighbor with the lowest ETX.
+   * \param neighborMainAddr The main address of the neighbor.
+   * \returns The link tuple, or NULL if there is no symmetric link to the neighbor.
+   */
+  const LinkTuple * FindBestLink (const Ipv6Address &neighborMainAddr) const;
+
+  /**
+   * \returns The ETX of the best symmetric link to each neighbor, by main address.
+   */
+  std::map<Ipv6Address, double> GetNeighborCosts () const;
+
+  /**
+   * \returns The symmetric neighbors with a link on each local interface, by
+   * interface address, with the ETX of the best symmetric link to them on
+   * that interface, infinite if the link is not symmetric anymore.  The
+   * neighbors without any link tuple are all on the interface
+   * Ipv6Address::GetAny (), with an infinite ETX, as when the whole node
+   * was considered as a single interface.
+   */
+  InterfaceNeighborCosts GetInterfaceNeighborCosts () const;
+
+  /**
+   * \brief Creates the routes to the neighbors, the 2-hop neighbors and the
+   * nodes of the Topology Set along the paths of lowest ETX (steps 2 and 3
+   * of the routing table computation with the ETX metric).
+   *
+   * The paths are computed with Dijkstra's algorithm on a binary heap.
+   */
+  void EtxRoutingTableComputation ();
+
   /**
    * \brief Removes 2_hop neighbor tuple_ if expired. Else the timer is rescheduled to expire at tuple_->time().
    *
@@ -473,8 +1140,52 @@ private:
 
   /// A list of pending messages which are buffered awaiting for being sent.
   olsr6::MessageList m_queuedMessages;
+  /// The interface each queued message is restricted to, the any address if it is sent on all of them.
+  std::vector<Ipv6Address> m_queuedMessageIfaces;
   Timer m_queuedMessagesTimer; //!< timer for throttling outgoing messages
 
+  bool m_unicastRelay;  //!< True if the packets for a single neighbor are sent as unicast.
+  bool m_compressedMessages;  //!< True if the HELLO, TC and MID messages may be sent compressed.
+  /// Expiry time of the compression capability of each neighbor interface, announced in its HELLOs.
+  std::map<Ipv6Address, Time> m_compressionNeighbors;
+
+  /**
+   * \brief Tells whether the messages sent on an interface may be compressed.
+   *
+   * They may if the interface has links and the HELLOs of every neighbor
+   * interface of these links announced that it accepts compressed messages.
+   *
+   * \param ifaceAddr The address of the interface.
+   * \returns True if the messages may be compressed.
+   */
+  bool CanCompress (const Ipv6Address &ifaceAddr) const;
+
+  std::string m_authenticationKey;  //!< Key the packets are signed with, empty if they are not.
+  uint8_t m_authenticationKeyId;    //!< Key ID of m_authenticationKey.
+  /// Precomputed HMAC states of the keys accepted, by Key ID.
+  std::map<uint8_t, HmacSha256> m_authenticationKeys;
+  /// Packet sequence numbers received from each signing node.
+  std::map<Ipv6Address, ReplayWindow> m_replayWindows;
+
+  /**
+   * \brief Writes the ICV of a packet ending with a signature message.
+   * \param packet The packet, starting with its packet header.
+   */
+  void SignPacket (Ptr<Packet> packet);
+
+  /**
+   * \brief Checks the signature of a packet, then that its sequence number
+   * was not received yet from the signing node.
+   *
+   * \param packet The packet, starting with its packet header.
+   * \param header The packet header.
+   * \param signature The signature message ending the packet, or an empty
+   *        message if the packet is not signed.
+   * \returns True if the packet is accepted.
+   */
+  bool AuthenticatePacket (Ptr<const Packet> packet, const PacketHeader &header,
+                           const MessageHeader &signature);
+
   /**
    * \brief OLSR6's default forwarding algorithm.
    *
@@ -498,8 +1209,11 @@ private:
    *
    * \param message the %OLSR6 message which must be sent.
    * \param delay maximum delay the %OLSR6 message is going to be buffered.
+   * \param iface the address of the only interface to send the message on,
+   * or the any address to send it on every interface.
    */
-  void QueueMessage (const olsr6::MessageHeader &message, Time delay);
+  void QueueMessage (const olsr6::MessageHeader &message, Time delay,
+                     Ipv6Address iface = Ipv6Address::GetAny ());
 
   /**
    * \brief Creates as many %OLSR6 packets as needed in order to send all buffered
@@ -511,10 +1225,23 @@ private:
   void SendQueuedMessages ();
 
   /**
-   * \brief Creates a new %OLSR6 HELLO message which is buffered for being sent later on.
+   * \brief Creates a new %OLSR6 HELLO message for each interface which is buffered
+   * for being sent later on that interface.
+   *
+   * The HELLO of an interface lists the links of that interface, and the
+   * neighbors only reached through other interfaces with the UNSPEC_LINK
+   * link type (\RFC{3626}, section 6.2).
    */
   void SendHello ();
 
+  /**
+   * \brief Establishes the neighbor type advertised in the HELLO messages.
+   * \param neighborMainAddr The main address of the neighbor.
+   * \param nb_type The neighbor type, set if the neighbor is known.
+   * \returns False if the neighbor is not in the Neighbor Set.
+   */
+  bool GetNeighborType (const Ipv6Address &neighborMainAddr, uint8_t &nb_type);
+
   /**
    * \brief Creates a new %OLSR6 TC message which is buffered for being sent later on.
    */
@@ -689,6 +1416,36 @@ private:
   void ProcessTc (const olsr6::MessageHeader &msg,
                   const Ipv6Address &senderIface);
 
+  /**
+   * \brief Processes a differential TC message.
+   *
+   * The changes are relative to the Advertised Neighbor Set of the TC
+   * message they are based on.  Only the links which they add or remove
+   * since the last differential TC applied are inserted or erased; the
+   * other links of the originator are refreshed in a single pass.  If the
+   * base TC was not received, the message is discarded and the Topology
+   * Set waits for the next full TC.
+   *
+   * \param msg The %OLSR6 message which contains the differential TC message.
+   * \param senderIface The address of the interface where the message was sent from.
+   */
+  void ProcessDiffTc (const olsr6::MessageHeader &msg,
+                      const Ipv6Address &senderIface);
+
+  /**
+   * \brief Updates the Topology Set with an Advertised Neighbor Set
+   * (steps 3 and 4 of the TC message processing).
+   *
+   * \param originator The originator of the advertised set.
+   * \param ansn The Advertised Neighbor Sequence Number.
+   * \param addresses The advertised neighbor main addresses.
+   * \param vTime The validity time of the advertised links.
+   * \param costs The ETX of the advertised links, empty if not advertised.
+   */
+  void UpdateTopologySet (const Ipv6Address &originator, uint16_t ansn,
+                          const std::vector<Ipv6Address> &addresses, Time vTime,
+                          const std::vector<double> &costs = std::vector<double> ());
+
   /**
    * \brief Processes a MID message following \RFC{3626} specification.
    *
@@ -755,7 +1512,6 @@ private:
   void PopulateMprSelectorSet (const olsr6::MessageHeader &msg,
                                const olsr6::MessageHeader::Hello &hello);
 
-  int Degree (NeighborTuple const &tuple);
   /// Check that address is one of my interfaces
   bool IsMyOwnAddress (const Ipv6Address & a) const;
 
@@ -769,12 +1525,30 @@ private:
   /// Rx packet trace.
   TracedCallback <const PacketHeader &, const MessageList &> m_rxPacketTrace;
 
+  /// Rx packet trace, with the whole packet and the interface addresses.
+  TracedCallback <Ptr<const Packet>, const Ipv6Address &, const Ipv6Address &> m_rxRawPacketTrace;
+
+  /// Memory usage samples.
+  TracedCallback <const MemoryUsage &> m_memoryUsageTrace;
+
+  /// Triggered and suppressed TC counts, fired when either changes.
+  TracedCallback <uint32_t, uint32_t> m_tcTriggerTrace;
+
   /// Tx packet trace.
   TracedCallback <const PacketHeader &, const MessageList &> m_txPacketTrace;
 
   /// Routing table chanes challback
   TracedCallback <uint32_t> m_routingTableChanged;
 
+  /// Multicast data packets relayed.
+  TracedCallback <Ptr<const Packet>, const Ipv6Header &> m_multicastRelayTrace;
+
+  /// Changes of the advertised willingness.
+  TracedCallback <uint8_t, uint8_t> m_willingnessTrace;
+
+  /// Packets dropped by the authentication.
+  TracedCallback <const PacketHeader &, const Ipv6Address &> m_authenticationFailureTrace;
+
   /// Provides uniform random variables.
   Ptr<UniformRandomVariable> m_uniformRandomVariable;
 
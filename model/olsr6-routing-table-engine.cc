@@ -0,0 +1,496 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Ankit Deepak <adadeepak8@gmail.com>
+ *          Shravya Ks <shravya.ks0@gmail.com>,
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+///
+/// \file	olsr6-routing-table-engine.cc
+/// \brief	Implementation of the offline computation of the OLSR6 routing tables of a whole network.
+///
+
+#include "olsr6-routing-table-engine.h"
+#include "ns3/system-thread.h"
+#include "ns3/log.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Olsr6RoutingTableEngine");
+
+namespace olsr6 {
+
+/********** NetworkTopology **********/
+
+uint32_t
+NetworkTopology::AddNode (uint8_t willingness)
+{
+  NodeEntry node;
+  node.willingness = willingness;
+  nodes.push_back (node);
+  return nodes.size () - 1;
+}
+
+void
+NetworkTopology::AddInterface (uint32_t node, Ipv6Address address, uint32_t index)
+{
+  NS_ASSERT (node < nodes.size ());
+  InterfaceEntry interface;
+  interface.address = address;
+  interface.index = index;
+  nodes[node].interfaces.push_back (interface);
+}
+
+void
+NetworkTopology::AddLink (Ipv6Address ifaceA, Ipv6Address ifaceB)
+{
+  LinkEntry link;
+  link.ifaceA = ifaceA;
+  link.ifaceB = ifaceB;
+  links.push_back (link);
+}
+
+void
+NetworkTopology::AddAssociation (uint32_t node, Ipv6Address networkAddr, Ipv6Prefix netmask)
+{
+  NS_ASSERT (node < nodes.size ());
+  Association association;
+  association.networkAddr = networkAddr;
+  association.netmask = netmask;
+  nodes[node].associations.push_back (association);
+}
+
+/********** RoutingTableEngine **********/
+
+RoutingTableEngine::RoutingTableEngine ()
+  : m_nThreads (1),
+    m_topology (NULL),
+    m_task (NULL),
+    m_nextNode (0)
+{
+}
+
+void
+RoutingTableEngine::SetNThreads (uint32_t nThreads)
+{
+  NS_ASSERT (nThreads > 0);
+  m_nThreads = nThreads;
+}
+
+uint32_t
+RoutingTableEngine::GetNThreads (void) const
+{
+  return m_nThreads;
+}
+
+void
+RoutingTableEngine::Compute (const NetworkTopology &topology)
+{
+  NS_LOG_FUNCTION (this << topology.nodes.size () << topology.links.size () << m_nThreads);
+
+  m_topology = &topology;
+  uint32_t nNodes = topology.nodes.size ();
+
+  m_nodeIndex.clear ();
+  for (uint32_t node = 0; node < nNodes; node++)
+    {
+      const std::vector<NetworkTopology::InterfaceEntry> &interfaces = topology.nodes[node].interfaces;
+      if (interfaces.empty ())
+        {
+          NS_FATAL_ERROR ("Node " << node << " of the topology has no interface");
+        }
+      for (std::vector<NetworkTopology::InterfaceEntry>::const_iterator it = interfaces.begin ();
+           it != interfaces.end (); it++)
+        {
+          if (!m_nodeIndex.insert (std::make_pair (it->address, node)).second)
+            {
+              NS_FATAL_ERROR ("Address " << it->address << " is used by two interfaces of the topology");
+            }
+        }
+    }
+
+  m_adjacency.assign (nNodes, std::vector<Adjacency> ());
+  for (std::vector<NetworkTopology::LinkEntry>::const_iterator it = topology.links.begin ();
+       it != topology.links.end (); it++)
+    {
+      std::map<Ipv6Address, uint32_t>::const_iterator a = m_nodeIndex.find (it->ifaceA);
+      std::map<Ipv6Address, uint32_t>::const_iterator b = m_nodeIndex.find (it->ifaceB);
+      if (a == m_nodeIndex.end () || b == m_nodeIndex.end () || a->second == b->second)
+        {
+          NS_FATAL_ERROR ("Link " << it->ifaceA << " <-> " << it->ifaceB << " does not join two nodes of the topology");
+        }
+      Adjacency adjacency;
+      adjacency.localIfaceAddr = it->ifaceA;
+      adjacency.neighborIfaceAddr = it->ifaceB;
+      adjacency.neighbor = b->second;
+      m_adjacency[a->second].push_back (adjacency);
+      adjacency.localIfaceAddr = it->ifaceB;
+      adjacency.neighborIfaceAddr = it->ifaceA;
+      adjacency.neighbor = a->second;
+      m_adjacency[b->second].push_back (adjacency);
+    }
+
+  m_states.assign (nNodes, Olsr6State ());
+  m_results.assign (nNodes, Result ());
+
+  // HELLO messages: neighborhood and MPR set of every node.
+  RunParallel (&RoutingTableEngine::ComputeMprSet);
+
+  // TC and HNA messages: every node learns the links between the MPRs and
+  // their selectors, and the networks announced by the gateways.
+  m_topologySet.clear ();
+  m_associationSet.clear ();
+  for (uint32_t node = 0; node < nNodes; node++)
+    {
+      Ipv6Address mainAddress = topology.nodes[node].interfaces.front ().address;
+      const MprSet &mprSet = m_results[node].mprSet;
+      for (MprSet::const_iterator mpr = mprSet.begin (); mpr != mprSet.end (); mpr++)
+        {
+          TopologyTuple tuple;
+          tuple.destAddr = mainAddress;
+          tuple.lastAddr = *mpr;
+          tuple.sequenceNumber = 0;
+          m_topologySet.push_back (tuple);
+        }
+      const Associations &associations = topology.nodes[node].associations;
+      for (Associations::const_iterator it = associations.begin (); it != associations.end (); it++)
+        {
+          AssociationTuple tuple;
+          tuple.gatewayAddr = mainAddress;
+          tuple.networkAddr = it->networkAddr;
+          tuple.netmask = it->netmask;
+          m_associationSet.push_back (tuple);
+        }
+    }
+
+  RunParallel (&RoutingTableEngine::ComputeRoutingTable);
+
+  m_states.clear ();
+  m_topology = NULL;
+}
+
+uint32_t
+RoutingTableEngine::GetNNodes (void) const
+{
+  return m_results.size ();
+}
+
+const MprSet &
+RoutingTableEngine::GetMprSet (uint32_t node) const
+{
+  NS_ASSERT (node < m_results.size ());
+  return m_results[node].mprSet;
+}
+
+const std::vector<RoutingTableEntry> &
+RoutingTableEngine::GetRoutingTableEntries (uint32_t node) const
+{
+  NS_ASSERT (node < m_results.size ());
+  return m_results[node].table;
+}
+
+const std::vector<HnaRoutingTableEntry> &
+RoutingTableEngine::GetHnaRoutingTableEntries (uint32_t node) const
+{
+  NS_ASSERT (node < m_results.size ());
+  return m_results[node].hnaTable;
+}
+
+void
+RoutingTableEngine::RunParallel (Task task)
+{
+  m_task = task;
+  m_nextNode = 0;
+
+  if (m_nThreads == 1)
+    {
+      Worker ();
+      return;
+    }
+
+  std::vector<Ptr<SystemThread> > threads;
+  for (uint32_t i = 0; i < m_nThreads; i++)
+    {
+      threads.push_back (Create<SystemThread> (MakeCallback (&RoutingTableEngine::Worker, this)));
+      threads.back ()->Start ();
+    }
+  for (std::vector<Ptr<SystemThread> >::iterator it = threads.begin (); it != threads.end (); it++)
+    {
+      (*it)->Join ();
+    }
+}
+
+void
+RoutingTableEngine::Worker (void)
+{
+  while (true)
+    {
+      uint32_t node;
+      {
+        CriticalSection cs (m_mutex);
+        if (m_nextNode == m_results.size ())
+          {
+            return;
+          }
+        node = m_nextNode++;
+      }
+      (this->*m_task)(node);
+    }
+}
+
+void
+RoutingTableEngine::ComputeMprSet (uint32_t node)
+{
+  Olsr6State &state = m_states[node];
+  Ipv6Address mainAddress = m_topology->nodes[node].interfaces.front ().address;
+
+  // Link Set and Neighbor Set: every link is symmetric.
+  for (std::vector<Adjacency>::const_iterator it = m_adjacency[node].begin ();
+       it != m_adjacency[node].end (); it++)
+    {
+      LinkTuple link;
+      link.localIfaceAddr = it->localIfaceAddr;
+      link.neighborIfaceAddr = it->neighborIfaceAddr;
+      state.InsertLinkTuple (link);
+
+      Ipv6Address neighborMainAddr = GetMainAddress (it->neighborIfaceAddr);
+      if (state.FindNeighborTuple (neighborMainAddr) == NULL)
+        {
+          NeighborTuple neighbor;
+          neighbor.neighborMainAddr = neighborMainAddr;
+          neighbor.status = NeighborTuple::STATUS_SYM;
+          neighbor.willingness = m_topology->nodes[it->neighbor].willingness;
+          state.InsertNeighborTuple (neighbor);
+        }
+    }
+
+  // 2-hop Neighbor Set: the symmetric neighbors listed in the HELLO
+  // messages of each neighbor, except the node itself.
+  for (std::vector<Adjacency>::const_iterator it = m_adjacency[node].begin ();
+       it != m_adjacency[node].end (); it++)
+    {
+      Ipv6Address neighborMainAddr = GetMainAddress (it->neighborIfaceAddr);
+      const std::vector<Adjacency> &neighborLinks = m_adjacency[it->neighbor];
+      for (std::vector<Adjacency>::const_iterator it2 = neighborLinks.begin ();
+           it2 != neighborLinks.end (); it2++)
+        {
+          Ipv6Address twoHopNeighborAddr = GetMainAddress (it2->neighborIfaceAddr);
+          if (twoHopNeighborAddr == mainAddress
+              || state.FindTwoHopNeighborTuple (neighborMainAddr, twoHopNeighborAddr) != NULL)
+            {
+              continue;
+            }
+          TwoHopNeighborTuple twoHop;
+          twoHop.neighborMainAddr = neighborMainAddr;
+          twoHop.twoHopNeighborAddr = twoHopNeighborAddr;
+          state.InsertTwoHopNeighborTuple (twoHop);
+        }
+    }
+
+  MprSet mprSet = state.ComputeMprSet (mainAddress);
+  state.SetMprSet (mprSet);
+  m_results[node].mprSet = mprSet;
+}
+
+void
+RoutingTableEngine::ComputeRoutingTable (uint32_t node)
+{
+  const Olsr6State &state = m_states[node];
+  Ipv6Address mainAddress = m_topology->nodes[node].interfaces.front ().address;
+  std::map<Ipv6Address, RoutingTableEntry> table;
+
+  // 2. The symmetric neighbors (h=1), through every link to them, plus
+  // their main address if no link reaches it.
+  const NeighborSet &neighborSet = state.GetNeighbors ();
+  for (NeighborSet::const_iterator nb = neighborSet.begin (); nb != neighborSet.end (); nb++)
+    {
+      bool nb_main_addr = false;
+      const LinkTuple *lt = NULL;
+      for (LinkSet::const_iterator link = state.GetLinks ().begin ();
+           link != state.GetLinks ().end (); link++)
+        {
+          if (GetMainAddress (link->neighborIfaceAddr) == nb->neighborMainAddr)
+            {
+              lt = &(*link);
+              RoutingTableEntry &entry = table[link->neighborIfaceAddr];
+              entry.destAddr = link->neighborIfaceAddr;
+              entry.nextAddr = link->neighborIfaceAddr;
+              entry.interface = GetInterface (node, link->localIfaceAddr);
+              entry.distance = 1;
+              if (link->neighborIfaceAddr == nb->neighborMainAddr)
+                {
+                  nb_main_addr = true;
+                }
+            }
+        }
+      if (!nb_main_addr && lt != NULL)
+        {
+          RoutingTableEntry &entry = table[nb->neighborMainAddr];
+          entry.destAddr = nb->neighborMainAddr;
+          entry.nextAddr = lt->neighborIfaceAddr;
+          entry.interface = GetInterface (node, lt->localIfaceAddr);
+          entry.distance = 1;
+        }
+    }
+
+  // 3. The 2-hop neighbors, through a neighbor willing to forward.
+  const TwoHopNeighborSet &twoHopNeighbors = state.GetTwoHopNeighbors ();
+  for (TwoHopNeighborSet::const_iterator it = twoHopNeighbors.begin (); it != twoHopNeighbors.end (); it++)
+    {
+      if (state.FindSymNeighborTuple (it->twoHopNeighborAddr) || it->twoHopNeighborAddr == mainAddress)
+        {
+          continue;
+        }
+      const NeighborTuple *nb = state.FindSymNeighborTuple (it->neighborMainAddr);
+      if (nb == NULL || nb->willingness == OLSR6_WILL_NEVER)
+        {
+          continue;
+        }
+      std::map<Ipv6Address, RoutingTableEntry>::const_iterator nbEntry = table.find (it->neighborMainAddr);
+      if (nbEntry != table.end ())
+        {
+          RoutingTableEntry entry = nbEntry->second;
+          entry.destAddr = it->twoHopNeighborAddr;
+          entry.distance = 2;
+          table[it->twoHopNeighborAddr] = entry;
+        }
+    }
+
+  // 3.1. The destinations of the advertised links, hop by hop.
+  for (uint32_t h = 2;; h++)
+    {
+      bool added = false;
+      for (TopologySet::const_iterator it = m_topologySet.begin (); it != m_topologySet.end (); it++)
+        {
+          std::map<Ipv6Address, RoutingTableEntry>::const_iterator last = table.find (it->lastAddr);
+          if (table.find (it->destAddr) == table.end ()
+              && last != table.end () && last->second.distance == h)
+            {
+              RoutingTableEntry entry = last->second;
+              entry.destAddr = it->destAddr;
+              entry.distance = h + 1;
+              table[it->destAddr] = entry;
+              added = true;
+            }
+        }
+      if (!added)
+        {
+          break;
+        }
+    }
+
+  // 4. The other interface addresses of every reached node.
+  for (uint32_t other = 0; other < m_topology->nodes.size (); other++)
+    {
+      const std::vector<NetworkTopology::InterfaceEntry> &interfaces = m_topology->nodes[other].interfaces;
+      std::map<Ipv6Address, RoutingTableEntry>::const_iterator mainEntry = table.find (interfaces.front ().address);
+      if (mainEntry == table.end ())
+        {
+          continue;
+        }
+      RoutingTableEntry entry = mainEntry->second;
+      for (std::vector<NetworkTopology::InterfaceEntry>::const_iterator it = interfaces.begin () + 1;
+           it != interfaces.end (); it++)
+        {
+          if (table.find (it->address) == table.end ())
+            {
+              entry.destAddr = it->address;
+              table[it->address] = entry;
+            }
+        }
+    }
+
+  // 5. The networks announced by the other gateways, through the nearest one.
+  std::vector<HnaRoutingTableEntry> &hnaTable = m_results[node].hnaTable;
+  const Associations &localAssociations = m_topology->nodes[node].associations;
+  for (AssociationSet::const_iterator it = m_associationSet.begin (); it != m_associationSet.end (); it++)
+    {
+      bool local = false;
+      for (Associations::const_iterator assoc = localAssociations.begin ();
+           assoc != localAssociations.end (); assoc++)
+        {
+          if (assoc->networkAddr == it->networkAddr && assoc->netmask == it->netmask)
+            {
+              local = true;
+            }
+        }
+      std::map<Ipv6Address, RoutingTableEntry>::const_iterator gateway = table.find (it->gatewayAddr);
+      if (local || gateway == table.end ())
+        {
+          continue;
+        }
+
+      std::vector<HnaRoutingTableEntry>::iterator route = hnaTable.begin ();
+      while (route != hnaTable.end ()
+             && !(route->networkAddr == it->networkAddr && route->netmask == it->netmask))
+        {
+          route++;
+        }
+      if (route != hnaTable.end ())
+        {
+          if (route->distance <= gateway->second.distance)
+            {
+              continue;
+            }
+          hnaTable.erase (route);
+        }
+      HnaRoutingTableEntry entry;
+      entry.networkAddr = it->networkAddr;
+      entry.netmask = it->netmask;
+      entry.nextAddr = gateway->second.nextAddr;
+      entry.interface = gateway->second.interface;
+      entry.distance = gateway->second.distance;
+      hnaTable.push_back (entry);
+    }
+
+  std::vector<RoutingTableEntry> &result = m_results[node].table;
+  for (std::map<Ipv6Address, RoutingTableEntry>::const_iterator it = table.begin (); it != table.end (); it++)
+    {
+      result.push_back (it->second);
+    }
+}
+
+Ipv6Address
+RoutingTableEngine::GetMainAddress (const Ipv6Address &ifaceAddr) const
+{
+  std::map<Ipv6Address, uint32_t>::const_iterator it = m_nodeIndex.find (ifaceAddr);
+  if (it == m_nodeIndex.end ())
+    {
+      return ifaceAddr;
+    }
+  return m_topology->nodes[it->second].interfaces.front ().address;
+}
+
+uint32_t
+RoutingTableEngine::GetInterface (uint32_t node, const Ipv6Address &ifaceAddr) const
+{
+  const std::vector<NetworkTopology::InterfaceEntry> &interfaces = m_topology->nodes[node].interfaces;
+  for (std::vector<NetworkTopology::InterfaceEntry>::const_iterator it = interfaces.begin ();
+       it != interfaces.end (); it++)
+    {
+      if (it->address == ifaceAddr)
+        {
+          return it->index;
+        }
+    }
+  NS_ASSERT (false); // should not be reached
+  return 0;
+}
+
+}
+}  // namespace olsr6, ns3
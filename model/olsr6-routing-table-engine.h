@@ -0,0 +1,241 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Ankit Deepak <adadeepak8@gmail.com>
+ *          Shravya Ks <shravya.ks0@gmail.com>,
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+/// \brief	This header file declares the offline engine computing the OLSR6 routing tables of a whole network.
+
+#ifndef OLSR6_ROUTING_TABLE_ENGINE_H
+#define OLSR6_ROUTING_TABLE_ENGINE_H
+
+#include "olsr6-routing-protocol.h"
+#include "olsr6-state.h"
+#include "ns3/ipv6-address.h"
+#include "ns3/system-mutex.h"
+
+#include <vector>
+#include <map>
+
+namespace ns3 {
+namespace olsr6 {
+
+/// \ingroup olsr6
+/// Description of a whole network, as seen by %OLSR6 once it has converged.
+struct NetworkTopology
+{
+  /// An interface of a node.
+  struct InterfaceEntry
+  {
+    Ipv6Address address; //!< Address of the interface.
+    uint32_t index;      //!< Index of the interface in the Ipv6 object of the node.
+  };
+
+  /// A node running %OLSR6.
+  struct NodeEntry
+  {
+    std::vector<InterfaceEntry> interfaces; //!< Interfaces, the first one holds the main address.
+    uint8_t willingness;                    //!< Willingness of the node.
+    Associations associations;              //!< Networks announced by the node in HNA messages.
+  };
+
+  /// A symmetric link between two interfaces.
+  struct LinkEntry
+  {
+    Ipv6Address ifaceA; //!< Address of the interface at one end.
+    Ipv6Address ifaceB; //!< Address of the interface at the other end.
+  };
+
+  /**
+   * \brief Adds a node.
+   * \param willingness The willingness of the node.
+   * \returns The index of the node.
+   */
+  uint32_t AddNode (uint8_t willingness);
+
+  /**
+   * \brief Adds an interface to a node.  The address of the first interface
+   * added to a node is its main address.
+   * \param node The index of the node.
+   * \param address The address of the interface.
+   * \param index The index of the interface in the Ipv6 object of the node.
+   */
+  void AddInterface (uint32_t node, Ipv6Address address, uint32_t index);
+
+  /**
+   * \brief Adds a symmetric link between two interfaces.
+   * \param ifaceA The address of the interface at one end.
+   * \param ifaceB The address of the interface at the other end.
+   */
+  void AddLink (Ipv6Address ifaceA, Ipv6Address ifaceB);
+
+  /**
+   * \brief Adds a network announced by a node in HNA messages.
+   * \param node The index of the node.
+   * \param networkAddr The network address.
+   * \param netmask The network mask.
+   */
+  void AddAssociation (uint32_t node, Ipv6Address networkAddr, Ipv6Prefix netmask);
+
+  std::vector<NodeEntry> nodes; //!< Nodes of the network.
+  std::vector<LinkEntry> links; //!< Links of the network.
+};
+
+/// \ingroup olsr6
+/// A route to a network announced in HNA messages.
+struct HnaRoutingTableEntry
+{
+  Ipv6Address networkAddr; //!< Address of the destination network.
+  Ipv6Prefix netmask;      //!< Mask of the destination network.
+  Ipv6Address nextAddr;    //!< Address of the next hop.
+  uint32_t interface;      //!< Interface index.
+  uint32_t distance;       //!< Distance in hops to the gateway.
+};
+
+/// \ingroup olsr6
+/// \brief Offline computation of the MPR sets and routing tables of every
+/// node of a network.
+///
+/// The engine builds, for every node, the Link, Neighbor and 2-hop Neighbor
+/// Sets it would hold once HELLO messages have been exchanged, selects its
+/// MPR set with Olsr6State::ComputeMprSet, derives the Topology and
+/// Association Sets that TC and HNA messages would flood, and then follows
+/// the steps of RoutingProtocol::RoutingTableComputation for every node.
+///
+/// Both per-node phases run on a pool of SystemThread.  Every node is
+/// computed from data that is immutable during the phase and written to its
+/// own slot, so the results do not depend on the number of threads.
+class RoutingTableEngine
+{
+public:
+  RoutingTableEngine ();
+
+  /**
+   * \brief Sets the number of threads the computation runs on.
+   * \param nThreads The number of threads; 1 computes in the calling thread.
+   */
+  void SetNThreads (uint32_t nThreads);
+
+  /**
+   * \returns The number of threads the computation runs on.
+   */
+  uint32_t GetNThreads (void) const;
+
+  /**
+   * \brief Computes the MPR set and the routing tables of every node.
+   * \param topology The network.  It must outlive the computation only.
+   */
+  void Compute (const NetworkTopology &topology);
+
+  /**
+   * \returns The number of nodes of the last computed network.
+   */
+  uint32_t GetNNodes (void) const;
+
+  /**
+   * \param node The index of the node in the NetworkTopology.
+   * \returns The MPR set of the node.
+   */
+  const MprSet & GetMprSet (uint32_t node) const;
+
+  /**
+   * \param node The index of the node in the NetworkTopology.
+   * \returns The routing table of the node, ordered by destination as
+   * RoutingProtocol::GetRoutingTableEntries.
+   */
+  const std::vector<RoutingTableEntry> & GetRoutingTableEntries (uint32_t node) const;
+
+  /**
+   * \param node The index of the node in the NetworkTopology.
+   * \returns The routes of the node to the networks announced by the others.
+   */
+  const std::vector<HnaRoutingTableEntry> & GetHnaRoutingTableEntries (uint32_t node) const;
+
+private:
+  /// A link from a node to one of its neighbors.
+  struct Adjacency
+  {
+    Ipv6Address localIfaceAddr;    //!< Local interface address.
+    Ipv6Address neighborIfaceAddr; //!< Interface address of the neighbor.
+    uint32_t neighbor;             //!< Index of the neighbor.
+  };
+
+  /// The results computed for a node.
+  struct Result
+  {
+    MprSet mprSet;                                //!< MPR set.
+    std::vector<RoutingTableEntry> table;         //!< Routing table.
+    std::vector<HnaRoutingTableEntry> hnaTable;   //!< Routes to the HNA networks.
+  };
+
+  /// A computation run for every node.
+  typedef void (RoutingTableEngine::*Task)(uint32_t node);
+
+  /**
+   * \brief Runs a task for every node on the thread pool.
+   * \param task The task.
+   */
+  void RunParallel (Task task);
+
+  /// Runs the current task for the nodes not taken yet by another thread.
+  void Worker (void);
+
+  /**
+   * \brief Builds the neighborhood of a node and selects its MPR set.
+   * \param node The index of the node.
+   */
+  void ComputeMprSet (uint32_t node);
+
+  /**
+   * \brief Computes the routing table of a node.
+   * \param node The index of the node.
+   */
+  void ComputeRoutingTable (uint32_t node);
+
+  /**
+   * \param ifaceAddr An interface address.
+   * \returns The main address of the node owning the interface.
+   */
+  Ipv6Address GetMainAddress (const Ipv6Address &ifaceAddr) const;
+
+  /**
+   * \param node The index of a node.
+   * \param ifaceAddr The address of one of its interfaces.
+   * \returns The index of the interface.
+   */
+  uint32_t GetInterface (uint32_t node, const Ipv6Address &ifaceAddr) const;
+
+  uint32_t m_nThreads;                          //!< Number of threads.
+  const NetworkTopology *m_topology;            //!< Network being computed.
+  std::map<Ipv6Address, uint32_t> m_nodeIndex;  //!< Node index of every interface address.
+  std::vector<std::vector<Adjacency> > m_adjacency; //!< Links of every node.
+  std::vector<Olsr6State> m_states;             //!< Neighborhood of every node.
+  TopologySet m_topologySet;                    //!< Links advertised by TC messages.
+  AssociationSet m_associationSet;              //!< Networks advertised by HNA messages.
+  std::vector<Result> m_results;                //!< Results of every node.
+
+  Task m_task;          //!< Task being run by RunParallel.
+  uint32_t m_nextNode;  //!< Next node to be taken by a worker.
+  SystemMutex m_mutex;  //!< Protects m_nextNode.
+};
+
+}
+}  // namespace olsr6, ns3
+
+#endif /* OLSR6_ROUTING_TABLE_ENGINE_H */
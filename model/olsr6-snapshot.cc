@@ -0,0 +1,213 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Ankit Deepak <adadeepak8@gmail.com>
+ *          Shravya Ks <shravya.ks0@gmail.com>,
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+///
+/// \file	olsr6-snapshot.cc
+/// \brief	Implementation of the binary encoding of OLSR6 state snapshots.
+///
+
+#include "olsr6-snapshot.h"
+
+#include <algorithm>
+#include <cstring>
+
+#define IPV6_ADDRESS_SIZE 16
+
+namespace ns3 {
+namespace olsr6 {
+
+/********** SnapshotWriter **********/
+
+SnapshotWriter::SnapshotWriter (std::ostream &os, Time reference)
+  : m_os (os),
+    m_reference (reference)
+{
+}
+
+void
+SnapshotWriter::WriteU8 (uint8_t value)
+{
+  m_os.put (static_cast<char> (value));
+}
+
+void
+SnapshotWriter::WriteU16 (uint16_t value)
+{
+  WriteU8 ((value >> 8) & 0xff);
+  WriteU8 (value & 0xff);
+}
+
+void
+SnapshotWriter::WriteU32 (uint32_t value)
+{
+  WriteU16 ((value >> 16) & 0xffff);
+  WriteU16 (value & 0xffff);
+}
+
+void
+SnapshotWriter::WriteTime (Time time)
+{
+  WriteDuration (time - m_reference);
+}
+
+void
+SnapshotWriter::WriteDuration (Time duration)
+{
+  uint64_t nanoSeconds = static_cast<uint64_t> (duration.GetNanoSeconds ());
+  WriteU32 ((nanoSeconds >> 32) & 0xffffffff);
+  WriteU32 (nanoSeconds & 0xffffffff);
+}
+
+void
+SnapshotWriter::WriteDouble (double value)
+{
+  uint64_t bits;
+  std::memcpy (&bits, &value, sizeof (bits));
+  WriteU32 ((bits >> 32) & 0xffffffff);
+  WriteU32 (bits & 0xffffffff);
+}
+
+void
+SnapshotWriter::WriteAddress (const Ipv6Address &address)
+{
+  uint8_t buf[IPV6_ADDRESS_SIZE];
+  address.GetBytes (buf);
+  m_os.write (reinterpret_cast<const char *> (buf), IPV6_ADDRESS_SIZE);
+}
+
+void
+SnapshotWriter::WritePrefix (const Ipv6Prefix &prefix)
+{
+  WriteU8 (prefix.GetPrefixLength ());
+}
+
+void
+SnapshotWriter::WriteBytes (const uint8_t *buffer, uint32_t size)
+{
+  m_os.write (reinterpret_cast<const char *> (buffer), size);
+}
+
+bool
+SnapshotWriter::IsGood () const
+{
+  return m_os.good ();
+}
+
+/********** SnapshotReader **********/
+
+SnapshotReader::SnapshotReader (std::istream &is, Time reference)
+  : m_is (is),
+    m_reference (reference),
+    m_good (true)
+{
+}
+
+void
+SnapshotReader::ReadBytes (uint8_t *buffer, uint32_t size)
+{
+  if (m_good)
+    {
+      m_is.read (reinterpret_cast<char *> (buffer), size);
+      m_good = (static_cast<uint32_t> (m_is.gcount ()) == size);
+    }
+  if (!m_good)
+    {
+      std::fill (buffer, buffer + size, 0);
+    }
+}
+
+uint8_t
+SnapshotReader::ReadU8 (void)
+{
+  uint8_t value;
+  ReadBytes (&value, 1);
+  return value;
+}
+
+uint16_t
+SnapshotReader::ReadU16 (void)
+{
+  uint16_t value = ReadU8 () << 8;
+  value |= ReadU8 ();
+  return value;
+}
+
+uint32_t
+SnapshotReader::ReadU32 (void)
+{
+  uint32_t value = ReadU16 () << 16;
+  value |= ReadU16 ();
+  return value;
+}
+
+Time
+SnapshotReader::ReadTime (void)
+{
+  return m_reference + ReadDuration ();
+}
+
+Time
+SnapshotReader::ReadDuration (void)
+{
+  uint64_t nanoSeconds = static_cast<uint64_t> (ReadU32 ()) << 32;
+  nanoSeconds |= ReadU32 ();
+  return NanoSeconds (int64x64_t (static_cast<int64_t> (nanoSeconds)));
+}
+
+double
+SnapshotReader::ReadDouble (void)
+{
+  uint64_t bits = static_cast<uint64_t> (ReadU32 ()) << 32;
+  bits |= ReadU32 ();
+  double value;
+  std::memcpy (&value, &bits, sizeof (value));
+  return value;
+}
+
+Ipv6Address
+SnapshotReader::ReadAddress (void)
+{
+  uint8_t buf[IPV6_ADDRESS_SIZE];
+  ReadBytes (buf, IPV6_ADDRESS_SIZE);
+  return Ipv6Address (buf);
+}
+
+Ipv6Prefix
+SnapshotReader::ReadPrefix (void)
+{
+  uint8_t length = ReadU8 ();
+  if (length > 128)
+    {
+      m_good = false;
+      length = 0;
+    }
+  return Ipv6Prefix (length);
+}
+
+bool
+SnapshotReader::IsGood () const
+{
+  return m_good;
+}
+
+}
+}  // namespace olsr6, ns3
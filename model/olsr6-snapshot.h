@@ -0,0 +1,188 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Ankit Deepak <adadeepak8@gmail.com>
+ *          Shravya Ks <shravya.ks0@gmail.com>,
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+/// \brief	This header file declares the binary encoding used to save and restore the state of an OLSR6 node.
+
+#ifndef OLSR6_SNAPSHOT_H
+#define OLSR6_SNAPSHOT_H
+
+#include <iostream>
+
+#include "ns3/ipv6-address.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+namespace olsr6 {
+
+/// \ingroup olsr6
+/// Writes the fields of an %OLSR6 state snapshot to an output stream.
+///
+/// Integers and doubles are written in network byte order.  Times are
+/// written as a signed number of nanoseconds relative to a reference time,
+/// so that the reader can rebase them to the instant the snapshot is
+/// restored.
+class SnapshotWriter
+{
+public:
+  /**
+   * Constructor.
+   * \param os The stream the snapshot is written to.
+   * \param reference The time all the written times are relative to.
+   */
+  SnapshotWriter (std::ostream &os, Time reference);
+
+  /**
+   * Writes an 8-bit unsigned integer.
+   * \param value The value to write.
+   */
+  void WriteU8 (uint8_t value);
+  /**
+   * Writes a 16-bit unsigned integer.
+   * \param value The value to write.
+   */
+  void WriteU16 (uint16_t value);
+  /**
+   * Writes a 32-bit unsigned integer.
+   * \param value The value to write.
+   */
+  void WriteU32 (uint32_t value);
+  /**
+   * Writes a time, relative to the reference time.
+   * \param time The absolute time to write.
+   */
+  void WriteTime (Time time);
+  /**
+   * Writes a duration, which is not relative to the reference time.
+   * \param duration The duration to write.
+   */
+  void WriteDuration (Time duration);
+  /**
+   * Writes a double as its IEEE 754 binary64 bits.
+   * \param value The value to write.
+   */
+  void WriteDouble (double value);
+  /**
+   * Writes an IPv6 address.
+   * \param address The address to write.
+   */
+  void WriteAddress (const Ipv6Address &address);
+  /**
+   * Writes an IPv6 prefix as its prefix length.
+   * \param prefix The prefix to write.
+   */
+  void WritePrefix (const Ipv6Prefix &prefix);
+  /**
+   * Writes raw bytes.
+   * \param buffer The bytes to write.
+   * \param size The number of bytes to write.
+   */
+  void WriteBytes (const uint8_t *buffer, uint32_t size);
+
+  /**
+   * \returns True if no write error has occurred.
+   */
+  bool IsGood () const;
+
+private:
+  std::ostream &m_os; //!< Output stream.
+  Time m_reference;   //!< Time the written times are relative to.
+};
+
+/// \ingroup olsr6
+/// Reads the fields of an %OLSR6 state snapshot written by a SnapshotWriter.
+///
+/// Once the end of the stream has been hit every read returns zero and
+/// IsGood () returns false, so that callers can check for a truncated
+/// snapshot once, after having read a whole record.
+class SnapshotReader
+{
+public:
+  /**
+   * Constructor.
+   * \param is The stream the snapshot is read from.
+   * \param reference The time all the read times are rebased to.
+   */
+  SnapshotReader (std::istream &is, Time reference);
+
+  /**
+   * Reads an 8-bit unsigned integer.
+   * \returns The value read.
+   */
+  uint8_t ReadU8 (void);
+  /**
+   * Reads a 16-bit unsigned integer.
+   * \returns The value read.
+   */
+  uint16_t ReadU16 (void);
+  /**
+   * Reads a 32-bit unsigned integer.
+   * \returns The value read.
+   */
+  uint32_t ReadU32 (void);
+  /**
+   * Reads a time and rebases it to the reference time.
+   * \returns The absolute time read.
+   */
+  Time ReadTime (void);
+  /**
+   * Reads a duration, which is not rebased.
+   * \returns The duration read.
+   */
+  Time ReadDuration (void);
+  /**
+   * Reads a double.
+   * \returns The value read.
+   */
+  double ReadDouble (void);
+  /**
+   * Reads an IPv6 address.
+   * \returns The address read.
+   */
+  Ipv6Address ReadAddress (void);
+  /**
+   * Reads an IPv6 prefix.
+   * \returns The prefix read.
+   */
+  Ipv6Prefix ReadPrefix (void);
+  /**
+   * Reads raw bytes.
+   * \param buffer The destination buffer.
+   * \param size The number of bytes to read.
+   */
+  void ReadBytes (uint8_t *buffer, uint32_t size);
+
+  /**
+   * \returns True if every read so far has been satisfied.
+   */
+  bool IsGood () const;
+
+private:
+
+  std::istream &m_is; //!< Input stream.
+  Time m_reference;   //!< Time the read times are rebased to.
+  bool m_good;        //!< False once a read could not be satisfied.
+};
+
+}
+}  // namespace olsr6, ns3
+
+#endif /* OLSR6_SNAPSHOT_H */
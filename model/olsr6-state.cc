@@ -32,9 +32,16 @@
 ///
 
 #include "olsr6-state.h"
+#include "ns3/log.h"
 
+#include <limits>
+#include <set>
+#include <sstream>
 
 namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("Olsr6State");
+
 namespace olsr6 {
 
 /********** MPR Selector Set Manipulation **********/
@@ -127,6 +134,20 @@ Olsr6State::FindNeighborTuple (Ipv6Address const &mainAddr)
   return NULL;
 }
 
+const NeighborTuple*
+Olsr6State::FindNeighborTuple (Ipv6Address const &mainAddr) const
+{
+  for (NeighborSet::const_iterator it = m_neighborSet.begin ();
+       it != m_neighborSet.end (); it++)
+    {
+      if (it->neighborMainAddr == mainAddr)
+        {
+          return &(*it);
+        }
+    }
+  return NULL;
+}
+
 const NeighborTuple*
 Olsr6State::FindSymNeighborTuple (Ipv6Address const &mainAddr) const
 {
@@ -293,6 +314,537 @@ Olsr6State::GetMprSet () const
   return m_mprSet;
 }
 
+/********** MPR Computation **********/
+
+///
+/// \brief This auxiliary function (defined in \RFC{3626}) is used for calculating the MPR Set.
+///
+/// \param tuple the neighbor tuple which has the main address of the node we are going to calculate its degree to.
+/// \return the degree of the node.
+///
+int
+Olsr6State::Degree (NeighborTuple const &tuple) const
+{
+  int degree = 0;
+  for (TwoHopNeighborSet::const_iterator it = GetTwoHopNeighbors ().begin ();
+       it != GetTwoHopNeighbors ().end (); it++)
+    {
+      TwoHopNeighborTuple const &nb2hop_tuple = *it;
+      if (nb2hop_tuple.neighborMainAddr == tuple.neighborMainAddr)
+        {
+          const NeighborTuple *nb_tuple =
+            FindNeighborTuple (nb2hop_tuple.neighborMainAddr);
+          if (nb_tuple == NULL)
+            {
+              degree++;
+            }
+        }
+    }
+  return degree;
+}
+
+namespace {
+///
+/// \brief Remove all covered 2-hop neighbors from N2 set.
+/// This is a helper function used by ComputeMprSet algorithm.
+///
+/// \param neighborMainAddr Neighbor main address.
+/// \param N2 Reference to the 2-hop neighbor set.
+///
+void
+CoverTwoHopNeighbors (Ipv6Address neighborMainAddr, TwoHopNeighborSet & N2)
+{
+  // first gather all 2-hop neighbors to be removed
+  std::set<Ipv6Address> toRemove;
+  for (TwoHopNeighborSet::iterator twoHopNeigh = N2.begin (); twoHopNeigh != N2.end (); twoHopNeigh++)
+    {
+      if (twoHopNeigh->neighborMainAddr == neighborMainAddr)
+        {
+          toRemove.insert (twoHopNeigh->twoHopNeighborAddr);
+        }
+    }
+  // Now remove all matching records from N2
+  for (TwoHopNeighborSet::iterator twoHopNeigh = N2.begin (); twoHopNeigh != N2.end (); )
+    {
+      if (toRemove.find (twoHopNeigh->twoHopNeighborAddr) != toRemove.end ())
+        {
+          twoHopNeigh = N2.erase (twoHopNeigh);
+        }
+      else
+        {
+          twoHopNeigh++;
+        }
+    }
+}
+} // anonymous namespace
+
+int
+Olsr6State::Degree (NeighborTuple const &tuple, std::map<Ipv6Address, int> &degrees) const
+{
+  std::map<Ipv6Address, int>::const_iterator degree = degrees.find (tuple.neighborMainAddr);
+  if (degree != degrees.end ())
+    {
+      return degree->second;
+    }
+  return degrees[tuple.neighborMainAddr] = Degree (tuple);
+}
+
+MprSet
+Olsr6State::ComputeMprSet (const Ipv6Address &mainAddress) const
+{
+  // The whole node is considered as a single interface
+  InterfaceNeighborCosts neighbors;
+  std::map<Ipv6Address, double> &interfaceNeighbors = neighbors[Ipv6Address::GetAny ()];
+  for (NeighborSet::const_iterator neighbor = GetNeighbors ().begin ();
+       neighbor != GetNeighbors ().end (); neighbor++)
+    {
+      interfaceNeighbors[neighbor->neighborMainAddr] = 1.0;
+    }
+  InterfaceMprSets mprSets = ComputeInterfaceMprSets (mainAddress, neighbors);
+  return mprSets[Ipv6Address::GetAny ()];
+}
+
+InterfaceMprSets
+Olsr6State::ComputeInterfaceMprSets (const Ipv6Address &mainAddress,
+                                     const InterfaceNeighborCosts &interfaceNeighbors) const
+{
+  // MPR computation is done for each interface. See section 8.3.1
+  // (RFC 3626) for details.  The exclusions from N2 below do not depend on
+  // the interface, so that they are evaluated once for all the interfaces,
+  // and only the selection itself is repeated.
+  InterfaceMprSets mprSets;
+
+  // N is the subset of neighbors of the node, which are
+  // neighbor "of the interface I"
+  NeighborSet N;
+  for (NeighborSet::const_iterator neighbor = GetNeighbors ().begin ();
+       neighbor != GetNeighbors ().end (); neighbor++)
+    {
+      if (neighbor->status == NeighborTuple::STATUS_SYM) // I think that we need this check
+        {
+          N.push_back (*neighbor);
+        }
+    }
+
+  // N2 is the set of 2-hop neighbors reachable from "the interface
+  // I", excluding:
+  // (i)   the nodes only reachable by members of N with willingness WILL_NEVER
+  // (ii)  the node performing the computation
+  // (iii) all the symmetric neighbors: the nodes for which there exists a symmetric
+  //       link to this node on some interface.
+  TwoHopNeighborSet N2;
+  for (TwoHopNeighborSet::const_iterator twoHopNeigh = GetTwoHopNeighbors ().begin ();
+       twoHopNeigh != GetTwoHopNeighbors ().end (); twoHopNeigh++)
+    {
+      // excluding:
+      // (ii)  the node performing the computation
+      if (twoHopNeigh->twoHopNeighborAddr == mainAddress)
+        {
+          continue;
+        }
+
+      //  excluding:
+      // (i)   the nodes only reachable by members of N with willingness WILL_NEVER
+      bool ok = false;
+      for (NeighborSet::const_iterator neigh = N.begin ();
+           neigh != N.end (); neigh++)
+        {
+          if (neigh->neighborMainAddr == twoHopNeigh->neighborMainAddr)
+            {
+              if (neigh->willingness == OLSR6_WILL_NEVER)
+                {
+                  ok = false;
+                  break;
+                }
+              else
+                {
+                  ok = true;
+                  break;
+                }
+            }
+        }
+      if (!ok)
+        {
+          continue;
+        }
+
+      // excluding:
+      // (iii) all the symmetric neighbors: the nodes for which there exists a symmetric
+      //       link to this node on some interface.
+      for (NeighborSet::const_iterator neigh = N.begin ();
+           neigh != N.end (); neigh++)
+        {
+          if (neigh->neighborMainAddr == twoHopNeigh->twoHopNeighborAddr)
+            {
+              ok = false;
+              break;
+            }
+        }
+
+      if (ok)
+        {
+          N2.push_back (*twoHopNeigh);
+        }
+    }
+
+#ifdef NS3_LOG_ENABLE
+  {
+    std::ostringstream os;
+    os << "[";
+    for (TwoHopNeighborSet::const_iterator iter = N2.begin ();
+         iter != N2.end (); iter++)
+      {
+        TwoHopNeighborSet::const_iterator next = iter;
+        next++;
+        os << iter->neighborMainAddr << "->" << iter->twoHopNeighborAddr;
+        if (next != N2.end ())
+          {
+            os << ", ";
+          }
+      }
+    os << "]";
+    NS_LOG_DEBUG ("N2: " << os.str ());
+  }
+#endif  //NS3_LOG_ENABLE
+
+  // The degrees are computed at most once, whatever the number of interfaces
+  std::map<Ipv6Address, int> degrees;
+  for (InterfaceNeighborCosts::const_iterator iface = interfaceNeighbors.begin ();
+       iface != interfaceNeighbors.end (); iface++)
+    {
+      NeighborSet interfaceN;
+      for (NeighborSet::const_iterator neighbor = N.begin (); neighbor != N.end (); neighbor++)
+        {
+          if (iface->second.find (neighbor->neighborMainAddr) != iface->second.end ())
+            {
+              interfaceN.push_back (*neighbor);
+            }
+        }
+      TwoHopNeighborSet interfaceN2;
+      for (TwoHopNeighborSet::const_iterator twoHopNeigh = N2.begin (); twoHopNeigh != N2.end (); twoHopNeigh++)
+        {
+          if (iface->second.find (twoHopNeigh->neighborMainAddr) != iface->second.end ())
+            {
+              interfaceN2.push_back (*twoHopNeigh);
+            }
+        }
+
+      MprSet &mprSet = mprSets[iface->first];
+      mprSet = SelectMprSet (interfaceN, interfaceN2, degrees);
+
+#ifdef NS3_LOG_ENABLE
+      {
+        std::ostringstream os;
+        os << "[";
+        for (MprSet::const_iterator iter = mprSet.begin ();
+             iter != mprSet.end (); iter++)
+          {
+            MprSet::const_iterator next = iter;
+            next++;
+            os << *iter;
+            if (next != mprSet.end ())
+              {
+                os << ", ";
+              }
+          }
+        os << "]";
+        NS_LOG_DEBUG ("Computed MPR set for node " << mainAddress << " on interface "
+                      << iface->first << ": " << os.str ());
+      }
+#endif  //NS3_LOG_ENABLE
+    }
+
+  return mprSets;
+}
+
+MprSet
+Olsr6State::SelectMprSet (const NeighborSet &N, TwoHopNeighborSet N2,
+                          std::map<Ipv6Address, int> &degrees) const
+{
+  MprSet mprSet;
+
+  // 1. Start with an MPR set made of all members of N with
+  // N_willingness equal to WILL_ALWAYS
+  for (NeighborSet::const_iterator neighbor = N.begin (); neighbor != N.end (); neighbor++)
+    {
+      if (neighbor->willingness == OLSR6_WILL_ALWAYS)
+        {
+          mprSet.insert (neighbor->neighborMainAddr);
+          // (not in RFC but I think is needed: remove the 2-hop
+          // neighbors reachable by the MPR from N2)
+          CoverTwoHopNeighbors (neighbor->neighborMainAddr, N2);
+        }
+    }
+
+  // 2. Calculate D(y), where y is a member of N, for all nodes in N.
+  // (we do this later)
+
+  // 3. Add to the MPR set those nodes in N, which are the *only*
+  // nodes to provide reachability to a node in N2.
+  std::set<Ipv6Address> coveredTwoHopNeighbors;
+  for (TwoHopNeighborSet::const_iterator twoHopNeigh = N2.begin (); twoHopNeigh != N2.end (); twoHopNeigh++)
+    {
+      bool onlyOne = true;
+      // try to find another neighbor that can reach twoHopNeigh->twoHopNeighborAddr
+      for (TwoHopNeighborSet::const_iterator otherTwoHopNeigh = N2.begin (); otherTwoHopNeigh != N2.end (); otherTwoHopNeigh++)
+        {
+          if (otherTwoHopNeigh->twoHopNeighborAddr == twoHopNeigh->twoHopNeighborAddr
+              && otherTwoHopNeigh->neighborMainAddr != twoHopNeigh->neighborMainAddr)
+            {
+              onlyOne = false;
+              break;
+            }
+        }
+      if (onlyOne)
+        {
+          NS_LOG_LOGIC ("Neighbor " << twoHopNeigh->neighborMainAddr
+                                    << " is the only that can reach 2-hop neigh. "
+                                    << twoHopNeigh->twoHopNeighborAddr
+                                    << " => select as MPR.");
+
+          mprSet.insert (twoHopNeigh->neighborMainAddr);
+
+          // take note of all the 2-hop neighbors reachable by the newly elected MPR
+          for (TwoHopNeighborSet::const_iterator otherTwoHopNeigh = N2.begin ();
+               otherTwoHopNeigh != N2.end (); otherTwoHopNeigh++)
+            {
+              if (otherTwoHopNeigh->neighborMainAddr == twoHopNeigh->neighborMainAddr)
+                {
+                  coveredTwoHopNeighbors.insert (otherTwoHopNeigh->twoHopNeighborAddr);
+                }
+            }
+        }
+    }
+  // Remove the nodes from N2 which are now covered by a node in the MPR set.
+  for (TwoHopNeighborSet::iterator twoHopNeigh = N2.begin ();
+       twoHopNeigh != N2.end (); )
+    {
+      if (coveredTwoHopNeighbors.find (twoHopNeigh->twoHopNeighborAddr) != coveredTwoHopNeighbors.end ())
+        {
+          // This works correctly only because it is known that twoHopNeigh is reachable by exactly one neighbor,
+          // so only one record in N2 exists for each of them. This record is erased here.
+          NS_LOG_LOGIC ("2-hop neigh. " << twoHopNeigh->twoHopNeighborAddr << " is already covered by an MPR.");
+          twoHopNeigh = N2.erase (twoHopNeigh);
+        }
+      else
+        {
+          twoHopNeigh++;
+        }
+    }
+
+  // 4. While there exist nodes in N2 which are not covered by at
+  // least one node in the MPR set:
+  while (N2.begin () != N2.end ())
+    {
+
+#ifdef NS3_LOG_ENABLE
+      {
+        std::ostringstream os;
+        os << "[";
+        for (TwoHopNeighborSet::const_iterator iter = N2.begin ();
+             iter != N2.end (); iter++)
+          {
+            TwoHopNeighborSet::const_iterator next = iter;
+            next++;
+            os << iter->neighborMainAddr << "->" << iter->twoHopNeighborAddr;
+            if (next != N2.end ())
+              {
+                os << ", ";
+              }
+          }
+        os << "]";
+        NS_LOG_DEBUG ("Step 4 iteration: N2=" << os.str ());
+      }
+#endif  //NS3_LOG_ENABLE
+
+
+      // 4.1. For each node in N, calculate the reachability, i.e., the
+      // number of nodes in N2 which are not yet covered by at
+      // least one node in the MPR set, and which are reachable
+      // through this 1-hop neighbor
+      std::map<int, std::vector<const NeighborTuple *> > reachability;
+      std::set<int> rs;
+      for (NeighborSet::const_iterator it = N.begin (); it != N.end (); it++)
+        {
+          NeighborTuple const &nb_tuple = *it;
+          int r = 0;
+          for (TwoHopNeighborSet::iterator it2 = N2.begin (); it2 != N2.end (); it2++)
+            {
+              TwoHopNeighborTuple const &nb2hop_tuple = *it2;
+              if (nb_tuple.neighborMainAddr == nb2hop_tuple.neighborMainAddr)
+                {
+                  r++;
+                }
+            }
+          rs.insert (r);
+          reachability[r].push_back (&nb_tuple);
+        }
+
+      // 4.2. Select as a MPR the node with highest N_willingness among
+      // the nodes in N with non-zero reachability. In case of
+      // multiple choice select the node which provides
+      // reachability to the maximum number of nodes in N2. In
+      // case of multiple nodes providing the same amount of
+      // reachability, select the node as MPR whose D(y) is
+      // greater. Remove the nodes from N2 which are now covered
+      // by a node in the MPR set.
+      NeighborTuple const *max = NULL;
+      int max_r = 0;
+      for (std::set<int>::iterator it = rs.begin (); it != rs.end (); it++)
+        {
+          int r = *it;
+          if (r == 0)
+            {
+              continue;
+            }
+          for (std::vector<const NeighborTuple *>::iterator it2 = reachability[r].begin ();
+               it2 != reachability[r].end (); it2++)
+            {
+              const NeighborTuple *nb_tuple = *it2;
+              if (max == NULL || nb_tuple->willingness > max->willingness)
+                {
+                  max = nb_tuple;
+                  max_r = r;
+                }
+              else if (nb_tuple->willingness == max->willingness)
+                {
+                  if (r > max_r)
+                    {
+                      max = nb_tuple;
+                      max_r = r;
+                    }
+                  else if (r == max_r)
+                    {
+                      if (Degree (*nb_tuple, degrees) > Degree (*max, degrees))
+                        {
+                          max = nb_tuple;
+                          max_r = r;
+                        }
+                    }
+                }
+            }
+        }
+
+      if (max != NULL)
+        {
+          mprSet.insert (max->neighborMainAddr);
+          CoverTwoHopNeighbors (max->neighborMainAddr, N2);
+          NS_LOG_LOGIC (N2.size () << " 2-hop neighbors left to cover!");
+        }
+    }
+
+  return mprSet;
+}
+
+MprSet
+Olsr6State::ComputeEtxMprSet (const Ipv6Address &mainAddress,
+                              const std::map<Ipv6Address, double> &neighborCosts) const
+{
+  // The whole node is considered as a single interface, on which the
+  // neighbors without a cost have no symmetric link
+  InterfaceNeighborCosts neighbors;
+  std::map<Ipv6Address, double> &interfaceNeighbors = neighbors[Ipv6Address::GetAny ()];
+  for (NeighborSet::const_iterator neighbor = GetNeighbors ().begin ();
+       neighbor != GetNeighbors ().end (); neighbor++)
+    {
+      std::map<Ipv6Address, double>::const_iterator cost =
+        neighborCosts.find (neighbor->neighborMainAddr);
+      interfaceNeighbors[neighbor->neighborMainAddr] =
+        (cost == neighborCosts.end () ? std::numeric_limits<double>::infinity () : cost->second);
+    }
+  InterfaceMprSets mprSets = ComputeInterfaceEtxMprSets (mainAddress, neighbors);
+  return mprSets[Ipv6Address::GetAny ()];
+}
+
+InterfaceMprSets
+Olsr6State::ComputeInterfaceEtxMprSets (const Ipv6Address &mainAddress,
+                                        const InterfaceNeighborCosts &interfaceNeighbors) const
+{
+  InterfaceMprSets mprSets;
+
+  // The symmetric neighbors, and those which may forward
+  std::map<Ipv6Address, const NeighborTuple *> N;
+  for (NeighborSet::const_iterator neighbor = GetNeighbors ().begin ();
+       neighbor != GetNeighbors ().end (); neighbor++)
+    {
+      if (neighbor->status == NeighborTuple::STATUS_SYM)
+        {
+          N[neighbor->neighborMainAddr] = &*neighbor;
+        }
+    }
+
+  // The 2-hop tuples towards a node which is not the node itself nor a
+  // symmetric neighbor, through a neighbor which may forward.  They do not
+  // depend on the interface, so that they are found once.
+  std::vector<std::pair<const TwoHopNeighborTuple *, const NeighborTuple *> > N2;
+  for (TwoHopNeighborSet::const_iterator twoHopNeigh = GetTwoHopNeighbors ().begin ();
+       twoHopNeigh != GetTwoHopNeighbors ().end (); twoHopNeigh++)
+    {
+      if (twoHopNeigh->twoHopNeighborAddr == mainAddress
+          || N.find (twoHopNeigh->twoHopNeighborAddr) != N.end ())
+        {
+          continue;
+        }
+      std::map<Ipv6Address, const NeighborTuple *>::const_iterator neighbor =
+        N.find (twoHopNeigh->neighborMainAddr);
+      if (neighbor == N.end () || neighbor->second->willingness == OLSR6_WILL_NEVER)
+        {
+          continue;
+        }
+      N2.push_back (std::make_pair (&*twoHopNeigh, neighbor->second));
+    }
+
+  for (InterfaceNeighborCosts::const_iterator iface = interfaceNeighbors.begin ();
+       iface != interfaceNeighbors.end (); iface++)
+    {
+      MprSet &mprSet = mprSets[iface->first];
+      for (std::map<Ipv6Address, double>::const_iterator cost = iface->second.begin ();
+           cost != iface->second.end (); cost++)
+        {
+          std::map<Ipv6Address, const NeighborTuple *>::const_iterator neighbor = N.find (cost->first);
+          if (neighbor != N.end () && neighbor->second->willingness == OLSR6_WILL_ALWAYS)
+            {
+              mprSet.insert (neighbor->first);
+            }
+        }
+
+      // The best neighbor of the interface towards each 2-hop neighbor
+      std::map<Ipv6Address, std::pair<double, const NeighborTuple *> > best;
+      for (std::vector<std::pair<const TwoHopNeighborTuple *, const NeighborTuple *> >::const_iterator it = N2.begin ();
+           it != N2.end (); it++)
+        {
+          const TwoHopNeighborTuple *twoHopNeigh = it->first;
+          std::map<Ipv6Address, double>::const_iterator cost =
+            iface->second.find (twoHopNeigh->neighborMainAddr);
+          if (cost == iface->second.end () || cost->second == std::numeric_limits<double>::infinity ())
+            {
+              continue;
+            }
+
+          double pathCost = cost->second + twoHopNeigh->cost;
+          std::map<Ipv6Address, std::pair<double, const NeighborTuple *> >::iterator current =
+            best.find (twoHopNeigh->twoHopNeighborAddr);
+          if (current == best.end ()
+              || pathCost < current->second.first
+              || (pathCost == current->second.first
+                  && it->second->willingness > current->second.second->willingness))
+            {
+              best[twoHopNeigh->twoHopNeighborAddr] = std::make_pair (pathCost, it->second);
+            }
+        }
+
+      for (std::map<Ipv6Address, std::pair<double, const NeighborTuple *> >::const_iterator it = best.begin ();
+           it != best.end (); it++)
+        {
+          NS_LOG_LOGIC ("2-hop neighbor " << it->first << " is best reached on interface " << iface->first
+                        << " through " << it->second.second->neighborMainAddr << " (ETX " << it->second.first << ")");
+          mprSet.insert (it->second.second->neighborMainAddr);
+        }
+    }
+
+  return mprSets;
+}
+
 /********** Duplicate Set Manipulation **********/
 
 DuplicateTuple*
@@ -418,6 +970,21 @@ Olsr6State::FindNewerTopologyTuple (Ipv6Address const & lastAddr, uint16_t ansn)
   return NULL;
 }
 
+std::map<Ipv6Address, TopologyTuple*>
+Olsr6State::FindTopologyTuples (Ipv6Address const &lastAddr)
+{
+  std::map<Ipv6Address, TopologyTuple*> tuples;
+  for (TopologySet::iterator it = m_topologySet.begin ();
+       it != m_topologySet.end (); it++)
+    {
+      if (it->lastAddr == lastAddr)
+        {
+          tuples[it->destAddr] = &(*it);
+        }
+    }
+  return tuples;
+}
+
 void
 Olsr6State::EraseTopologyTuple (const TopologyTuple &tuple)
 {
@@ -435,18 +1002,51 @@ Olsr6State::EraseTopologyTuple (const TopologyTuple &tuple)
 void
 Olsr6State::EraseOlderTopologyTuples (const Ipv6Address &lastAddr, uint16_t ansn)
 {
+  // Compacts the set in a single pass rather than erasing the tuples one
+  // by one, which moves the tail of the set for every erased tuple
+  TopologySet::iterator last = m_topologySet.begin ();
   for (TopologySet::iterator it = m_topologySet.begin ();
-       it != m_topologySet.end (); )
+       it != m_topologySet.end (); it++)
     {
-      if (it->lastAddr == lastAddr && it->sequenceNumber < ansn)
+      if (it->lastAddr != lastAddr || it->sequenceNumber >= ansn)
         {
-          it = m_topologySet.erase (it);
+          if (last != it)
+            {
+              *last = *it;
+            }
+          last++;
         }
-      else
+    }
+  m_topologySet.erase (last, m_topologySet.end ());
+}
+
+void
+Olsr6State::RefreshTopologyTuples (const Ipv6Address &lastAddr, uint16_t ansn, Time expirationTime,
+                                   const std::set<Ipv6Address> &withdrawn,
+                                   std::set<Ipv6Address> &missing)
+{
+  // Compacts the set as EraseOlderTopologyTuples does
+  TopologySet::iterator last = m_topologySet.begin ();
+  for (TopologySet::iterator it = m_topologySet.begin ();
+       it != m_topologySet.end (); it++)
+    {
+      if (it->lastAddr == lastAddr)
         {
-          it++;
+          if (withdrawn.find (it->destAddr) != withdrawn.end ())
+            {
+              continue;
+            }
+          it->sequenceNumber = ansn;
+          it->expirationTime = expirationTime;
+          missing.erase (it->destAddr);
+        }
+      if (last != it)
+        {
+          *last = *it;
         }
+      last++;
     }
+  m_topologySet.erase (last, m_topologySet.end ());
 }
 
 void
@@ -576,5 +1176,446 @@ Olsr6State::InsertAssociation (const Association &tuple)
   m_associations.push_back (tuple);
 }
 
+Associations
+Olsr6State::GetAggregatedAssociations () const
+{
+  // Networks by prefix length, without their host bits
+  std::set<std::pair<uint8_t, Ipv6Address> > networks;
+  for (Associations::const_iterator it = m_associations.begin ();
+       it != m_associations.end (); it++)
+    {
+      Ipv6Address network = it->networkAddr;
+      networks.insert (std::make_pair (it->netmask.GetPrefixLength (), network.CombinePrefix (it->netmask)));
+    }
+
+  // The longest prefixes are merged first, so that their parents can be
+  // merged in turn
+  for (uint32_t length = 128; length > 0; length--)
+    {
+      std::set<std::pair<uint8_t, Ipv6Address> >::iterator it =
+        networks.lower_bound (std::make_pair (uint8_t (length), Ipv6Address::GetAny ()));
+      while (it != networks.end () && it->first == length)
+        {
+          // The first network of a pair ends with a 0 bit, its sibling with a 1
+          uint8_t bytes[16];
+          it->second.GetBytes (bytes);
+          uint8_t bit = 0x80 >> ((length - 1) % 8);
+          if (bytes[(length - 1) / 8] & bit)
+            {
+              it++;
+              continue;
+            }
+          bytes[(length - 1) / 8] |= bit;
+          std::pair<uint8_t, Ipv6Address> sibling (length, Ipv6Address (bytes));
+          if (networks.find (sibling) == networks.end ())
+            {
+              it++;
+              continue;
+            }
+          networks.insert (std::make_pair (uint8_t (length - 1), it->second));
+          networks.erase (sibling);
+          networks.erase (it++);
+        }
+    }
+
+  Associations aggregated;
+  for (std::set<std::pair<uint8_t, Ipv6Address> >::const_iterator it = networks.begin ();
+       it != networks.end (); it++)
+    {
+      bool covered = false;
+      for (uint32_t length = 0; length < it->first && !covered; length++)
+        {
+          Ipv6Address network = it->second;
+          covered = networks.find (std::make_pair (uint8_t (length), network.CombinePrefix (Ipv6Prefix (length))))
+            != networks.end ();
+        }
+      if (!covered)
+        {
+          aggregated.push_back ((Association) { it->second, Ipv6Prefix (it->first) });
+        }
+    }
+  NS_LOG_DEBUG (m_associations.size () << " local associations aggregated into " << aggregated.size ());
+  return aggregated;
+}
+
+void
+Olsr6State::EraseSupersededAssociationTuples (const Ipv6Address &gatewayAddr,
+                                              const Associations &networks)
+{
+  AssociationSet::iterator it = m_associationSet.begin ();
+  while (it != m_associationSet.end ())
+    {
+      bool superseded = false;
+      if (it->gatewayAddr == gatewayAddr)
+        {
+          Association association = { it->networkAddr, it->netmask };
+          for (Associations::const_iterator network = networks.begin ();
+               network != networks.end (); network++)
+            {
+              if (*network == association)
+                {
+                  superseded = false;
+                  break;
+                }
+              // The shortest of the two prefixes matches both networks if they overlap
+              Ipv6Prefix shortest = network->netmask.GetPrefixLength () < it->netmask.GetPrefixLength ()
+                ? network->netmask : it->netmask;
+              if (shortest.IsMatch (network->networkAddr, it->networkAddr))
+                {
+                  superseded = true;
+                }
+            }
+        }
+      if (superseded)
+        {
+          NS_LOG_DEBUG ("Superseded " << *it);
+          it = m_associationSet.erase (it);
+        }
+      else
+        {
+          it++;
+        }
+    }
+}
+
+/********** Snapshot **********/
+
+void
+Olsr6State::Serialize (SnapshotWriter &writer) const
+{
+  writer.WriteU32 (m_linkSet.size ());
+  for (LinkSet::const_iterator it = m_linkSet.begin ();
+       it != m_linkSet.end (); it++)
+    {
+      writer.WriteAddress (it->localIfaceAddr);
+      writer.WriteAddress (it->neighborIfaceAddr);
+      writer.WriteTime (it->symTime);
+      writer.WriteTime (it->asymTime);
+      writer.WriteTime (it->time);
+      writer.WriteDouble (it->quality);
+      writer.WriteU8 (it->pending);
+      writer.WriteTime (it->lostTime);
+      writer.WriteDuration (it->helloInterval);
+      writer.WriteTime (it->helloDeadline);
+      writer.WriteU32 (it->helloHistory);
+      writer.WriteU32 (it->helloHistoryLength);
+      writer.WriteDouble (it->lq);
+      writer.WriteDouble (it->nlq);
+    }
+
+  writer.WriteU32 (m_neighborSet.size ());
+  for (NeighborSet::const_iterator it = m_neighborSet.begin ();
+       it != m_neighborSet.end (); it++)
+    {
+      writer.WriteAddress (it->neighborMainAddr);
+      writer.WriteU8 (it->status);
+      writer.WriteU8 (it->willingness);
+    }
+
+  writer.WriteU32 (m_twoHopNeighborSet.size ());
+  for (TwoHopNeighborSet::const_iterator it = m_twoHopNeighborSet.begin ();
+       it != m_twoHopNeighborSet.end (); it++)
+    {
+      writer.WriteAddress (it->neighborMainAddr);
+      writer.WriteAddress (it->twoHopNeighborAddr);
+      writer.WriteTime (it->expirationTime);
+      writer.WriteDouble (it->cost);
+    }
+
+  writer.WriteU32 (m_topologySet.size ());
+  for (TopologySet::const_iterator it = m_topologySet.begin ();
+       it != m_topologySet.end (); it++)
+    {
+      writer.WriteAddress (it->destAddr);
+      writer.WriteAddress (it->lastAddr);
+      writer.WriteU16 (it->sequenceNumber);
+      writer.WriteTime (it->expirationTime);
+      writer.WriteDouble (it->cost);
+    }
+
+  writer.WriteU32 (m_mprSet.size ());
+  for (MprSet::const_iterator it = m_mprSet.begin ();
+       it != m_mprSet.end (); it++)
+    {
+      writer.WriteAddress (*it);
+    }
+
+  writer.WriteU32 (m_mprSelectorSet.size ());
+  for (MprSelectorSet::const_iterator it = m_mprSelectorSet.begin ();
+       it != m_mprSelectorSet.end (); it++)
+    {
+      writer.WriteAddress (it->mainAddr);
+      writer.WriteTime (it->expirationTime);
+    }
+
+  writer.WriteU32 (m_duplicateSet.size ());
+  for (DuplicateSet::const_iterator it = m_duplicateSet.begin ();
+       it != m_duplicateSet.end (); it++)
+    {
+      writer.WriteAddress (it->address);
+      writer.WriteU16 (it->sequenceNumber);
+      writer.WriteU8 (it->retransmitted);
+      writer.WriteU32 (it->ifaceList.size ());
+      for (std::vector<Ipv6Address>::const_iterator iface = it->ifaceList.begin ();
+           iface != it->ifaceList.end (); iface++)
+        {
+          writer.WriteAddress (*iface);
+        }
+      writer.WriteTime (it->expirationTime);
+    }
+
+  writer.WriteU32 (m_ifaceAssocSet.size ());
+  for (IfaceAssocSet::const_iterator it = m_ifaceAssocSet.begin ();
+       it != m_ifaceAssocSet.end (); it++)
+    {
+      writer.WriteAddress (it->ifaceAddr);
+      writer.WriteAddress (it->mainAddr);
+      writer.WriteTime (it->time);
+    }
+
+  writer.WriteU32 (m_associationSet.size ());
+  for (AssociationSet::const_iterator it = m_associationSet.begin ();
+       it != m_associationSet.end (); it++)
+    {
+      writer.WriteAddress (it->gatewayAddr);
+      writer.WriteAddress (it->networkAddr);
+      writer.WritePrefix (it->netmask);
+      writer.WriteTime (it->expirationTime);
+      writer.WriteU16 (it->capacity);
+      writer.WriteU8 (it->load);
+    }
+
+  writer.WriteU32 (m_associations.size ());
+  for (Associations::const_iterator it = m_associations.begin ();
+       it != m_associations.end (); it++)
+    {
+      writer.WriteAddress (it->networkAddr);
+      writer.WritePrefix (it->netmask);
+    }
+}
+
+bool
+Olsr6State::Deserialize (SnapshotReader &reader)
+{
+  m_linkSet.clear ();
+  for (uint32_t n = reader.ReadU32 (); n > 0 && reader.IsGood (); n--)
+    {
+      LinkTuple tuple;
+      tuple.localIfaceAddr = reader.ReadAddress ();
+      tuple.neighborIfaceAddr = reader.ReadAddress ();
+      tuple.symTime = reader.ReadTime ();
+      tuple.asymTime = reader.ReadTime ();
+      tuple.time = reader.ReadTime ();
+      tuple.quality = reader.ReadDouble ();
+      tuple.pending = (reader.ReadU8 () != 0);
+      tuple.lostTime = reader.ReadTime ();
+      tuple.helloInterval = reader.ReadDuration ();
+      tuple.helloDeadline = reader.ReadTime ();
+      tuple.helloHistory = reader.ReadU32 ();
+      tuple.helloHistoryLength = reader.ReadU32 ();
+      tuple.lq = reader.ReadDouble ();
+      tuple.nlq = reader.ReadDouble ();
+      m_linkSet.push_back (tuple);
+    }
+
+  m_neighborSet.clear ();
+  for (uint32_t n = reader.ReadU32 (); n > 0 && reader.IsGood (); n--)
+    {
+      NeighborTuple tuple;
+      tuple.neighborMainAddr = reader.ReadAddress ();
+      tuple.status = (reader.ReadU8 () == NeighborTuple::STATUS_SYM) ?
+        NeighborTuple::STATUS_SYM : NeighborTuple::STATUS_NOT_SYM;
+      tuple.willingness = reader.ReadU8 ();
+      m_neighborSet.push_back (tuple);
+    }
+
+  m_twoHopNeighborSet.clear ();
+  for (uint32_t n = reader.ReadU32 (); n > 0 && reader.IsGood (); n--)
+    {
+      TwoHopNeighborTuple tuple;
+      tuple.neighborMainAddr = reader.ReadAddress ();
+      tuple.twoHopNeighborAddr = reader.ReadAddress ();
+      tuple.expirationTime = reader.ReadTime ();
+      tuple.cost = reader.ReadDouble ();
+      m_twoHopNeighborSet.push_back (tuple);
+    }
+
+  m_topologySet.clear ();
+  for (uint32_t n = reader.ReadU32 (); n > 0 && reader.IsGood (); n--)
+    {
+      TopologyTuple tuple;
+      tuple.destAddr = reader.ReadAddress ();
+      tuple.lastAddr = reader.ReadAddress ();
+      tuple.sequenceNumber = reader.ReadU16 ();
+      tuple.expirationTime = reader.ReadTime ();
+      tuple.cost = reader.ReadDouble ();
+      m_topologySet.push_back (tuple);
+    }
+
+  m_mprSet.clear ();
+  for (uint32_t n = reader.ReadU32 (); n > 0 && reader.IsGood (); n--)
+    {
+      m_mprSet.insert (reader.ReadAddress ());
+    }
+
+  m_mprSelectorSet.clear ();
+  for (uint32_t n = reader.ReadU32 (); n > 0 && reader.IsGood (); n--)
+    {
+      MprSelectorTuple tuple;
+      tuple.mainAddr = reader.ReadAddress ();
+      tuple.expirationTime = reader.ReadTime ();
+      m_mprSelectorSet.push_back (tuple);
+    }
+
+  m_duplicateSet.clear ();
+  for (uint32_t n = reader.ReadU32 (); n > 0 && reader.IsGood (); n--)
+    {
+      DuplicateTuple tuple;
+      tuple.address = reader.ReadAddress ();
+      tuple.sequenceNumber = reader.ReadU16 ();
+      tuple.retransmitted = (reader.ReadU8 () != 0);
+      for (uint32_t i = reader.ReadU32 (); i > 0 && reader.IsGood (); i--)
+        {
+          tuple.ifaceList.push_back (reader.ReadAddress ());
+        }
+      tuple.expirationTime = reader.ReadTime ();
+      m_duplicateSet.push_back (tuple);
+    }
+
+  m_ifaceAssocSet.clear ();
+  for (uint32_t n = reader.ReadU32 (); n > 0 && reader.IsGood (); n--)
+    {
+      IfaceAssocTuple tuple;
+      tuple.ifaceAddr = reader.ReadAddress ();
+      tuple.mainAddr = reader.ReadAddress ();
+      tuple.time = reader.ReadTime ();
+      m_ifaceAssocSet.push_back (tuple);
+    }
+
+  m_associationSet.clear ();
+  for (uint32_t n = reader.ReadU32 (); n > 0 && reader.IsGood (); n--)
+    {
+      AssociationTuple tuple;
+      tuple.gatewayAddr = reader.ReadAddress ();
+      tuple.networkAddr = reader.ReadAddress ();
+      tuple.netmask = reader.ReadPrefix ();
+      tuple.expirationTime = reader.ReadTime ();
+      tuple.capacity = reader.ReadU16 ();
+      tuple.load = reader.ReadU8 ();
+      m_associationSet.push_back (tuple);
+    }
+
+  m_associations.clear ();
+  for (uint32_t n = reader.ReadU32 (); n > 0 && reader.IsGood (); n--)
+    {
+      Association tuple;
+      tuple.networkAddr = reader.ReadAddress ();
+      tuple.netmask = reader.ReadPrefix ();
+      m_associations.push_back (tuple);
+    }
+
+  return reader.IsGood ();
+}
+
+/********** Memory Accounting **********/
+
+void
+ContainerUsage::AddTree (uint32_t n, uint32_t valueSize)
+{
+  // Red-black tree node: color, parent, left and right child
+  count += n;
+  bytes += n * (valueSize + 4 * sizeof (void *));
+}
+
+uint64_t
+MemoryUsage::GetTotalBytes () const
+{
+  return linkSet.bytes + neighborSet.bytes + twoHopNeighborSet.bytes
+         + topologySet.bytes + mprSet.bytes + mprSelectorSet.bytes
+         + duplicateSet.bytes + ifaceAssocSet.bytes + associationSet.bytes
+         + associations.bytes + routingTable.bytes + queuedMessages.bytes
+         + events.bytes;
+}
+
+namespace {
+
+/// Adds a container usage to another one.
+void
+Accumulate (ContainerUsage &a, const ContainerUsage &b)
+{
+  a.count += b.count;
+  a.bytes += b.bytes;
+}
+
+/// Prints a container usage.
+void
+Print (std::ostream &os, const char *name, const ContainerUsage &usage)
+{
+  os << name << "=" << usage.count << "/" << usage.bytes << "B ";
+}
+
+} // anonymous namespace
+
+MemoryUsage &
+MemoryUsage::operator += (const MemoryUsage &other)
+{
+  Accumulate (linkSet, other.linkSet);
+  Accumulate (neighborSet, other.neighborSet);
+  Accumulate (twoHopNeighborSet, other.twoHopNeighborSet);
+  Accumulate (topologySet, other.topologySet);
+  Accumulate (mprSet, other.mprSet);
+  Accumulate (mprSelectorSet, other.mprSelectorSet);
+  Accumulate (duplicateSet, other.duplicateSet);
+  Accumulate (ifaceAssocSet, other.ifaceAssocSet);
+  Accumulate (associationSet, other.associationSet);
+  Accumulate (associations, other.associations);
+  Accumulate (routingTable, other.routingTable);
+  Accumulate (queuedMessages, other.queuedMessages);
+  Accumulate (events, other.events);
+  return *this;
+}
+
+std::ostream &
+operator << (std::ostream &os, const MemoryUsage &usage)
+{
+  Print (os, "link", usage.linkSet);
+  Print (os, "neighbor", usage.neighborSet);
+  Print (os, "twoHop", usage.twoHopNeighborSet);
+  Print (os, "topology", usage.topologySet);
+  Print (os, "mpr", usage.mprSet);
+  Print (os, "mprSelector", usage.mprSelectorSet);
+  Print (os, "duplicate", usage.duplicateSet);
+  Print (os, "ifaceAssoc", usage.ifaceAssocSet);
+  Print (os, "association", usage.associationSet);
+  Print (os, "localAssociation", usage.associations);
+  Print (os, "routingTable", usage.routingTable);
+  Print (os, "queued", usage.queuedMessages);
+  Print (os, "events", usage.events);
+  os << "total=" << usage.GetTotalBytes () << "B";
+  return os;
+}
+
+MemoryUsage
+Olsr6State::GetMemoryUsage () const
+{
+  MemoryUsage usage;
+  usage.linkSet.AddVector (m_linkSet);
+  usage.neighborSet.AddVector (m_neighborSet);
+  usage.twoHopNeighborSet.AddVector (m_twoHopNeighborSet);
+  usage.topologySet.AddVector (m_topologySet);
+  usage.mprSet.AddTree (m_mprSet.size (), sizeof (Ipv6Address));
+  usage.mprSelectorSet.AddVector (m_mprSelectorSet);
+  usage.duplicateSet.AddVector (m_duplicateSet);
+  for (DuplicateSet::const_iterator it = m_duplicateSet.begin ();
+       it != m_duplicateSet.end (); it++)
+    {
+      usage.duplicateSet.bytes += it->ifaceList.capacity () * sizeof (Ipv6Address);
+    }
+  usage.ifaceAssocSet.AddVector (m_ifaceAssocSet);
+  usage.associationSet.AddVector (m_associationSet);
+  usage.associations.AddVector (m_associations);
+  return usage;
+}
+
 }
 }  // namespace olsr6, ns3
@@ -31,10 +31,84 @@
 #define OLSR6_STATE_H
 
 #include "olsr6-repositories.h"
+#include "olsr6-snapshot.h"
+
+#include <map>
 
 namespace ns3 {
 namespace olsr6 {
 
+/// \ingroup olsr6
+/// Element count and approximate memory footprint of a container.
+struct ContainerUsage
+{
+  ContainerUsage ()
+    : count (0),
+      bytes (0)
+  {
+  }
+
+  /**
+   * Accounts for the elements and the heap block of a vector.
+   * \param v The vector.
+   */
+  template <class T>
+  void AddVector (const std::vector<T> &v)
+  {
+    count += v.size ();
+    bytes += v.capacity () * sizeof (T);
+  }
+
+  /**
+   * Accounts for the nodes of a std::set or std::map.
+   * \param n The number of elements.
+   * \param valueSize The size of an element.
+   */
+  void AddTree (uint32_t n, uint32_t valueSize);
+
+  uint32_t count;  //!< Number of elements.
+  uint64_t bytes;  //!< Approximate number of bytes, heap blocks owned by the elements included.
+};
+
+/// \ingroup olsr6
+/// Memory used by the repositories of an %OLSR6 node.
+struct MemoryUsage
+{
+  ContainerUsage linkSet;           //!< Link Set.
+  ContainerUsage neighborSet;       //!< Neighbor Set.
+  ContainerUsage twoHopNeighborSet; //!< 2-hop Neighbor Set.
+  ContainerUsage topologySet;       //!< Topology Set.
+  ContainerUsage mprSet;            //!< MPR Set.
+  ContainerUsage mprSelectorSet;    //!< MPR Selector Set.
+  ContainerUsage duplicateSet;      //!< Duplicate Set, interface lists included.
+  ContainerUsage ifaceAssocSet;     //!< Interface Association Set.
+  ContainerUsage associationSet;    //!< Association Set.
+  ContainerUsage associations;      //!< Local Host Network Associations.
+  ContainerUsage routingTable;      //!< Routing table.
+  ContainerUsage queuedMessages;    //!< Messages waiting to be sent.
+  ContainerUsage events;            //!< Pending tuple expiry and message timers.
+
+  /**
+   * \returns The sum of the bytes of every container.
+   */
+  uint64_t GetTotalBytes () const;
+
+  /**
+   * Adds the usage of another node, field by field.
+   * \param other The usage to add.
+   * \returns This usage.
+   */
+  MemoryUsage & operator += (const MemoryUsage &other);
+};
+
+/**
+ * Prints the count and bytes of every container of a MemoryUsage.
+ * \param os The output stream.
+ * \param usage The usage.
+ * \returns The output stream.
+ */
+std::ostream & operator << (std::ostream &os, const MemoryUsage &usage);
+
 /// \ingroup olsr6
 /// This class encapsulates all data structures needed for maintaining internal state of an OLSR6 node.
 class Olsr6State
@@ -125,6 +199,12 @@ public:
    * \returns The neighbor tuple, if found. Else it returns a null pointer.
    */
   NeighborTuple* FindNeighborTuple (const Ipv6Address &mainAddr);
+  /**
+   * Finds a neighbor tuple.
+   * \param mainAddr The neighbor tuple main address.
+   * \returns The neighbor tuple, if found. Else it returns a null pointer.
+   */
+  const NeighborTuple* FindNeighborTuple (const Ipv6Address &mainAddr) const;
 
   /**
    * Finds a symmetrical neighbor tuple.
@@ -233,6 +313,15 @@ public:
 
   // Duplicate
 
+  /**
+   * Gets the duplicate set.
+   * \returns The duplicate set.
+   */
+  const DuplicateSet & GetDuplicates () const
+  {
+    return m_duplicateSet;
+  }
+
   /**
    * Finds a duplicate tuple.
    * \param address The duplicate tuple address.
@@ -314,6 +403,14 @@ public:
    */
   TopologyTuple* FindNewerTopologyTuple (const Ipv6Address &lastAddr,
                                          uint16_t ansn);
+  /**
+   * Finds the topology tuples of the links advertised by a node, in a
+   * single pass over the topology set.
+   * \param lastAddr The address of the node previous to the destinations.
+   * \returns The topology tuples, by destination address.  The pointers
+   * are invalidated by the next insertion or erasure.
+   */
+  std::map<Ipv6Address, TopologyTuple*> FindTopologyTuples (const Ipv6Address &lastAddr);
   /**
    * Erases a topology tuple.
    * \param tuple The tuple to erase.
@@ -326,6 +423,21 @@ public:
    */
   void EraseOlderTopologyTuples (const Ipv6Address &lastAddr,
                                  uint16_t ansn);
+  /**
+   * Updates the topology tuples of the links advertised by a node, in a
+   * single pass over the topology set: the tuples towards the withdrawn
+   * destinations are erased, the others get the new ANSN and expiration
+   * time.
+   * \param lastAddr The address of the node previous to the destinations.
+   * \param ansn The Advertised Neighbor Sequence Number.
+   * \param expirationTime The new expiration time of the tuples.
+   * \param withdrawn The destinations no longer advertised.
+   * \param missing The destinations which must have a tuple; those found
+   * are removed from it.
+   */
+  void RefreshTopologyTuples (const Ipv6Address &lastAddr, uint16_t ansn, Time expirationTime,
+                              const std::set<Ipv6Address> &withdrawn,
+                              std::set<Ipv6Address> &missing);
   /**
    * Inserts a topology tuple.
    * \param tuple The tuple to insert.
@@ -423,6 +535,30 @@ public:
    * \param tuple The tuple to insert.
    */
   void InsertAssociation (const Association &tuple);
+  /**
+   * \brief Aggregates the local associations into the fewest networks
+   * covering exactly the same addresses, to be advertised.
+   *
+   * Two networks of the same prefix length which only differ in the last
+   * bit of their prefix are merged, repeatedly; the networks covered by
+   * another one are left out.
+   *
+   * \returns The aggregated associations.
+   */
+  Associations GetAggregatedAssociations () const;
+  /**
+   * \brief Erases the association tuples of a gateway which overlap one of
+   * the networks it now advertises without being one of them.
+   *
+   * An HNA message carries all the networks of its gateway: the tuples of
+   * its earlier messages, which aggregated them differently, are superseded
+   * instead of routing the networks withdrawn since until they expire.
+   *
+   * \param gatewayAddr The main address of the gateway.
+   * \param networks The networks the gateway advertises.
+   */
+  void EraseSupersededAssociationTuples (const Ipv6Address &gatewayAddr,
+                                         const Associations &networks);
 
   /**
    * Returns a vector of all interfaces of a given neighbor, with the
@@ -433,6 +569,121 @@ public:
   std::vector<Ipv6Address>
   FindNeighborInterfaces (const Ipv6Address &neighborMainAddr) const;
 
+  // MPR computation
+
+  /**
+   * \brief Selects an MPR set from the Neighbor Set and the 2-hop Neighbor
+   * Set, following \RFC{3626} hints.
+   *
+   * The state is not modified, so that this method can also be used on
+   * states that do not belong to a running protocol instance.
+   *
+   * \param mainAddress The main address of the node owning the state.
+   * \returns The MPR set.
+   */
+  MprSet ComputeMprSet (const Ipv6Address &mainAddress) const;
+
+  /**
+   * \brief Selects an MPR set which keeps the best two-hop paths of the ETX
+   * metric.
+   *
+   * For each strict 2-hop neighbor, the symmetric neighbor through which
+   * the sum of the ETX of the two links is the lowest is selected, the
+   * higher willingness breaking the ties.  The neighbors with willingness
+   * WILL_ALWAYS are selected too.
+   *
+   * \param mainAddress The main address of the node owning the state.
+   * \param neighborCosts The ETX of the best link to each symmetric neighbor,
+   * by main address.
+   * \returns The MPR set.
+   */
+  MprSet ComputeEtxMprSet (const Ipv6Address &mainAddress,
+                           const std::map<Ipv6Address, double> &neighborCosts) const;
+
+  /**
+   * \brief Selects the MPR set of each interface, following \RFC{3626}
+   * section 8.3.1.
+   *
+   * The selection of an interface only considers the symmetric neighbors
+   * of that interface and the 2-hop neighbors they reach.  The filtering
+   * of the 2-hop neighbors and the degrees of the neighbors are shared by
+   * all the interfaces.  The MPR set of the node is the union of the
+   * returned sets.
+   *
+   * \param mainAddress The main address of the node owning the state.
+   * \param interfaceNeighbors The neighbors of each interface, by interface
+   * address; the costs are not used.
+   * \returns The MPR set of each interface of interfaceNeighbors.
+   */
+  InterfaceMprSets ComputeInterfaceMprSets (const Ipv6Address &mainAddress,
+                                            const InterfaceNeighborCosts &interfaceNeighbors) const;
+
+  /**
+   * \brief Selects the MPR set of each interface which keeps the best
+   * two-hop paths of the ETX metric through that interface.
+   *
+   * \param mainAddress The main address of the node owning the state.
+   * \param interfaceNeighbors The neighbors of each interface, by interface
+   * address, with the ETX of the best symmetric link to them on that
+   * interface, infinite if there is none.
+   * \returns The MPR set of each interface of interfaceNeighbors.
+   */
+  InterfaceMprSets ComputeInterfaceEtxMprSets (const Ipv6Address &mainAddress,
+                                               const InterfaceNeighborCosts &interfaceNeighbors) const;
+
+private:
+  /**
+   * \brief This auxiliary function (defined in \RFC{3626}) is used for calculating the MPR Set.
+   * \param tuple The neighbor tuple whose degree is computed.
+   * \returns The degree of the neighbor.
+   */
+  int Degree (NeighborTuple const &tuple) const;
+
+  /**
+   * \brief Returns the degree of a neighbor, computing it only if it is not
+   * cached yet.
+   * \param tuple The neighbor tuple whose degree is computed.
+   * \param degrees The degrees already computed, by neighbor main address.
+   * \returns The degree of the neighbor.
+   */
+  int Degree (NeighborTuple const &tuple, std::map<Ipv6Address, int> &degrees) const;
+
+  /**
+   * \brief Selects an MPR set among some neighbors (\RFC{3626}, section 8.3.1).
+   * \param N The symmetric neighbors of the interface.
+   * \param N2 The 2-hop neighbors reachable through them, without the
+   * excluded ones.
+   * \param degrees The degrees of the neighbors computed so far.
+   * \returns The MPR set.
+   */
+  MprSet SelectMprSet (const NeighborSet &N, TwoHopNeighborSet N2,
+                       std::map<Ipv6Address, int> &degrees) const;
+
+public:
+
+  // Snapshot
+
+  /**
+   * Writes all the sets to a binary snapshot.
+   * \param writer The snapshot writer. Tuple times are written relative to its reference time.
+   */
+  void Serialize (SnapshotWriter &writer) const;
+  /**
+   * Replaces all the sets with the content of a binary snapshot.
+   * \param reader The snapshot reader. Tuple times are rebased to its reference time.
+   * \returns False if the snapshot is truncated or malformed.
+   */
+  bool Deserialize (SnapshotReader &reader);
+
+  // Memory accounting
+
+  /**
+   * Counts the tuples of every set and estimates the memory they use.
+   * \returns The usage of the sets.  The routing table, queued messages and
+   * events do not belong to the state and are left empty.
+   */
+  MemoryUsage GetMemoryUsage () const;
+
 };
 
 }
@@ -0,0 +1,148 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Ankit Deepak <adadeepak8@gmail.com>
+ *          Shravya Ks <shravya.ks0@gmail.com>,
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/boolean.h"
+#include "ns3/nstime.h"
+#include "ns3/olsr6-helper.h"
+#include "ns3/olsr6-routing-protocol.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/simple-net-device-helper.h"
+
+#include <vector>
+
+using namespace ns3;
+using namespace olsr6;
+
+/**
+ * Testcase checking, on the chain A - B - C, that the adaptive HELLO
+ * interval of B backs off to its ceiling once the neighborhood is stable,
+ * and that every HELLO advertises the interval until the next one.
+ */
+class Olsr6AdaptiveIntervalsTestCase : public TestCase
+{
+public:
+  Olsr6AdaptiveIntervalsTestCase ();
+  /// \brief Run test case
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Records the HELLO messages sent by B.
+   * \param header The packet header.
+   * \param messages The messages of the packet.
+   */
+  void Tx (const PacketHeader &header, const MessageList &messages);
+
+  std::vector<Time> m_times;   //!< Emission times of the HELLO messages.
+  std::vector<Time> m_htimes;  //!< Advertised HELLO intervals.
+  std::vector<Time> m_vtimes;  //!< Advertised validity times.
+};
+
+Olsr6AdaptiveIntervalsTestCase::Olsr6AdaptiveIntervalsTestCase ()
+  : TestCase ("Check the adaptive HELLO interval")
+{
+}
+
+void
+Olsr6AdaptiveIntervalsTestCase::Tx (const PacketHeader &header, const MessageList &messages)
+{
+  for (MessageList::const_iterator it = messages.begin (); it != messages.end (); it++)
+    {
+      if (it->GetMessageType () == MessageHeader::HELLO_MESSAGE)
+        {
+          m_times.push_back (Simulator::Now ());
+          m_htimes.push_back (it->GetHello ().GetHTime ());
+          m_vtimes.push_back (it->GetVTime ());
+        }
+    }
+}
+
+void
+Olsr6AdaptiveIntervalsTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (3);
+
+  Olsr6Helper olsr6;
+  olsr6.Set ("AdaptiveIntervals", BooleanValue (true));
+  olsr6.Set ("MinHelloInterval", TimeValue (Seconds (0.5)));
+  olsr6.Set ("MaxHelloInterval", TimeValue (Seconds (8)));
+  InternetStackHelper internet;
+  internet.SetRoutingHelper (olsr6);
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper simpleNetHelper;
+  simpleNetHelper.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  simpleNetHelper.SetChannelAttribute ("Delay", StringValue ("2ms"));
+
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase ("2001:1::", Ipv6Prefix (64));
+  ipv6.Assign (simpleNetHelper.Install (NodeContainer (nodes.Get (0), nodes.Get (1))));
+  ipv6.NewNetwork ();
+  ipv6.Assign (simpleNetHelper.Install (NodeContainer (nodes.Get (1), nodes.Get (2))));
+
+  Ptr<RoutingProtocol> b = Olsr6Helper::GetOlsr6RoutingProtocol (nodes.Get (1));
+  b->TraceConnectWithoutContext ("Tx", MakeCallback (&Olsr6AdaptiveIntervalsTestCase::Tx, this));
+
+  Simulator::Stop (Seconds (60));
+  Simulator::Run ();
+  uint32_t nRoutes = b->GetRoutingTableEntries ().size ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (nRoutes, 2, "B should have converged");
+
+  // 30 HELLO messages with the fixed 2s interval
+  NS_TEST_ASSERT_MSG_GT (m_times.size (), 2, "B should send HELLO messages");
+  NS_TEST_EXPECT_MSG_LT (m_times.size (), 30, "Fewer HELLO messages than with the fixed interval");
+  NS_TEST_EXPECT_MSG_EQ (m_htimes.front (), Seconds (0.5), "The first HELLO uses the floor");
+  NS_TEST_EXPECT_MSG_EQ (m_htimes.back (), Seconds (8), "The interval backs off to the ceiling");
+
+  for (uint32_t i = 0; i < m_times.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_vtimes[i], 3 * m_htimes[i], "The validity time follows the advertised interval");
+      if (i + 1 < m_times.size ())
+        {
+          // The next interval is at most twice as long, so the next jitter
+          // is at most half the advertised interval.
+          Time latest = m_htimes[i] + MilliSeconds (m_htimes[i].GetMilliSeconds () / 2);
+          NS_TEST_EXPECT_MSG_EQ ((m_times[i + 1] - m_times[i] <= latest), true,
+                                 "HELLO " << i + 1 << " is later than advertised");
+        }
+    }
+}
+
+static class Olsr6AdaptiveIntervalsTestSuite : public TestSuite
+{
+public:
+  Olsr6AdaptiveIntervalsTestSuite ();
+} g_olsr6AdaptiveIntervalsTestSuite;
+
+Olsr6AdaptiveIntervalsTestSuite::Olsr6AdaptiveIntervalsTestSuite ()
+  : TestSuite ("routing-olsr6-adaptive-intervals", UNIT)
+{
+  AddTestCase (new Olsr6AdaptiveIntervalsTestCase (), TestCase::QUICK);
+}
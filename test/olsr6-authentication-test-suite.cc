@@ -0,0 +1,487 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Ankit Deepak <adadeepak8@gmail.com>
+ *          Shravya Ks <shravya.ks0@gmail.com>,
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/olsr6-helper.h"
+#include "ns3/olsr6-routing-protocol.h"
+#include "ns3/olsr6-authentication.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/simple-net-device-helper.h"
+
+#include <algorithm>
+#include <cstdio>
+
+using namespace ns3;
+using namespace olsr6;
+
+/**
+ * \param data The bytes.
+ * \param size The number of bytes.
+ * \returns The bytes in hexadecimal.
+ */
+static std::string
+ToHex (const uint8_t *data, uint32_t size)
+{
+  std::string hex;
+  for (uint32_t i = 0; i < size; i++)
+    {
+      char byte[3];
+      std::sprintf (byte, "%02x", data[i]);
+      hex += byte;
+    }
+  return hex;
+}
+
+/**
+ * \param data The data.
+ * \returns The SHA-256 digest of the data, in hexadecimal.
+ */
+static std::string
+Sha256Hex (std::string data)
+{
+  Sha256 hash;
+  hash.Update ((const uint8_t *) data.data (), data.size ());
+  uint8_t digest[Sha256::DIGEST_SIZE];
+  hash.Final (digest);
+  return ToHex (digest, sizeof (digest));
+}
+
+/**
+ * Testcase for the SHA-256 test vectors of FIPS 180-4.
+ */
+class Olsr6Sha256TestCase : public TestCase
+{
+public:
+  Olsr6Sha256TestCase ();
+  /// \brief Run test case
+  virtual void DoRun (void);
+};
+
+Olsr6Sha256TestCase::Olsr6Sha256TestCase ()
+  : TestCase ("Check the SHA-256 hash function")
+{
+}
+
+void
+Olsr6Sha256TestCase::DoRun (void)
+{
+  NS_TEST_EXPECT_MSG_EQ (Sha256Hex ("abc"),
+                         "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad", "1000");
+  NS_TEST_EXPECT_MSG_EQ (Sha256Hex (""),
+                         "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855", "1001");
+  NS_TEST_EXPECT_MSG_EQ (Sha256Hex ("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"),
+                         "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1", "1002");
+
+  // One million 'a', hashed in pieces which do not match the blocks
+  Sha256 hash;
+  std::vector<uint8_t> a (1000, 'a');
+  uint32_t left = 1000000;
+  for (uint32_t n = 1; left > 0; n = (n + 7) % 1000 + 1)
+    {
+      uint32_t size = std::min (n, left);
+      hash.Update (&a[0], size);
+      left -= size;
+    }
+  uint8_t digest[Sha256::DIGEST_SIZE];
+  hash.Final (digest);
+  NS_TEST_EXPECT_MSG_EQ (ToHex (digest, sizeof (digest)),
+                         "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0", "1003");
+}
+
+/**
+ * Testcase for the HMAC-SHA-256 test vectors of RFC 4231.
+ */
+class Olsr6HmacTestCase : public TestCase
+{
+public:
+  Olsr6HmacTestCase ();
+  /// \brief Run test case
+  virtual void DoRun (void);
+};
+
+Olsr6HmacTestCase::Olsr6HmacTestCase ()
+  : TestCase ("Check the HMAC-SHA-256")
+{
+}
+
+void
+Olsr6HmacTestCase::DoRun (void)
+{
+  uint8_t icv[HmacSha256::ICV_SIZE];
+
+  // Test case 1
+  std::vector<uint8_t> key (20, 0x0b);
+  HmacSha256 hmac1 (&key[0], key.size ());
+  std::string data = "Hi There";
+  hmac1.Compute ((const uint8_t *) data.data (), data.size (), icv);
+  NS_TEST_EXPECT_MSG_EQ (ToHex (icv, sizeof (icv)),
+                         "b0344c61d8db38535ca8afceaf0bf12b881dc200c9833da726e9376c2e32cff7", "1010");
+
+  // Test case 2
+  HmacSha256 hmac2 (std::string ("Jefe"));
+  data = "what do ya want for nothing?";
+  hmac2.Compute ((const uint8_t *) data.data (), data.size (), icv);
+  NS_TEST_EXPECT_MSG_EQ (ToHex (icv, sizeof (icv)),
+                         "5bdcc146bf60754e6a042426089575c75a003f089d2739839dec58b964ec3843", "1011");
+
+  // Test case 3
+  key.assign (20, 0xaa);
+  HmacSha256 hmac3 (&key[0], key.size ());
+  std::vector<uint8_t> bytes (50, 0xdd);
+  hmac3.Compute (&bytes[0], bytes.size (), icv);
+  NS_TEST_EXPECT_MSG_EQ (ToHex (icv, sizeof (icv)),
+                         "773ea91e36800e46854db8ebd09181a72959098b3ef8c122d9635514ced565fe", "1012");
+
+  // Test case 6, with a key longer than a block
+  key.assign (131, 0xaa);
+  HmacSha256 hmac6 (&key[0], key.size ());
+  data = "Test Using Larger Than Block-Size Key - Hash Key First";
+  hmac6.Compute ((const uint8_t *) data.data (), data.size (), icv);
+  NS_TEST_EXPECT_MSG_EQ (ToHex (icv, sizeof (icv)),
+                         "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54", "1013");
+
+  // The precomputed states are not altered by the ICVs computed
+  hmac6.Compute ((const uint8_t *) data.data (), data.size (), icv);
+  NS_TEST_EXPECT_MSG_EQ (ToHex (icv, sizeof (icv)),
+                         "60e431591ee0b67f0d8a26aacbf5b77f8e0bc6213728c5140546040f0ee37f54", "1014");
+
+  NS_TEST_EXPECT_MSG_EQ (hmac6.Verify ((const uint8_t *) data.data (), data.size (), icv), true, "1015");
+  icv[HmacSha256::ICV_SIZE - 1] ^= 1;
+  NS_TEST_EXPECT_MSG_EQ (hmac6.Verify ((const uint8_t *) data.data (), data.size (), icv), false, "1016");
+  icv[HmacSha256::ICV_SIZE - 1] ^= 1;
+  NS_TEST_EXPECT_MSG_EQ (hmac2.Verify ((const uint8_t *) data.data (), data.size (), icv), false, "1017");
+}
+
+/**
+ * Testcase for the replay window of the packet sequence numbers.
+ */
+class Olsr6ReplayWindowTestCase : public TestCase
+{
+public:
+  Olsr6ReplayWindowTestCase ();
+  /// \brief Run test case
+  virtual void DoRun (void);
+};
+
+Olsr6ReplayWindowTestCase::Olsr6ReplayWindowTestCase ()
+  : TestCase ("Check the replay window")
+{
+}
+
+void
+Olsr6ReplayWindowTestCase::DoRun (void)
+{
+  Time now = Seconds (1);
+  Time hold = Seconds (6);
+
+  ReplayWindow window;
+  NS_TEST_EXPECT_MSG_EQ (window.Accept (10, now, hold), true, "1020");
+  NS_TEST_EXPECT_MSG_EQ (window.Accept (10, now, hold), false, "1021");
+  NS_TEST_EXPECT_MSG_EQ (window.Accept (12, now, hold), true, "1022");
+  // Late, but not received yet
+  NS_TEST_EXPECT_MSG_EQ (window.Accept (11, now, hold), true, "1023");
+  NS_TEST_EXPECT_MSG_EQ (window.Accept (11, now, hold), false, "1024");
+  NS_TEST_EXPECT_MSG_EQ (window.Accept (65535, now, hold), true, "1025");
+  NS_TEST_EXPECT_MSG_EQ (window.Accept (100, now, hold), true, "1026");
+  // 64 numbers behind the highest one is too old
+  NS_TEST_EXPECT_MSG_EQ (window.Accept (36, now, hold), false, "1027");
+  NS_TEST_EXPECT_MSG_EQ (window.Accept (37, now, hold), true, "1028");
+  NS_TEST_EXPECT_MSG_EQ (window.Accept (37, now, hold), false, "1029");
+  NS_TEST_EXPECT_MSG_EQ (window.Accept (100, now, hold), false, "1030");
+  // Once expired, the window starts again
+  NS_TEST_EXPECT_MSG_EQ (window.IsExpired (Seconds (8)), true, "1031");
+  NS_TEST_EXPECT_MSG_EQ (window.Accept (100, Seconds (8), hold), true, "1032");
+
+  // Across the wrap around
+  ReplayWindow wrapped;
+  NS_TEST_EXPECT_MSG_EQ (wrapped.Accept (65534, now, hold), true, "1040");
+  NS_TEST_EXPECT_MSG_EQ (wrapped.Accept (1, now, hold), true, "1041");
+  NS_TEST_EXPECT_MSG_EQ (wrapped.Accept (65535, now, hold), true, "1042");
+  NS_TEST_EXPECT_MSG_EQ (wrapped.Accept (65534, now, hold), false, "1043");
+  NS_TEST_EXPECT_MSG_EQ (wrapped.Accept (0, now, hold), true, "1044");
+  NS_TEST_EXPECT_MSG_EQ (wrapped.Accept (1, now, hold), false, "1045");
+}
+
+/**
+ * Counts the packets a node dropped by the authentication.
+ */
+class AuthenticationFailureCounter
+{
+public:
+  AuthenticationFailureCounter ();
+  /**
+   * \brief AuthenticationFailure trace of a node.
+   * \param header The packet header.
+   * \param sender Address of the sending interface.
+   */
+  void Fail (const PacketHeader &header, const Ipv6Address &sender);
+
+  uint32_t m_failures;  //!< Packets dropped.
+};
+
+AuthenticationFailureCounter::AuthenticationFailureCounter ()
+  : m_failures (0)
+{
+}
+
+void
+AuthenticationFailureCounter::Fail (const PacketHeader &header, const Ipv6Address &sender)
+{
+  m_failures++;
+}
+
+/**
+ * \brief Tells whether a node has a route to a destination.
+ * \param protocol The routing protocol of the node.
+ * \param dest The destination.
+ * \returns True if the node has a route to the destination.
+ */
+static bool
+HasRoute (Ptr<RoutingProtocol> protocol, Ipv6Address dest)
+{
+  std::vector<RoutingTableEntry> entries = protocol->GetRoutingTableEntries ();
+  for (std::vector<RoutingTableEntry>::const_iterator it = entries.begin (); it != entries.end (); it++)
+    {
+      if (it->destAddr == dest)
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+/**
+ * Testcase for the authentication on a link shared by A, B and C.  A and B
+ * sign their packets with the same key; C signs its packets with the same
+ * key, with another key A and B were given, or with a key they do not know,
+ * in which case nobody hears C.
+ */
+class Olsr6AuthenticatedLinkTestCase : public TestCase
+{
+public:
+  /// Key of C.
+  enum Key
+  {
+    SAME_KEY,
+    ADDED_KEY,
+    WRONG_KEY
+  };
+
+  /**
+   * \param key The key of C.
+   */
+  Olsr6AuthenticatedLinkTestCase (Key key);
+  /// \brief Run test case
+  virtual void DoRun (void);
+
+private:
+  Key m_key;  //!< The key of C.
+};
+
+Olsr6AuthenticatedLinkTestCase::Olsr6AuthenticatedLinkTestCase (Key key)
+  : TestCase (key == SAME_KEY ? "Check the authentication of nodes sharing a key"
+              : key == ADDED_KEY ? "Check the authentication of nodes accepting each other's key"
+              : "Check the authentication of a node with a wrong key"),
+    m_key (key)
+{
+}
+
+void
+Olsr6AuthenticatedLinkTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (3);
+
+  Olsr6Helper olsr6;
+  olsr6.Set ("AuthenticationKey", StringValue ("shared secret"));
+  olsr6.Set ("AuthenticationKeyId", UintegerValue (1));
+  InternetStackHelper internet;
+  internet.SetRoutingHelper (olsr6);
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper simpleNetHelper;
+  simpleNetHelper.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  simpleNetHelper.SetChannelAttribute ("Delay", StringValue ("2ms"));
+
+  // A, B, C are the nodes 0, 1, 2
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase ("2001:1::", Ipv6Prefix (64));
+  Ipv6InterfaceContainer interfaces = ipv6.Assign (simpleNetHelper.Install (nodes));
+
+  Ptr<RoutingProtocol> a = Olsr6Helper::GetOlsr6RoutingProtocol (nodes.Get (0));
+  Ptr<RoutingProtocol> b = Olsr6Helper::GetOlsr6RoutingProtocol (nodes.Get (1));
+  Ptr<RoutingProtocol> c = Olsr6Helper::GetOlsr6RoutingProtocol (nodes.Get (2));
+  // With the wrong key, C uses the same Key ID as A and B
+  if (m_key == WRONG_KEY)
+    {
+      c->SetAttribute ("AuthenticationKey", StringValue ("other secret"));
+    }
+  if (m_key == ADDED_KEY)
+    {
+      c->SetAttribute ("AuthenticationKey", StringValue ("other secret"));
+      c->SetAttribute ("AuthenticationKeyId", UintegerValue (2));
+      a->AddAuthenticationKey (2, "other secret");
+      b->AddAuthenticationKey (2, "other secret");
+      c->AddAuthenticationKey (1, "shared secret");
+    }
+
+  AuthenticationFailureCounter aCounter;
+  AuthenticationFailureCounter cCounter;
+  a->TraceConnectWithoutContext ("AuthenticationFailure",
+                                 MakeCallback (&AuthenticationFailureCounter::Fail, &aCounter));
+  c->TraceConnectWithoutContext ("AuthenticationFailure",
+                                 MakeCallback (&AuthenticationFailureCounter::Fail, &cCounter));
+
+  Simulator::Stop (Seconds (20));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (HasRoute (a, interfaces.GetAddress (1, 1)), true, "A has a route to B");
+  if (m_key == WRONG_KEY)
+    {
+      NS_TEST_EXPECT_MSG_GT (aCounter.m_failures, 0, "A dropped the packets of C");
+      NS_TEST_EXPECT_MSG_GT (cCounter.m_failures, 0, "C dropped the packets of A and B");
+      NS_TEST_EXPECT_MSG_EQ (HasRoute (a, interfaces.GetAddress (2, 1)), false, "A has no route to C");
+      NS_TEST_EXPECT_MSG_EQ (HasRoute (c, interfaces.GetAddress (0, 1)), false, "C has no route to A");
+    }
+  else
+    {
+      NS_TEST_EXPECT_MSG_EQ (aCounter.m_failures, 0, "A dropped no packet");
+      NS_TEST_EXPECT_MSG_EQ (cCounter.m_failures, 0, "C dropped no packet");
+      NS_TEST_EXPECT_MSG_EQ (HasRoute (a, interfaces.GetAddress (2, 1)), true, "A has a route to C");
+      NS_TEST_EXPECT_MSG_EQ (HasRoute (c, interfaces.GetAddress (0, 1)), true, "C has a route to A");
+    }
+
+  Simulator::Destroy ();
+}
+
+/**
+ * Testcase for the replay of a signed packet: B records the first packet
+ * it receives from A, which is then received again.
+ */
+class Olsr6ReplayTestCase : public TestCase
+{
+public:
+  Olsr6ReplayTestCase ();
+  /// \brief Run test case
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief RxPacket trace of B, which records the first packet.
+   * \param packet The packet.
+   * \param sender Address of the sending interface.
+   * \param receiver Address of the receiving interface.
+   */
+  void Record (Ptr<const Packet> packet, const Ipv6Address &sender, const Ipv6Address &receiver);
+  /**
+   * \brief Makes B receive the recorded packet again.
+   * \param b The routing protocol of B.
+   */
+  void Replay (Ptr<RoutingProtocol> b);
+
+  Ptr<Packet> m_packet;     //!< Recorded packet.
+  Ipv6Address m_sender;     //!< Sender of the recorded packet.
+  Ipv6Address m_receiver;   //!< Receiver of the recorded packet.
+};
+
+Olsr6ReplayTestCase::Olsr6ReplayTestCase ()
+  : TestCase ("Check the replay of a signed packet")
+{
+}
+
+void
+Olsr6ReplayTestCase::Record (Ptr<const Packet> packet, const Ipv6Address &sender, const Ipv6Address &receiver)
+{
+  if (m_packet == 0)
+    {
+      m_packet = packet->Copy ();
+      m_sender = sender;
+      m_receiver = receiver;
+    }
+}
+
+void
+Olsr6ReplayTestCase::Replay (Ptr<RoutingProtocol> b)
+{
+  NS_TEST_ASSERT_MSG_NE (m_packet, 0, "B received a packet");
+  b->ReceivePacket (m_packet->Copy (), m_sender, m_receiver);
+}
+
+void
+Olsr6ReplayTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+
+  Olsr6Helper olsr6;
+  olsr6.Set ("AuthenticationKey", StringValue ("shared secret"));
+  InternetStackHelper internet;
+  internet.SetRoutingHelper (olsr6);
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper simpleNetHelper;
+  simpleNetHelper.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  simpleNetHelper.SetChannelAttribute ("Delay", StringValue ("2ms"));
+
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase ("2001:1::", Ipv6Prefix (64));
+  ipv6.Assign (simpleNetHelper.Install (nodes));
+
+  Ptr<RoutingProtocol> b = Olsr6Helper::GetOlsr6RoutingProtocol (nodes.Get (1));
+  b->TraceConnectWithoutContext ("RxPacket", MakeCallback (&Olsr6ReplayTestCase::Record, this));
+  AuthenticationFailureCounter counter;
+  b->TraceConnectWithoutContext ("AuthenticationFailure",
+                                 MakeCallback (&AuthenticationFailureCounter::Fail, &counter));
+
+  Simulator::Schedule (Seconds (5), &Olsr6ReplayTestCase::Replay, this, b);
+  Simulator::Stop (Seconds (6));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_EQ (counter.m_failures, 1, "B dropped the replayed packet, and only it");
+
+  m_packet = 0;
+  Simulator::Destroy ();
+}
+
+static class Olsr6AuthenticationTestSuite : public TestSuite
+{
+public:
+  Olsr6AuthenticationTestSuite ();
+} g_olsr6AuthenticationTestSuite;
+
+Olsr6AuthenticationTestSuite::Olsr6AuthenticationTestSuite ()
+  : TestSuite ("routing-olsr6-authentication", UNIT)
+{
+  AddTestCase (new Olsr6Sha256TestCase (), TestCase::QUICK);
+  AddTestCase (new Olsr6HmacTestCase (), TestCase::QUICK);
+  AddTestCase (new Olsr6ReplayWindowTestCase (), TestCase::QUICK);
+  AddTestCase (new Olsr6AuthenticatedLinkTestCase (Olsr6AuthenticatedLinkTestCase::SAME_KEY), TestCase::QUICK);
+  AddTestCase (new Olsr6AuthenticatedLinkTestCase (Olsr6AuthenticatedLinkTestCase::ADDED_KEY), TestCase::QUICK);
+  AddTestCase (new Olsr6AuthenticatedLinkTestCase (Olsr6AuthenticatedLinkTestCase::WRONG_KEY), TestCase::QUICK);
+  AddTestCase (new Olsr6ReplayTestCase (), TestCase::QUICK);
+}
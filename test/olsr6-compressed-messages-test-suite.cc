@@ -0,0 +1,261 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Ankit Deepak <adadeepak8@gmail.com>
+ *          Shravya Ks <shravya.ks0@gmail.com>,
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/boolean.h"
+#include "ns3/olsr6-helper.h"
+#include "ns3/olsr6-routing-protocol.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/simple-net-device-helper.h"
+
+using namespace ns3;
+using namespace olsr6;
+
+/**
+ * Counts the compressed and plain messages received by a node once the
+ * neighbors know each other.
+ */
+class CompressedMessagesCounter
+{
+public:
+  CompressedMessagesCounter ();
+  /**
+   * \brief Receive trace of a node.
+   * \param header The packet header.
+   * \param messages The messages of the packet.
+   */
+  void Receive (const PacketHeader &header, const MessageList &messages);
+
+  uint32_t m_compressed;  //!< Compressed messages received.
+  uint32_t m_plain;       //!< Plain messages received.
+};
+
+CompressedMessagesCounter::CompressedMessagesCounter ()
+  : m_compressed (0),
+    m_plain (0)
+{
+}
+
+void
+CompressedMessagesCounter::Receive (const PacketHeader &header, const MessageList &messages)
+{
+  // Until the HELLO of a neighbor is heard, its capability is unknown
+  if (Simulator::Now () < Seconds (10))
+    {
+      return;
+    }
+  for (MessageList::const_iterator it = messages.begin (); it != messages.end (); it++)
+    {
+      if (it->IsCompressed ())
+        {
+          m_compressed++;
+        }
+      else
+        {
+          m_plain++;
+        }
+    }
+}
+
+/**
+ * \brief Tells whether a node has a route to a destination.
+ * \param protocol The routing protocol of the node.
+ * \param dest The destination.
+ * \returns True if the node has a route to the destination.
+ */
+static bool
+HasRoute (Ptr<RoutingProtocol> protocol, Ipv6Address dest)
+{
+  std::vector<RoutingTableEntry> entries = protocol->GetRoutingTableEntries ();
+  for (std::vector<RoutingTableEntry>::const_iterator it = entries.begin (); it != entries.end (); it++)
+    {
+      if (it->destAddr == dest)
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+/**
+ * Testcase for the compressed messages on a link shared by A, B and C.  A
+ * and B send compressed messages; C does too, or is a legacy node sending
+ * and accepting only plain messages, in which case nobody sends
+ * compressed messages on the link.
+ */
+class Olsr6SharedLinkCompressionTestCase : public TestCase
+{
+public:
+  /**
+   * \param legacy True if C does not accept the compressed messages.
+   */
+  Olsr6SharedLinkCompressionTestCase (bool legacy);
+  /// \brief Run test case
+  virtual void DoRun (void);
+
+private:
+  bool m_legacy;  //!< True if C does not accept the compressed messages.
+};
+
+Olsr6SharedLinkCompressionTestCase::Olsr6SharedLinkCompressionTestCase (bool legacy)
+  : TestCase (legacy ? "Check the plain messages on a link with a legacy node"
+              : "Check the compressed messages on a link of capable nodes"),
+    m_legacy (legacy)
+{
+}
+
+void
+Olsr6SharedLinkCompressionTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (3);
+
+  Olsr6Helper olsr6;
+  olsr6.Set ("CompressedMessages", BooleanValue (true));
+  InternetStackHelper internet;
+  internet.SetRoutingHelper (olsr6);
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper simpleNetHelper;
+  simpleNetHelper.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  simpleNetHelper.SetChannelAttribute ("Delay", StringValue ("2ms"));
+
+  // A, B, C are the nodes 0, 1, 2
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase ("2001:1::", Ipv6Prefix (64));
+  Ipv6InterfaceContainer interfaces = ipv6.Assign (simpleNetHelper.Install (nodes));
+
+  Ptr<RoutingProtocol> c = Olsr6Helper::GetOlsr6RoutingProtocol (nodes.Get (2));
+  if (m_legacy)
+    {
+      c->SetAttribute ("CompressedMessages", BooleanValue (false));
+    }
+
+  CompressedMessagesCounter a;
+  CompressedMessagesCounter b;
+  Olsr6Helper::GetOlsr6RoutingProtocol (nodes.Get (0))->TraceConnectWithoutContext (
+    "Rx", MakeCallback (&CompressedMessagesCounter::Receive, &a));
+  Olsr6Helper::GetOlsr6RoutingProtocol (nodes.Get (1))->TraceConnectWithoutContext (
+    "Rx", MakeCallback (&CompressedMessagesCounter::Receive, &b));
+
+  Simulator::Stop (Seconds (30));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_GT (a.m_compressed + a.m_plain, 0, "A received messages");
+  if (m_legacy)
+    {
+      NS_TEST_EXPECT_MSG_EQ (a.m_compressed + b.m_compressed, 0, "No compressed message on the link");
+    }
+  else
+    {
+      // The messages listing a single address gain nothing and are sent plain
+      NS_TEST_EXPECT_MSG_GT (a.m_compressed, 0, "A received compressed messages");
+      NS_TEST_EXPECT_MSG_GT (b.m_compressed, 0, "B received compressed messages");
+    }
+  NS_TEST_EXPECT_MSG_EQ (HasRoute (c, interfaces.GetAddress (0, 1)), true, "C has a route to A");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * Testcase for the compressed messages on the chain A - B - C, where C is
+ * a legacy node.  A stands for three nodes sharing a link with B, so that
+ * the HELLOs of B on this link list enough addresses to be compressed.  B
+ * sends compressed messages to A and plain ones to C, the messages it
+ * forwards included, and every node still reaches the others.
+ */
+class Olsr6ChainCompressionTestCase : public TestCase
+{
+public:
+  Olsr6ChainCompressionTestCase ();
+  /// \brief Run test case
+  virtual void DoRun (void);
+};
+
+Olsr6ChainCompressionTestCase::Olsr6ChainCompressionTestCase ()
+  : TestCase ("Check the compressed messages on a chain with a legacy node")
+{
+}
+
+void
+Olsr6ChainCompressionTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (5);
+
+  Olsr6Helper olsr6;
+  olsr6.Set ("CompressedMessages", BooleanValue (true));
+  InternetStackHelper internet;
+  internet.SetRoutingHelper (olsr6);
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper simpleNetHelper;
+  simpleNetHelper.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  simpleNetHelper.SetChannelAttribute ("Delay", StringValue ("2ms"));
+
+  // A is the nodes 0 to 2, B and C the nodes 3 and 4
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase ("2001:1::", Ipv6Prefix (64));
+  NodeContainer abNodes (nodes.Get (0), nodes.Get (1), nodes.Get (2), nodes.Get (3));
+  Ipv6InterfaceContainer ab = ipv6.Assign (simpleNetHelper.Install (abNodes));
+  ipv6.NewNetwork ();
+  Ipv6InterfaceContainer bc = ipv6.Assign (simpleNetHelper.Install (NodeContainer (nodes.Get (3), nodes.Get (4))));
+
+  Ptr<RoutingProtocol> a = Olsr6Helper::GetOlsr6RoutingProtocol (nodes.Get (0));
+  Ptr<RoutingProtocol> c = Olsr6Helper::GetOlsr6RoutingProtocol (nodes.Get (4));
+  c->SetAttribute ("CompressedMessages", BooleanValue (false));
+
+  CompressedMessagesCounter aCounter;
+  CompressedMessagesCounter cCounter;
+  a->TraceConnectWithoutContext ("Rx", MakeCallback (&CompressedMessagesCounter::Receive, &aCounter));
+  c->TraceConnectWithoutContext ("Rx", MakeCallback (&CompressedMessagesCounter::Receive, &cCounter));
+
+  Simulator::Stop (Seconds (30));
+  Simulator::Run ();
+
+  NS_TEST_EXPECT_MSG_GT (aCounter.m_compressed, 0, "A received compressed messages");
+  NS_TEST_EXPECT_MSG_GT (cCounter.m_plain, 0, "C received plain messages");
+  NS_TEST_EXPECT_MSG_EQ (cCounter.m_compressed, 0, "C received no compressed message");
+  NS_TEST_EXPECT_MSG_EQ (HasRoute (a, bc.GetAddress (1, 1)), true, "A has a route to C");
+  NS_TEST_EXPECT_MSG_EQ (HasRoute (c, ab.GetAddress (0, 1)), true, "C has a route to A");
+
+  Simulator::Destroy ();
+}
+
+static class Olsr6CompressedMessagesTestSuite : public TestSuite
+{
+public:
+  Olsr6CompressedMessagesTestSuite ();
+} g_olsr6CompressedMessagesTestSuite;
+
+Olsr6CompressedMessagesTestSuite::Olsr6CompressedMessagesTestSuite ()
+  : TestSuite ("routing-olsr6-compressed-messages", UNIT)
+{
+  AddTestCase (new Olsr6SharedLinkCompressionTestCase (false), TestCase::QUICK);
+  AddTestCase (new Olsr6SharedLinkCompressionTestCase (true), TestCase::QUICK);
+  AddTestCase (new Olsr6ChainCompressionTestCase (), TestCase::QUICK);
+}
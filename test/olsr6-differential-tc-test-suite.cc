@@ -0,0 +1,190 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Ankit Deepak <adadeepak8@gmail.com>
+ *          Shravya Ks <shravya.ks0@gmail.com>,
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/nstime.h"
+#include "ns3/olsr6-helper.h"
+#include "ns3/olsr6-routing-protocol.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/simple-net-device-helper.h"
+
+using namespace ns3;
+using namespace olsr6;
+
+/**
+ * Testcase on the network
+ *
+ * \verbatim
+                 L2
+                /
+   X -- L1 -- H -- L3
+                \
+                 L4
+   \endverbatim
+ *
+ * where H advertises its four MPR selectors.  With differential TCs, H
+ * sends fewer TC bytes and X, which learns the links of H from its TCs
+ * only, keeps its routes.
+ */
+class Olsr6DifferentialTcTestCase : public TestCase
+{
+public:
+  Olsr6DifferentialTcTestCase ();
+  /// \brief Run test case
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Runs the scenario.
+   * \param differential true to enable the differential TCs
+   */
+  void Run (bool differential);
+  /**
+   * \brief Records the TC messages originated by H.
+   * \param header The packet header.
+   * \param messages The messages of the packet.
+   */
+  void Tx (const PacketHeader &header, const MessageList &messages);
+  /**
+   * \brief Samples the size of the routing table of X, every second.
+   * \param x The routing protocol of X.
+   */
+  void Sample (Ptr<RoutingProtocol> x);
+
+  uint32_t m_nFull;       //!< Full TC messages originated by H.
+  uint32_t m_nDiff;       //!< Differential TC messages originated by H.
+  uint32_t m_bytes;       //!< Bytes of the TC messages originated by H.
+  uint32_t m_minRoutes;   //!< Smallest routing table of X after convergence.
+};
+
+Olsr6DifferentialTcTestCase::Olsr6DifferentialTcTestCase ()
+  : TestCase ("Check the differential TC messages")
+{
+}
+
+void
+Olsr6DifferentialTcTestCase::Tx (const PacketHeader &header, const MessageList &messages)
+{
+  for (MessageList::const_iterator it = messages.begin (); it != messages.end (); it++)
+    {
+      // Forwarded messages have a non-zero hop count
+      if (it->GetHopCount () != 0)
+        {
+          continue;
+        }
+      if (it->GetMessageType () == MessageHeader::TC_MESSAGE)
+        {
+          m_nFull++;
+          m_bytes += it->GetSerializedSize ();
+        }
+      else if (it->GetMessageType () == MessageHeader::DTC_MESSAGE)
+        {
+          m_nDiff++;
+          m_bytes += it->GetSerializedSize ();
+        }
+    }
+}
+
+void
+Olsr6DifferentialTcTestCase::Sample (Ptr<RoutingProtocol> x)
+{
+  m_minRoutes = std::min<uint32_t> (m_minRoutes, x->GetRoutingTableEntries ().size ());
+  Simulator::Schedule (Seconds (1), &Olsr6DifferentialTcTestCase::Sample, this, x);
+}
+
+void
+Olsr6DifferentialTcTestCase::Run (bool differential)
+{
+  m_nFull = 0;
+  m_nDiff = 0;
+  m_bytes = 0;
+  m_minRoutes = 0xffffffff;
+
+  // H, L1, L2, L3, L4 and X
+  NodeContainer nodes;
+  nodes.Create (6);
+
+  Olsr6Helper olsr6;
+  olsr6.Set ("DifferentialTc", BooleanValue (differential));
+  olsr6.Set ("FullTcRefresh", UintegerValue (4));
+  InternetStackHelper internet;
+  internet.SetRoutingHelper (olsr6);
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper simpleNetHelper;
+  simpleNetHelper.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  simpleNetHelper.SetChannelAttribute ("Delay", StringValue ("2ms"));
+
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase ("2001:1::", Ipv6Prefix (64));
+  for (uint32_t i = 1; i <= 4; i++)
+    {
+      ipv6.Assign (simpleNetHelper.Install (NodeContainer (nodes.Get (0), nodes.Get (i))));
+      ipv6.NewNetwork ();
+    }
+  ipv6.Assign (simpleNetHelper.Install (NodeContainer (nodes.Get (1), nodes.Get (5))));
+
+  Olsr6Helper::GetOlsr6RoutingProtocol (nodes.Get (0))->TraceConnectWithoutContext (
+    "Tx", MakeCallback (&Olsr6DifferentialTcTestCase::Tx, this));
+  Simulator::Schedule (Seconds (30), &Olsr6DifferentialTcTestCase::Sample, this,
+                       Olsr6Helper::GetOlsr6RoutingProtocol (nodes.Get (5)));
+
+  Simulator::Stop (Seconds (90));
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+Olsr6DifferentialTcTestCase::DoRun (void)
+{
+  Run (false);
+  uint32_t fullBytes = m_bytes;
+  NS_TEST_ASSERT_MSG_GT (m_nFull, 0, "H should send TC messages");
+  NS_TEST_EXPECT_MSG_EQ (m_nDiff, 0, "No differential TC by default");
+  // 10 interface addresses, one of them owned by X
+  NS_TEST_EXPECT_MSG_EQ (m_minRoutes, 9, "X should keep its routes with full TCs");
+
+  Run (true);
+  NS_TEST_ASSERT_MSG_GT (m_nFull, 0, "H should send full TC messages");
+  NS_TEST_EXPECT_MSG_GT (m_nDiff, m_nFull, "Most TC messages of H should be differential");
+  NS_TEST_EXPECT_MSG_LT (m_bytes, fullBytes, "Differential TCs should be smaller");
+  NS_TEST_EXPECT_MSG_EQ (m_minRoutes, 9, "X should keep its routes with differential TCs");
+}
+
+static class Olsr6DifferentialTcTestSuite : public TestSuite
+{
+public:
+  Olsr6DifferentialTcTestSuite ();
+} g_olsr6DifferentialTcTestSuite;
+
+Olsr6DifferentialTcTestSuite::Olsr6DifferentialTcTestSuite ()
+  : TestSuite ("routing-olsr6-differential-tc", UNIT)
+{
+  AddTestCase (new Olsr6DifferentialTcTestCase (), TestCase::QUICK);
+}
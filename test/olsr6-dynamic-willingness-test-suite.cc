@@ -0,0 +1,305 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Ankit Deepak <adadeepak8@gmail.com>
+ *          Shravya Ks <shravya.ks0@gmail.com>,
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/socket.h"
+#include "ns3/socket-factory.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/olsr6-helper.h"
+#include "ns3/olsr6-routing-protocol.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/simple-net-device-helper.h"
+
+using namespace ns3;
+using namespace olsr6;
+
+/**
+ * Testcase for the willingness controller, driven by a load set by the
+ * test.  The willingness of A, configured high, is kept while the load is
+ * between the thresholds, lowered one level per sample down to low while
+ * it is above, kept again when it falls between the thresholds, and raised
+ * one level per hold time up to high once it is below.  B sees it in the
+ * HELLO messages of A.
+ */
+class Olsr6WillingnessControllerTestCase : public TestCase
+{
+public:
+  Olsr6WillingnessControllerTestCase ();
+  /// \brief Run test case
+  virtual void DoRun (void);
+
+private:
+  /// \returns The load of A.
+  double GetLoad (void);
+  /**
+   * \brief Sets the load of A.
+   * \param load The load.
+   */
+  void SetLoad (double load);
+  /**
+   * \brief Checks the willingness of A.
+   * \param expected The willingness A is expected to advertise.
+   */
+  void Check (uint8_t expected);
+  /**
+   * \brief Checks the willingness of A in its last HELLO received by B.
+   * \param expected The willingness expected.
+   */
+  void CheckHello (uint8_t expected);
+  /**
+   * \brief Receives the packets of B.
+   * \param header The packet header.
+   * \param messages The messages of the packet.
+   */
+  void ReceiveB (const PacketHeader &header, const MessageList &messages);
+  /**
+   * \brief Counts the changes of the willingness of A.
+   * \param oldWillingness The previous willingness.
+   * \param newWillingness The new willingness.
+   */
+  void WillingnessChanged (uint8_t oldWillingness, uint8_t newWillingness);
+
+  double m_load;               //!< Load of A.
+  Ptr<RoutingProtocol> m_a;    //!< The routing protocol of A.
+  Ipv6Address m_aAddress;      //!< The main address of A.
+  uint8_t m_helloWillingness;  //!< Willingness of the last HELLO of A received by B.
+  uint32_t m_changes;          //!< Changes of the willingness of A.
+};
+
+Olsr6WillingnessControllerTestCase::Olsr6WillingnessControllerTestCase ()
+  : TestCase ("Check the steps and the hysteresis of the willingness controller"),
+    m_load (0.5),
+    m_helloWillingness (0),
+    m_changes (0)
+{
+}
+
+double
+Olsr6WillingnessControllerTestCase::GetLoad (void)
+{
+  return m_load;
+}
+
+void
+Olsr6WillingnessControllerTestCase::SetLoad (double load)
+{
+  m_load = load;
+}
+
+void
+Olsr6WillingnessControllerTestCase::Check (uint8_t expected)
+{
+  NS_TEST_EXPECT_MSG_EQ (int (m_a->GetWillingness ()), int (expected),
+                         "Willingness of A at " << Simulator::Now ().GetSeconds () << "s");
+}
+
+void
+Olsr6WillingnessControllerTestCase::CheckHello (uint8_t expected)
+{
+  NS_TEST_EXPECT_MSG_EQ (int (m_helloWillingness), int (expected),
+                         "Willingness advertised by A at " << Simulator::Now ().GetSeconds () << "s");
+}
+
+void
+Olsr6WillingnessControllerTestCase::ReceiveB (const PacketHeader &header, const MessageList &messages)
+{
+  for (MessageList::const_iterator msg = messages.begin (); msg != messages.end (); msg++)
+    {
+      if (msg->GetMessageType () == MessageHeader::HELLO_MESSAGE && msg->GetOriginatorAddress () == m_aAddress)
+        {
+          m_helloWillingness = msg->GetHello ().willingness;
+        }
+    }
+}
+
+void
+Olsr6WillingnessControllerTestCase::WillingnessChanged (uint8_t oldWillingness, uint8_t newWillingness)
+{
+  m_changes++;
+}
+
+void
+Olsr6WillingnessControllerTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (2);
+
+  Olsr6Helper olsr6;
+  InternetStackHelper internet;
+  internet.SetRoutingHelper (olsr6);
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper simpleNetHelper;
+  simpleNetHelper.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  simpleNetHelper.SetChannelAttribute ("Delay", StringValue ("2ms"));
+
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase ("2001:1::", Ipv6Prefix (64));
+  Ipv6InterfaceContainer interfaces = ipv6.Assign (simpleNetHelper.Install (nodes));
+  m_aAddress = interfaces.GetAddress (0, 1);
+
+  m_a = Olsr6Helper::GetOlsr6RoutingProtocol (nodes.Get (0));
+  m_a->SetAttribute ("Willingness", StringValue ("high"));
+  m_a->SetAttribute ("WillingnessLoadSignal", StringValue ("callback"));
+  m_a->SetAttribute ("WillingnessHoldTime", TimeValue (Seconds (2)));
+  m_a->SetWillingnessLoadCallback (MakeCallback (&Olsr6WillingnessControllerTestCase::GetLoad, this));
+  m_a->TraceConnectWithoutContext ("WillingnessChanged",
+                                   MakeCallback (&Olsr6WillingnessControllerTestCase::WillingnessChanged, this));
+  Olsr6Helper::GetOlsr6RoutingProtocol (nodes.Get (1))->TraceConnectWithoutContext (
+    "Rx", MakeCallback (&Olsr6WillingnessControllerTestCase::ReceiveB, this));
+
+  // The load is sampled every second, the changes fall in between
+  Simulator::Schedule (Seconds (9.5), &Olsr6WillingnessControllerTestCase::Check, this, 6);
+  Simulator::Schedule (Seconds (9.5), &Olsr6WillingnessControllerTestCase::CheckHello, this, 6);
+  Simulator::Schedule (Seconds (10.5), &Olsr6WillingnessControllerTestCase::SetLoad, this, 0.9);
+  Simulator::Schedule (Seconds (11.5), &Olsr6WillingnessControllerTestCase::Check, this, 3);
+  Simulator::Schedule (Seconds (12.5), &Olsr6WillingnessControllerTestCase::Check, this, 1);
+  Simulator::Schedule (Seconds (15.5), &Olsr6WillingnessControllerTestCase::Check, this, 1);
+  // One HELLO interval later, B has heard of it
+  Simulator::Schedule (Seconds (15.5), &Olsr6WillingnessControllerTestCase::CheckHello, this, 1);
+  Simulator::Schedule (Seconds (16.5), &Olsr6WillingnessControllerTestCase::SetLoad, this, 0.5);
+  Simulator::Schedule (Seconds (25.2), &Olsr6WillingnessControllerTestCase::Check, this, 1);
+  Simulator::Schedule (Seconds (25.5), &Olsr6WillingnessControllerTestCase::SetLoad, this, 0.1);
+  Simulator::Schedule (Seconds (26.5), &Olsr6WillingnessControllerTestCase::Check, this, 1);
+  Simulator::Schedule (Seconds (27.5), &Olsr6WillingnessControllerTestCase::Check, this, 3);
+  Simulator::Schedule (Seconds (28.5), &Olsr6WillingnessControllerTestCase::Check, this, 3);
+  Simulator::Schedule (Seconds (29.5), &Olsr6WillingnessControllerTestCase::Check, this, 6);
+  Simulator::Schedule (Seconds (35.5), &Olsr6WillingnessControllerTestCase::Check, this, 6);
+  Simulator::Schedule (Seconds (35.5), &Olsr6WillingnessControllerTestCase::CheckHello, this, 6);
+  Simulator::Stop (Seconds (36));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_a = 0;
+
+  NS_TEST_EXPECT_MSG_EQ (m_changes, 4, "Two steps down and two steps up");
+}
+
+/**
+ * Testcase for the forwarding load signal on the chain B - A - C.  From
+ * 15 s to 25 s, B sends 50 packets per second to C through A, five times
+ * the forwarding capacity of A: A lowers its willingness to low, and
+ * raises it back to default once the traffic stopped.
+ */
+class Olsr6ForwardingLoadTestCase : public TestCase
+{
+public:
+  Olsr6ForwardingLoadTestCase ();
+  /// \brief Run test case
+  virtual void DoRun (void);
+
+private:
+  /// \brief Sends a packet from B to C, and schedules the next one.
+  void Send (void);
+  /**
+   * \brief Checks the willingness of A.
+   * \param expected The willingness A is expected to advertise.
+   */
+  void Check (uint8_t expected);
+
+  Ptr<Socket> m_socket;        //!< The socket of B.
+  Ipv6Address m_c;             //!< The address of C.
+  Ptr<RoutingProtocol> m_a;    //!< The routing protocol of A.
+};
+
+Olsr6ForwardingLoadTestCase::Olsr6ForwardingLoadTestCase ()
+  : TestCase ("Check the willingness driven by the forwarded packets")
+{
+}
+
+void
+Olsr6ForwardingLoadTestCase::Send (void)
+{
+  m_socket->SendTo (Create<Packet> (100), 0, Inet6SocketAddress (m_c, 9));
+  if (Simulator::Now () < Seconds (25))
+    {
+      Simulator::Schedule (Seconds (0.02), &Olsr6ForwardingLoadTestCase::Send, this);
+    }
+}
+
+void
+Olsr6ForwardingLoadTestCase::Check (uint8_t expected)
+{
+  NS_TEST_EXPECT_MSG_EQ (int (m_a->GetWillingness ()), int (expected),
+                         "Willingness of A at " << Simulator::Now ().GetSeconds () << "s");
+}
+
+void
+Olsr6ForwardingLoadTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (3);
+
+  Olsr6Helper olsr6;
+  InternetStackHelper internet;
+  internet.SetRoutingHelper (olsr6);
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper simpleNetHelper;
+  simpleNetHelper.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  simpleNetHelper.SetChannelAttribute ("Delay", StringValue ("2ms"));
+
+  // A, B, C are the nodes 0, 1, 2
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase ("2001:1::", Ipv6Prefix (64));
+  ipv6.Assign (simpleNetHelper.Install (NodeContainer (nodes.Get (0), nodes.Get (1))));
+  ipv6.NewNetwork ();
+  Ipv6InterfaceContainer ac = ipv6.Assign (simpleNetHelper.Install (NodeContainer (nodes.Get (0), nodes.Get (2))));
+  m_c = ac.GetAddress (1, 1);
+
+  m_a = Olsr6Helper::GetOlsr6RoutingProtocol (nodes.Get (0));
+  m_a->SetAttribute ("WillingnessLoadSignal", StringValue ("forwarding"));
+  m_a->SetAttribute ("ForwardingCapacity", UintegerValue (10));
+  m_a->SetAttribute ("WillingnessHoldTime", TimeValue (Seconds (2)));
+
+  m_socket = Socket::CreateSocket (nodes.Get (1), TypeId::LookupByName ("ns3::UdpSocketFactory"));
+  m_socket->Bind6 ();
+
+  Simulator::Schedule (Seconds (14.5), &Olsr6ForwardingLoadTestCase::Check, this, 3);
+  Simulator::Schedule (Seconds (15), &Olsr6ForwardingLoadTestCase::Send, this);
+  Simulator::Schedule (Seconds (20.5), &Olsr6ForwardingLoadTestCase::Check, this, 1);
+  Simulator::Schedule (Seconds (24.5), &Olsr6ForwardingLoadTestCase::Check, this, 1);
+  Simulator::Schedule (Seconds (35), &Olsr6ForwardingLoadTestCase::Check, this, 3);
+  Simulator::Stop (Seconds (36));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_socket = 0;
+  m_a = 0;
+}
+
+static class Olsr6DynamicWillingnessTestSuite : public TestSuite
+{
+public:
+  Olsr6DynamicWillingnessTestSuite ();
+} g_olsr6DynamicWillingnessTestSuite;
+
+Olsr6DynamicWillingnessTestSuite::Olsr6DynamicWillingnessTestSuite ()
+  : TestSuite ("routing-olsr6-dynamic-willingness", UNIT)
+{
+  AddTestCase (new Olsr6WillingnessControllerTestCase (), TestCase::QUICK);
+  AddTestCase (new Olsr6ForwardingLoadTestCase (), TestCase::QUICK);
+}
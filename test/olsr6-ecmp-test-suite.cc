@@ -0,0 +1,172 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Ankit Deepak <adadeepak8@gmail.com>
+ *          Shravya Ks <shravya.ks0@gmail.com>,
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/ipv6-header.h"
+#include "ns3/ipv6-route.h"
+#include "ns3/olsr6-helper.h"
+#include "ns3/olsr6-routing-protocol.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/simple-net-device-helper.h"
+
+#include <set>
+#include <sstream>
+#include <vector>
+
+using namespace ns3;
+using namespace olsr6;
+
+/**
+ * Testcase for the equal-cost routes on the square A - B - D - C - A, where
+ * A reaches D through B or C in two hops.
+ */
+class Olsr6EcmpTestCase : public TestCase
+{
+public:
+  /**
+   * \param maxPaths The MaxEqualCostPaths of the nodes.
+   */
+  Olsr6EcmpTestCase (uint32_t maxPaths);
+  /// \brief Run test case
+  virtual void DoRun (void);
+
+private:
+  /// \brief Checks the routes of A towards D.
+  void Check (void);
+  /**
+   * \param maxPaths The MaxEqualCostPaths of the nodes.
+   * \returns The name of the test case.
+   */
+  static std::string GetName (uint32_t maxPaths);
+
+  uint32_t m_maxPaths;       //!< The MaxEqualCostPaths of the nodes.
+  Ptr<RoutingProtocol> m_a;  //!< The routing protocol of A.
+  Ipv6Address m_a1;          //!< The address of A on the link to B.
+  Ipv6Address m_d;           //!< The main address of D.
+  Ipv6Address m_b;           //!< The address of B on the link to A.
+  Ipv6Address m_c;           //!< The address of C on the link to A.
+};
+
+std::string
+Olsr6EcmpTestCase::GetName (uint32_t maxPaths)
+{
+  std::ostringstream oss;
+  oss << "Check the equal-cost routes with MaxEqualCostPaths " << maxPaths;
+  return oss.str ();
+}
+
+Olsr6EcmpTestCase::Olsr6EcmpTestCase (uint32_t maxPaths)
+  : TestCase (GetName (maxPaths)),
+    m_maxPaths (maxPaths)
+{
+}
+
+void
+Olsr6EcmpTestCase::Check (void)
+{
+  std::vector<RoutingTableEntry> entries = m_a->GetEqualCostEntries (m_d);
+  NS_TEST_ASSERT_MSG_EQ (entries.size (), std::min (m_maxPaths, 2u), "Routes of A towards D");
+  for (uint32_t i = 0; i < entries.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (entries[i].distance, 2, "D is two hops away");
+      NS_TEST_EXPECT_MSG_EQ ((entries[i].nextAddr == m_b || entries[i].nextAddr == m_c), true,
+                             "D is reached through B or C");
+    }
+
+  // The flows are spread over the routes, and each flow keeps its route
+  Ptr<Ipv6RoutingProtocol> routing = m_a;
+  std::set<Ipv6Address> gateways;
+  for (uint32_t flowLabel = 0; flowLabel < 32; flowLabel++)
+    {
+      Ipv6Header header;
+      header.SetSourceAddress (m_a1);
+      header.SetDestinationAddress (m_d);
+      header.SetFlowLabel (flowLabel);
+      Socket::SocketErrno sockerr;
+      Ptr<Ipv6Route> route = routing->RouteOutput (Create<Packet> (), header, 0, sockerr);
+      NS_TEST_ASSERT_MSG_NE (route, 0, "A has a route to D");
+      Ptr<Ipv6Route> again = routing->RouteOutput (Create<Packet> (), header, 0, sockerr);
+      NS_TEST_EXPECT_MSG_EQ (route->GetGateway (), again->GetGateway (), "A flow keeps its route");
+      gateways.insert (route->GetGateway ());
+    }
+  NS_TEST_EXPECT_MSG_EQ (gateways.size (), entries.size (), "The flows use every route");
+}
+
+void
+Olsr6EcmpTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (4);
+
+  Olsr6Helper olsr6;
+  olsr6.Set ("MaxEqualCostPaths", UintegerValue (m_maxPaths));
+  InternetStackHelper internet;
+  internet.SetRoutingHelper (olsr6);
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper simpleNetHelper;
+  simpleNetHelper.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  simpleNetHelper.SetChannelAttribute ("Delay", StringValue ("2ms"));
+
+  // A, B, C, D are the nodes 0, 1, 2, 3
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase ("2001:1::", Ipv6Prefix (64));
+  Ipv6InterfaceContainer ab = ipv6.Assign (simpleNetHelper.Install (NodeContainer (nodes.Get (0), nodes.Get (1))));
+  ipv6.NewNetwork ();
+  Ipv6InterfaceContainer ac = ipv6.Assign (simpleNetHelper.Install (NodeContainer (nodes.Get (0), nodes.Get (2))));
+  ipv6.NewNetwork ();
+  Ipv6InterfaceContainer bd = ipv6.Assign (simpleNetHelper.Install (NodeContainer (nodes.Get (1), nodes.Get (3))));
+  ipv6.NewNetwork ();
+  ipv6.Assign (simpleNetHelper.Install (NodeContainer (nodes.Get (2), nodes.Get (3))));
+
+  m_a = Olsr6Helper::GetOlsr6RoutingProtocol (nodes.Get (0));
+  m_a1 = ab.GetAddress (0, 1);
+  m_b = ab.GetAddress (1, 1);
+  m_c = ac.GetAddress (1, 1);
+  m_d = bd.GetAddress (1, 1);
+
+  Simulator::Schedule (Seconds (40), &Olsr6EcmpTestCase::Check, this);
+  Simulator::Stop (Seconds (41));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_a = 0;
+}
+
+static class Olsr6EcmpTestSuite : public TestSuite
+{
+public:
+  Olsr6EcmpTestSuite ();
+} g_olsr6EcmpTestSuite;
+
+Olsr6EcmpTestSuite::Olsr6EcmpTestSuite ()
+  : TestSuite ("routing-olsr6-ecmp", UNIT)
+{
+  AddTestCase (new Olsr6EcmpTestCase (1), TestCase::QUICK);
+  AddTestCase (new Olsr6EcmpTestCase (2), TestCase::QUICK);
+  AddTestCase (new Olsr6EcmpTestCase (4), TestCase::QUICK);
+}
@@ -0,0 +1,255 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Ankit Deepak <adadeepak8@gmail.com>
+ *          Shravya Ks <shravya.ks0@gmail.com>,
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/double.h"
+#include "ns3/pointer.h"
+#include "ns3/error-model.h"
+#include "ns3/olsr6-helper.h"
+#include "ns3/olsr6-routing-protocol.h"
+#include "ns3/olsr6-state.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/simple-net-device-helper.h"
+
+#include <map>
+#include <vector>
+
+using namespace ns3;
+using namespace olsr6;
+
+/**
+ * Testcase for the MPR selection of the ETX metric: each 2-hop neighbor
+ * keeps its cheapest path, whatever the coverage of the neighbors.
+ */
+class Olsr6EtxMprTestCase : public TestCase
+{
+public:
+  Olsr6EtxMprTestCase ();
+  /// \brief Run test case
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Adds a symmetric neighbor with the default willingness.
+   * \param state The state.
+   * \param addr The main address of the neighbor.
+   */
+  static void AddNeighbor (Olsr6State &state, const char *addr);
+  /**
+   * \brief Adds a 2-hop neighbor.
+   * \param state The state.
+   * \param neighbor The main address of the neighbor.
+   * \param twoHop The main address of the 2-hop neighbor.
+   * \param cost The ETX of the link between them.
+   */
+  static void AddTwoHop (Olsr6State &state, const char *neighbor, const char *twoHop, double cost);
+};
+
+Olsr6EtxMprTestCase::Olsr6EtxMprTestCase ()
+  : TestCase ("Check the MPR selection of the ETX metric")
+{
+}
+
+void
+Olsr6EtxMprTestCase::AddNeighbor (Olsr6State &state, const char *addr)
+{
+  NeighborTuple tuple;
+  tuple.neighborMainAddr = Ipv6Address (addr);
+  tuple.status = NeighborTuple::STATUS_SYM;
+  tuple.willingness = 3;
+  state.InsertNeighborTuple (tuple);
+}
+
+void
+Olsr6EtxMprTestCase::AddTwoHop (Olsr6State &state, const char *neighbor, const char *twoHop, double cost)
+{
+  TwoHopNeighborTuple tuple;
+  tuple.neighborMainAddr = Ipv6Address (neighbor);
+  tuple.twoHopNeighborAddr = Ipv6Address (twoHop);
+  tuple.expirationTime = Seconds (30);
+  tuple.cost = cost;
+  state.InsertTwoHopNeighborTuple (tuple);
+}
+
+void
+Olsr6EtxMprTestCase::DoRun (void)
+{
+  Olsr6State state;
+  AddNeighbor (state, "2001:1::2");
+  AddNeighbor (state, "2001:1::3");
+
+  // 2001:1::2 covers both 2-hop neighbors, but through bad links
+  AddTwoHop (state, "2001:1::2", "2001:1::4", 4);
+  AddTwoHop (state, "2001:1::2", "2001:1::5", 4);
+  AddTwoHop (state, "2001:1::3", "2001:1::4", 1);
+  AddTwoHop (state, "2001:1::3", "2001:1::5", 1);
+  // 2001:1::1 is the node itself
+  AddTwoHop (state, "2001:1::2", "2001:1::1", 1);
+
+  std::map<Ipv6Address, double> costs;
+  costs[Ipv6Address ("2001:1::2")] = 1;
+  costs[Ipv6Address ("2001:1::3")] = 2;
+
+  MprSet mprSet = state.ComputeEtxMprSet (Ipv6Address ("2001:1::1"), costs);
+  NS_TEST_EXPECT_MSG_EQ (mprSet.size (), 1, "A single MPR keeps the best paths");
+  NS_TEST_EXPECT_MSG_EQ ((mprSet.find (Ipv6Address ("2001:1::3")) != mprSet.end ()), true,
+                         "2001:1::3 is on the best paths (ETX 3 against 5)");
+
+  // A bad link to 2001:1::3 makes the other neighbor the best one
+  costs[Ipv6Address ("2001:1::3")] = 6;
+  mprSet = state.ComputeEtxMprSet (Ipv6Address ("2001:1::1"), costs);
+  NS_TEST_EXPECT_MSG_EQ (mprSet.size (), 1, "A single MPR keeps the best paths");
+  NS_TEST_EXPECT_MSG_EQ ((mprSet.find (Ipv6Address ("2001:1::2")) != mprSet.end ()), true,
+                         "2001:1::2 is on the best paths (ETX 5 against 7)");
+}
+
+/**
+ * Testcase for the routes of the ETX metric on the triangle A - B - C,
+ * where the direct link between A and C drops most packets.  The hop count
+ * metric routes from A to C over the lossy link whenever it is symmetric,
+ * the ETX metric through B.
+ */
+class Olsr6EtxRoutingTestCase : public TestCase
+{
+public:
+  Olsr6EtxRoutingTestCase ();
+  /// \brief Run test case
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Runs the scenario.
+   * \param metric The link metric of the nodes.
+   */
+  void Run (std::string metric);
+  /// \brief Records, every second, the next hop of A towards C.
+  void Check (void);
+
+  Ptr<RoutingProtocol> m_a;  //!< The routing protocol of A.
+  Ipv6Address m_c;           //!< The main address of C.
+  Ipv6Address m_b;           //!< The address of B on the link to A.
+  uint32_t m_direct;         //!< Number of samples routing directly to C.
+  uint32_t m_throughB;       //!< Number of samples routing through B.
+};
+
+Olsr6EtxRoutingTestCase::Olsr6EtxRoutingTestCase ()
+  : TestCase ("Check the routes of the ETX metric around a lossy link")
+{
+}
+
+void
+Olsr6EtxRoutingTestCase::Check (void)
+{
+  std::vector<RoutingTableEntry> table = m_a->GetRoutingTableEntries ();
+  for (std::vector<RoutingTableEntry>::const_iterator it = table.begin (); it != table.end (); it++)
+    {
+      if (it->destAddr == m_c)
+        {
+          if (it->nextAddr == m_b)
+            {
+              m_throughB++;
+            }
+          else
+            {
+              m_direct++;
+            }
+        }
+    }
+  Simulator::Schedule (Seconds (1), &Olsr6EtxRoutingTestCase::Check, this);
+}
+
+void
+Olsr6EtxRoutingTestCase::Run (std::string metric)
+{
+  NodeContainer nodes;
+  nodes.Create (3);
+
+  Olsr6Helper olsr6;
+  olsr6.Set ("LinkMetric", StringValue (metric));
+  InternetStackHelper internet;
+  internet.SetRoutingHelper (olsr6);
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper simpleNetHelper;
+  simpleNetHelper.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  simpleNetHelper.SetChannelAttribute ("Delay", StringValue ("2ms"));
+
+  // The links A - B and B - C come first, so that the main address of C
+  // is on the link to B
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase ("2001:1::", Ipv6Prefix (64));
+  Ipv6InterfaceContainer ab = ipv6.Assign (simpleNetHelper.Install (NodeContainer (nodes.Get (0), nodes.Get (1))));
+  ipv6.NewNetwork ();
+  Ipv6InterfaceContainer bc = ipv6.Assign (simpleNetHelper.Install (NodeContainer (nodes.Get (1), nodes.Get (2))));
+  ipv6.NewNetwork ();
+  NetDeviceContainer lossy = simpleNetHelper.Install (NodeContainer (nodes.Get (0), nodes.Get (2)));
+  ipv6.Assign (lossy);
+
+  for (uint32_t i = 0; i < lossy.GetN (); i++)
+    {
+      Ptr<RateErrorModel> em = CreateObject<RateErrorModel> ();
+      em->SetAttribute ("ErrorRate", DoubleValue (0.6));
+      em->SetAttribute ("ErrorUnit", StringValue ("ERROR_UNIT_PACKET"));
+      lossy.Get (i)->SetAttribute ("ReceiveErrorModel", PointerValue (em));
+    }
+
+  m_a = Olsr6Helper::GetOlsr6RoutingProtocol (nodes.Get (0));
+  m_b = ab.GetAddress (1, 1);
+  m_c = bc.GetAddress (1, 1);
+  m_direct = 0;
+  m_throughB = 0;
+
+  Simulator::Schedule (Seconds (30), &Olsr6EtxRoutingTestCase::Check, this);
+  Simulator::Stop (Seconds (60));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_a = 0;
+}
+
+void
+Olsr6EtxRoutingTestCase::DoRun (void)
+{
+  Run ("hop-count");
+  NS_TEST_EXPECT_MSG_GT (m_direct, 0, "The hop count metric uses the lossy link");
+
+  Run ("etx");
+  NS_TEST_EXPECT_MSG_EQ (m_direct, 0, "The ETX metric avoids the lossy link");
+  NS_TEST_EXPECT_MSG_GT (m_throughB, 0, "The ETX metric routes through B");
+}
+
+static class Olsr6EtxTestSuite : public TestSuite
+{
+public:
+  Olsr6EtxTestSuite ();
+} g_olsr6EtxTestSuite;
+
+Olsr6EtxTestSuite::Olsr6EtxTestSuite ()
+  : TestSuite ("routing-olsr6-etx", UNIT)
+{
+  AddTestCase (new Olsr6EtxMprTestCase (), TestCase::QUICK);
+  AddTestCase (new Olsr6EtxRoutingTestCase (), TestCase::QUICK);
+}
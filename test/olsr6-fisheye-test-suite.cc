@@ -0,0 +1,246 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Ankit Deepak <adadeepak8@gmail.com>
+ *          Shravya Ks <shravya.ks0@gmail.com>,
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/nstime.h"
+#include "ns3/olsr6-helper.h"
+#include "ns3/olsr6-routing-protocol.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/simple-net-device-helper.h"
+
+#include <vector>
+
+using namespace ns3;
+using namespace olsr6;
+
+/**
+ * Testcase checking, on the chain A - B - C - D - E with the TTL sequence
+ * 2 2 2 255, the TTL and the validity time of the TC messages originated
+ * by B, and that E, out of reach of the short-scope TCs of B, keeps its
+ * routes between two of its full floods.
+ */
+class Olsr6FisheyeTestCase : public TestCase
+{
+public:
+  Olsr6FisheyeTestCase ();
+  /// \brief Run test case
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Records the TC messages originated by B.
+   * \param header The packet header.
+   * \param messages The messages of the packet.
+   */
+  void Tx (const PacketHeader &header, const MessageList &messages);
+  /**
+   * \brief Samples the size of the routing table of E, every second.
+   * \param e The routing protocol of E.
+   */
+  void Sample (Ptr<RoutingProtocol> e);
+
+  std::vector<uint8_t> m_ttls;     //!< TTLs of the TC messages.
+  std::vector<Time> m_vtimes;      //!< Validity times of the TC messages.
+  uint32_t m_minRoutes;            //!< Smallest routing table of E after convergence.
+};
+
+Olsr6FisheyeTestCase::Olsr6FisheyeTestCase ()
+  : TestCase ("Check the fisheye TTL sequence of the TC messages")
+{
+}
+
+void
+Olsr6FisheyeTestCase::Tx (const PacketHeader &header, const MessageList &messages)
+{
+  for (MessageList::const_iterator it = messages.begin (); it != messages.end (); it++)
+    {
+      // Forwarded messages have a non-zero hop count
+      if (it->GetMessageType () == MessageHeader::TC_MESSAGE && it->GetHopCount () == 0)
+        {
+          m_ttls.push_back (it->GetTimeToLive ());
+          m_vtimes.push_back (it->GetVTime ());
+        }
+    }
+}
+
+void
+Olsr6FisheyeTestCase::Sample (Ptr<RoutingProtocol> e)
+{
+  m_minRoutes = std::min<uint32_t> (m_minRoutes, e->GetRoutingTableEntries ().size ());
+  Simulator::Schedule (Seconds (1), &Olsr6FisheyeTestCase::Sample, this, e);
+}
+
+void
+Olsr6FisheyeTestCase::DoRun (void)
+{
+  m_minRoutes = 0xffffffff;
+
+  NodeContainer nodes;
+  nodes.Create (5);
+
+  Olsr6Helper olsr6;
+  olsr6.Set ("FisheyeTtl", StringValue ("2 2 2 255"));
+  InternetStackHelper internet;
+  internet.SetRoutingHelper (olsr6);
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper simpleNetHelper;
+  simpleNetHelper.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  simpleNetHelper.SetChannelAttribute ("Delay", StringValue ("2ms"));
+
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase ("2001:1::", Ipv6Prefix (64));
+  for (uint32_t i = 0; i + 1 < nodes.GetN (); i++)
+    {
+      ipv6.Assign (simpleNetHelper.Install (NodeContainer (nodes.Get (i), nodes.Get (i + 1))));
+      ipv6.NewNetwork ();
+    }
+
+  Olsr6Helper::GetOlsr6RoutingProtocol (nodes.Get (1))->TraceConnectWithoutContext (
+    "Tx", MakeCallback (&Olsr6FisheyeTestCase::Tx, this));
+  // E learns the link A - B from the full floods of B only, every 20s
+  Simulator::Schedule (Seconds (40), &Olsr6FisheyeTestCase::Sample, this,
+                       Olsr6Helper::GetOlsr6RoutingProtocol (nodes.Get (4)));
+
+  Simulator::Stop (Seconds (100));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_GT (m_ttls.size (), 8, "B should send TC messages");
+  for (uint32_t i = 0; i < m_ttls.size (); i++)
+    {
+      if (m_ttls[i] == 255)
+        {
+          NS_TEST_EXPECT_MSG_EQ (m_vtimes[i], Seconds (60), "A full flood is held 4 TC intervals");
+          if (i >= 3)
+            {
+              NS_TEST_EXPECT_MSG_EQ (m_ttls[i - 1] + m_ttls[i - 2] + m_ttls[i - 3], 6,
+                                     "Three short-scope TCs precede a full flood");
+            }
+        }
+      else
+        {
+          NS_TEST_EXPECT_MSG_EQ ((uint32_t) m_ttls[i], 2, "TTL of TC " << i);
+          NS_TEST_EXPECT_MSG_EQ (m_vtimes[i], Seconds (15), "A short-scope TC is held 1 TC interval");
+        }
+    }
+
+  // 8 interface addresses, one of them owned by E
+  NS_TEST_EXPECT_MSG_EQ (m_minRoutes, 7, "E should keep its routes between the full floods");
+}
+
+/**
+ * Testcase checking that the TC messages flood the network without a
+ * fisheye TTL sequence.
+ */
+class Olsr6FisheyeDisabledTestCase : public TestCase
+{
+public:
+  Olsr6FisheyeDisabledTestCase ();
+  /// \brief Run test case
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Records the TC messages originated by the node.
+   * \param header The packet header.
+   * \param messages The messages of the packet.
+   */
+  void Tx (const PacketHeader &header, const MessageList &messages);
+
+  uint32_t m_nTc;        //!< TC messages originated.
+  uint32_t m_nFlooding;  //!< TC messages originated with TTL 255.
+};
+
+Olsr6FisheyeDisabledTestCase::Olsr6FisheyeDisabledTestCase ()
+  : TestCase ("Check that TC messages flood the network by default")
+{
+}
+
+void
+Olsr6FisheyeDisabledTestCase::Tx (const PacketHeader &header, const MessageList &messages)
+{
+  for (MessageList::const_iterator it = messages.begin (); it != messages.end (); it++)
+    {
+      if (it->GetMessageType () == MessageHeader::TC_MESSAGE && it->GetHopCount () == 0)
+        {
+          m_nTc++;
+          if (it->GetTimeToLive () == 255 && it->GetVTime () == Seconds (15))
+            {
+              m_nFlooding++;
+            }
+        }
+    }
+}
+
+void
+Olsr6FisheyeDisabledTestCase::DoRun (void)
+{
+  m_nTc = 0;
+  m_nFlooding = 0;
+
+  NodeContainer nodes;
+  nodes.Create (3);
+
+  Olsr6Helper olsr6;
+  InternetStackHelper internet;
+  internet.SetRoutingHelper (olsr6);
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper simpleNetHelper;
+  simpleNetHelper.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  simpleNetHelper.SetChannelAttribute ("Delay", StringValue ("2ms"));
+
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase ("2001:1::", Ipv6Prefix (64));
+  ipv6.Assign (simpleNetHelper.Install (NodeContainer (nodes.Get (0), nodes.Get (1))));
+  ipv6.NewNetwork ();
+  ipv6.Assign (simpleNetHelper.Install (NodeContainer (nodes.Get (1), nodes.Get (2))));
+
+  Olsr6Helper::GetOlsr6RoutingProtocol (nodes.Get (1))->TraceConnectWithoutContext (
+    "Tx", MakeCallback (&Olsr6FisheyeDisabledTestCase::Tx, this));
+
+  Simulator::Stop (Seconds (30));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_ASSERT_MSG_GT (m_nTc, 0, "B should send TC messages");
+  NS_TEST_EXPECT_MSG_EQ (m_nFlooding, m_nTc, "Every TC floods the network and is held 3 TC intervals");
+}
+
+static class Olsr6FisheyeTestSuite : public TestSuite
+{
+public:
+  Olsr6FisheyeTestSuite ();
+} g_olsr6FisheyeTestSuite;
+
+Olsr6FisheyeTestSuite::Olsr6FisheyeTestSuite ()
+  : TestSuite ("routing-olsr6-fisheye", UNIT)
+{
+  AddTestCase (new Olsr6FisheyeTestCase (), TestCase::QUICK);
+  AddTestCase (new Olsr6FisheyeDisabledTestCase (), TestCase::QUICK);
+}
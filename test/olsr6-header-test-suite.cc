@@ -263,6 +263,133 @@ Olsr6TcTestCase::DoRun (void)
 
 }
 
+class Olsr6DiffTcTestCase : public TestCase
+{
+public:
+  Olsr6DiffTcTestCase ();
+  virtual void DoRun (void);
+};
+
+Olsr6DiffTcTestCase::Olsr6DiffTcTestCase ()
+  : TestCase ("Check differential Tc olsr6 messages")
+{
+}
+void
+Olsr6DiffTcTestCase::DoRun (void)
+{
+  Packet packet;
+  olsr6::MessageHeader msgIn;
+  olsr6::MessageHeader::DiffTc &diffTcIn = msgIn.GetDiffTc ();
+
+  diffTcIn.ansn = 0x1234;
+  diffTcIn.baseAnsn = 0x1230;
+  diffTcIn.addedAddresses.push_back (Ipv6Address ("2001:1::4"));
+  diffTcIn.addedAddresses.push_back (Ipv6Address ("2001:1::5"));
+  diffTcIn.removedAddresses.push_back (Ipv6Address ("2001:1::6"));
+  packet.AddHeader (msgIn);
+
+  NS_TEST_ASSERT_MSG_EQ (packet.GetSize (), msgIn.GetSerializedSize (), "600");
+
+  olsr6::MessageHeader msgOut;
+  packet.RemoveHeader (msgOut);
+  NS_TEST_ASSERT_MSG_EQ (msgOut.GetMessageType (), olsr6::MessageHeader::DTC_MESSAGE, "601");
+  olsr6::MessageHeader::DiffTc &diffTcOut = msgOut.GetDiffTc ();
+
+  NS_TEST_ASSERT_MSG_EQ (diffTcOut.ansn, 0x1234, "602");
+  NS_TEST_ASSERT_MSG_EQ (diffTcOut.baseAnsn, 0x1230, "603");
+  NS_TEST_ASSERT_MSG_EQ (diffTcOut.addedAddresses.size (), 2, "604");
+  NS_TEST_ASSERT_MSG_EQ (diffTcOut.removedAddresses.size (), 1, "605");
+
+  NS_TEST_ASSERT_MSG_EQ (diffTcOut.addedAddresses[0],
+                         Ipv6Address ("2001:1::4"), "606");
+  NS_TEST_ASSERT_MSG_EQ (diffTcOut.addedAddresses[1],
+                         Ipv6Address ("2001:1::5"), "607");
+  NS_TEST_ASSERT_MSG_EQ (diffTcOut.removedAddresses[0],
+                         Ipv6Address ("2001:1::6"), "608");
+
+  NS_TEST_ASSERT_MSG_EQ (packet.GetSize (), 0, "609");
+
+}
+
+class Olsr6LinkQualityTestCase : public TestCase
+{
+public:
+  Olsr6LinkQualityTestCase ();
+  virtual void DoRun (void);
+};
+
+Olsr6LinkQualityTestCase::Olsr6LinkQualityTestCase ()
+  : TestCase ("Check link quality extension of Hello and Tc olsr6 messages")
+{
+}
+void
+Olsr6LinkQualityTestCase::DoRun (void)
+{
+  olsr6::MessageHeader::LinkQuality q1 = { 255, 128 };
+  olsr6::MessageHeader::LinkQuality q2 = { 64, 32 };
+
+  {
+    Packet packet;
+    olsr6::MessageHeader msgIn;
+    olsr6::MessageHeader::Hello &helloIn = msgIn.GetHello ();
+    helloIn.SetHTime (Seconds (2));
+    helloIn.willingness = 3;
+
+    olsr6::MessageHeader::Hello::LinkMessage lm;
+    lm.linkCode = 6;
+    lm.neighborInterfaceAddresses.push_back (Ipv6Address ("2001:1::4"));
+    lm.neighborInterfaceAddresses.push_back (Ipv6Address ("2001:1::5"));
+    lm.linkQualities.push_back (q1);
+    lm.linkQualities.push_back (q2);
+    helloIn.linkMessages.push_back (lm);
+    packet.AddHeader (msgIn);
+
+    NS_TEST_ASSERT_MSG_EQ (packet.GetSize (), msgIn.GetSerializedSize (), "700");
+
+    olsr6::MessageHeader msgOut;
+    packet.RemoveHeader (msgOut);
+    olsr6::MessageHeader::Hello &helloOut = msgOut.GetHello ();
+
+    NS_TEST_ASSERT_MSG_EQ (helloOut.linkMessages.size (), 1, "701");
+    NS_TEST_ASSERT_MSG_EQ (helloOut.linkMessages[0].neighborInterfaceAddresses.size (), 2, "702");
+    NS_TEST_ASSERT_MSG_EQ (helloOut.linkMessages[0].linkQualities.size (), 2, "703");
+    NS_TEST_ASSERT_MSG_EQ (helloOut.linkMessages[0].neighborInterfaceAddresses[1],
+                           Ipv6Address ("2001:1::5"), "704");
+    NS_TEST_ASSERT_MSG_EQ (helloOut.linkMessages[0].linkQualities[0].lq, 255, "705");
+    NS_TEST_ASSERT_MSG_EQ (helloOut.linkMessages[0].linkQualities[0].nlq, 128, "706");
+    NS_TEST_ASSERT_MSG_EQ (helloOut.linkMessages[0].linkQualities[1].lq, 64, "707");
+    NS_TEST_ASSERT_MSG_EQ (helloOut.linkMessages[0].linkQualities[1].nlq, 32, "708");
+    NS_TEST_ASSERT_MSG_EQ (packet.GetSize (), 0, "709");
+  }
+
+  {
+    Packet packet;
+    olsr6::MessageHeader msgIn;
+    olsr6::MessageHeader::Tc &tcIn = msgIn.GetTc ();
+    tcIn.ansn = 0x4321;
+    tcIn.neighborAddresses.push_back (Ipv6Address ("2001:1::4"));
+    tcIn.neighborAddresses.push_back (Ipv6Address ("2001:1::5"));
+    tcIn.linkQualities.push_back (q1);
+    tcIn.linkQualities.push_back (q2);
+    packet.AddHeader (msgIn);
+
+    NS_TEST_ASSERT_MSG_EQ (packet.GetSize (), msgIn.GetSerializedSize (), "710");
+
+    olsr6::MessageHeader msgOut;
+    packet.RemoveHeader (msgOut);
+    olsr6::MessageHeader::Tc &tcOut = msgOut.GetTc ();
+
+    NS_TEST_ASSERT_MSG_EQ (tcOut.ansn, 0x4321, "711");
+    NS_TEST_ASSERT_MSG_EQ (tcOut.neighborAddresses.size (), 2, "712");
+    NS_TEST_ASSERT_MSG_EQ (tcOut.linkQualities.size (), 2, "713");
+    NS_TEST_ASSERT_MSG_EQ (tcOut.neighborAddresses[0],
+                           Ipv6Address ("2001:1::4"), "714");
+    NS_TEST_ASSERT_MSG_EQ (tcOut.linkQualities[0].nlq, 128, "715");
+    NS_TEST_ASSERT_MSG_EQ (tcOut.linkQualities[1].lq, 64, "716");
+    NS_TEST_ASSERT_MSG_EQ (packet.GetSize (), 0, "717");
+  }
+}
+
 class Olsr6HnaTestCase : public TestCase
 {
 public:
@@ -309,6 +436,279 @@ Olsr6HnaTestCase::DoRun (void)
 }
 
 
+class Olsr6GatewayHnaTestCase : public TestCase
+{
+public:
+  Olsr6GatewayHnaTestCase ();
+  virtual void DoRun (void);
+};
+
+Olsr6GatewayHnaTestCase::Olsr6GatewayHnaTestCase ()
+  : TestCase ("Check gateway information of extended Hna olsr6 messages")
+{
+}
+
+void
+Olsr6GatewayHnaTestCase::DoRun (void)
+{
+  Packet packet;
+  olsr6::MessageHeader msgIn;
+  olsr6::MessageHeader::Hna &hnaIn = msgIn.GetHna ();
+
+  hnaIn.capacity = 1000;
+  hnaIn.load = 200;
+  hnaIn.associations.push_back ((olsr6::MessageHeader::Hna::Association)
+                                { Ipv6Address ("2001:1::"), Ipv6Prefix (64)});
+  packet.AddHeader (msgIn);
+
+  NS_TEST_ASSERT_MSG_EQ (packet.GetSize (), msgIn.GetSerializedSize (), "510");
+  NS_TEST_ASSERT_MSG_EQ (packet.GetSize (), 24 + 4 + 32, "511");
+
+  olsr6::MessageHeader msgOut;
+  packet.RemoveHeader (msgOut);
+  olsr6::MessageHeader::Hna &hnaOut = msgOut.GetHna ();
+
+  NS_TEST_ASSERT_MSG_EQ (hnaOut.capacity, 1000, "512");
+  NS_TEST_ASSERT_MSG_EQ (hnaOut.load, 200, "513");
+  NS_TEST_ASSERT_MSG_EQ (hnaOut.associations.size (), 1, "514");
+  NS_TEST_ASSERT_MSG_EQ (hnaOut.associations[0].address,
+                         Ipv6Address ("2001:1::"), "515");
+  NS_TEST_ASSERT_MSG_EQ (hnaOut.associations[0].mask,
+                         Ipv6Prefix (64), "516");
+  NS_TEST_ASSERT_MSG_EQ (packet.GetSize (), 0, "517");
+}
+
+
+class Olsr6CompressedTestCase : public TestCase
+{
+public:
+  Olsr6CompressedTestCase ();
+  virtual void DoRun (void);
+};
+
+Olsr6CompressedTestCase::Olsr6CompressedTestCase ()
+  : TestCase ("Check compressed Hello, Tc and Mid olsr6 messages")
+{
+}
+
+void
+Olsr6CompressedTestCase::DoRun (void)
+{
+  {
+    // Two link messages of ten neighbors in the same /64
+    Packet packet;
+    olsr6::MessageHeader msgIn;
+    olsr6::MessageHeader::Hello &helloIn = msgIn.GetHello ();
+    helloIn.SetHTime (Seconds (2));
+    helloIn.willingness = 3;
+    for (uint8_t code = 6; code <= 10; code += 4)
+      {
+        olsr6::MessageHeader::Hello::LinkMessage lm;
+        lm.linkCode = code;
+        for (uint8_t n = 0; n < 10; n++)
+          {
+            uint8_t bytes[16] = { 0x20, 0x01, 0x00, 0x01 };
+            bytes[15] = code * 10 + n;
+            lm.neighborInterfaceAddresses.push_back (Ipv6Address (bytes));
+          }
+        helloIn.linkMessages.push_back (lm);
+      }
+    uint32_t plainSize = msgIn.GetSerializedSize ();
+    NS_TEST_ASSERT_MSG_EQ (msgIn.IsCompressed (), false, "800");
+    msgIn.SetCompression (true);
+    NS_TEST_ASSERT_MSG_EQ (msgIn.IsCompressed (), true, "801");
+    NS_TEST_ASSERT_MSG_LT (2 * msgIn.GetSerializedSize (), plainSize, "802");
+    packet.AddHeader (msgIn);
+    NS_TEST_ASSERT_MSG_EQ (packet.GetSize (), msgIn.GetSerializedSize (), "803");
+
+    olsr6::MessageHeader msgOut;
+    packet.RemoveHeader (msgOut);
+    NS_TEST_ASSERT_MSG_EQ (packet.GetSize (), 0, "804");
+    NS_TEST_ASSERT_MSG_EQ (msgOut.GetMessageType (), olsr6::MessageHeader::HELLO_MESSAGE, "805");
+    NS_TEST_ASSERT_MSG_EQ (msgOut.IsCompressed (), true, "806");
+    olsr6::MessageHeader::Hello &helloOut = msgOut.GetHello ();
+    NS_TEST_ASSERT_MSG_EQ (helloOut.compression, true, "807");
+    NS_TEST_ASSERT_MSG_EQ (helloOut.willingness, 3, "808");
+    NS_TEST_ASSERT_MSG_EQ (helloOut.GetHTime (), Seconds (2), "809");
+    NS_TEST_ASSERT_MSG_EQ (helloOut.linkMessages.size (), 2, "810");
+    for (uint32_t i = 0; i < 2; i++)
+      {
+        NS_TEST_ASSERT_MSG_EQ (helloOut.linkMessages[i].linkCode, helloIn.linkMessages[i].linkCode, "811");
+        NS_TEST_ASSERT_MSG_EQ (helloOut.linkMessages[i].linkQualities.size (), 0, "812");
+        NS_TEST_ASSERT_MSG_EQ (helloOut.linkMessages[i].neighborInterfaceAddresses.size (), 10, "813");
+        for (uint32_t n = 0; n < 10; n++)
+          {
+            NS_TEST_ASSERT_MSG_EQ (helloOut.linkMessages[i].neighborInterfaceAddresses[n],
+                                   helloIn.linkMessages[i].neighborInterfaceAddresses[n], "814");
+          }
+      }
+
+    // A forwarder may send it again without the compression
+    msgOut.SetCompression (false);
+    NS_TEST_ASSERT_MSG_EQ (msgOut.IsCompressed (), false, "815");
+  }
+
+  {
+    // Link qualities in a compressed Hello
+    Packet packet;
+    olsr6::MessageHeader msgIn;
+    olsr6::MessageHeader::Hello &helloIn = msgIn.GetHello ();
+    helloIn.SetHTime (Seconds (2));
+    helloIn.willingness = 7;
+    olsr6::MessageHeader::Hello::LinkMessage lm;
+    lm.linkCode = 6;
+    lm.neighborInterfaceAddresses.push_back (Ipv6Address ("2001:1::4"));
+    lm.neighborInterfaceAddresses.push_back (Ipv6Address ("2001:1::5"));
+    lm.linkQualities.push_back ((olsr6::MessageHeader::LinkQuality) { 255, 128 });
+    lm.linkQualities.push_back ((olsr6::MessageHeader::LinkQuality) { 64, 32 });
+    helloIn.linkMessages.push_back (lm);
+    msgIn.SetCompression (true);
+    NS_TEST_ASSERT_MSG_EQ (msgIn.IsCompressed (), true, "820");
+    packet.AddHeader (msgIn);
+
+    olsr6::MessageHeader msgOut;
+    packet.RemoveHeader (msgOut);
+    NS_TEST_ASSERT_MSG_EQ (packet.GetSize (), 0, "821");
+    olsr6::MessageHeader::Hello &helloOut = msgOut.GetHello ();
+    NS_TEST_ASSERT_MSG_EQ (helloOut.willingness, 7, "822");
+    NS_TEST_ASSERT_MSG_EQ (helloOut.linkMessages.size (), 1, "823");
+    NS_TEST_ASSERT_MSG_EQ (helloOut.linkMessages[0].neighborInterfaceAddresses[1],
+                           Ipv6Address ("2001:1::5"), "824");
+    NS_TEST_ASSERT_MSG_EQ (helloOut.linkMessages[0].linkQualities.size (), 2, "825");
+    NS_TEST_ASSERT_MSG_EQ (helloOut.linkMessages[0].linkQualities[0].lq, 255, "826");
+    NS_TEST_ASSERT_MSG_EQ (helloOut.linkMessages[0].linkQualities[1].nlq, 32, "827");
+  }
+
+  {
+    // Subnet addresses, whose tail of zeros is not written, with link qualities
+    Packet packet;
+    olsr6::MessageHeader msgIn;
+    olsr6::MessageHeader::Tc &tcIn = msgIn.GetTc ();
+    tcIn.ansn = 0x4321;
+    for (uint8_t n = 0; n < 8; n++)
+      {
+        uint8_t bytes[16] = { 0x20, 0x01, 0x00, 0x01, 0x00, 0x00, 0x00 };
+        bytes[7] = n + 1;
+        tcIn.neighborAddresses.push_back (Ipv6Address (bytes));
+        tcIn.linkQualities.push_back ((olsr6::MessageHeader::LinkQuality) { n, uint8_t (255 - n) });
+      }
+    uint32_t plainSize = msgIn.GetSerializedSize ();
+    msgIn.SetCompression (true);
+    NS_TEST_ASSERT_MSG_LT (2 * msgIn.GetSerializedSize (), plainSize, "830");
+    packet.AddHeader (msgIn);
+    NS_TEST_ASSERT_MSG_EQ (packet.GetSize (), msgIn.GetSerializedSize (), "831");
+
+    olsr6::MessageHeader msgOut;
+    packet.RemoveHeader (msgOut);
+    NS_TEST_ASSERT_MSG_EQ (packet.GetSize (), 0, "832");
+    NS_TEST_ASSERT_MSG_EQ (msgOut.GetMessageType (), olsr6::MessageHeader::TC_MESSAGE, "833");
+    olsr6::MessageHeader::Tc &tcOut = msgOut.GetTc ();
+    NS_TEST_ASSERT_MSG_EQ (tcOut.ansn, 0x4321, "834");
+    NS_TEST_ASSERT_MSG_EQ (tcOut.neighborAddresses.size (), 8, "835");
+    NS_TEST_ASSERT_MSG_EQ (tcOut.linkQualities.size (), 8, "836");
+    for (uint32_t n = 0; n < 8; n++)
+      {
+        NS_TEST_ASSERT_MSG_EQ (tcOut.neighborAddresses[n], tcIn.neighborAddresses[n], "837");
+        NS_TEST_ASSERT_MSG_EQ (tcOut.linkQualities[n].lq, n, "838");
+        NS_TEST_ASSERT_MSG_EQ (tcOut.linkQualities[n].nlq, 255 - n, "839");
+      }
+  }
+
+  {
+    // Addresses of several prefixes, in several blocks, keep their order
+    Packet packet;
+    olsr6::MessageHeader msgIn;
+    olsr6::MessageHeader::Mid &midIn = msgIn.GetMid ();
+    midIn.interfaceAddresses.push_back (Ipv6Address ("2001:1::1"));
+    midIn.interfaceAddresses.push_back (Ipv6Address ("2001:1::2"));
+    midIn.interfaceAddresses.push_back (Ipv6Address ("2001:1::3"));
+    midIn.interfaceAddresses.push_back (Ipv6Address ("fd00:abcd:1234::77"));
+    midIn.interfaceAddresses.push_back (Ipv6Address ("2001:2::1"));
+    midIn.interfaceAddresses.push_back (Ipv6Address ("2001:2::2"));
+    msgIn.SetCompression (true);
+    NS_TEST_ASSERT_MSG_EQ (msgIn.IsCompressed (), true, "840");
+    packet.AddHeader (msgIn);
+
+    olsr6::MessageHeader msgOut;
+    packet.RemoveHeader (msgOut);
+    NS_TEST_ASSERT_MSG_EQ (packet.GetSize (), 0, "841");
+    NS_TEST_ASSERT_MSG_EQ (msgOut.GetMessageType (), olsr6::MessageHeader::MID_MESSAGE, "842");
+    olsr6::MessageHeader::Mid &midOut = msgOut.GetMid ();
+    NS_TEST_ASSERT_MSG_EQ (midOut.interfaceAddresses.size (), 6, "843");
+    for (uint32_t n = 0; n < 6; n++)
+      {
+        NS_TEST_ASSERT_MSG_EQ (midOut.interfaceAddresses[n], midIn.interfaceAddresses[n], "844");
+      }
+  }
+
+  {
+    // A single address gains nothing and is sent plain
+    Packet packet;
+    olsr6::MessageHeader msgIn;
+    olsr6::MessageHeader::Mid &midIn = msgIn.GetMid ();
+    midIn.interfaceAddresses.push_back (Ipv6Address ("2001:db8:5a3c:e01:9d2:11ff:fe4b:7c31"));
+    uint32_t plainSize = msgIn.GetSerializedSize ();
+    msgIn.SetCompression (true);
+    NS_TEST_ASSERT_MSG_EQ (msgIn.IsCompressed (), false, "850");
+    NS_TEST_ASSERT_MSG_EQ (msgIn.GetSerializedSize (), plainSize, "851");
+    packet.AddHeader (msgIn);
+
+    olsr6::MessageHeader msgOut;
+    packet.RemoveHeader (msgOut);
+    NS_TEST_ASSERT_MSG_EQ (msgOut.IsCompressed (), false, "852");
+    NS_TEST_ASSERT_MSG_EQ (msgOut.GetMid ().interfaceAddresses[0], midIn.interfaceAddresses[0], "853");
+  }
+}
+
+
+class Olsr6SignatureTestCase : public TestCase
+{
+public:
+  Olsr6SignatureTestCase ();
+  virtual void DoRun (void);
+};
+
+Olsr6SignatureTestCase::Olsr6SignatureTestCase ()
+  : TestCase ("Check Signature olsr6 messages")
+{
+}
+
+void
+Olsr6SignatureTestCase::DoRun (void)
+{
+  Packet packet;
+  olsr6::MessageHeader msgIn;
+  olsr6::MessageHeader::Signature &signatureIn = msgIn.GetSignature ();
+  signatureIn.keyId = 7;
+  for (int n = 0; n < 32; n++)
+    {
+      signatureIn.icv[n] = n * 3;
+    }
+  packet.AddHeader (msgIn);
+
+  // The ICV ends the message
+  NS_TEST_ASSERT_MSG_EQ (packet.GetSize (), 24 + 4 + 32, "860");
+  uint8_t bytes[60];
+  packet.CopyData (bytes, sizeof (bytes));
+  NS_TEST_ASSERT_MSG_EQ (int (bytes[0]), olsr6::MessageHeader::SIGNATURE_MESSAGE, "861");
+  NS_TEST_ASSERT_MSG_EQ (int (bytes[24]), 7, "862");
+  NS_TEST_ASSERT_MSG_EQ (int (bytes[59]), 31 * 3, "863");
+
+  olsr6::MessageHeader msgOut;
+  packet.RemoveHeader (msgOut);
+  NS_TEST_ASSERT_MSG_EQ (msgOut.GetMessageType (), olsr6::MessageHeader::SIGNATURE_MESSAGE, "864");
+  NS_TEST_ASSERT_MSG_EQ (msgOut.IsCompressed (), false, "865");
+  const olsr6::MessageHeader::Signature &signatureOut = msgOut.GetSignature ();
+  NS_TEST_ASSERT_MSG_EQ (int (signatureOut.keyId), 7, "866");
+  for (int n = 0; n < 32; n++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (int (signatureOut.icv[n]), n * 3, "867");
+    }
+
+  NS_TEST_ASSERT_MSG_EQ (packet.GetSize (), 0, "All bytes in packet were not read");
+}
+
+
 static class Olsr6TestSuite : public TestSuite
 {
 public:
@@ -319,8 +719,13 @@ Olsr6TestSuite::Olsr6TestSuite ()
   : TestSuite ("routing-olsr6-header", UNIT)
 {
   AddTestCase (new Olsr6HnaTestCase (), TestCase::QUICK);
+  AddTestCase (new Olsr6GatewayHnaTestCase (), TestCase::QUICK);
   AddTestCase (new Olsr6TcTestCase (), TestCase::QUICK);
+  AddTestCase (new Olsr6DiffTcTestCase (), TestCase::QUICK);
+  AddTestCase (new Olsr6LinkQualityTestCase (), TestCase::QUICK);
   AddTestCase (new Olsr6HelloTestCase (), TestCase::QUICK);
   AddTestCase (new Olsr6MidTestCase (), TestCase::QUICK);
   AddTestCase (new Olsr6EmfTestCase (), TestCase::QUICK);
+  AddTestCase (new Olsr6CompressedTestCase (), TestCase::QUICK);
+  AddTestCase (new Olsr6SignatureTestCase (), TestCase::QUICK);
 }
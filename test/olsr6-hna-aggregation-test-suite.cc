@@ -0,0 +1,251 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Ankit Deepak <adadeepak8@gmail.com>
+ *          Shravya Ks <shravya.ks0@gmail.com>,
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/boolean.h"
+#include "ns3/ipv6-header.h"
+#include "ns3/ipv6-route.h"
+#include "ns3/olsr6-helper.h"
+#include "ns3/olsr6-routing-protocol.h"
+#include "ns3/olsr6-state.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/simple-net-device-helper.h"
+
+using namespace ns3;
+using namespace olsr6;
+
+/**
+ * Testcase for the aggregation of the local associations, and for the
+ * association tuples superseded by a differently aggregated HNA message.
+ */
+class Olsr6HnaAggregationTestCase : public TestCase
+{
+public:
+  Olsr6HnaAggregationTestCase ();
+  /// \brief Run test case
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \param state The state.
+   * \param network The network address.
+   * \param prefixLength The prefix length of the network.
+   */
+  static void AddAssociation (Olsr6State &state, const char *network, uint8_t prefixLength);
+  /**
+   * \param state The state.
+   * \param gateway The main address of the gateway.
+   * \param network The network address.
+   * \param prefixLength The prefix length of the network.
+   */
+  static void AddAssociationTuple (Olsr6State &state, const char *gateway,
+                                   const char *network, uint8_t prefixLength);
+};
+
+Olsr6HnaAggregationTestCase::Olsr6HnaAggregationTestCase ()
+  : TestCase ("Check the aggregation of the HNA associations")
+{
+}
+
+void
+Olsr6HnaAggregationTestCase::AddAssociation (Olsr6State &state, const char *network, uint8_t prefixLength)
+{
+  Association association = { Ipv6Address (network), Ipv6Prefix (prefixLength) };
+  state.InsertAssociation (association);
+}
+
+void
+Olsr6HnaAggregationTestCase::AddAssociationTuple (Olsr6State &state, const char *gateway,
+                                                  const char *network, uint8_t prefixLength)
+{
+  AssociationTuple tuple;
+  tuple.gatewayAddr = Ipv6Address (gateway);
+  tuple.networkAddr = Ipv6Address (network);
+  tuple.netmask = Ipv6Prefix (prefixLength);
+  tuple.expirationTime = Seconds (15);
+  state.InsertAssociationTuple (tuple);
+}
+
+void
+Olsr6HnaAggregationTestCase::DoRun (void)
+{
+  Olsr6State state;
+  AddAssociation (state, "2001:db8:0:3::", 64);
+  AddAssociation (state, "2001:db8:0:1::", 64);
+  AddAssociation (state, "2001:db8:0:2::", 64);
+  AddAssociation (state, "2001:db8::", 64);
+  AddAssociation (state, "2001:db8:0:5::", 64);
+  AddAssociation (state, "2001:db8:0:2:8000::", 65);
+  AddAssociation (state, "2001:db9::", 48);
+
+  // The four first /64 are merged into a /62, which covers the /65
+  Associations aggregated = state.GetAggregatedAssociations ();
+  NS_TEST_ASSERT_MSG_EQ (aggregated.size (), 3, "Aggregated associations");
+  NS_TEST_EXPECT_MSG_EQ (aggregated[0].networkAddr, Ipv6Address ("2001:db9::"), "Network left alone");
+  NS_TEST_EXPECT_MSG_EQ (aggregated[0].netmask, Ipv6Prefix (48), "Prefix left alone");
+  NS_TEST_EXPECT_MSG_EQ (aggregated[1].networkAddr, Ipv6Address ("2001:db8::"), "Aggregate");
+  NS_TEST_EXPECT_MSG_EQ (aggregated[1].netmask, Ipv6Prefix (62), "Prefix of the aggregate");
+  NS_TEST_EXPECT_MSG_EQ (aggregated[2].networkAddr, Ipv6Address ("2001:db8:0:5::"), "Network without its sibling");
+  NS_TEST_EXPECT_MSG_EQ (aggregated[2].netmask, Ipv6Prefix (64), "Prefix without its sibling");
+
+  // The gateway now advertises a /63 instead of two of its /64
+  AddAssociationTuple (state, "2001:1::1", "2001:db8::", 64);
+  AddAssociationTuple (state, "2001:1::1", "2001:db8:0:1::", 64);
+  AddAssociationTuple (state, "2001:1::1", "2001:db8:0:4::", 64);
+  AddAssociationTuple (state, "2001:1::1", "2001:db8::", 63);
+  AddAssociationTuple (state, "2001:1::2", "2001:db8:0:1::", 64);
+  Associations networks;
+  networks.push_back ((Association) { Ipv6Address ("2001:db8::"), Ipv6Prefix (63) });
+  networks.push_back ((Association) { Ipv6Address ("2001:db8:0:4::"), Ipv6Prefix (64) });
+  state.EraseSupersededAssociationTuples (Ipv6Address ("2001:1::1"), networks);
+
+  const AssociationSet &associationSet = state.GetAssociationSet ();
+  NS_TEST_ASSERT_MSG_EQ (associationSet.size (), 3, "Superseded tuples erased");
+  NS_TEST_EXPECT_MSG_EQ (associationSet[0].networkAddr, Ipv6Address ("2001:db8:0:4::"), "Network still advertised");
+  NS_TEST_EXPECT_MSG_EQ (associationSet[1].netmask, Ipv6Prefix (63), "Aggregate advertised");
+  NS_TEST_EXPECT_MSG_EQ (associationSet[2].gatewayAddr, Ipv6Address ("2001:1::2"), "Tuple of another gateway");
+}
+
+/**
+ * Testcase for the routes to aggregated HNA networks on the chain
+ * G1 - A - B - G2, where G1 announces 2001:db8:0:0::/64 to
+ * 2001:db8:0:3::/64, and G2 announces 2001:db8:0:1::/64 too.  Whether the
+ * networks of G1 are aggregated or not, A routes them all to G1, the
+ * nearest gateway.
+ */
+class Olsr6HnaAggregationRoutingTestCase : public TestCase
+{
+public:
+  /**
+   * \param aggregation The HnaAggregation attribute of the nodes.
+   */
+  Olsr6HnaAggregationRoutingTestCase (bool aggregation);
+  /// \brief Run test case
+  virtual void DoRun (void);
+
+private:
+  /// \brief Checks the association set and the routes of A.
+  void Check (void);
+  /**
+   * \param dest A destination.
+   * \returns The next hop of A towards the destination, :: if there is no route.
+   */
+  Ipv6Address GetNextHop (const char *dest);
+
+  bool m_aggregation;        //!< The HnaAggregation attribute of the nodes.
+  Ptr<RoutingProtocol> m_a;  //!< The routing protocol of A.
+  Ipv6Address m_a1;          //!< The address of A on the link to G1.
+  Ipv6Address m_g1;          //!< The address of G1 on the link to A.
+};
+
+Olsr6HnaAggregationRoutingTestCase::Olsr6HnaAggregationRoutingTestCase (bool aggregation)
+  : TestCase (aggregation ? "Check the routes to aggregated HNA networks"
+              : "Check the routes to HNA networks without aggregation"),
+    m_aggregation (aggregation)
+{
+}
+
+Ipv6Address
+Olsr6HnaAggregationRoutingTestCase::GetNextHop (const char *dest)
+{
+  Ptr<Ipv6RoutingProtocol> routing = m_a;
+  Ipv6Header header;
+  header.SetSourceAddress (m_a1);
+  header.SetDestinationAddress (Ipv6Address (dest));
+  Socket::SocketErrno sockerr;
+  Ptr<Ipv6Route> route = routing->RouteOutput (Create<Packet> (), header, 0, sockerr);
+  return route ? route->GetGateway () : Ipv6Address ();
+}
+
+void
+Olsr6HnaAggregationRoutingTestCase::Check (void)
+{
+  NS_TEST_EXPECT_MSG_EQ (m_a->GetMemoryUsage ().associationSet.count, m_aggregation ? 2 : 5,
+                         "One tuple per advertised network");
+  NS_TEST_EXPECT_MSG_EQ (GetNextHop ("2001:db8::1"), m_g1, "Network of G1");
+  NS_TEST_EXPECT_MSG_EQ (GetNextHop ("2001:db8:0:1::1"), m_g1, "Network of G1 and G2");
+  NS_TEST_EXPECT_MSG_EQ (GetNextHop ("2001:db8:0:3::1"), m_g1, "Network of G1");
+  NS_TEST_EXPECT_MSG_EQ (GetNextHop ("2001:db8:0:4::1"), Ipv6Address (), "Network not announced");
+}
+
+void
+Olsr6HnaAggregationRoutingTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (4);
+
+  Olsr6Helper olsr6;
+  olsr6.Set ("HnaAggregation", BooleanValue (m_aggregation));
+  InternetStackHelper internet;
+  internet.SetRoutingHelper (olsr6);
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper simpleNetHelper;
+  simpleNetHelper.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  simpleNetHelper.SetChannelAttribute ("Delay", StringValue ("2ms"));
+
+  // A, G1, B, G2 are the nodes 0, 1, 2, 3
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase ("2001:1::", Ipv6Prefix (64));
+  Ipv6InterfaceContainer ag1 = ipv6.Assign (simpleNetHelper.Install (NodeContainer (nodes.Get (0), nodes.Get (1))));
+  ipv6.NewNetwork ();
+  ipv6.Assign (simpleNetHelper.Install (NodeContainer (nodes.Get (0), nodes.Get (2))));
+  ipv6.NewNetwork ();
+  ipv6.Assign (simpleNetHelper.Install (NodeContainer (nodes.Get (2), nodes.Get (3))));
+
+  Ptr<RoutingProtocol> g1 = Olsr6Helper::GetOlsr6RoutingProtocol (nodes.Get (1));
+  g1->AddHostNetworkAssociation (Ipv6Address ("2001:db8::"), Ipv6Prefix (64));
+  g1->AddHostNetworkAssociation (Ipv6Address ("2001:db8:0:1::"), Ipv6Prefix (64));
+  g1->AddHostNetworkAssociation (Ipv6Address ("2001:db8:0:2::"), Ipv6Prefix (64));
+  g1->AddHostNetworkAssociation (Ipv6Address ("2001:db8:0:3::"), Ipv6Prefix (64));
+  Ptr<RoutingProtocol> g2 = Olsr6Helper::GetOlsr6RoutingProtocol (nodes.Get (3));
+  g2->AddHostNetworkAssociation (Ipv6Address ("2001:db8:0:1::"), Ipv6Prefix (64));
+
+  m_a = Olsr6Helper::GetOlsr6RoutingProtocol (nodes.Get (0));
+  m_a1 = ag1.GetAddress (0, 1);
+  m_g1 = ag1.GetAddress (1, 1);
+
+  Simulator::Schedule (Seconds (40), &Olsr6HnaAggregationRoutingTestCase::Check, this);
+  Simulator::Stop (Seconds (41));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_a = 0;
+}
+
+static class Olsr6HnaAggregationTestSuite : public TestSuite
+{
+public:
+  Olsr6HnaAggregationTestSuite ();
+} g_olsr6HnaAggregationTestSuite;
+
+Olsr6HnaAggregationTestSuite::Olsr6HnaAggregationTestSuite ()
+  : TestSuite ("routing-olsr6-hna-aggregation", UNIT)
+{
+  AddTestCase (new Olsr6HnaAggregationTestCase (), TestCase::QUICK);
+  AddTestCase (new Olsr6HnaAggregationRoutingTestCase (false), TestCase::QUICK);
+  AddTestCase (new Olsr6HnaAggregationRoutingTestCase (true), TestCase::QUICK);
+}
@@ -0,0 +1,200 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Ankit Deepak <adadeepak8@gmail.com>
+ *          Shravya Ks <shravya.ks0@gmail.com>,
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/ipv6-header.h"
+#include "ns3/ipv6-route.h"
+#include "ns3/olsr6-helper.h"
+#include "ns3/olsr6-routing-protocol.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/simple-net-device-helper.h"
+
+#include <sstream>
+
+using namespace ns3;
+using namespace olsr6;
+
+/**
+ * Testcase for the gateway selection of the HNA networks on the chain
+ * G1 - A - B - G2, where G1 and G2 both announce 2001:db8::/64, with
+ * uplink capacities of 100 and 1000 Mbit/s.  A sends the flows to the
+ * network through G1, one hop away, or through B to G2, two hops away.
+ */
+class Olsr6HnaGatewayTestCase : public TestCase
+{
+public:
+  /**
+   * \param selection The HnaGatewaySelection of the nodes.
+   * \param slack The HnaDistanceSlack of the nodes.
+   * \param load The uplink load advertised by G2.
+   * \param viaG1 True if some flows are expected through G1.
+   * \param viaG2 True if some flows are expected through G2.
+   */
+  Olsr6HnaGatewayTestCase (std::string selection, uint32_t slack, uint8_t load,
+                           bool viaG1, bool viaG2);
+  /// \brief Run test case
+  virtual void DoRun (void);
+
+private:
+  /// \brief Checks the gateways of the flows of A.
+  void Check (void);
+  /**
+   * \param selection The HnaGatewaySelection of the nodes.
+   * \param slack The HnaDistanceSlack of the nodes.
+   * \param load The uplink load advertised by G2.
+   * \returns The name of the test case.
+   */
+  static std::string GetName (std::string selection, uint32_t slack, uint8_t load);
+
+  std::string m_selection;   //!< The HnaGatewaySelection of the nodes.
+  uint32_t m_slack;          //!< The HnaDistanceSlack of the nodes.
+  uint8_t m_load;            //!< The uplink load advertised by G2.
+  bool m_viaG1;              //!< True if some flows are expected through G1.
+  bool m_viaG2;              //!< True if some flows are expected through G2.
+  Ptr<RoutingProtocol> m_a;  //!< The routing protocol of A.
+  Ipv6Address m_a1;          //!< The address of A on the link to G1.
+  Ipv6Address m_g1;          //!< The address of G1 on the link to A.
+  Ipv6Address m_b;           //!< The address of B on the link to A.
+};
+
+std::string
+Olsr6HnaGatewayTestCase::GetName (std::string selection, uint32_t slack, uint8_t load)
+{
+  std::ostringstream oss;
+  oss << "Check the " << selection << " gateway selection with HnaDistanceSlack " << slack
+      << " and a load of G2 of " << uint32_t (load);
+  return oss.str ();
+}
+
+Olsr6HnaGatewayTestCase::Olsr6HnaGatewayTestCase (std::string selection, uint32_t slack, uint8_t load,
+                                                  bool viaG1, bool viaG2)
+  : TestCase (GetName (selection, slack, load)),
+    m_selection (selection),
+    m_slack (slack),
+    m_load (load),
+    m_viaG1 (viaG1),
+    m_viaG2 (viaG2)
+{
+}
+
+void
+Olsr6HnaGatewayTestCase::Check (void)
+{
+  Ptr<Ipv6RoutingProtocol> routing = m_a;
+  uint32_t viaG1 = 0;
+  uint32_t viaG2 = 0;
+  for (uint32_t flowLabel = 0; flowLabel < 128; flowLabel++)
+    {
+      Ipv6Header header;
+      header.SetSourceAddress (m_a1);
+      header.SetDestinationAddress (Ipv6Address ("2001:db8::1"));
+      header.SetFlowLabel (flowLabel);
+      Socket::SocketErrno sockerr;
+      Ptr<Ipv6Route> route = routing->RouteOutput (Create<Packet> (), header, 0, sockerr);
+      NS_TEST_ASSERT_MSG_NE (route, 0, "A has a route to the network");
+      Ptr<Ipv6Route> again = routing->RouteOutput (Create<Packet> (), header, 0, sockerr);
+      NS_TEST_EXPECT_MSG_EQ (route->GetGateway (), again->GetGateway (), "A flow keeps its gateway");
+      if (route->GetGateway () == m_g1)
+        {
+          viaG1++;
+        }
+      else
+        {
+          NS_TEST_EXPECT_MSG_EQ (route->GetGateway (), m_b, "G2 is reached through B");
+          viaG2++;
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ ((viaG1 > 0), m_viaG1, "Flows through G1");
+  NS_TEST_EXPECT_MSG_EQ ((viaG2 > 0), m_viaG2, "Flows through G2");
+  if (m_selection == "weighted" && m_viaG2)
+    {
+      NS_TEST_EXPECT_MSG_EQ ((viaG2 > viaG1), true, "G2 has the largest capacity left");
+    }
+}
+
+void
+Olsr6HnaGatewayTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (4);
+
+  Olsr6Helper olsr6;
+  olsr6.Set ("HnaGatewaySelection", StringValue (m_selection));
+  olsr6.Set ("HnaDistanceSlack", UintegerValue (m_slack));
+  InternetStackHelper internet;
+  internet.SetRoutingHelper (olsr6);
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper simpleNetHelper;
+  simpleNetHelper.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  simpleNetHelper.SetChannelAttribute ("Delay", StringValue ("2ms"));
+
+  // A, G1, B, G2 are the nodes 0, 1, 2, 3
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase ("2001:1::", Ipv6Prefix (64));
+  Ipv6InterfaceContainer ag1 = ipv6.Assign (simpleNetHelper.Install (NodeContainer (nodes.Get (0), nodes.Get (1))));
+  ipv6.NewNetwork ();
+  Ipv6InterfaceContainer ab = ipv6.Assign (simpleNetHelper.Install (NodeContainer (nodes.Get (0), nodes.Get (2))));
+  ipv6.NewNetwork ();
+  ipv6.Assign (simpleNetHelper.Install (NodeContainer (nodes.Get (2), nodes.Get (3))));
+
+  Ptr<RoutingProtocol> g1 = Olsr6Helper::GetOlsr6RoutingProtocol (nodes.Get (1));
+  g1->SetAttribute ("GatewayCapacity", UintegerValue (100));
+  g1->AddHostNetworkAssociation (Ipv6Address ("2001:db8::"), Ipv6Prefix (64));
+  Ptr<RoutingProtocol> g2 = Olsr6Helper::GetOlsr6RoutingProtocol (nodes.Get (3));
+  g2->SetAttribute ("GatewayCapacity", UintegerValue (1000));
+  g2->SetAttribute ("GatewayLoad", UintegerValue (m_load));
+  g2->AddHostNetworkAssociation (Ipv6Address ("2001:db8::"), Ipv6Prefix (64));
+
+  m_a = Olsr6Helper::GetOlsr6RoutingProtocol (nodes.Get (0));
+  m_a1 = ag1.GetAddress (0, 1);
+  m_g1 = ag1.GetAddress (1, 1);
+  m_b = ab.GetAddress (1, 1);
+
+  Simulator::Schedule (Seconds (40), &Olsr6HnaGatewayTestCase::Check, this);
+  Simulator::Stop (Seconds (41));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_a = 0;
+}
+
+static class Olsr6HnaGatewayTestSuite : public TestSuite
+{
+public:
+  Olsr6HnaGatewayTestSuite ();
+} g_olsr6HnaGatewayTestSuite;
+
+Olsr6HnaGatewayTestSuite::Olsr6HnaGatewayTestSuite ()
+  : TestSuite ("routing-olsr6-hna-gateway", UNIT)
+{
+  AddTestCase (new Olsr6HnaGatewayTestCase ("nearest", 1, 0, true, false), TestCase::QUICK);
+  AddTestCase (new Olsr6HnaGatewayTestCase ("hash", 0, 0, true, false), TestCase::QUICK);
+  AddTestCase (new Olsr6HnaGatewayTestCase ("hash", 1, 0, true, true), TestCase::QUICK);
+  AddTestCase (new Olsr6HnaGatewayTestCase ("weighted", 1, 0, true, true), TestCase::QUICK);
+  AddTestCase (new Olsr6HnaGatewayTestCase ("weighted", 1, 255, true, false), TestCase::QUICK);
+}
@@ -0,0 +1,180 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Ankit Deepak <adadeepak8@gmail.com>
+ *          Shravya Ks <shravya.ks0@gmail.com>,
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/ipv6.h"
+#include "ns3/olsr6-helper.h"
+#include "ns3/olsr6-routing-protocol.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/simple-net-device-helper.h"
+
+using namespace ns3;
+using namespace olsr6;
+
+/**
+ * Testcase for the reaction to interface changes on the chain B - A - C,
+ * where A reaches B and C on two different interfaces.  At 20 s, the
+ * interface of A towards C goes down, or loses its address; A forgets C
+ * right away instead of after the neighbor hold time.  At 25 s, the
+ * interface comes back, or gets a new address, and A reaches C again.
+ */
+class Olsr6InterfaceChangeTestCase : public TestCase
+{
+public:
+  /**
+   * \param removeAddress True to remove and add the address of the
+   * interface, false to set the interface down and up.
+   */
+  Olsr6InterfaceChangeTestCase (bool removeAddress);
+  /// \brief Run test case
+  virtual void DoRun (void);
+
+private:
+  /// \brief Takes the interface of A towards C away.
+  void Down (void);
+  /// \brief Brings the interface of A towards C back.
+  void Up (void);
+  /**
+   * \brief Checks the route of A to C.
+   * \param expected True if A is expected to have a route to C.
+   */
+  void Check (bool expected);
+
+  bool m_removeAddress;      //!< True to change the address instead of the interface state.
+  Ptr<Ipv6> m_ipv6;          //!< The IPv6 stack of A.
+  Ptr<RoutingProtocol> m_a;  //!< The routing protocol of A.
+  uint32_t m_interface;      //!< The interface of A towards C.
+  Ipv6Address m_ac;          //!< The address of A on the link to C.
+  Ipv6Address m_c;           //!< The address of C.
+};
+
+Olsr6InterfaceChangeTestCase::Olsr6InterfaceChangeTestCase (bool removeAddress)
+  : TestCase (removeAddress ? "Check the reaction to the removal of an address"
+              : "Check the reaction to an interface going down"),
+    m_removeAddress (removeAddress),
+    m_interface (0)
+{
+}
+
+void
+Olsr6InterfaceChangeTestCase::Down (void)
+{
+  if (m_removeAddress)
+    {
+      m_ipv6->RemoveAddress (m_interface, m_ac);
+    }
+  else
+    {
+      m_ipv6->SetDown (m_interface);
+    }
+}
+
+void
+Olsr6InterfaceChangeTestCase::Up (void)
+{
+  if (m_removeAddress)
+    {
+      m_ipv6->AddAddress (m_interface, Ipv6InterfaceAddress (Ipv6Address ("2001:2::100"), Ipv6Prefix (64)));
+    }
+  else
+    {
+      m_ipv6->SetUp (m_interface);
+      // The global address does not survive the interface going down
+      m_ipv6->AddAddress (m_interface, Ipv6InterfaceAddress (m_ac, Ipv6Prefix (64)));
+    }
+}
+
+void
+Olsr6InterfaceChangeTestCase::Check (bool expected)
+{
+  bool found = false;
+  std::vector<RoutingTableEntry> entries = m_a->GetRoutingTableEntries ();
+  for (std::vector<RoutingTableEntry>::const_iterator it = entries.begin (); it != entries.end (); it++)
+    {
+      if (it->destAddr == m_c)
+        {
+          found = true;
+          NS_TEST_EXPECT_MSG_EQ (it->nextAddr, m_c, "C is a neighbor of A");
+          NS_TEST_EXPECT_MSG_EQ (it->interface, m_interface, "C is reached on its interface");
+        }
+    }
+  NS_TEST_EXPECT_MSG_EQ (found, expected, "Route of A to C at " << Simulator::Now ().GetSeconds () << "s");
+}
+
+void
+Olsr6InterfaceChangeTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (3);
+
+  Olsr6Helper olsr6;
+  InternetStackHelper internet;
+  internet.SetRoutingHelper (olsr6);
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper simpleNetHelper;
+  simpleNetHelper.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  simpleNetHelper.SetChannelAttribute ("Delay", StringValue ("2ms"));
+
+  // A, B, C are the nodes 0, 1, 2
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase ("2001:1::", Ipv6Prefix (64));
+  ipv6.Assign (simpleNetHelper.Install (NodeContainer (nodes.Get (0), nodes.Get (1))));
+  ipv6.NewNetwork ();
+  Ipv6InterfaceContainer ac = ipv6.Assign (simpleNetHelper.Install (NodeContainer (nodes.Get (0), nodes.Get (2))));
+
+  m_ipv6 = nodes.Get (0)->GetObject<Ipv6> ();
+  m_a = Olsr6Helper::GetOlsr6RoutingProtocol (nodes.Get (0));
+  m_interface = ac.GetInterfaceIndex (0);
+  m_ac = ac.GetAddress (0, 1);
+  m_c = ac.GetAddress (1, 1);
+
+  Simulator::Schedule (Seconds (19), &Olsr6InterfaceChangeTestCase::Check, this, true);
+  Simulator::Schedule (Seconds (20), &Olsr6InterfaceChangeTestCase::Down, this);
+  // Far below the neighbor hold time of 6 s
+  Simulator::Schedule (Seconds (20.5), &Olsr6InterfaceChangeTestCase::Check, this, false);
+  Simulator::Schedule (Seconds (25), &Olsr6InterfaceChangeTestCase::Up, this);
+  Simulator::Schedule (Seconds (35), &Olsr6InterfaceChangeTestCase::Check, this, true);
+  Simulator::Stop (Seconds (36));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_ipv6 = 0;
+  m_a = 0;
+}
+
+static class Olsr6InterfaceChangeTestSuite : public TestSuite
+{
+public:
+  Olsr6InterfaceChangeTestSuite ();
+} g_olsr6InterfaceChangeTestSuite;
+
+Olsr6InterfaceChangeTestSuite::Olsr6InterfaceChangeTestSuite ()
+  : TestSuite ("routing-olsr6-interface-change", UNIT)
+{
+  AddTestCase (new Olsr6InterfaceChangeTestCase (false), TestCase::QUICK);
+  AddTestCase (new Olsr6InterfaceChangeTestCase (true), TestCase::QUICK);
+}
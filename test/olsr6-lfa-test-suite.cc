@@ -0,0 +1,187 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Ankit Deepak <adadeepak8@gmail.com>
+ *          Shravya Ks <shravya.ks0@gmail.com>,
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/double.h"
+#include "ns3/boolean.h"
+#include "ns3/pointer.h"
+#include "ns3/error-model.h"
+#include "ns3/olsr6-helper.h"
+#include "ns3/olsr6-routing-protocol.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/simple-net-device-helper.h"
+
+#include <vector>
+
+using namespace ns3;
+using namespace olsr6;
+
+/**
+ * Testcase for the loop-free alternate next hops on the square
+ * A - B - D - C - A: A reaches D through B or C, each one protecting the
+ * other, while the neighbors of A have no loop-free alternate.  When the
+ * link to the primary next hop towards D fails, the route switches to the
+ * alternate at once.
+ */
+class Olsr6LfaTestCase : public TestCase
+{
+public:
+  /**
+   * \param enabled The LoopFreeAlternates attribute of the nodes.
+   */
+  Olsr6LfaTestCase (bool enabled);
+  /// \brief Run test case
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Looks for the route of A to a destination.
+   * \param dest The destination.
+   * \param[out] entry The route.
+   * \returns true if A has a route to the destination.
+   */
+  bool Lookup (Ipv6Address dest, RoutingTableEntry &entry);
+  /// \brief Checks the alternates, then fails the link to the primary next hop.
+  void Check (void);
+
+  bool m_enabled;            //!< The LoopFreeAlternates attribute of the nodes.
+  Ptr<RoutingProtocol> m_a;  //!< The routing protocol of A.
+  Ipv6Address m_b;           //!< The address of B on the link to A.
+  Ipv6Address m_c;           //!< The address of C on the link to A.
+  Ipv6Address m_d;           //!< The main address of D.
+  NetDeviceContainer m_ab;   //!< The devices of the link A - B.
+  NetDeviceContainer m_ac;   //!< The devices of the link A - C.
+};
+
+Olsr6LfaTestCase::Olsr6LfaTestCase (bool enabled)
+  : TestCase (enabled ? "Check the loop-free alternates" : "Check the routes without loop-free alternates"),
+    m_enabled (enabled)
+{
+}
+
+bool
+Olsr6LfaTestCase::Lookup (Ipv6Address dest, RoutingTableEntry &entry)
+{
+  std::vector<RoutingTableEntry> table = m_a->GetRoutingTableEntries ();
+  for (std::vector<RoutingTableEntry>::const_iterator it = table.begin (); it != table.end (); it++)
+    {
+      if (it->destAddr == dest)
+        {
+          entry = *it;
+          return true;
+        }
+    }
+  return false;
+}
+
+void
+Olsr6LfaTestCase::Check (void)
+{
+  RoutingTableEntry toD, toB;
+  NS_TEST_ASSERT_MSG_EQ (Lookup (m_d, toD), true, "A has a route to D");
+  NS_TEST_ASSERT_MSG_EQ (Lookup (m_b, toB), true, "A has a route to B");
+  NS_TEST_EXPECT_MSG_EQ (toB.alternateNextAddr, Ipv6Address (), "C would send the packets to B back through A");
+  if (!m_enabled)
+    {
+      NS_TEST_EXPECT_MSG_EQ (toD.alternateNextAddr, Ipv6Address (), "No alternate is computed");
+      return;
+    }
+
+  Ipv6Address primary = toD.nextAddr;
+  Ipv6Address alternate = (primary == m_b) ? m_c : m_b;
+  NS_TEST_EXPECT_MSG_EQ ((primary == m_b || primary == m_c), true, "D is reached through B or C");
+  NS_TEST_EXPECT_MSG_EQ (toD.alternateNextAddr, alternate, "The other neighbor protects the route to D");
+
+  // The link to the primary next hop fails, and the link layer reports it
+  NetDeviceContainer failing = (primary == m_b) ? m_ab : m_ac;
+  for (uint32_t i = 0; i < failing.GetN (); i++)
+    {
+      Ptr<RateErrorModel> em = CreateObject<RateErrorModel> ();
+      em->SetAttribute ("ErrorRate", DoubleValue (1.0));
+      em->SetAttribute ("ErrorUnit", StringValue ("ERROR_UNIT_PACKET"));
+      failing.Get (i)->SetAttribute ("ReceiveErrorModel", PointerValue (em));
+    }
+  m_a->NotifyLinkFailure (primary);
+
+  NS_TEST_ASSERT_MSG_EQ (Lookup (m_d, toD), true, "A still has a route to D");
+  NS_TEST_EXPECT_MSG_EQ (toD.nextAddr, alternate, "The route to D switched to the alternate");
+  NS_TEST_EXPECT_MSG_EQ (toD.distance, 2, "The alternate is as short as the primary");
+}
+
+void
+Olsr6LfaTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (4);
+
+  Olsr6Helper olsr6;
+  olsr6.Set ("LoopFreeAlternates", BooleanValue (m_enabled));
+  InternetStackHelper internet;
+  internet.SetRoutingHelper (olsr6);
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper simpleNetHelper;
+  simpleNetHelper.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  simpleNetHelper.SetChannelAttribute ("Delay", StringValue ("2ms"));
+
+  // A, B, C, D are the nodes 0, 1, 2, 3
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase ("2001:1::", Ipv6Prefix (64));
+  m_ab = simpleNetHelper.Install (NodeContainer (nodes.Get (0), nodes.Get (1)));
+  Ipv6InterfaceContainer ab = ipv6.Assign (m_ab);
+  ipv6.NewNetwork ();
+  m_ac = simpleNetHelper.Install (NodeContainer (nodes.Get (0), nodes.Get (2)));
+  Ipv6InterfaceContainer ac = ipv6.Assign (m_ac);
+  ipv6.NewNetwork ();
+  Ipv6InterfaceContainer bd = ipv6.Assign (simpleNetHelper.Install (NodeContainer (nodes.Get (1), nodes.Get (3))));
+  ipv6.NewNetwork ();
+  ipv6.Assign (simpleNetHelper.Install (NodeContainer (nodes.Get (2), nodes.Get (3))));
+
+  m_a = Olsr6Helper::GetOlsr6RoutingProtocol (nodes.Get (0));
+  m_b = ab.GetAddress (1, 1);
+  m_c = ac.GetAddress (1, 1);
+  m_d = bd.GetAddress (1, 1);
+
+  Simulator::Schedule (Seconds (40), &Olsr6LfaTestCase::Check, this);
+  Simulator::Stop (Seconds (41));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_a = 0;
+}
+
+static class Olsr6LfaTestSuite : public TestSuite
+{
+public:
+  Olsr6LfaTestSuite ();
+} g_olsr6LfaTestSuite;
+
+Olsr6LfaTestSuite::Olsr6LfaTestSuite ()
+  : TestSuite ("routing-olsr6-lfa", UNIT)
+{
+  AddTestCase (new Olsr6LfaTestCase (false), TestCase::QUICK);
+  AddTestCase (new Olsr6LfaTestCase (true), TestCase::QUICK);
+}
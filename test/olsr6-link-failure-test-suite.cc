@@ -0,0 +1,174 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Ankit Deepak <adadeepak8@gmail.com>
+ *          Shravya Ks <shravya.ks0@gmail.com>,
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/double.h"
+#include "ns3/pointer.h"
+#include "ns3/nstime.h"
+#include "ns3/error-model.h"
+#include "ns3/olsr6-helper.h"
+#include "ns3/olsr6-routing-protocol.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/simple-net-device-helper.h"
+
+#include <vector>
+
+using namespace ns3;
+using namespace olsr6;
+
+/**
+ * Testcase checking, on the chain A - B - C, how long B keeps routing
+ * through the link to C once that link has failed, with and without
+ * link-layer failure feedback.
+ */
+class Olsr6LinkFailureTestCase : public TestCase
+{
+public:
+  Olsr6LinkFailureTestCase ();
+  /// \brief Run test case
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Runs the scenario.
+   * \param feedback true if the link layer reports the failure
+   * \returns the time B kept its route to C after the failure
+   */
+  Time Run (bool feedback);
+  /**
+   * \brief Makes the failing link drop every packet.
+   * \param devices The two devices of the link.
+   */
+  static void Fail (NetDeviceContainer devices);
+  /// \brief Checks, every 100 ms, whether B still routes to C.
+  void Check (void);
+
+  Ptr<RoutingProtocol> m_b;  //!< The routing protocol of B.
+  Ipv6Address m_c;           //!< The address of C.
+  Time m_lost;               //!< When B dropped its route to C.
+};
+
+Olsr6LinkFailureTestCase::Olsr6LinkFailureTestCase ()
+  : TestCase ("Check the black-hole window after a link failure")
+{
+}
+
+void
+Olsr6LinkFailureTestCase::Fail (NetDeviceContainer devices)
+{
+  for (uint32_t i = 0; i < devices.GetN (); i++)
+    {
+      Ptr<RateErrorModel> em = CreateObject<RateErrorModel> ();
+      em->SetAttribute ("ErrorRate", DoubleValue (1.0));
+      em->SetAttribute ("ErrorUnit", StringValue ("ERROR_UNIT_PACKET"));
+      devices.Get (i)->SetAttribute ("ReceiveErrorModel", PointerValue (em));
+    }
+}
+
+void
+Olsr6LinkFailureTestCase::Check (void)
+{
+  bool routed = false;
+  std::vector<RoutingTableEntry> table = m_b->GetRoutingTableEntries ();
+  for (std::vector<RoutingTableEntry>::const_iterator it = table.begin (); it != table.end (); it++)
+    {
+      routed = routed || it->destAddr == m_c;
+    }
+  if (!routed && m_lost.IsZero ())
+    {
+      m_lost = Simulator::Now ();
+    }
+  Simulator::Schedule (MilliSeconds (100), &Olsr6LinkFailureTestCase::Check, this);
+}
+
+Time
+Olsr6LinkFailureTestCase::Run (bool feedback)
+{
+  NodeContainer nodes;
+  nodes.Create (3);
+
+  Olsr6Helper olsr6;
+  InternetStackHelper internet;
+  internet.SetRoutingHelper (olsr6);
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper simpleNetHelper;
+  simpleNetHelper.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  simpleNetHelper.SetChannelAttribute ("Delay", StringValue ("2ms"));
+
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase ("2001:1::", Ipv6Prefix (64));
+  ipv6.Assign (simpleNetHelper.Install (NodeContainer (nodes.Get (0), nodes.Get (1))));
+  ipv6.NewNetwork ();
+  NetDeviceContainer failing = simpleNetHelper.Install (NodeContainer (nodes.Get (1), nodes.Get (2)));
+  Ipv6InterfaceContainer interfaces = ipv6.Assign (failing);
+
+  m_b = Olsr6Helper::GetOlsr6RoutingProtocol (nodes.Get (1));
+  m_c = interfaces.GetAddress (1, 1);
+  m_lost = Seconds (0);
+
+  // The link fails at 30s; with feedback, the first frame B fails to
+  // deliver is reported right away
+  Simulator::Schedule (Seconds (30), &Olsr6LinkFailureTestCase::Fail, failing);
+  if (feedback)
+    {
+      Simulator::Schedule (Seconds (30.01), &RoutingProtocol::NotifyLinkFailure, m_b, m_c);
+    }
+  Simulator::Schedule (Seconds (30), &Olsr6LinkFailureTestCase::Check, this);
+
+  Simulator::Stop (Seconds (45));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_b = 0;
+
+  NS_TEST_EXPECT_MSG_EQ (m_lost.IsZero (), false, "B should drop its route to C");
+  return m_lost - Seconds (30);
+}
+
+void
+Olsr6LinkFailureTestCase::DoRun (void)
+{
+  Time withoutFeedback = Run (false);
+  Time withFeedback = Run (true);
+
+  // Without feedback, the link tuple only expires OLSR6_NEIGHB_HOLD_TIME
+  // (6s) after the last HELLO, sent at most 2.5s before the failure
+  NS_TEST_EXPECT_MSG_GT (withoutFeedback, Seconds (3), "The link tuple expires after the neighbor hold time");
+  NS_TEST_EXPECT_MSG_LT (withFeedback, Seconds (0.5), "The feedback drops the route at once");
+}
+
+static class Olsr6LinkFailureTestSuite : public TestSuite
+{
+public:
+  Olsr6LinkFailureTestSuite ();
+} g_olsr6LinkFailureTestSuite;
+
+Olsr6LinkFailureTestSuite::Olsr6LinkFailureTestSuite ()
+  : TestSuite ("routing-olsr6-link-failure", UNIT)
+{
+  AddTestCase (new Olsr6LinkFailureTestCase (), TestCase::QUICK);
+}
@@ -0,0 +1,195 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Ankit Deepak <adadeepak8@gmail.com>
+ *          Shravya Ks <shravya.ks0@gmail.com>,
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
+#include "ns3/pointer.h"
+#include "ns3/nstime.h"
+#include "ns3/error-model.h"
+#include "ns3/olsr6-helper.h"
+#include "ns3/olsr6-routing-protocol.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/simple-net-device-helper.h"
+
+using namespace ns3;
+using namespace olsr6;
+
+/**
+ * Testcase for the link quality and the hysteresis thresholds
+ * (RFC 3626, section 14).
+ */
+class Olsr6LinkHysteresisTestCase : public TestCase
+{
+public:
+  Olsr6LinkHysteresisTestCase ();
+  /// \brief Run test case
+  virtual void DoRun (void);
+};
+
+Olsr6LinkHysteresisTestCase::Olsr6LinkHysteresisTestCase ()
+  : TestCase ("Check the link quality hysteresis")
+{
+}
+
+void
+Olsr6LinkHysteresisTestCase::DoRun (void)
+{
+  Ptr<RoutingProtocol> protocol = CreateObject<RoutingProtocol> ();
+  protocol->SetAttribute ("LinkHysteresis", BooleanValue (true));
+  protocol->SetAttribute ("HystScaling", DoubleValue (0.5));
+  protocol->SetAttribute ("HystThresholdHigh", DoubleValue (0.8));
+  protocol->SetAttribute ("HystThresholdLow", DoubleValue (0.3));
+
+  // A new link, not symmetric yet
+  LinkTuple link;
+  link.neighborIfaceAddr = Ipv6Address ("2001:1::2");
+  link.localIfaceAddr = Ipv6Address ("2001:1::1");
+  link.symTime = Seconds (-1);
+  link.time = Seconds (100);
+  link.quality = 0;
+  link.pending = true;
+
+  // Received, missed (r, m) and the pending state after each HELLO
+  const char *sequence = "rrrmrmmrrr";
+  bool pending[] = { true, true, false, false, false, false, true, true, true, false };
+  double quality = 0;
+  for (uint32_t i = 0; sequence[i] != 0; i++)
+    {
+      bool received = sequence[i] == 'r';
+      protocol->UpdateLinkQuality (link, received);
+      quality = 0.5 * quality + (received ? 0.5 : 0);
+      NS_TEST_EXPECT_MSG_EQ_TOL (link.quality, quality, 1e-9, "Quality after HELLO " << i);
+      NS_TEST_EXPECT_MSG_EQ (link.pending, pending[i], "Pending state after HELLO " << i);
+      if (i == 6)
+        {
+          NS_TEST_EXPECT_MSG_GT (link.lostTime, Seconds (0), "A lost link is advertised as lost");
+        }
+    }
+  NS_TEST_EXPECT_MSG_LT (link.lostTime, Seconds (0), "An established link is not advertised as lost");
+
+  protocol->Dispose ();
+}
+
+/**
+ * Testcase checking, on the chain A - B - C, that B establishes its links
+ * with hysteresis and loses the link to C once HELLOs are missed.
+ */
+class Olsr6LinkHysteresisFailureTestCase : public TestCase
+{
+public:
+  Olsr6LinkHysteresisFailureTestCase ();
+  /// \brief Run test case
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Samples the routing table of B.
+   * \param b The routing protocol of B.
+   * \param nRoutes Where to store the number of routes.
+   */
+  static void Sample (Ptr<RoutingProtocol> b, uint32_t *nRoutes);
+  /**
+   * \brief Makes a device drop every packet.
+   * \param device The device.
+   */
+  static void Fail (Ptr<NetDevice> device);
+};
+
+Olsr6LinkHysteresisFailureTestCase::Olsr6LinkHysteresisFailureTestCase ()
+  : TestCase ("Check the link establishment and loss with hysteresis")
+{
+}
+
+void
+Olsr6LinkHysteresisFailureTestCase::Sample (Ptr<RoutingProtocol> b, uint32_t *nRoutes)
+{
+  *nRoutes = b->GetRoutingTableEntries ().size ();
+}
+
+void
+Olsr6LinkHysteresisFailureTestCase::Fail (Ptr<NetDevice> device)
+{
+  Ptr<RateErrorModel> em = CreateObject<RateErrorModel> ();
+  em->SetAttribute ("ErrorRate", DoubleValue (1.0));
+  em->SetAttribute ("ErrorUnit", StringValue ("ERROR_UNIT_PACKET"));
+  device->SetAttribute ("ReceiveErrorModel", PointerValue (em));
+}
+
+void
+Olsr6LinkHysteresisFailureTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (3);
+
+  Olsr6Helper olsr6;
+  olsr6.Set ("LinkHysteresis", BooleanValue (true));
+  InternetStackHelper internet;
+  internet.SetRoutingHelper (olsr6);
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper simpleNetHelper;
+  simpleNetHelper.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  simpleNetHelper.SetChannelAttribute ("Delay", StringValue ("2ms"));
+
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase ("2001:1::", Ipv6Prefix (64));
+  ipv6.Assign (simpleNetHelper.Install (NodeContainer (nodes.Get (0), nodes.Get (1))));
+  ipv6.NewNetwork ();
+  NetDeviceContainer failing = simpleNetHelper.Install (NodeContainer (nodes.Get (1), nodes.Get (2)));
+  ipv6.Assign (failing);
+
+  // HELLOs every 2s: the link to C fails at 30s, and two missed HELLOs
+  // bring its quality from about 1 below 0.3
+  Ptr<RoutingProtocol> b = Olsr6Helper::GetOlsr6RoutingProtocol (nodes.Get (1));
+  uint32_t nRoutesBefore = 0;
+  uint32_t nRoutesAfter = 0;
+  Simulator::Schedule (Seconds (29), &Olsr6LinkHysteresisFailureTestCase::Sample, b, &nRoutesBefore);
+  Simulator::Schedule (Seconds (30), &Olsr6LinkHysteresisFailureTestCase::Fail, failing.Get (0));
+  Simulator::Schedule (Seconds (30), &Olsr6LinkHysteresisFailureTestCase::Fail, failing.Get (1));
+  Simulator::Schedule (Seconds (37), &Olsr6LinkHysteresisFailureTestCase::Sample, b, &nRoutesAfter);
+
+  Simulator::Stop (Seconds (40));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (nRoutesBefore, 2, "B should reach A and C");
+  NS_TEST_EXPECT_MSG_EQ (nRoutesAfter, 1, "B should have lost the link to C");
+}
+
+static class Olsr6LinkHysteresisTestSuite : public TestSuite
+{
+public:
+  Olsr6LinkHysteresisTestSuite ();
+} g_olsr6LinkHysteresisTestSuite;
+
+Olsr6LinkHysteresisTestSuite::Olsr6LinkHysteresisTestSuite ()
+  : TestSuite ("routing-olsr6-link-hysteresis", UNIT)
+{
+  AddTestCase (new Olsr6LinkHysteresisTestCase (), TestCase::QUICK);
+  AddTestCase (new Olsr6LinkHysteresisFailureTestCase (), TestCase::QUICK);
+}
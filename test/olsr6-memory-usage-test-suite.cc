@@ -0,0 +1,166 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Ankit Deepak <adadeepak8@gmail.com>
+ *          Shravya Ks <shravya.ks0@gmail.com>,
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/nstime.h"
+#include "ns3/olsr6-helper.h"
+#include "ns3/olsr6-state.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/simple-net-device-helper.h"
+
+using namespace ns3;
+using namespace olsr6;
+
+/**
+ * Testcase for the memory accounting of Olsr6State.
+ */
+class Olsr6StateMemoryUsageTestCase : public TestCase
+{
+public:
+  Olsr6StateMemoryUsageTestCase ();
+  /// \brief Run test case
+  virtual void DoRun (void);
+};
+
+Olsr6StateMemoryUsageTestCase::Olsr6StateMemoryUsageTestCase ()
+  : TestCase ("Check the memory usage reported by Olsr6State")
+{
+}
+
+void
+Olsr6StateMemoryUsageTestCase::DoRun (void)
+{
+  Olsr6State state;
+  NS_TEST_EXPECT_MSG_EQ (state.GetMemoryUsage ().GetTotalBytes (), 0, "An empty state uses no memory");
+
+  DuplicateTuple duplicate;
+  duplicate.address = Ipv6Address ("2001:1::1");
+  duplicate.sequenceNumber = 1;
+  duplicate.retransmitted = false;
+  duplicate.ifaceList.push_back (Ipv6Address ("2001:1::2"));
+  duplicate.ifaceList.push_back (Ipv6Address ("2001:2::2"));
+  duplicate.ifaceList.push_back (Ipv6Address ("2001:3::2"));
+  duplicate.expirationTime = Seconds (30);
+  state.InsertDuplicateTuple (duplicate);
+
+  MprSet mprSet;
+  mprSet.insert (Ipv6Address ("2001:1::1"));
+  mprSet.insert (Ipv6Address ("2001:1::3"));
+  state.SetMprSet (mprSet);
+
+  MemoryUsage usage = state.GetMemoryUsage ();
+  NS_TEST_EXPECT_MSG_EQ (usage.duplicateSet.count, 1, "One duplicate tuple");
+  NS_TEST_EXPECT_MSG_EQ ((usage.duplicateSet.bytes >= sizeof (DuplicateTuple) + 3 * sizeof (Ipv6Address)), true,
+                         "The interface list of the duplicate tuple is accounted for");
+  NS_TEST_EXPECT_MSG_EQ (usage.mprSet.count, 2, "Two MPRs");
+  NS_TEST_EXPECT_MSG_GT (usage.mprSet.bytes, 2 * sizeof (Ipv6Address), "The tree nodes of the MPR set are accounted for");
+  NS_TEST_EXPECT_MSG_EQ (usage.linkSet.count, 0, "No link tuple");
+  NS_TEST_EXPECT_MSG_EQ (usage.GetTotalBytes (), usage.duplicateSet.bytes + usage.mprSet.bytes,
+                         "The total is the sum of the sets");
+
+  MemoryUsage sum;
+  sum += usage;
+  sum += usage;
+  NS_TEST_EXPECT_MSG_EQ (sum.duplicateSet.count, 2, "Aggregated duplicate tuples");
+  NS_TEST_EXPECT_MSG_EQ (sum.GetTotalBytes (), 2 * usage.GetTotalBytes (), "Aggregated total");
+}
+
+/**
+ * Testcase for the memory usage samples aggregated by Olsr6Helper on the
+ * chain A - B - C.
+ */
+class Olsr6HelperMemoryUsageTestCase : public TestCase
+{
+public:
+  Olsr6HelperMemoryUsageTestCase ();
+  /// \brief Run test case
+  virtual void DoRun (void);
+};
+
+Olsr6HelperMemoryUsageTestCase::Olsr6HelperMemoryUsageTestCase ()
+  : TestCase ("Check the memory usage aggregated by Olsr6Helper")
+{
+}
+
+void
+Olsr6HelperMemoryUsageTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (3);
+
+  Olsr6Helper olsr6;
+  olsr6.Set ("MemoryUsageInterval", TimeValue (Seconds (1)));
+  InternetStackHelper internet;
+  internet.SetRoutingHelper (olsr6);
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper simpleNetHelper;
+  simpleNetHelper.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  simpleNetHelper.SetChannelAttribute ("Delay", StringValue ("2ms"));
+
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase ("2001:1::", Ipv6Prefix (64));
+  ipv6.Assign (simpleNetHelper.Install (NodeContainer (nodes.Get (0), nodes.Get (1))));
+  ipv6.NewNetwork ();
+  ipv6.Assign (simpleNetHelper.Install (NodeContainer (nodes.Get (1), nodes.Get (2))));
+
+  olsr6.TrackMemoryUsage (nodes);
+
+  Simulator::Stop (Seconds (20));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  MemoryUsage usage = olsr6.GetNetworkMemoryUsage ();
+  // A and C have one link each, B two
+  NS_TEST_EXPECT_MSG_EQ (usage.linkSet.count, 4, "Links of the network");
+  // 4 interface addresses, each reachable from the 2 nodes not owning it
+  NS_TEST_EXPECT_MSG_EQ (usage.routingTable.count, 8, "Routes of the network");
+  NS_TEST_EXPECT_MSG_GT (usage.events.count, 0, "Pending events");
+
+  uint64_t sumOfHighWaterMarks = 0;
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      NS_TEST_EXPECT_MSG_GT (olsr6.GetMemoryHighWaterMark (nodes.Get (i)), 0, "High-water mark of node " << i);
+      sumOfHighWaterMarks += olsr6.GetMemoryHighWaterMark (nodes.Get (i));
+    }
+  NS_TEST_EXPECT_MSG_EQ ((olsr6.GetNetworkMemoryHighWaterMark () >= usage.GetTotalBytes ()), true,
+                         "The network high-water mark is at least the last usage");
+  NS_TEST_EXPECT_MSG_EQ ((sumOfHighWaterMarks >= olsr6.GetNetworkMemoryHighWaterMark ()), true,
+                         "The network high-water mark is at most the sum of the node ones");
+}
+
+static class Olsr6MemoryUsageTestSuite : public TestSuite
+{
+public:
+  Olsr6MemoryUsageTestSuite ();
+} g_olsr6MemoryUsageTestSuite;
+
+Olsr6MemoryUsageTestSuite::Olsr6MemoryUsageTestSuite ()
+  : TestSuite ("routing-olsr6-memory-usage", UNIT)
+{
+  AddTestCase (new Olsr6StateMemoryUsageTestCase (), TestCase::QUICK);
+  AddTestCase (new Olsr6HelperMemoryUsageTestCase (), TestCase::QUICK);
+}
@@ -0,0 +1,161 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Ankit Deepak <adadeepak8@gmail.com>
+ *          Shravya Ks <shravya.ks0@gmail.com>,
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/olsr6-helper.h"
+#include "ns3/olsr6-routing-protocol.h"
+#include "ns3/olsr6-oracle.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/simple-net-device-helper.h"
+
+using namespace ns3;
+using namespace olsr6;
+
+/// Testcase for the routes installed by the oracle mode on a chain A - B - C - D
+class Olsr6OracleTestCase : public TestCase
+{
+public:
+  Olsr6OracleTestCase ();
+  /// \brief Run test case
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Looks up the route of a node towards a destination.
+   * \param node The node.
+   * \param dest The destination address.
+   * \param [out] entry The route, if found.
+   * \returns True if the node has a route towards dest.
+   */
+  bool GetRoute (Ptr<Node> node, Ipv6Address dest, RoutingTableEntry &entry);
+  /// Checks the routes of the converged chain.
+  void CheckChain (void);
+  /// Checks the routes once the B - C link is down.
+  void CheckBroken (void);
+
+  NodeContainer m_nodes;       //!< Nodes A, B, C and D.
+  Ipv6Address m_addrBtoC;      //!< Address of B on the B - C link.
+  Ipv6Address m_addrCtoB;      //!< Address of C on the B - C link.
+  Ipv6Address m_addrD;         //!< Address of D on the C - D link.
+};
+
+Olsr6OracleTestCase::Olsr6OracleTestCase ()
+  : TestCase ("Check the routes installed by the OLSR6 oracle mode")
+{
+}
+
+bool
+Olsr6OracleTestCase::GetRoute (Ptr<Node> node, Ipv6Address dest, RoutingTableEntry &entry)
+{
+  Ptr<RoutingProtocol> olsr6 = DynamicCast<RoutingProtocol> (node->GetObject<Ipv6> ()->GetRoutingProtocol ());
+  NS_ASSERT (olsr6 != 0);
+  std::vector<RoutingTableEntry> table = olsr6->GetRoutingTableEntries ();
+  for (std::vector<RoutingTableEntry>::const_iterator it = table.begin (); it != table.end (); it++)
+    {
+      if (it->destAddr == dest)
+        {
+          entry = *it;
+          return true;
+        }
+    }
+  return false;
+}
+
+void
+Olsr6OracleTestCase::CheckChain (void)
+{
+  NS_TEST_EXPECT_MSG_EQ (OracleTopology::Get ()->GetNNodes (), 4, "Every node should be in the topology");
+
+  RoutingTableEntry entry;
+  NS_TEST_ASSERT_MSG_EQ (GetRoute (m_nodes.Get (0), m_addrD, entry), true, "A should have a route to D");
+  NS_TEST_EXPECT_MSG_EQ (entry.distance, 3, "D is 3 hops away from A");
+  NS_TEST_ASSERT_MSG_EQ (GetRoute (m_nodes.Get (0), m_addrCtoB, entry), true, "A should have a route to C");
+  NS_TEST_EXPECT_MSG_EQ (entry.distance, 2, "C is 2 hops away from A");
+  NS_TEST_ASSERT_MSG_EQ (GetRoute (m_nodes.Get (3), m_addrBtoC, entry), true, "D should have a route to B");
+  NS_TEST_EXPECT_MSG_EQ (entry.distance, 2, "B is 2 hops away from D");
+
+  OracleTopology::Get ()->SetLinkState (m_addrBtoC, m_addrCtoB, false);
+}
+
+void
+Olsr6OracleTestCase::CheckBroken (void)
+{
+  RoutingTableEntry entry;
+  NS_TEST_EXPECT_MSG_EQ (GetRoute (m_nodes.Get (0), m_addrD, entry), false, "A should have lost its route to D");
+  NS_TEST_EXPECT_MSG_EQ (GetRoute (m_nodes.Get (0), m_addrCtoB, entry), false, "A should have lost its route to C");
+  NS_TEST_EXPECT_MSG_EQ (GetRoute (m_nodes.Get (3), m_addrBtoC, entry), false, "D should have lost its route to B");
+  NS_TEST_ASSERT_MSG_EQ (GetRoute (m_nodes.Get (3), m_addrCtoB, entry), true, "D should still reach C");
+  NS_TEST_EXPECT_MSG_EQ (entry.distance, 1, "C is a neighbor of D");
+}
+
+void
+Olsr6OracleTestCase::DoRun (void)
+{
+  m_nodes.Create (4);
+
+  Olsr6Helper olsr6;
+  olsr6.SetOracleMode (true);
+  InternetStackHelper internet;
+  internet.SetRoutingHelper (olsr6);
+  internet.Install (m_nodes);
+
+  // One channel per link, so that the nodes form a chain
+  SimpleNetDeviceHelper simpleNetHelper;
+  simpleNetHelper.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  simpleNetHelper.SetChannelAttribute ("Delay", StringValue ("2ms"));
+
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase ("2001:1::", Ipv6Prefix (64));
+  ipv6.Assign (simpleNetHelper.Install (NodeContainer (m_nodes.Get (0), m_nodes.Get (1))));
+  ipv6.NewNetwork ();
+  Ipv6InterfaceContainer bc = ipv6.Assign (simpleNetHelper.Install (NodeContainer (m_nodes.Get (1), m_nodes.Get (2))));
+  ipv6.NewNetwork ();
+  Ipv6InterfaceContainer cd = ipv6.Assign (simpleNetHelper.Install (NodeContainer (m_nodes.Get (2), m_nodes.Get (3))));
+
+  m_addrBtoC = bc.GetAddress (0, 1);
+  m_addrCtoB = bc.GetAddress (1, 1);
+  m_addrD = cd.GetAddress (1, 1);
+
+  Simulator::Schedule (Seconds (1), &Olsr6OracleTestCase::CheckChain, this);
+  Simulator::Schedule (Seconds (2), &Olsr6OracleTestCase::CheckBroken, this);
+  Simulator::Stop (Seconds (3));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  NS_TEST_EXPECT_MSG_EQ (OracleTopology::Get ()->GetNNodes (), 0, "Every node should have left the topology");
+}
+
+static class Olsr6OracleTestSuite : public TestSuite
+{
+public:
+  Olsr6OracleTestSuite ();
+} g_olsr6OracleTestSuite;
+
+Olsr6OracleTestSuite::Olsr6OracleTestSuite ()
+  : TestSuite ("routing-olsr6-oracle", UNIT)
+{
+  AddTestCase (new Olsr6OracleTestCase (), TestCase::QUICK);
+}
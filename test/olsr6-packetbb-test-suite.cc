@@ -0,0 +1,587 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Ankit Deepak <adadeepak8@gmail.com>
+ *          Shravya Ks <shravya.ks0@gmail.com>,
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+
+
+#include "ns3/test.h"
+#include "ns3/buffer.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/olsr6-packetbb.h"
+
+using namespace ns3;
+using namespace olsr6;
+
+/// A packet with a sequence number and one message, written by hand from \RFC{5444}.
+static const uint8_t g_knownPacket[] = {
+  0x08, 0x12, 0x34,                   // Version, flags, sequence number
+  0x01, 0xff, 0x00, 0x3a,             // Message type, flags, address length, size
+  0x20, 0x01, 0x0d, 0xb8, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x01, // Originator
+  0xff, 0x00, 0x00, 0x42,             // Hop limit, hop count, sequence number
+  0x00, 0x04, 0x07, 0x10, 0x01, 0x64, // Message TLV block
+  0x03, 0x80, 0x0f,                   // Address block of 3 addresses with a head
+  0x20, 0x01, 0x0d, 0xb8, 0x00, 0x00, 0x00, 0x00,
+  0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,       // Head
+  0x02, 0x03, 0x04,                   // Mids
+  0x00, 0x05, 0x02, 0x50, 0x01, 0x01, 0x01 // Address TLV block, for the second address
+};
+
+/**
+ * \returns The packet of g_knownPacket.
+ */
+static PbbPacket
+GetKnownPacket (void)
+{
+  PbbPacket packet;
+  packet.hasSequenceNumber = true;
+  packet.sequenceNumber = 0x1234;
+
+  PbbMessage message;
+  message.type = 1;
+  message.hasOriginator = true;
+  message.originator = Ipv6Address ("2001:db8::1");
+  message.hasHopLimit = true;
+  message.hopLimit = 255;
+  message.hasHopCount = true;
+  message.hopCount = 0;
+  message.hasSequenceNumber = true;
+  message.sequenceNumber = 0x42;
+  PbbTlv validity;
+  validity.type = 7;
+  validity.hasValue = true;
+  validity.value.push_back (0x64);
+  message.tlvs.push_back (validity);
+
+  PbbAddressBlock block;
+  block.addresses.push_back (Ipv6Address ("2001:db8::2"));
+  block.addresses.push_back (Ipv6Address ("2001:db8::3"));
+  block.addresses.push_back (Ipv6Address ("2001:db8::4"));
+  PbbTlv status;
+  status.type = 2;
+  status.hasIndexStart = true;
+  status.indexStart = 1;
+  status.hasValue = true;
+  status.value.push_back (1);
+  block.tlvs.push_back (status);
+  message.addressBlocks.push_back (block);
+
+  packet.messages.push_back (message);
+  return packet;
+}
+
+/**
+ * \param data The bytes.
+ * \param size The number of bytes.
+ * \returns A buffer holding the bytes.
+ */
+static Buffer
+MakeBuffer (const uint8_t *data, uint32_t size)
+{
+  Buffer buffer;
+  buffer.AddAtStart (size);
+  if (size > 0)
+    {
+      buffer.Begin ().Write (data, size);
+    }
+  return buffer;
+}
+
+/**
+ * \param a A TLV.
+ * \param b Another TLV.
+ * \returns True if the TLVs are the same.
+ */
+static bool
+IsEqual (const PbbTlv &a, const PbbTlv &b)
+{
+  return a.type == b.type && a.hasTypeExt == b.hasTypeExt && a.typeExt == b.typeExt
+         && a.hasIndexStart == b.hasIndexStart && a.indexStart == b.indexStart
+         && a.hasIndexStop == b.hasIndexStop && a.indexStop == b.indexStop
+         && a.multiValue == b.multiValue && a.hasValue == b.hasValue && a.value == b.value;
+}
+
+/**
+ * \param a Some TLVs.
+ * \param b Other TLVs.
+ * \returns True if the TLVs are the same.
+ */
+static bool
+IsEqual (const std::vector<PbbTlv> &a, const std::vector<PbbTlv> &b)
+{
+  if (a.size () != b.size ())
+    {
+      return false;
+    }
+  for (uint32_t k = 0; k < a.size (); k++)
+    {
+      if (!IsEqual (a[k], b[k]))
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+/**
+ * \param a A message.
+ * \param b Another message.
+ * \returns True if the messages are the same.
+ */
+static bool
+IsEqual (const PbbMessage &a, const PbbMessage &b)
+{
+  if (a.type != b.type || a.hasOriginator != b.hasOriginator || a.originator != b.originator
+      || a.hasHopLimit != b.hasHopLimit || a.hopLimit != b.hopLimit
+      || a.hasHopCount != b.hasHopCount || a.hopCount != b.hopCount
+      || a.hasSequenceNumber != b.hasSequenceNumber || a.sequenceNumber != b.sequenceNumber
+      || !IsEqual (a.tlvs, b.tlvs) || a.addressBlocks.size () != b.addressBlocks.size ())
+    {
+      return false;
+    }
+  for (uint32_t k = 0; k < a.addressBlocks.size (); k++)
+    {
+      if (a.addressBlocks[k].addresses != b.addressBlocks[k].addresses
+          || a.addressBlocks[k].prefixLengths != b.addressBlocks[k].prefixLengths
+          || !IsEqual (a.addressBlocks[k].tlvs, b.addressBlocks[k].tlvs))
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+/**
+ * \param a A packet.
+ * \param b Another packet.
+ * \returns True if the packets are the same.
+ */
+static bool
+IsEqual (const PbbPacket &a, const PbbPacket &b)
+{
+  if (a.hasSequenceNumber != b.hasSequenceNumber || a.sequenceNumber != b.sequenceNumber
+      || !IsEqual (a.tlvs, b.tlvs) || a.messages.size () != b.messages.size ())
+    {
+      return false;
+    }
+  for (uint32_t k = 0; k < a.messages.size (); k++)
+    {
+      if (!IsEqual (a.messages[k], b.messages[k]))
+        {
+          return false;
+        }
+    }
+  return true;
+}
+
+
+/**
+ * Testcase for the encoding of a packet, compared with the bytes of
+ * g_knownPacket, and for its decoding.
+ */
+class Olsr6PbbEncodingTestCase : public TestCase
+{
+public:
+  Olsr6PbbEncodingTestCase ();
+  virtual void DoRun (void);
+};
+
+Olsr6PbbEncodingTestCase::Olsr6PbbEncodingTestCase ()
+  : TestCase ("Check the encoding of RFC 5444 packets")
+{
+}
+
+void
+Olsr6PbbEncodingTestCase::DoRun (void)
+{
+  PbbPacket packetIn = GetKnownPacket ();
+  uint32_t size = sizeof (g_knownPacket);
+  NS_TEST_ASSERT_MSG_EQ (packetIn.GetSerializedSize (), size, "900");
+
+  Buffer buffer;
+  buffer.AddAtStart (size);
+  packetIn.Serialize (buffer.Begin ());
+  uint8_t bytes[sizeof (g_knownPacket)];
+  buffer.CopyData (bytes, size);
+  for (uint32_t k = 0; k < size; k++)
+    {
+      NS_TEST_ASSERT_MSG_EQ (int (bytes[k]), int (g_knownPacket[k]), "901 byte " << k);
+    }
+
+  PbbPacket packetOut;
+  NS_TEST_ASSERT_MSG_EQ (packetOut.Deserialize (buffer.Begin ()), size, "902");
+  NS_TEST_ASSERT_MSG_EQ (IsEqual (packetIn, packetOut), true, "903");
+  NS_TEST_ASSERT_MSG_EQ (packetOut.messages[0].addressBlocks[0].addresses[2],
+                         Ipv6Address ("2001:db8::4"), "904");
+
+  // Several messages in a packet, with packet TLVs and prefix lengths
+  packetIn.messages.push_back (packetIn.messages[0]);
+  packetIn.messages[1].type = 2;
+  packetIn.messages[1].hasOriginator = false;
+  packetIn.messages[1].originator = Ipv6Address ();
+  packetIn.messages[1].addressBlocks[0].prefixLengths.push_back (64);
+  PbbTlv tlv;
+  tlv.type = 9;
+  tlv.hasTypeExt = true;
+  tlv.typeExt = 3;
+  tlv.hasValue = true;
+  tlv.value.assign (300, 0xab);
+  packetIn.tlvs.push_back (tlv);
+  buffer = Buffer ();
+  buffer.AddAtStart (packetIn.GetSerializedSize ());
+  packetIn.Serialize (buffer.Begin ());
+  NS_TEST_ASSERT_MSG_EQ (packetOut.Deserialize (buffer.Begin ()), packetIn.GetSerializedSize (), "905");
+  NS_TEST_ASSERT_MSG_EQ (IsEqual (packetIn, packetOut), true, "906");
+}
+
+
+/**
+ * Testcase for the reading in place of g_knownPacket.
+ */
+class Olsr6PbbReaderTestCase : public TestCase
+{
+public:
+  Olsr6PbbReaderTestCase ();
+  virtual void DoRun (void);
+};
+
+Olsr6PbbReaderTestCase::Olsr6PbbReaderTestCase ()
+  : TestCase ("Check the reading in place of RFC 5444 packets")
+{
+}
+
+void
+Olsr6PbbReaderTestCase::DoRun (void)
+{
+  Buffer buffer = MakeBuffer (g_knownPacket, sizeof (g_knownPacket));
+  PbbPacketReader reader (buffer.Begin (), buffer.GetSize ());
+  NS_TEST_ASSERT_MSG_EQ (reader.IsValid (), true, "910");
+  NS_TEST_ASSERT_MSG_EQ (reader.HasSequenceNumber (), true, "911");
+  NS_TEST_ASSERT_MSG_EQ (reader.GetSequenceNumber (), 0x1234, "912");
+  PbbTlvView tlv;
+  PbbTlvIterator packetTlvs = reader.GetTlvs ();
+  NS_TEST_ASSERT_MSG_EQ (packetTlvs.Next (tlv), false, "913");
+
+  PbbMessageView message;
+  NS_TEST_ASSERT_MSG_EQ (reader.NextMessage (message), true, "914");
+  NS_TEST_ASSERT_MSG_EQ (int (message.type), 1, "915");
+  NS_TEST_ASSERT_MSG_EQ (message.size, sizeof (g_knownPacket) - 3, "916");
+  NS_TEST_ASSERT_MSG_EQ (message.GetOriginator (), Ipv6Address ("2001:db8::1"), "917");
+  NS_TEST_ASSERT_MSG_EQ (int (message.hopLimit), 255, "918");
+  NS_TEST_ASSERT_MSG_EQ (message.sequenceNumber, 0x42, "919");
+
+  // The value is read where it lies in the buffer
+  NS_TEST_ASSERT_MSG_EQ (message.tlvs.Next (tlv), true, "920");
+  NS_TEST_ASSERT_MSG_EQ (int (tlv.type), 7, "921");
+  NS_TEST_ASSERT_MSG_EQ (tlv.length, 1, "922");
+  NS_TEST_ASSERT_MSG_EQ (tlv.value.GetDistanceFrom (buffer.Begin ()), 32, "923");
+  NS_TEST_ASSERT_MSG_EQ (int (tlv.value.ReadU8 ()), 0x64, "924");
+  NS_TEST_ASSERT_MSG_EQ (message.tlvs.Next (tlv), false, "925");
+
+  PbbAddressBlockView block;
+  NS_TEST_ASSERT_MSG_EQ (message.NextAddressBlock (block), true, "926");
+  NS_TEST_ASSERT_MSG_EQ (int (block.numAddresses), 3, "927");
+  NS_TEST_ASSERT_MSG_EQ (int (block.headLength), 15, "928");
+  NS_TEST_ASSERT_MSG_EQ (block.GetAddress (1), Ipv6Address ("2001:db8::3"), "929");
+  NS_TEST_ASSERT_MSG_EQ (int (block.GetNPrefixLengths ()), 0, "930");
+  NS_TEST_ASSERT_MSG_EQ (block.tlvs.Next (tlv), true, "931");
+  NS_TEST_ASSERT_MSG_EQ (int (tlv.indexStart), 1, "932");
+  NS_TEST_ASSERT_MSG_EQ (int (tlv.indexStop), 1, "933");
+  NS_TEST_ASSERT_MSG_EQ (message.NextAddressBlock (block), false, "934");
+
+  NS_TEST_ASSERT_MSG_EQ (reader.NextMessage (message), false, "935");
+  NS_TEST_ASSERT_MSG_EQ (reader.IsValid (), true, "936");
+
+  // A packet cut in the middle of its message is malformed
+  for (uint32_t size = 4; size < sizeof (g_knownPacket); size++)
+    {
+      Buffer cut = MakeBuffer (g_knownPacket, size);
+      PbbPacketReader cutReader (cut.Begin (), size);
+      NS_TEST_ASSERT_MSG_EQ (cutReader.NextMessage (message), false, "937 size " << size);
+      NS_TEST_ASSERT_MSG_EQ (cutReader.IsValid (), false, "938 size " << size);
+      PbbPacket packet;
+      NS_TEST_ASSERT_MSG_EQ (packet.Deserialize (cut.Begin ()), 0, "939 size " << size);
+    }
+}
+
+
+/**
+ * Testcase for the decoding of random packets: the packets written are
+ * read back unchanged, and damaged copies of them are either rejected or
+ * read within their bounds.
+ */
+class Olsr6PbbFuzzTestCase : public TestCase
+{
+public:
+  Olsr6PbbFuzzTestCase ();
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \param numAddresses The number of addresses of the address block of
+   * the TLV, 0 for a packet or message TLV.
+   * \returns A random TLV.
+   */
+  PbbTlv GetTlv (uint32_t numAddresses);
+  /// \returns A random packet.
+  PbbPacket GetPacket (void);
+  /**
+   * \brief Reads a packet in place, everything included.
+   * \param buffer The packet.
+   */
+  void Walk (const Buffer &buffer);
+
+  Ptr<UniformRandomVariable> m_random;  //!< The random draws.
+};
+
+Olsr6PbbFuzzTestCase::Olsr6PbbFuzzTestCase ()
+  : TestCase ("Check the decoding of random and damaged RFC 5444 packets")
+{
+}
+
+PbbTlv
+Olsr6PbbFuzzTestCase::GetTlv (uint32_t numAddresses)
+{
+  PbbTlv tlv;
+  tlv.type = m_random->GetInteger (0, 255);
+  tlv.hasTypeExt = m_random->GetInteger (0, 1);
+  tlv.typeExt = tlv.hasTypeExt ? m_random->GetInteger (0, 255) : 0;
+  if (numAddresses > 0 && m_random->GetInteger (0, 1))
+    {
+      tlv.hasIndexStart = true;
+      tlv.indexStart = m_random->GetInteger (0, numAddresses - 1);
+      if (m_random->GetInteger (0, 1))
+        {
+          tlv.hasIndexStop = true;
+          tlv.indexStop = m_random->GetInteger (tlv.indexStart, numAddresses - 1);
+        }
+    }
+  tlv.hasValue = m_random->GetInteger (0, 2) > 0;
+  if (tlv.hasValue)
+    {
+      // Long values take an extended length
+      uint32_t length = m_random->GetInteger (0, 4) ? m_random->GetInteger (0, 8) : m_random->GetInteger (0, 600);
+      if (tlv.hasIndexStop && m_random->GetInteger (0, 1))
+        {
+          tlv.multiValue = true;
+          length = (tlv.indexStop - tlv.indexStart + 1) * m_random->GetInteger (0, 2);
+        }
+      for (uint32_t k = 0; k < length; k++)
+        {
+          tlv.value.push_back (m_random->GetInteger (0, 255));
+        }
+    }
+  return tlv;
+}
+
+PbbPacket
+Olsr6PbbFuzzTestCase::GetPacket (void)
+{
+  PbbPacket packet;
+  packet.hasSequenceNumber = m_random->GetInteger (0, 1);
+  packet.sequenceNumber = packet.hasSequenceNumber ? m_random->GetInteger (0, 0xffff) : 0;
+  for (uint32_t k = m_random->GetInteger (0, 2); k > 0; k--)
+    {
+      packet.tlvs.push_back (GetTlv (0));
+    }
+  for (uint32_t m = m_random->GetInteger (0, 3); m > 0; m--)
+    {
+      PbbMessage message;
+      message.type = m_random->GetInteger (0, 255);
+      message.hasOriginator = m_random->GetInteger (0, 1);
+      uint8_t bytes[16];
+      for (uint32_t k = 0; k < 16; k++)
+        {
+          bytes[k] = m_random->GetInteger (0, 255);
+        }
+      message.originator = message.hasOriginator ? Ipv6Address (bytes) : Ipv6Address ();
+      message.hasHopLimit = m_random->GetInteger (0, 1);
+      message.hopLimit = message.hasHopLimit ? m_random->GetInteger (0, 255) : 0;
+      message.hasHopCount = m_random->GetInteger (0, 1);
+      message.hopCount = message.hasHopCount ? m_random->GetInteger (0, 255) : 0;
+      message.hasSequenceNumber = m_random->GetInteger (0, 1);
+      message.sequenceNumber = message.hasSequenceNumber ? m_random->GetInteger (0, 0xffff) : 0;
+      for (uint32_t k = m_random->GetInteger (0, 2); k > 0; k--)
+        {
+          message.tlvs.push_back (GetTlv (0));
+        }
+
+      for (uint32_t b = m_random->GetInteger (0, 3); b > 0; b--)
+        {
+          // Addresses around a random one: random, in its /64, in its /56, or one byte off
+          PbbAddressBlock block;
+          uint8_t base[16];
+          for (uint32_t k = 0; k < 16; k++)
+            {
+              base[k] = m_random->GetInteger (0, 255);
+            }
+          uint32_t n = m_random->GetInteger (0, 7) ? m_random->GetInteger (1, 10) : m_random->GetInteger (1, 255);
+          for (uint32_t a = 0; a < n; a++)
+            {
+              std::copy (base, base + 16, bytes);
+              switch (m_random->GetInteger (0, 3))
+                {
+                case 0:
+                  for (uint32_t k = 0; k < 16; k++)
+                    {
+                      bytes[k] = m_random->GetInteger (0, 255);
+                    }
+                  break;
+                case 1:
+                  bytes[15] = m_random->GetInteger (0, 255);
+                  break;
+                case 2:
+                  bytes[7] = m_random->GetInteger (0, 255);
+                  std::fill (bytes + 8, bytes + 16, 0);
+                  break;
+                default:
+                  bytes[m_random->GetInteger (0, 15)] = m_random->GetInteger (0, 255);
+                }
+              block.addresses.push_back (Ipv6Address (bytes));
+            }
+          switch (m_random->GetInteger (0, 2))
+            {
+            case 1:
+              block.prefixLengths.push_back (m_random->GetInteger (0, 128));
+              break;
+            case 2:
+              for (uint32_t a = 0; a < n; a++)
+                {
+                  block.prefixLengths.push_back (m_random->GetInteger (0, 128));
+                }
+              break;
+            }
+          for (uint32_t k = m_random->GetInteger (0, 3); k > 0; k--)
+            {
+              block.tlvs.push_back (GetTlv (n));
+            }
+          message.addressBlocks.push_back (block);
+        }
+      packet.messages.push_back (message);
+    }
+  return packet;
+}
+
+void
+Olsr6PbbFuzzTestCase::Walk (const Buffer &buffer)
+{
+  PbbTlvView tlv;
+  PbbTlv copy;
+  PbbPacketReader reader (buffer.Begin (), buffer.GetSize ());
+  PbbTlvIterator tlvs = reader.GetTlvs ();
+  while (tlvs.Next (tlv))
+    {
+      tlv.CopyTo (copy);
+    }
+  PbbMessageView message;
+  while (reader.NextMessage (message))
+    {
+      while (message.tlvs.Next (tlv))
+        {
+          tlv.CopyTo (copy);
+        }
+      if (message.addressLength != 16)
+        {
+          continue;
+        }
+      if (message.HasOriginator ())
+        {
+          message.GetOriginator ();
+        }
+      PbbAddressBlockView block;
+      while (message.NextAddressBlock (block))
+        {
+          for (uint32_t k = 0; k < block.numAddresses; k++)
+            {
+              block.GetAddress (k);
+              if (block.GetNPrefixLengths () > 0)
+                {
+                  block.GetPrefixLength (k);
+                }
+            }
+          while (block.tlvs.Next (tlv))
+            {
+              tlv.CopyTo (copy);
+            }
+        }
+    }
+  PbbPacket packet;
+  packet.Deserialize (buffer.Begin ());
+}
+
+void
+Olsr6PbbFuzzTestCase::DoRun (void)
+{
+  m_random = CreateObject<UniformRandomVariable> ();
+  m_random->SetStream (1);
+
+  for (uint32_t run = 0; run < 1000; run++)
+    {
+      PbbPacket packetIn = GetPacket ();
+      uint32_t size = packetIn.GetSerializedSize ();
+      Buffer buffer;
+      buffer.AddAtStart (size);
+      packetIn.Serialize (buffer.Begin ());
+
+      PbbPacket packetOut;
+      NS_TEST_ASSERT_MSG_EQ (packetOut.Deserialize (buffer.Begin ()), size, "950 run " << run);
+      NS_TEST_ASSERT_MSG_EQ (IsEqual (packetIn, packetOut), true, "951 run " << run);
+
+      // Damaged copies: bit flips, overwritten bytes and cuts
+      std::vector<uint8_t> bytes (size);
+      buffer.CopyData (&bytes[0], size);
+      for (uint32_t damage = 0; damage < 10; damage++)
+        {
+          std::vector<uint8_t> damaged = bytes;
+          uint32_t damagedSize = size;
+          switch (m_random->GetInteger (0, 2))
+            {
+            case 0:
+              damaged[m_random->GetInteger (0, size - 1)] ^= 1 << m_random->GetInteger (0, 7);
+              break;
+            case 1:
+              for (uint32_t k = 0; k < 4; k++)
+                {
+                  damaged[m_random->GetInteger (0, size - 1)] = m_random->GetInteger (0, 255);
+                }
+              break;
+            default:
+              damagedSize = m_random->GetInteger (0, size);
+            }
+          Walk (MakeBuffer (damagedSize > 0 ? &damaged[0] : 0, damagedSize));
+        }
+    }
+}
+
+
+static class Olsr6PbbTestSuite : public TestSuite
+{
+public:
+  Olsr6PbbTestSuite ();
+} g_olsr6PbbTestSuite;
+
+Olsr6PbbTestSuite::Olsr6PbbTestSuite ()
+  : TestSuite ("routing-olsr6-packetbb", UNIT)
+{
+  AddTestCase (new Olsr6PbbEncodingTestCase (), TestCase::QUICK);
+  AddTestCase (new Olsr6PbbReaderTestCase (), TestCase::QUICK);
+  AddTestCase (new Olsr6PbbFuzzTestCase (), TestCase::QUICK);
+}
@@ -0,0 +1,279 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Ankit Deepak <adadeepak8@gmail.com>
+ *          Shravya Ks <shravya.ks0@gmail.com>,
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/ipv6-header.h"
+#include "ns3/ipv6-route.h"
+#include "ns3/olsr6-helper.h"
+#include "ns3/olsr6-routing-protocol.h"
+#include "ns3/olsr6-state.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/simple-net-device-helper.h"
+
+#include <limits>
+
+using namespace ns3;
+using namespace olsr6;
+
+/**
+ * Testcase for the MPR selection of each interface.  The node has the
+ * neighbor B on its first interface and C on its second one; the 2-hop
+ * neighbor X is reached through both, Y through C only.  C alone covers
+ * both 2-hop neighbors, but the first interface needs B to reach X.
+ */
+class Olsr6InterfaceMprTestCase : public TestCase
+{
+public:
+  Olsr6InterfaceMprTestCase ();
+  /// \brief Run test case
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Adds a symmetric neighbor.
+   * \param state The state.
+   * \param addr The main address of the neighbor.
+   */
+  static void AddNeighbor (Olsr6State &state, const char *addr);
+  /**
+   * \brief Adds a 2-hop neighbor.
+   * \param state The state.
+   * \param neighbor The main address of the neighbor.
+   * \param twoHop The main address of the 2-hop neighbor.
+   */
+  static void AddTwoHop (Olsr6State &state, const char *neighbor, const char *twoHop);
+};
+
+Olsr6InterfaceMprTestCase::Olsr6InterfaceMprTestCase ()
+  : TestCase ("Check the MPR selection of each interface")
+{
+}
+
+void
+Olsr6InterfaceMprTestCase::AddNeighbor (Olsr6State &state, const char *addr)
+{
+  NeighborTuple tuple;
+  tuple.neighborMainAddr = Ipv6Address (addr);
+  tuple.status = NeighborTuple::STATUS_SYM;
+  tuple.willingness = 3;
+  state.InsertNeighborTuple (tuple);
+}
+
+void
+Olsr6InterfaceMprTestCase::AddTwoHop (Olsr6State &state, const char *neighbor, const char *twoHop)
+{
+  TwoHopNeighborTuple tuple;
+  tuple.neighborMainAddr = Ipv6Address (neighbor);
+  tuple.twoHopNeighborAddr = Ipv6Address (twoHop);
+  tuple.expirationTime = Seconds (30);
+  state.InsertTwoHopNeighborTuple (tuple);
+}
+
+void
+Olsr6InterfaceMprTestCase::DoRun (void)
+{
+  Ipv6Address node ("2001:1::1");
+  Ipv6Address iface1 ("2001:1::1");
+  Ipv6Address iface2 ("2001:2::1");
+  Ipv6Address b ("2001:1::2");
+  Ipv6Address c ("2001:2::2");
+
+  Olsr6State state;
+  AddNeighbor (state, "2001:1::2");
+  AddNeighbor (state, "2001:2::2");
+  AddTwoHop (state, "2001:1::2", "2001:3::1");
+  AddTwoHop (state, "2001:2::2", "2001:3::1");
+  AddTwoHop (state, "2001:2::2", "2001:4::1");
+
+  MprSet mprSet = state.ComputeMprSet (node);
+  NS_TEST_EXPECT_MSG_EQ (mprSet.size (), 1, "C covers every 2-hop neighbor of the node");
+  NS_TEST_EXPECT_MSG_EQ ((mprSet.find (c) != mprSet.end ()), true, "C is the MPR of the node");
+
+  InterfaceNeighborCosts neighbors;
+  neighbors[iface1][b] = 1;
+  neighbors[iface2][c] = 2;
+
+  InterfaceMprSets mprSets = state.ComputeInterfaceMprSets (node, neighbors);
+  NS_TEST_EXPECT_MSG_EQ (mprSets.size (), 2, "Both interfaces have an MPR set");
+  NS_TEST_EXPECT_MSG_EQ (mprSets[iface1].size (), 1, "A single MPR on the first interface");
+  NS_TEST_EXPECT_MSG_EQ ((mprSets[iface1].find (b) != mprSets[iface1].end ()), true,
+                         "B is the MPR of the first interface");
+  NS_TEST_EXPECT_MSG_EQ (mprSets[iface2].size (), 1, "A single MPR on the second interface");
+  NS_TEST_EXPECT_MSG_EQ ((mprSets[iface2].find (c) != mprSets[iface2].end ()), true,
+                         "C is the MPR of the second interface");
+
+  mprSets = state.ComputeInterfaceEtxMprSets (node, neighbors);
+  NS_TEST_EXPECT_MSG_EQ (mprSets[iface1].size (), 1, "A single ETX MPR on the first interface");
+  NS_TEST_EXPECT_MSG_EQ ((mprSets[iface1].find (b) != mprSets[iface1].end ()), true,
+                         "B is the ETX MPR of the first interface");
+  NS_TEST_EXPECT_MSG_EQ (mprSets[iface2].size (), 1, "A single ETX MPR on the second interface");
+  NS_TEST_EXPECT_MSG_EQ ((mprSets[iface2].find (c) != mprSets[iface2].end ()), true,
+                         "C is the ETX MPR of the second interface");
+
+  // Without a symmetric link on the first interface, B is not selected there
+  neighbors[iface1][b] = std::numeric_limits<double>::infinity ();
+  mprSets = state.ComputeInterfaceEtxMprSets (node, neighbors);
+  NS_TEST_EXPECT_MSG_EQ (mprSets[iface1].size (), 0, "No ETX MPR on the first interface");
+}
+
+/**
+ * Testcase for the HELLO messages of the node A of the chain B - A - C,
+ * where A reaches B and C on two different interfaces.  The HELLO messages
+ * A sends to B list the link to B, and C with the UNSPEC_LINK link type
+ * only, which is enough for B to route to C through A.
+ */
+class Olsr6InterfaceHelloTestCase : public TestCase
+{
+public:
+  Olsr6InterfaceHelloTestCase ();
+  /// \brief Run test case
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Checks the HELLO messages of A received by B.
+   * \param header The OLSR6 packet header.
+   * \param messages The messages of the packet.
+   */
+  void ReceiveB (const PacketHeader &header, const MessageList &messages);
+  /// \brief Checks the route of B to C.
+  void Check (void);
+
+  Ptr<RoutingProtocol> m_b;  //!< The routing protocol of B.
+  Ipv6Address m_a;           //!< The main address of A.
+  Ipv6Address m_ab;          //!< The address of A on the link to B.
+  Ipv6Address m_ba;          //!< The address of B on the link to A.
+  Ipv6Address m_c;           //!< The address of C.
+  uint32_t m_hellos;         //!< Number of HELLO messages of A received by B.
+  uint32_t m_linkMessages;   //!< Number of link messages about the link to B.
+  uint32_t m_unspecMessages; //!< Number of link messages about C.
+};
+
+Olsr6InterfaceHelloTestCase::Olsr6InterfaceHelloTestCase ()
+  : TestCase ("Check the HELLO messages of each interface"),
+    m_hellos (0),
+    m_linkMessages (0),
+    m_unspecMessages (0)
+{
+}
+
+void
+Olsr6InterfaceHelloTestCase::ReceiveB (const PacketHeader &header, const MessageList &messages)
+{
+  for (MessageList::const_iterator msg = messages.begin (); msg != messages.end (); msg++)
+    {
+      if (msg->GetMessageType () != MessageHeader::HELLO_MESSAGE || msg->GetOriginatorAddress () != m_a)
+        {
+          continue;
+        }
+      m_hellos++;
+      const MessageHeader::Hello &hello = msg->GetHello ();
+      for (std::vector<MessageHeader::Hello::LinkMessage>::const_iterator linkMessage = hello.linkMessages.begin ();
+           linkMessage != hello.linkMessages.end (); linkMessage++)
+        {
+          NS_TEST_EXPECT_MSG_EQ (linkMessage->neighborInterfaceAddresses.size (), 1, "One address per link message");
+          if ((linkMessage->linkCode & 0x03) == 0)
+            {
+              NS_TEST_EXPECT_MSG_EQ (linkMessage->neighborInterfaceAddresses[0], m_c,
+                                     "C is reached through the other interface");
+              m_unspecMessages++;
+            }
+          else
+            {
+              NS_TEST_EXPECT_MSG_EQ (linkMessage->neighborInterfaceAddresses[0], m_ba,
+                                     "The link to B is the only link of the interface");
+              m_linkMessages++;
+            }
+        }
+    }
+}
+
+void
+Olsr6InterfaceHelloTestCase::Check (void)
+{
+  Ptr<Ipv6RoutingProtocol> routing = m_b;
+  Ipv6Header header;
+  header.SetSourceAddress (m_ba);
+  header.SetDestinationAddress (m_c);
+  Socket::SocketErrno sockerr;
+  Ptr<Ipv6Route> route = routing->RouteOutput (Create<Packet> (), header, 0, sockerr);
+  NS_TEST_ASSERT_MSG_NE (route, 0, "B has a route to C");
+  NS_TEST_EXPECT_MSG_EQ (route->GetGateway (), m_ab, "C is reached through A");
+}
+
+void
+Olsr6InterfaceHelloTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (3);
+
+  Olsr6Helper olsr6;
+  InternetStackHelper internet;
+  internet.SetRoutingHelper (olsr6);
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper simpleNetHelper;
+  simpleNetHelper.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  simpleNetHelper.SetChannelAttribute ("Delay", StringValue ("2ms"));
+
+  // A, B, C are the nodes 0, 1, 2
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase ("2001:1::", Ipv6Prefix (64));
+  Ipv6InterfaceContainer ab = ipv6.Assign (simpleNetHelper.Install (NodeContainer (nodes.Get (0), nodes.Get (1))));
+  ipv6.NewNetwork ();
+  Ipv6InterfaceContainer ac = ipv6.Assign (simpleNetHelper.Install (NodeContainer (nodes.Get (0), nodes.Get (2))));
+
+  m_a = ab.GetAddress (0, 1);
+  m_ab = ab.GetAddress (0, 1);
+  m_ba = ab.GetAddress (1, 1);
+  m_c = ac.GetAddress (1, 1);
+  m_b = Olsr6Helper::GetOlsr6RoutingProtocol (nodes.Get (1));
+  m_b->TraceConnectWithoutContext ("Rx", MakeCallback (&Olsr6InterfaceHelloTestCase::ReceiveB, this));
+
+  Simulator::Schedule (Seconds (20), &Olsr6InterfaceHelloTestCase::Check, this);
+  Simulator::Stop (Seconds (21));
+  Simulator::Run ();
+  Simulator::Destroy ();
+  m_b = 0;
+
+  NS_TEST_EXPECT_MSG_GT (m_hellos, 0, "B receives the HELLO messages of A");
+  NS_TEST_EXPECT_MSG_GT (m_linkMessages, 0, "A advertises its link to B");
+  NS_TEST_EXPECT_MSG_GT (m_unspecMessages, 0, "A advertises C to B");
+}
+
+static class Olsr6PerInterfaceTestSuite : public TestSuite
+{
+public:
+  Olsr6PerInterfaceTestSuite ();
+} g_olsr6PerInterfaceTestSuite;
+
+Olsr6PerInterfaceTestSuite::Olsr6PerInterfaceTestSuite ()
+  : TestSuite ("routing-olsr6-per-interface", UNIT)
+{
+  AddTestCase (new Olsr6InterfaceMprTestCase (), TestCase::QUICK);
+  AddTestCase (new Olsr6InterfaceHelloTestCase (), TestCase::QUICK);
+}
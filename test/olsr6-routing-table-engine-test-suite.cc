@@ -0,0 +1,189 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Ankit Deepak <adadeepak8@gmail.com>
+ *          Shravya Ks <shravya.ks0@gmail.com>,
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/olsr6-helper.h"
+#include "ns3/olsr6-routing-protocol.h"
+#include "ns3/olsr6-routing-table-engine.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/simple-net-device-helper.h"
+
+using namespace ns3;
+using namespace olsr6;
+
+/**
+ * Testcase comparing the routing tables computed offline by the
+ * RoutingTableEngine with the ones built by OLSR6 in a simulation, on the
+ * tree A - B - C - {D, E}.
+ */
+class Olsr6RoutingTableEngineTestCase : public TestCase
+{
+public:
+  Olsr6RoutingTableEngineTestCase ();
+  /// \brief Run test case
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Adds an interface of the simulation to a node of the network topology.
+   * \param node The index of the node in the topology.
+   * \param interfaces The container holding the interface.
+   * \param i The position of the interface in the container.
+   */
+  void AddInterface (uint32_t node, const Ipv6InterfaceContainer &interfaces, uint32_t i);
+  /// Compares the engine with the simulated routing tables.
+  void CheckRoutingTables (void);
+
+  NodeContainer m_nodes;       //!< Nodes A, B, C, D and E.
+  NetworkTopology m_topology;  //!< The same network, for the engine.
+};
+
+Olsr6RoutingTableEngineTestCase::Olsr6RoutingTableEngineTestCase ()
+  : TestCase ("Check the OLSR6 routing table engine against a simulation")
+{
+}
+
+void
+Olsr6RoutingTableEngineTestCase::AddInterface (uint32_t node, const Ipv6InterfaceContainer &interfaces, uint32_t i)
+{
+  m_topology.AddInterface (node, interfaces.GetAddress (i, 1), interfaces.GetInterfaceIndex (i));
+}
+
+void
+Olsr6RoutingTableEngineTestCase::CheckRoutingTables (void)
+{
+  RoutingTableEngine engine;
+  engine.Compute (m_topology);
+  NS_TEST_ASSERT_MSG_EQ (engine.GetNNodes (), m_nodes.GetN (), "Every node should be computed");
+
+  for (uint32_t node = 0; node < m_nodes.GetN (); node++)
+    {
+      Ptr<RoutingProtocol> olsr6 =
+        DynamicCast<RoutingProtocol> (m_nodes.Get (node)->GetObject<Ipv6> ()->GetRoutingProtocol ());
+      NS_ASSERT (olsr6 != 0);
+      std::vector<RoutingTableEntry> simulated = olsr6->GetRoutingTableEntries ();
+      const std::vector<RoutingTableEntry> &computed = engine.GetRoutingTableEntries (node);
+
+      // 8 interface addresses in the network
+      NS_TEST_EXPECT_MSG_EQ (simulated.size (), 8 - m_topology.nodes[node].interfaces.size (),
+                             "Node " << node << " should reach every other interface");
+      NS_TEST_ASSERT_MSG_EQ (computed.size (), simulated.size (), "Routing table size of node " << node);
+      for (uint32_t i = 0; i < computed.size (); i++)
+        {
+          NS_TEST_EXPECT_MSG_EQ (computed[i].destAddr, simulated[i].destAddr, "Destination of node " << node);
+          NS_TEST_EXPECT_MSG_EQ (computed[i].nextAddr, simulated[i].nextAddr,
+                                 "Next hop of node " << node << " to " << simulated[i].destAddr);
+          NS_TEST_EXPECT_MSG_EQ (computed[i].interface, simulated[i].interface,
+                                 "Interface of node " << node << " to " << simulated[i].destAddr);
+          NS_TEST_EXPECT_MSG_EQ (computed[i].distance, simulated[i].distance,
+                                 "Distance of node " << node << " to " << simulated[i].destAddr);
+        }
+    }
+
+  // The results must not depend on the number of threads
+  RoutingTableEngine parallel;
+  parallel.SetNThreads (4);
+  parallel.Compute (m_topology);
+  for (uint32_t node = 0; node < m_nodes.GetN (); node++)
+    {
+      NS_TEST_EXPECT_MSG_EQ ((parallel.GetMprSet (node) == engine.GetMprSet (node)), true,
+                             "MPR set of node " << node << " depends on the number of threads");
+      const std::vector<RoutingTableEntry> &a = engine.GetRoutingTableEntries (node);
+      const std::vector<RoutingTableEntry> &b = parallel.GetRoutingTableEntries (node);
+      NS_TEST_ASSERT_MSG_EQ (a.size (), b.size (), "Routing table of node " << node << " depends on the number of threads");
+      for (uint32_t i = 0; i < a.size (); i++)
+        {
+          NS_TEST_EXPECT_MSG_EQ (a[i].destAddr, b[i].destAddr, "Destination depends on the number of threads");
+          NS_TEST_EXPECT_MSG_EQ (a[i].nextAddr, b[i].nextAddr, "Next hop depends on the number of threads");
+          NS_TEST_EXPECT_MSG_EQ (a[i].distance, b[i].distance, "Distance depends on the number of threads");
+        }
+    }
+}
+
+void
+Olsr6RoutingTableEngineTestCase::DoRun (void)
+{
+  m_nodes.Create (5);
+
+  Olsr6Helper olsr6;
+  InternetStackHelper internet;
+  internet.SetRoutingHelper (olsr6);
+  internet.Install (m_nodes);
+
+  // One channel per link: A - B - C - D and C - E
+  SimpleNetDeviceHelper simpleNetHelper;
+  simpleNetHelper.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  simpleNetHelper.SetChannelAttribute ("Delay", StringValue ("2ms"));
+
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase ("2001:1::", Ipv6Prefix (64));
+  Ipv6InterfaceContainer ab = ipv6.Assign (simpleNetHelper.Install (NodeContainer (m_nodes.Get (0), m_nodes.Get (1))));
+  ipv6.NewNetwork ();
+  Ipv6InterfaceContainer bc = ipv6.Assign (simpleNetHelper.Install (NodeContainer (m_nodes.Get (1), m_nodes.Get (2))));
+  ipv6.NewNetwork ();
+  Ipv6InterfaceContainer cd = ipv6.Assign (simpleNetHelper.Install (NodeContainer (m_nodes.Get (2), m_nodes.Get (3))));
+  ipv6.NewNetwork ();
+  Ipv6InterfaceContainer ce = ipv6.Assign (simpleNetHelper.Install (NodeContainer (m_nodes.Get (2), m_nodes.Get (4))));
+
+  // Default willingness (3); interfaces in interface index order, so that
+  // the first one holds the main address chosen by the protocol
+  uint32_t a = m_topology.AddNode (3);
+  AddInterface (a, ab, 0);
+  uint32_t b = m_topology.AddNode (3);
+  AddInterface (b, ab, 1);
+  AddInterface (b, bc, 0);
+  uint32_t c = m_topology.AddNode (3);
+  AddInterface (c, bc, 1);
+  AddInterface (c, cd, 0);
+  AddInterface (c, ce, 0);
+  uint32_t d = m_topology.AddNode (3);
+  AddInterface (d, cd, 1);
+  uint32_t e = m_topology.AddNode (3);
+  AddInterface (e, ce, 1);
+
+  m_topology.AddLink (ab.GetAddress (0, 1), ab.GetAddress (1, 1));
+  m_topology.AddLink (bc.GetAddress (0, 1), bc.GetAddress (1, 1));
+  m_topology.AddLink (cd.GetAddress (0, 1), cd.GetAddress (1, 1));
+  m_topology.AddLink (ce.GetAddress (0, 1), ce.GetAddress (1, 1));
+
+  // Leave time for HELLO, TC and MID messages to converge
+  Simulator::Schedule (Seconds (40), &Olsr6RoutingTableEngineTestCase::CheckRoutingTables, this);
+  Simulator::Stop (Seconds (41));
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+static class Olsr6RoutingTableEngineTestSuite : public TestSuite
+{
+public:
+  Olsr6RoutingTableEngineTestSuite ();
+} g_olsr6RoutingTableEngineTestSuite;
+
+Olsr6RoutingTableEngineTestSuite::Olsr6RoutingTableEngineTestSuite ()
+  : TestSuite ("routing-olsr6-engine", UNIT)
+{
+  AddTestCase (new Olsr6RoutingTableEngineTestCase (), TestCase::QUICK);
+}
@@ -0,0 +1,128 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Ankit Deepak <adadeepak8@gmail.com>
+ *          Shravya Ks <shravya.ks0@gmail.com>,
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/olsr6-helper.h"
+#include "ns3/olsr6-rx-trace-helper.h"
+#include "ns3/olsr6-routing-protocol.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/simple-net-device-helper.h"
+
+#include <cstdio>
+
+using namespace ns3;
+using namespace olsr6;
+
+/**
+ * Testcase recording the packets received by B in the chain A - B - C,
+ * replaying them and checking that the replayed routing table is the one
+ * B built in the simulation.
+ */
+class Olsr6RxTraceTestCase : public TestCase
+{
+public:
+  Olsr6RxTraceTestCase ();
+  /// \brief Run test case
+  virtual void DoRun (void);
+};
+
+Olsr6RxTraceTestCase::Olsr6RxTraceTestCase ()
+  : TestCase ("Check that replaying the recorded packets of a node rebuilds its routing table")
+{
+}
+
+void
+Olsr6RxTraceTestCase::DoRun (void)
+{
+  std::string filename = CreateTempDirFilename ("olsr6-rx-trace.bin");
+
+  NodeContainer nodes;
+  nodes.Create (3);
+
+  Olsr6Helper olsr6;
+  InternetStackHelper internet;
+  internet.SetRoutingHelper (olsr6);
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper simpleNetHelper;
+  simpleNetHelper.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  simpleNetHelper.SetChannelAttribute ("Delay", StringValue ("2ms"));
+
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase ("2001:1::", Ipv6Prefix (64));
+  ipv6.Assign (simpleNetHelper.Install (NodeContainer (nodes.Get (0), nodes.Get (1))));
+  ipv6.NewNetwork ();
+  ipv6.Assign (simpleNetHelper.Install (NodeContainer (nodes.Get (1), nodes.Get (2))));
+
+  Olsr6RxTraceRecorder recorder;
+  recorder.Record (nodes.Get (1), filename);
+
+  Simulator::Stop (Seconds (20));
+  Simulator::Run ();
+  recorder.Stop ();
+  std::vector<RoutingTableEntry> simulated =
+    Olsr6Helper::GetOlsr6RoutingProtocol (nodes.Get (1))->GetRoutingTableEntries ();
+  uint32_t nPackets = recorder.GetNPackets ();
+  Simulator::Destroy ();
+
+  // B reaches A and C directly
+  NS_TEST_ASSERT_MSG_EQ (simulated.size (), 2, "B should have a route to A and C");
+  NS_TEST_ASSERT_MSG_GT (nPackets, 0, "B should have received packets");
+
+  Olsr6RxTraceReplay replay;
+  replay.Load (filename);
+  NS_TEST_ASSERT_MSG_EQ (replay.GetNPackets (), nPackets, "Every recorded packet should be loaded");
+
+  // Twice, to check that a replay leaves nothing behind
+  for (uint32_t i = 0; i < 2; i++)
+    {
+      replay.Replay ();
+      NS_TEST_EXPECT_MSG_GT (replay.GetNMessages (), nPackets - 1, "Every packet holds at least one message");
+      std::vector<RoutingTableEntry> replayed = replay.GetRoutingTableEntries ();
+      NS_TEST_ASSERT_MSG_EQ (replayed.size (), simulated.size (), "Replayed routing table size");
+      for (uint32_t j = 0; j < replayed.size (); j++)
+        {
+          NS_TEST_EXPECT_MSG_EQ (replayed[j].destAddr, simulated[j].destAddr, "Replayed destination");
+          NS_TEST_EXPECT_MSG_EQ (replayed[j].nextAddr, simulated[j].nextAddr, "Replayed next hop");
+          NS_TEST_EXPECT_MSG_EQ (replayed[j].interface, simulated[j].interface, "Replayed interface");
+          NS_TEST_EXPECT_MSG_EQ (replayed[j].distance, simulated[j].distance, "Replayed distance");
+        }
+    }
+
+  std::remove (filename.c_str ());
+}
+
+static class Olsr6RxTraceTestSuite : public TestSuite
+{
+public:
+  Olsr6RxTraceTestSuite ();
+} g_olsr6RxTraceTestSuite;
+
+Olsr6RxTraceTestSuite::Olsr6RxTraceTestSuite ()
+  : TestSuite ("routing-olsr6-rx-trace", UNIT)
+{
+  AddTestCase (new Olsr6RxTraceTestCase (), TestCase::QUICK);
+}
@@ -0,0 +1,196 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Ankit Deepak <adadeepak8@gmail.com>
+ *          Shravya Ks <shravya.ks0@gmail.com>,
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/socket.h"
+#include "ns3/inet6-socket-address.h"
+#include "ns3/olsr6-helper.h"
+#include "ns3/olsr6-routing-protocol.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/simple-net-device-helper.h"
+
+#include <sstream>
+#include <vector>
+
+using namespace ns3;
+using namespace olsr6;
+
+/**
+ * Testcase for the relay of multicast data packets on the chain
+ * A - B - C - D, A sending to ff05::1.  Every node receives each packet
+ * once; with classical flooding B, C and D relay it, with s-mpr D does not
+ * as C has not selected it as MPR.
+ */
+class Olsr6SmfTestCase : public TestCase
+{
+public:
+  /**
+   * \param algorithm The MulticastRelay attribute of the nodes.
+   * \param relays The expected relays of each packet.
+   */
+  Olsr6SmfTestCase (std::string algorithm, uint32_t relays);
+  /// \brief Run test case
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \param algorithm The MulticastRelay attribute of the nodes.
+   * \returns The name of the test case.
+   */
+  static std::string GetName (std::string algorithm);
+  /**
+   * \brief Sends a multicast packet whose first byte is its number.
+   * \param socket The socket of A.
+   * \param number The number of the packet.
+   */
+  void Send (Ptr<Socket> socket, uint8_t number);
+  /**
+   * \brief Receives the packets of a node.
+   * \param socket The socket of the node.
+   */
+  void Receive (Ptr<Socket> socket);
+  /**
+   * \brief Counts the relays.
+   * \param packet The packet relayed.
+   * \param header Its IPv6 header.
+   */
+  void Relay (Ptr<const Packet> packet, const Ipv6Header &header);
+
+  std::string m_algorithm;           //!< The MulticastRelay attribute of the nodes.
+  uint32_t m_relays;                 //!< The expected relays of each packet.
+  std::vector<uint32_t> m_received;  //!< Packets received by each node.
+  uint32_t m_relayed;                //!< Relays of the packets.
+};
+
+std::string
+Olsr6SmfTestCase::GetName (std::string algorithm)
+{
+  std::ostringstream oss;
+  oss << "Check the multicast relays with MulticastRelay " << algorithm;
+  return oss.str ();
+}
+
+Olsr6SmfTestCase::Olsr6SmfTestCase (std::string algorithm, uint32_t relays)
+  : TestCase (GetName (algorithm)),
+    m_algorithm (algorithm),
+    m_relays (relays),
+    m_relayed (0)
+{
+}
+
+void
+Olsr6SmfTestCase::Send (Ptr<Socket> socket, uint8_t number)
+{
+  uint8_t payload[64] = { number };
+  socket->SendTo (Create<Packet> (payload, sizeof (payload)), 0,
+                  Inet6SocketAddress (Ipv6Address ("ff05::1"), 9));
+}
+
+void
+Olsr6SmfTestCase::Receive (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet;
+  while ((packet = socket->Recv ()))
+    {
+      m_received[socket->GetNode ()->GetId ()]++;
+    }
+}
+
+void
+Olsr6SmfTestCase::Relay (Ptr<const Packet> packet, const Ipv6Header &header)
+{
+  m_relayed++;
+}
+
+void
+Olsr6SmfTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (4);
+
+  Olsr6Helper olsr6;
+  olsr6.Set ("MulticastRelay", StringValue (m_algorithm));
+  InternetStackHelper internet;
+  internet.SetRoutingHelper (olsr6);
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper simpleNetHelper;
+  simpleNetHelper.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  simpleNetHelper.SetChannelAttribute ("Delay", StringValue ("2ms"));
+
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase ("2001:1::", Ipv6Prefix (64));
+  for (uint32_t i = 0; i + 1 < nodes.GetN (); i++)
+    {
+      ipv6.Assign (simpleNetHelper.Install (NodeContainer (nodes.Get (i), nodes.Get (i + 1))));
+      ipv6.NewNetwork ();
+    }
+
+  TypeId tid = TypeId::LookupByName ("ns3::UdpSocketFactory");
+  m_received.assign (nodes.GetN (), 0);
+  for (uint32_t i = 1; i < nodes.GetN (); i++)
+    {
+      Ptr<Socket> socket = Socket::CreateSocket (nodes.Get (i), tid);
+      socket->Bind (Inet6SocketAddress (Ipv6Address::GetAny (), 9));
+      socket->SetRecvCallback (MakeCallback (&Olsr6SmfTestCase::Receive, this));
+    }
+  for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+      Olsr6Helper::GetOlsr6RoutingProtocol (nodes.Get (i))->TraceConnectWithoutContext (
+        "MulticastRelay", MakeCallback (&Olsr6SmfTestCase::Relay, this));
+    }
+
+  Ptr<Socket> source = Socket::CreateSocket (nodes.Get (0), tid);
+  source->Bind6 ();
+  for (uint8_t i = 0; i < 5; i++)
+    {
+      Simulator::Schedule (Seconds (40 + i), &Olsr6SmfTestCase::Send, this, source, i);
+    }
+
+  Simulator::Stop (Seconds (50));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  for (uint32_t i = 1; i < nodes.GetN (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_received[i], 5, "Every node receives each packet once");
+    }
+  NS_TEST_EXPECT_MSG_EQ (m_relayed, 5 * m_relays, "Relays of the packets");
+}
+
+static class Olsr6SmfTestSuite : public TestSuite
+{
+public:
+  Olsr6SmfTestSuite ();
+} g_olsr6SmfTestSuite;
+
+Olsr6SmfTestSuite::Olsr6SmfTestSuite ()
+  : TestSuite ("routing-olsr6-smf", UNIT)
+{
+  AddTestCase (new Olsr6SmfTestCase ("cf", 3), TestCase::QUICK);
+  AddTestCase (new Olsr6SmfTestCase ("s-mpr", 2), TestCase::QUICK);
+}
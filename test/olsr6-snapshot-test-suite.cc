@@ -0,0 +1,207 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Ankit Deepak <adadeepak8@gmail.com>
+ *          Shravya Ks <shravya.ks0@gmail.com>,
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+
+#include "ns3/test.h"
+#include "ns3/olsr6-state.h"
+
+#include <sstream>
+
+using namespace ns3;
+using namespace olsr6;
+
+/// Testcase for the save / restore round trip of an Olsr6State
+class Olsr6SnapshotTestCase : public TestCase
+{
+public:
+  Olsr6SnapshotTestCase ();
+  /// \brief Run test case
+  virtual void DoRun (void);
+};
+
+Olsr6SnapshotTestCase::Olsr6SnapshotTestCase ()
+  : TestCase ("Check OLSR6 state snapshot and expiry rebasing")
+{
+}
+void
+Olsr6SnapshotTestCase::DoRun (void)
+{
+  Olsr6State state;
+
+  LinkTuple link;
+  link.localIfaceAddr = Ipv6Address ("2001:1::1");
+  link.neighborIfaceAddr = Ipv6Address ("2001:1::2");
+  link.symTime = Seconds (12);
+  link.asymTime = Seconds (13);
+  link.time = Seconds (14);
+  link.quality = 0.375;
+  link.pending = true;
+  link.lostTime = Seconds (11);
+  link.helloInterval = Seconds (2);
+  link.helloDeadline = Seconds (13);
+  link.helloHistory = 0x2d;
+  link.helloHistoryLength = 6;
+  link.lq = 0.625;
+  link.nlq = 0.75;
+  state.InsertLinkTuple (link);
+
+  NeighborTuple neighbor;
+  neighbor.neighborMainAddr = Ipv6Address ("2001:1::2");
+  neighbor.status = NeighborTuple::STATUS_SYM;
+  neighbor.willingness = 6;
+  state.InsertNeighborTuple (neighbor);
+
+  TwoHopNeighborTuple twoHop;
+  twoHop.neighborMainAddr = Ipv6Address ("2001:1::2");
+  twoHop.twoHopNeighborAddr = Ipv6Address ("2001:1::3");
+  twoHop.expirationTime = Seconds (15);
+  twoHop.cost = 2.5;
+  state.InsertTwoHopNeighborTuple (twoHop);
+
+  TopologyTuple topology;
+  topology.destAddr = Ipv6Address ("2001:1::4");
+  topology.lastAddr = Ipv6Address ("2001:1::3");
+  topology.sequenceNumber = 42;
+  topology.expirationTime = Seconds (16);
+  topology.cost = 1.25;
+  state.InsertTopologyTuple (topology);
+
+  MprSet mprSet;
+  mprSet.insert (Ipv6Address ("2001:1::2"));
+  state.SetMprSet (mprSet);
+
+  MprSelectorTuple mprSelector;
+  mprSelector.mainAddr = Ipv6Address ("2001:1::2");
+  mprSelector.expirationTime = Seconds (17);
+  state.InsertMprSelectorTuple (mprSelector);
+
+  DuplicateTuple duplicate;
+  duplicate.address = Ipv6Address ("2001:1::4");
+  duplicate.sequenceNumber = 7;
+  duplicate.retransmitted = true;
+  duplicate.ifaceList.push_back (Ipv6Address ("2001:1::1"));
+  duplicate.expirationTime = Seconds (5);
+  state.InsertDuplicateTuple (duplicate);
+
+  IfaceAssocTuple ifaceAssoc;
+  ifaceAssoc.ifaceAddr = Ipv6Address ("2001:2::4");
+  ifaceAssoc.mainAddr = Ipv6Address ("2001:1::4");
+  ifaceAssoc.time = Seconds (18);
+  state.InsertIfaceAssocTuple (ifaceAssoc);
+
+  AssociationTuple association;
+  association.gatewayAddr = Ipv6Address ("2001:1::4");
+  association.networkAddr = Ipv6Address ("2001:3::");
+  association.netmask = Ipv6Prefix (64);
+  association.expirationTime = Seconds (19);
+  association.capacity = 100;
+  association.load = 64;
+  state.InsertAssociationTuple (association);
+
+  Association local;
+  local.networkAddr = Ipv6Address ("2001:4::");
+  local.netmask = Ipv6Prefix (48);
+  state.InsertAssociation (local);
+
+  // Save at t=10s, restore at t=100s: every expiry must move by 90s.
+  std::stringstream snapshot;
+  SnapshotWriter writer (snapshot, Seconds (10));
+  state.Serialize (writer);
+  NS_TEST_ASSERT_MSG_EQ (writer.IsGood (), true, "Snapshot could not be written");
+
+  Olsr6State restored;
+  SnapshotReader reader (snapshot, Seconds (100));
+  NS_TEST_ASSERT_MSG_EQ (restored.Deserialize (reader), true, "Snapshot could not be read");
+
+  NS_TEST_ASSERT_MSG_EQ (restored.GetLinks ().size (), 1, "Link Set not restored");
+  const LinkTuple &l = restored.GetLinks ()[0];
+  NS_TEST_EXPECT_MSG_EQ ((l == link), true, "Link tuple differs");
+  NS_TEST_EXPECT_MSG_EQ (l.symTime, Seconds (102), "symTime not rebased");
+  NS_TEST_EXPECT_MSG_EQ (l.asymTime, Seconds (103), "asymTime not rebased");
+  NS_TEST_EXPECT_MSG_EQ (l.time, Seconds (104), "time not rebased");
+  NS_TEST_EXPECT_MSG_EQ (l.quality, 0.375, "quality not restored");
+  NS_TEST_EXPECT_MSG_EQ (l.pending, true, "pending not restored");
+  NS_TEST_EXPECT_MSG_EQ (l.lostTime, Seconds (101), "lostTime not rebased");
+  NS_TEST_EXPECT_MSG_EQ (l.helloInterval, Seconds (2), "helloInterval must not be rebased");
+  NS_TEST_EXPECT_MSG_EQ (l.helloDeadline, Seconds (103), "helloDeadline not rebased");
+  NS_TEST_EXPECT_MSG_EQ (l.helloHistory, 0x2d, "helloHistory not restored");
+  NS_TEST_EXPECT_MSG_EQ (l.helloHistoryLength, 6, "helloHistoryLength not restored");
+  NS_TEST_EXPECT_MSG_EQ (l.lq, 0.625, "lq not restored");
+  NS_TEST_EXPECT_MSG_EQ (l.nlq, 0.75, "nlq not restored");
+
+  NS_TEST_ASSERT_MSG_EQ (restored.GetNeighbors ().size (), 1, "Neighbor Set not restored");
+  NS_TEST_EXPECT_MSG_EQ ((restored.GetNeighbors ()[0] == neighbor), true, "Neighbor tuple differs");
+
+  NS_TEST_ASSERT_MSG_EQ (restored.GetTwoHopNeighbors ().size (), 1, "2-hop Neighbor Set not restored");
+  NS_TEST_EXPECT_MSG_EQ ((restored.GetTwoHopNeighbors ()[0] == twoHop), true, "2-hop tuple differs");
+  NS_TEST_EXPECT_MSG_EQ (restored.GetTwoHopNeighbors ()[0].expirationTime, Seconds (105), "2-hop expiry not rebased");
+  NS_TEST_EXPECT_MSG_EQ (restored.GetTwoHopNeighbors ()[0].cost, 2.5, "2-hop cost not restored");
+
+  NS_TEST_ASSERT_MSG_EQ (restored.GetTopologySet ().size (), 1, "Topology Set not restored");
+  NS_TEST_EXPECT_MSG_EQ ((restored.GetTopologySet ()[0] == topology), true, "Topology tuple differs");
+  NS_TEST_EXPECT_MSG_EQ (restored.GetTopologySet ()[0].expirationTime, Seconds (106), "Topology expiry not rebased");
+  NS_TEST_EXPECT_MSG_EQ (restored.GetTopologySet ()[0].cost, 1.25, "Topology cost not restored");
+
+  NS_TEST_EXPECT_MSG_EQ (restored.FindMprAddress (Ipv6Address ("2001:1::2")), true, "MPR Set not restored");
+
+  NS_TEST_ASSERT_MSG_EQ (restored.GetMprSelectors ().size (), 1, "MPR Selector Set not restored");
+  NS_TEST_EXPECT_MSG_EQ (restored.GetMprSelectors ()[0].expirationTime, Seconds (107), "MPR selector expiry not rebased");
+
+  DuplicateTuple *dup = restored.FindDuplicateTuple (Ipv6Address ("2001:1::4"), 7);
+  NS_TEST_ASSERT_MSG_NE (dup, 0, "Duplicate Set not restored");
+  NS_TEST_EXPECT_MSG_EQ (dup->retransmitted, true, "Duplicate tuple differs");
+  NS_TEST_EXPECT_MSG_EQ (dup->ifaceList.size (), 1, "Duplicate interface list not restored");
+  NS_TEST_EXPECT_MSG_EQ (dup->expirationTime, Seconds (95), "Duplicate expiry not rebased");
+
+  const IfaceAssocTuple *ia = restored.FindIfaceAssocTuple (Ipv6Address ("2001:2::4"));
+  NS_TEST_ASSERT_MSG_NE (ia, 0, "Interface Association Set not restored");
+  NS_TEST_EXPECT_MSG_EQ (ia->mainAddr, Ipv6Address ("2001:1::4"), "Interface association tuple differs");
+  NS_TEST_EXPECT_MSG_EQ (ia->time, Seconds (108), "Interface association expiry not rebased");
+
+  NS_TEST_ASSERT_MSG_EQ (restored.GetAssociationSet ().size (), 1, "Association Set not restored");
+  NS_TEST_EXPECT_MSG_EQ ((restored.GetAssociationSet ()[0] == association), true, "Association tuple differs");
+  NS_TEST_EXPECT_MSG_EQ (restored.GetAssociationSet ()[0].expirationTime, Seconds (109), "Association expiry not rebased");
+  NS_TEST_EXPECT_MSG_EQ (restored.GetAssociationSet ()[0].capacity, 100, "Association capacity not restored");
+  NS_TEST_EXPECT_MSG_EQ ((uint32_t) restored.GetAssociationSet ()[0].load, 64, "Association load not restored");
+
+  NS_TEST_ASSERT_MSG_EQ (restored.GetAssociations ().size (), 1, "Local associations not restored");
+  NS_TEST_EXPECT_MSG_EQ ((restored.GetAssociations ()[0] == local), true, "Local association differs");
+
+  // A truncated snapshot must be detected
+  std::string bytes = snapshot.str ();
+  std::stringstream truncated (bytes.substr (0, bytes.size () - 3));
+  SnapshotReader truncatedReader (truncated, Seconds (100));
+  Olsr6State partial;
+  NS_TEST_EXPECT_MSG_EQ (partial.Deserialize (truncatedReader), false, "Truncated snapshot not detected");
+}
+
+static class Olsr6SnapshotTestSuite : public TestSuite
+{
+public:
+  Olsr6SnapshotTestSuite ();
+} g_olsr6SnapshotTestSuite;
+
+Olsr6SnapshotTestSuite::Olsr6SnapshotTestSuite ()
+  : TestSuite ("routing-olsr6-snapshot", UNIT)
+{
+  AddTestCase (new Olsr6SnapshotTestCase (), TestCase::QUICK);
+}
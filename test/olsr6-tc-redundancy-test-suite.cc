@@ -0,0 +1,167 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Ankit Deepak <adadeepak8@gmail.com>
+ *          Shravya Ks <shravya.ks0@gmail.com>,
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/uinteger.h"
+#include "ns3/nstime.h"
+#include "ns3/olsr6-helper.h"
+#include "ns3/olsr6-routing-protocol.h"
+#include "ns3/olsr6-state.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/simple-net-device-helper.h"
+
+#include <sstream>
+
+using namespace ns3;
+using namespace olsr6;
+
+/**
+ * Testcase checking, on the chain A - B - C - D, the links D learns from
+ * TC messages for each TC_REDUNDANCY level.
+ *
+ * - 0: B advertises A and C, C advertises B and D.
+ * - 1: A also advertises its MPR B.
+ * - 2: A also advertises its symmetric neighbor B.
+ */
+class Olsr6TcRedundancyTestCase : public TestCase
+{
+public:
+  /**
+   * \param redundancy The TC_REDUNDANCY level.
+   * \param nLinks The expected size of the topology set of D.
+   */
+  Olsr6TcRedundancyTestCase (uint32_t redundancy, uint32_t nLinks);
+  /// \brief Run test case
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Counts the TC messages originated by A.
+   * \param header The packet header.
+   * \param messages The messages of the packet.
+   */
+  void Tx (const PacketHeader &header, const MessageList &messages);
+
+  /**
+   * \param redundancy The TC_REDUNDANCY level.
+   * \returns The name of the test case.
+   */
+  static std::string GetName (uint32_t redundancy);
+
+  uint32_t m_redundancy;  //!< The TC_REDUNDANCY level.
+  uint32_t m_nLinks;      //!< The expected size of the topology set of D.
+  uint32_t m_nTc;         //!< TC messages originated by A.
+};
+
+std::string
+Olsr6TcRedundancyTestCase::GetName (uint32_t redundancy)
+{
+  std::ostringstream oss;
+  oss << "Check the links advertised with TC_REDUNDANCY " << redundancy;
+  return oss.str ();
+}
+
+Olsr6TcRedundancyTestCase::Olsr6TcRedundancyTestCase (uint32_t redundancy, uint32_t nLinks)
+  : TestCase (GetName (redundancy)),
+    m_redundancy (redundancy),
+    m_nLinks (nLinks),
+    m_nTc (0)
+{
+}
+
+void
+Olsr6TcRedundancyTestCase::Tx (const PacketHeader &header, const MessageList &messages)
+{
+  for (MessageList::const_iterator it = messages.begin (); it != messages.end (); it++)
+    {
+      if (it->GetMessageType () == MessageHeader::TC_MESSAGE)
+        {
+          m_nTc++;
+        }
+    }
+}
+
+void
+Olsr6TcRedundancyTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (4);
+
+  Olsr6Helper olsr6;
+  olsr6.Set ("TcRedundancy", UintegerValue (m_redundancy));
+  InternetStackHelper internet;
+  internet.SetRoutingHelper (olsr6);
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper simpleNetHelper;
+  simpleNetHelper.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  simpleNetHelper.SetChannelAttribute ("Delay", StringValue ("2ms"));
+
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase ("2001:1::", Ipv6Prefix (64));
+  for (uint32_t i = 0; i + 1 < nodes.GetN (); i++)
+    {
+      ipv6.Assign (simpleNetHelper.Install (NodeContainer (nodes.Get (i), nodes.Get (i + 1))));
+      ipv6.NewNetwork ();
+    }
+
+  Olsr6Helper::GetOlsr6RoutingProtocol (nodes.Get (0))->TraceConnectWithoutContext (
+    "Tx", MakeCallback (&Olsr6TcRedundancyTestCase::Tx, this));
+
+  Simulator::Stop (Seconds (30));
+  Simulator::Run ();
+  Ptr<RoutingProtocol> d = Olsr6Helper::GetOlsr6RoutingProtocol (nodes.Get (3));
+  MemoryUsage usage = d->GetMemoryUsage ();
+  uint32_t nRoutes = d->GetRoutingTableEntries ().size ();
+  Simulator::Destroy ();
+
+  if (m_redundancy == 0)
+    {
+      NS_TEST_EXPECT_MSG_EQ (m_nTc, 0, "A, selected by no one, should not send TC messages");
+    }
+  else
+    {
+      NS_TEST_EXPECT_MSG_GT (m_nTc, 0, "A should advertise B");
+    }
+  NS_TEST_EXPECT_MSG_EQ (usage.topologySet.count, m_nLinks, "Links known by D");
+  // 6 interface addresses, one of them owned by D
+  NS_TEST_EXPECT_MSG_EQ (nRoutes, 5, "D should reach every address");
+}
+
+static class Olsr6TcRedundancyTestSuite : public TestSuite
+{
+public:
+  Olsr6TcRedundancyTestSuite ();
+} g_olsr6TcRedundancyTestSuite;
+
+Olsr6TcRedundancyTestSuite::Olsr6TcRedundancyTestSuite ()
+  : TestSuite ("routing-olsr6-tc-redundancy", UNIT)
+{
+  AddTestCase (new Olsr6TcRedundancyTestCase (0, 4), TestCase::QUICK);
+  AddTestCase (new Olsr6TcRedundancyTestCase (1, 5), TestCase::QUICK);
+  AddTestCase (new Olsr6TcRedundancyTestCase (2, 5), TestCase::QUICK);
+}
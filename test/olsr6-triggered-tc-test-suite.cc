@@ -0,0 +1,176 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Ankit Deepak <adadeepak8@gmail.com>
+ *          Shravya Ks <shravya.ks0@gmail.com>,
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/boolean.h"
+#include "ns3/nstime.h"
+#include "ns3/olsr6-helper.h"
+#include "ns3/olsr6-routing-protocol.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/simple-net-device-helper.h"
+
+#include <vector>
+
+using namespace ns3;
+using namespace olsr6;
+
+/**
+ * Testcase checking, on the chain A - B - C, that B advertises its MPR
+ * selectors before its first periodic TC when triggered TCs are enabled,
+ * and that the triggered TCs are spaced and damped.
+ */
+class Olsr6TriggeredTcTestCase : public TestCase
+{
+public:
+  Olsr6TriggeredTcTestCase ();
+  /// \brief Run test case
+  virtual void DoRun (void);
+
+private:
+  /**
+   * \brief Runs the scenario.
+   * \param triggered true to enable the triggered TCs
+   */
+  void Run (bool triggered);
+  /**
+   * \brief Records the TC messages sent by B.
+   * \param header The packet header.
+   * \param messages The messages of the packet.
+   */
+  void Tx (const PacketHeader &header, const MessageList &messages);
+  /**
+   * \brief Records the triggered TC decisions of B.
+   * \param triggered The number of triggered TC messages sent so far.
+   * \param suppressed The number of triggers suppressed so far.
+   */
+  void TcTrigger (uint32_t triggered, uint32_t suppressed);
+
+  std::vector<Time> m_tcTimes;         //!< Emission times of the TC messages.
+  std::vector<Time> m_triggerTimes;    //!< Times at which triggered TCs were built.
+  uint32_t m_triggered;                //!< Triggered TCs sent.
+  uint32_t m_suppressed;               //!< Triggers suppressed.
+};
+
+Olsr6TriggeredTcTestCase::Olsr6TriggeredTcTestCase ()
+  : TestCase ("Check the triggered TC emission and its damping")
+{
+}
+
+void
+Olsr6TriggeredTcTestCase::Tx (const PacketHeader &header, const MessageList &messages)
+{
+  for (MessageList::const_iterator it = messages.begin (); it != messages.end (); it++)
+    {
+      if (it->GetMessageType () == MessageHeader::TC_MESSAGE)
+        {
+          m_tcTimes.push_back (Simulator::Now ());
+        }
+    }
+}
+
+void
+Olsr6TriggeredTcTestCase::TcTrigger (uint32_t triggered, uint32_t suppressed)
+{
+  if (triggered > m_triggered)
+    {
+      m_triggerTimes.push_back (Simulator::Now ());
+    }
+  m_triggered = triggered;
+  m_suppressed = suppressed;
+}
+
+void
+Olsr6TriggeredTcTestCase::Run (bool triggered)
+{
+  m_tcTimes.clear ();
+  m_triggerTimes.clear ();
+  m_triggered = 0;
+  m_suppressed = 0;
+
+  NodeContainer nodes;
+  nodes.Create (3);
+
+  Olsr6Helper olsr6;
+  olsr6.Set ("TriggeredTc", BooleanValue (triggered));
+  olsr6.Set ("TriggeredTcMinSpacing", TimeValue (Seconds (2)));
+  InternetStackHelper internet;
+  internet.SetRoutingHelper (olsr6);
+  internet.Install (nodes);
+
+  SimpleNetDeviceHelper simpleNetHelper;
+  simpleNetHelper.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  simpleNetHelper.SetChannelAttribute ("Delay", StringValue ("2ms"));
+
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase ("2001:1::", Ipv6Prefix (64));
+  ipv6.Assign (simpleNetHelper.Install (NodeContainer (nodes.Get (0), nodes.Get (1))));
+  ipv6.NewNetwork ();
+  ipv6.Assign (simpleNetHelper.Install (NodeContainer (nodes.Get (1), nodes.Get (2))));
+
+  Ptr<RoutingProtocol> b = Olsr6Helper::GetOlsr6RoutingProtocol (nodes.Get (1));
+  b->TraceConnectWithoutContext ("Tx", MakeCallback (&Olsr6TriggeredTcTestCase::Tx, this));
+  b->TraceConnectWithoutContext ("TcTrigger", MakeCallback (&Olsr6TriggeredTcTestCase::TcTrigger, this));
+
+  Simulator::Stop (Seconds (30));
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+void
+Olsr6TriggeredTcTestCase::DoRun (void)
+{
+  Run (false);
+  NS_TEST_ASSERT_MSG_GT (m_tcTimes.size (), 0, "B should send periodic TC messages");
+  NS_TEST_EXPECT_MSG_EQ (m_triggered, 0, "No triggered TC by default");
+  Time firstPeriodic = m_tcTimes.front ();
+
+  Run (true);
+  NS_TEST_ASSERT_MSG_GT (m_triggered, 0, "A and C selecting B as MPR should trigger a TC");
+  NS_TEST_ASSERT_MSG_GT (m_tcTimes.size (), 0, "B should send TC messages");
+  NS_TEST_EXPECT_MSG_LT (m_tcTimes.front (), firstPeriodic, "The triggered TC precedes the periodic one");
+  NS_TEST_EXPECT_MSG_EQ (m_triggerTimes.size (), m_triggered, "Every triggered TC is traced");
+
+  // A and C select B once each, and the chain is stable afterwards
+  NS_TEST_EXPECT_MSG_LT (m_triggered, 4, "At most one triggered TC per change of the selector set");
+  for (uint32_t i = 0; i + 1 < m_triggerTimes.size (); i++)
+    {
+      NS_TEST_EXPECT_MSG_EQ ((m_triggerTimes[i + 1] - m_triggerTimes[i] >= Seconds (2)), true,
+                             "Triggered TC " << i + 1 << " is closer than the minimum spacing");
+    }
+}
+
+static class Olsr6TriggeredTcTestSuite : public TestSuite
+{
+public:
+  Olsr6TriggeredTcTestSuite ();
+} g_olsr6TriggeredTcTestSuite;
+
+Olsr6TriggeredTcTestSuite::Olsr6TriggeredTcTestSuite ()
+  : TestSuite ("routing-olsr6-triggered-tc", UNIT)
+{
+  AddTestCase (new Olsr6TriggeredTcTestCase (), TestCase::QUICK);
+}
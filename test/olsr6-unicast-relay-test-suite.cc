@@ -0,0 +1,246 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016 NITK Surathkal
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ * Authors: Ankit Deepak <adadeepak8@gmail.com>
+ *          Shravya Ks <shravya.ks0@gmail.com>,
+ *          Mohit P. Tahiliani <tahiliani@nitk.edu.in>
+ */
+
+
+
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/boolean.h"
+#include "ns3/olsr6-helper.h"
+#include "ns3/olsr6-routing-protocol.h"
+#include "ns3/internet-stack-helper.h"
+#include "ns3/ipv6-address-helper.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/socket-factory.h"
+#include "ns3/ipv6-raw-socket-factory.h"
+#include "ns3/ipv6-raw-socket-impl.h"
+#include "ns3/udp-l4-protocol.h"
+#include "ns3/udp-header.h"
+
+#include <limits>
+
+using namespace ns3;
+using namespace olsr6;
+
+/**
+ * Counts the OLSR6 packets delivered to a node once the routes are
+ * established, by destination and content.
+ */
+class RelayProbe
+{
+public:
+  RelayProbe ();
+  /**
+   * \brief Opens a raw socket on a node to receive its UDP packets.
+   * \param node The node.
+   */
+  void Install (Ptr<Node> node);
+  /**
+   * \brief Receive callback of the raw socket.
+   * \param socket The socket.
+   */
+  void Receive (Ptr<Socket> socket);
+
+  Ptr<Socket> m_socket;         //!< Raw socket.
+  uint32_t m_helloPackets;      //!< Packets with a HELLO message.
+  uint32_t m_multicastPackets;  //!< Multicast packets without HELLO message.
+  uint32_t m_unicastPackets;    //!< Unicast packets.
+};
+
+RelayProbe::RelayProbe ()
+  : m_helloPackets (0),
+    m_multicastPackets (0),
+    m_unicastPackets (0)
+{
+}
+
+void
+RelayProbe::Install (Ptr<Node> node)
+{
+  Ptr<SocketFactory> factory = node->GetObject<Ipv6RawSocketFactory> ();
+  Ptr<Ipv6RawSocketImpl> socket = DynamicCast<Ipv6RawSocketImpl> (factory->CreateSocket ());
+  socket->SetProtocol (UdpL4Protocol::PROT_NUMBER);
+  socket->SetRecvCallback (MakeCallback (&RelayProbe::Receive, this));
+  m_socket = socket;
+}
+
+void
+RelayProbe::Receive (Ptr<Socket> socket)
+{
+  Ptr<Packet> packet = socket->Recv (std::numeric_limits<uint32_t>::max (), 0);
+  // The neighbors know each other after a few HELLOs
+  if (Simulator::Now () < Seconds (10))
+    {
+      return;
+    }
+
+  Ipv6Header ipHdr;
+  packet->RemoveHeader (ipHdr);
+  UdpHeader udpHdr;
+  packet->RemoveHeader (udpHdr);
+  PacketHeader pktHdr;
+  packet->RemoveHeader (pktHdr);
+  bool hello = false;
+  while (packet->GetSize () > 0)
+    {
+      MessageHeader msgHdr;
+      packet->RemoveHeader (msgHdr);
+      hello = hello || msgHdr.GetMessageType () == MessageHeader::HELLO_MESSAGE;
+    }
+
+  if (!ipHdr.GetDestinationAddress ().IsMulticast ())
+    {
+      m_unicastPackets++;
+    }
+  else if (hello)
+    {
+      m_helloPackets++;
+    }
+  else
+    {
+      m_multicastPackets++;
+    }
+}
+
+/**
+ * \brief Tells whether a node has a route to a destination.
+ * \param protocol The routing protocol of the node.
+ * \param dest The destination.
+ * \returns True if the node has a route to the destination.
+ */
+static bool
+HasRoute (Ptr<RoutingProtocol> protocol, Ipv6Address dest)
+{
+  std::vector<RoutingTableEntry> entries = protocol->GetRoutingTableEntries ();
+  for (std::vector<RoutingTableEntry>::const_iterator it = entries.begin (); it != entries.end (); it++)
+    {
+      if (it->destAddr == dest)
+        {
+          return true;
+        }
+    }
+  return false;
+}
+
+/**
+ * Testcase for the unicast relay on the chain A - B - C - D of point to
+ * point links, where B also has a link to H, a host which does not run
+ * OLSR6.  The TCs of B and C are flooded along the chain; with the
+ * unicast relay, they are sent as unicast to the single neighbor of each
+ * link and never reach H.
+ */
+class Olsr6UnicastRelayTestCase : public TestCase
+{
+public:
+  /**
+   * \param unicastRelay True if the nodes relay as unicast.
+   */
+  Olsr6UnicastRelayTestCase (bool unicastRelay);
+  /// \brief Run test case
+  virtual void DoRun (void);
+
+private:
+  bool m_unicastRelay;  //!< True if the nodes relay as unicast.
+};
+
+Olsr6UnicastRelayTestCase::Olsr6UnicastRelayTestCase (bool unicastRelay)
+  : TestCase (unicastRelay ? "Check the TCs relayed as unicast on a chain"
+              : "Check the TCs relayed as multicast on a chain"),
+    m_unicastRelay (unicastRelay)
+{
+}
+
+void
+Olsr6UnicastRelayTestCase::DoRun (void)
+{
+  NodeContainer nodes;
+  nodes.Create (4);
+  NodeContainer host;
+  host.Create (1);
+
+  Olsr6Helper olsr6;
+  olsr6.Set ("UnicastRelay", BooleanValue (m_unicastRelay));
+  InternetStackHelper internet;
+  internet.SetRoutingHelper (olsr6);
+  internet.Install (nodes);
+  InternetStackHelper hostInternet;
+  hostInternet.Install (host);
+
+  SimpleNetDeviceHelper simpleNetHelper;
+  simpleNetHelper.SetDeviceAttribute ("DataRate", StringValue ("10Mbps"));
+  simpleNetHelper.SetChannelAttribute ("Delay", StringValue ("2ms"));
+
+  // A, B, C, D are the nodes 0 to 3
+  Ipv6AddressHelper ipv6;
+  ipv6.SetBase ("2001:1::", Ipv6Prefix (64));
+  Ipv6InterfaceContainer ab = ipv6.Assign (simpleNetHelper.Install (NodeContainer (nodes.Get (0), nodes.Get (1))));
+  ipv6.NewNetwork ();
+  ipv6.Assign (simpleNetHelper.Install (NodeContainer (nodes.Get (1), nodes.Get (2))));
+  ipv6.NewNetwork ();
+  Ipv6InterfaceContainer cd = ipv6.Assign (simpleNetHelper.Install (NodeContainer (nodes.Get (2), nodes.Get (3))));
+  ipv6.NewNetwork ();
+  ipv6.Assign (simpleNetHelper.Install (NodeContainer (nodes.Get (1), host.Get (0))));
+
+  RelayProbe a;
+  a.Install (nodes.Get (0));
+  RelayProbe h;
+  h.Install (host.Get (0));
+
+  Simulator::Stop (Seconds (30));
+  Simulator::Run ();
+
+  Ptr<RoutingProtocol> aProtocol = Olsr6Helper::GetOlsr6RoutingProtocol (nodes.Get (0));
+  Ptr<RoutingProtocol> dProtocol = Olsr6Helper::GetOlsr6RoutingProtocol (nodes.Get (3));
+  NS_TEST_EXPECT_MSG_EQ (HasRoute (aProtocol, cd.GetAddress (1, 1)), true, "A has a route to D");
+  NS_TEST_EXPECT_MSG_EQ (HasRoute (dProtocol, ab.GetAddress (0, 1)), true, "D has a route to A");
+  NS_TEST_EXPECT_MSG_GT (a.m_helloPackets, 0, "A received HELLOs");
+  NS_TEST_EXPECT_MSG_GT (h.m_helloPackets, 0, "H received the HELLOs of B");
+  if (m_unicastRelay)
+    {
+      NS_TEST_EXPECT_MSG_GT (a.m_unicastPackets, 0, "A received the TCs as unicast");
+      NS_TEST_EXPECT_MSG_EQ (a.m_multicastPackets, 0, "A received no multicast TC");
+      NS_TEST_EXPECT_MSG_EQ (h.m_multicastPackets + h.m_unicastPackets, 0, "H received no TC");
+    }
+  else
+    {
+      NS_TEST_EXPECT_MSG_EQ (a.m_unicastPackets, 0, "A received no unicast packet");
+      NS_TEST_EXPECT_MSG_GT (h.m_multicastPackets, 0, "H received the TCs");
+    }
+
+  a.m_socket = 0;
+  h.m_socket = 0;
+  Simulator::Destroy ();
+}
+
+static class Olsr6UnicastRelayTestSuite : public TestSuite
+{
+public:
+  Olsr6UnicastRelayTestSuite ();
+} g_olsr6UnicastRelayTestSuite;
+
+Olsr6UnicastRelayTestSuite::Olsr6UnicastRelayTestSuite ()
+  : TestSuite ("routing-olsr6-unicast-relay", UNIT)
+{
+  AddTestCase (new Olsr6UnicastRelayTestCase (false), TestCase::QUICK);
+  AddTestCase (new Olsr6UnicastRelayTestCase (true), TestCase::QUICK);
+}